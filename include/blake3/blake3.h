@@ -0,0 +1,149 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Portable BLAKE3 hash, only the default hash mode is supported. This is
+ * shared between the bootloader and the host tools.
+ *
+ * BLAKE3 hashes the input as a binary tree of 1 KiB chunks. Complete
+ * subtrees are independent of each other, which lets the caller hash them on
+ * several cores and push the results with 'blake3_hasher_push_subtree':
+ *
+ *   n = blake3_hasher_update_head(&h, input, length);
+ *
+ *   while (length - n > BLAKE3_CHUNK_LEN) {
+ *       len = blake3_subtree_len(h.chunk.counter, length - n);
+ *       blake3_subtree_cvs(&input[n], len, h.chunk.counter, cvs);
+ *       blake3_hasher_push_subtree(&h, cvs, len);
+ *       n += len;
+ *   }
+ *
+ *   blake3_hasher_update(&h, &input[n], length - n);
+ *
+ * which is what 'blake3_hasher_update' does on its own.
+ *
+ */
+
+#ifndef INCLUDE_BLAKE3_BLAKE3_H
+#define INCLUDE_BLAKE3_BLAKE3_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BLAKE3_OUT_LEN   32
+#define BLAKE3_BLOCK_LEN 64
+#define BLAKE3_CHUNK_LEN 1024
+#define BLAKE3_MAX_DEPTH 54
+
+struct blake3_chunk_state {
+    uint32_t cv[8]; /*!< Chaining value */
+    uint64_t counter; /*!< Index of this chunk */
+    uint8_t buf[BLAKE3_BLOCK_LEN]; /*!< Partial block */
+    uint8_t buf_len; /*!< Bytes in 'buf' */
+    uint8_t blocks_compressed; /*!< Compressed blocks in this chunk */
+};
+
+struct blake3_hasher {
+    struct blake3_chunk_state chunk; /*!< Current chunk */
+    uint8_t cv_stack_len; /*!< Number of entries on 'cv_stack' */
+    uint8_t cv_stack[(BLAKE3_MAX_DEPTH + 1) * BLAKE3_OUT_LEN];
+    /*!< Chaining values of complete subtrees that are not merged yet */
+};
+
+/**
+ * Initialize a hasher
+ *
+ * @param[out] self Hasher
+ */
+void blake3_hasher_init(struct blake3_hasher *self);
+
+/**
+ * Add input to a hasher
+ *
+ * @param[in] self Hasher
+ * @param[in] input Input buffer
+ * @param[in] length Length of input
+ */
+void blake3_hasher_update(struct blake3_hasher *self, const void *input, size_t length);
+
+/**
+ * Output the digest. The hasher is not modified and more input can be
+ * added afterwards.
+ *
+ * @param[in] self Hasher
+ * @param[out] out Output buffer
+ * @param[in] out_length Bytes to output, usually BLAKE3_OUT_LEN
+ */
+void blake3_hasher_finalize(const struct blake3_hasher *self, uint8_t *out, size_t out_length);
+
+/**
+ * Add input until the hasher is at a chunk boundary and there is more input,
+ * or until the input is consumed.
+ *
+ * @param[in] self Hasher
+ * @param[in] input Input buffer
+ * @param[in] length Length of input
+ *
+ * @return Number of bytes consumed
+ */
+size_t blake3_hasher_update_head(struct blake3_hasher *self, const void *input, size_t length);
+
+/**
+ * Add the chaining values of a complete subtree, computed by
+ * 'blake3_subtree_cvs'. The hasher must be at a chunk boundary, see
+ * 'blake3_hasher_update_head'.
+ *
+ * @param[in] self Hasher
+ * @param[in] cvs Chaining values of the subtree
+ * @param[in] length Length of the subtree input
+ */
+void blake3_hasher_push_subtree(struct blake3_hasher *self, const uint8_t *cvs, size_t length);
+
+/**
+ * Length of the largest complete subtree that starts at chunk 'counter' and
+ * fits in 'length' bytes. 'length' must be larger than BLAKE3_CHUNK_LEN.
+ *
+ * @param[in] counter Index of the first chunk
+ * @param[in] length Available input
+ *
+ * @return Length of the subtree in bytes, a power of two
+ */
+size_t blake3_subtree_len(uint64_t counter, size_t length);
+
+/**
+ * Compute the chaining values that 'blake3_hasher_push_subtree' takes for a
+ * subtree. That is one value for a single chunk and the values of the two
+ * halves for larger subtrees.
+ *
+ * This does not use any shared state and can run on several cores at once.
+ *
+ * @param[in] input Subtree input
+ * @param[in] length Subtree length, from 'blake3_subtree_len'
+ * @param[in] counter Index of the first chunk
+ * @param[out] cvs Output, BLAKE3_OUT_LEN or 2 * BLAKE3_OUT_LEN bytes
+ */
+void blake3_subtree_cvs(const uint8_t *input, size_t length, uint64_t counter, uint8_t *cvs);
+
+/**
+ * Compute the chaining value of a complete subtree that is not the root.
+ * Re-entrant, like 'blake3_subtree_cvs'.
+ *
+ * @param[in] input Subtree input
+ * @param[in] length Subtree length, a power of two number of chunks
+ * @param[in] counter Index of the first chunk
+ * @param[out] cv Output, BLAKE3_OUT_LEN bytes
+ */
+void blake3_subtree_cv(const uint8_t *input, size_t length, uint64_t counter, uint8_t *cv);
+
+/**
+ * Compute the chaining value of a parent node that is not the root
+ *
+ * @param[in] children Chaining values of the left and the right child
+ * @param[out] cv Output, BLAKE3_OUT_LEN bytes
+ */
+void blake3_parent_cv(const uint8_t *children, uint8_t *cv);
+
+#endif // INCLUDE_BLAKE3_BLAKE3_H
@@ -16,8 +16,9 @@
 #include <uuid.h>
 
 /* TODO: Write a note about the bpak block size of 512 bytes */
-typedef int (*boot_read_cb_t)(int block_offset, size_t length, void *buf);
+typedef int (*boot_read_cb_t)(lba_t block_offset, size_t length, void *buf);
 typedef int (*boot_result_cb_t)(int result);
+typedef bool (*boot_skip_cb_t)(struct bpak_header *header, bpak_id_t part_id);
 
 /** Boot sources */
 enum boot_source {
@@ -52,10 +53,13 @@ struct boot_driver {
     int (*set_boot_partition)(uuid_t part_uu);
     void (*get_boot_partition)(uuid_t part_uu);
     int (*get_in_mem_image)(struct bpak_header **header);
+    boot_skip_cb_t skip_part; /*!< Optional, return true for parts that should not be loaded.
+                                   Only used for images with per-part digests */
     int (*authenticate_image)(struct bpak_header **header_ptr);
     int (*prepare)(struct bpak_header *header, uuid_t boot_part_uu);
     int (*late_boot_cb)(struct bpak_header *header, uuid_t boot_part_uu);
     void (*jump)(void);
+    bool (*warm_reset)(void); /*!< Optional, true if memory was retained since the last boot */
 };
 
 /**
@@ -122,6 +126,15 @@ void boot_clear_set_flags(uint32_t clear, uint32_t set);
  */
 uint32_t boot_get_flags(void);
 
+/**
+ * Check if the last boot reused a payload that was retained in memory
+ * over a warm reset. The payload is always verified against the
+ * authenticated header before it is reused.
+ *
+ * @return true if at least one part was not loaded again
+ */
+bool boot_warm_cache_hit(void);
+
 /**
  * Proxy function to set/activate a boot partition. This function will
  * call the 'set_boot_partition' callback in the config struct if it's
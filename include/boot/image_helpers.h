@@ -33,10 +33,64 @@ int boot_image_auth_header(struct bpak_header *hdr);
 
 int boot_image_verify_parts(struct bpak_header *hdr);
 
+/**
+ * Check if every part of an image has a signed digest
+ *
+ * Parts carry their own digest in a 'pb-part-digest' meta with the part
+ * as reference. The digest is computed over the part data including its
+ * padding, with the hash kind of the header, and is covered by the header
+ * signature.
+ *
+ * @param[in] hdr Pointer to an authenticated header
+ *
+ * @return true if all parts have a digest of the correct size
+ */
+bool boot_image_has_part_digests(struct bpak_header *hdr);
+
+/**
+ * Verify one part that is already at its load address
+ *
+ * Parts with signed digests can be loaded in any order, or in parallel,
+ * and verified independently of each other.
+ *
+ * @param[in] hdr Pointer to an authenticated header
+ * @param[in] part_id ID of the part to verify
+ *
+ * @return PB_OK, if the part matches its digest
+ *        -PB_ERR_BAD_HEADER, on bad header magic
+ *        -PB_ERR_UNKNOWN_HASH, Unknown hash
+ *        -PB_ERR_NOT_FOUND, if the part does not exist
+ *        -PB_ERR_BAD_META, if the load address or the digest is missing
+ *        -PB_ERR_BAD_PAYLOAD, on digest mismatch
+ */
+int boot_image_verify_part(struct bpak_header *hdr, bpak_id_t part_id);
+
+/**
+ * Load and hash all parts of an image
+ *
+ * When the image has per-part digests each part is verified as soon as it
+ * has been loaded and before 'result_f' is called for the part. Parts for
+ * which 'skip_f' returns true are not loaded. 'payload_digest' is set to the
+ * signed payload hash when all loaded parts have been verified.
+ *
+ * Without per-part digests all parts are loaded and 'payload_digest' is
+ * the hash of the complete payload.
+ *
+ * @param[in] hdr Pointer to an authenticated header
+ * @param[in] load_chunk_size Maximum size of one 'read_f' call
+ * @param[in] read_f Optional read function, NULL if the parts are in memory
+ * @param[in] result_f Optional callback with the result of each part
+ * @param[in] skip_f Optional callback that selects parts to skip
+ * @param[out] payload_digest Output digest buffer
+ * @param[in] payload_digest_size Size of the output buffer
+ *
+ * @return PB_OK on success or a negative error code
+ */
 int boot_image_load_and_hash(struct bpak_header *hdr,
                              size_t load_chunk_size,
                              boot_read_cb_t read_f,
                              boot_result_cb_t result_f,
+                             boot_skip_cb_t skip_f,
                              uint8_t *payload_digest,
                              size_t payload_digest_size);
 
@@ -15,13 +15,37 @@
  * Board regs are accessed in reverse order to allow future expansion. If the
  * reserved array is further split, consider carving of another reserved space
  * to make sure it's possible to grow the board_regs.
+ *
+ * Note 2: Journal
+ * Block 0 of the state partition holds a snapshot of the state. The
+ * following blocks, at most PB_STATE_JOURNAL_MAX_RECORDS, are a journal
+ * where a commit that only changes remaining_boot_attempts appends one
+ * complete state with the magic PB_STATE_JOURNAL_MAGIC. Any other change
+ * is written as a new snapshot. A record is valid if the CRC is correct and its
+ * generation matches the snapshot, the current state is the last valid
+ * record in an unbroken sequence from block 1, or the snapshot if there is
+ * none.
+ *
+ * When the journal is full, a new snapshot with the next generation is
+ * written, first to the backup partition and then to the primary. This
+ * invalidates all records of the previous generation. Only the primary
+ * partition has a journal, the backup holds the state of the latest
+ * snapshot. The backup can therefore only lag behind on the boot attempt
+ * counter, if the primary is lost a trial boot is restarted with the
+ * counter of the last snapshot.
+ *
+ * A state partition of one block has no journal and every commit writes a
+ * new snapshot.
  */
 
 #include <stdint.h>
 
-#define PB_STATE_MAGIC            0x026d4a65
+#define PB_STATE_MAGIC               0x026d4a65
+#define PB_STATE_JOURNAL_MAGIC       0x4a6f7572
+
+#define PB_STATE_JOURNAL_MAX_RECORDS 63
 
-#define PB_STATE_NO_OF_BOARD_REGS 4
+#define PB_STATE_NO_OF_BOARD_REGS    4
 
 struct pb_boot_state /* 512 bytes */
 {
@@ -30,7 +54,8 @@ struct pb_boot_state /* 512 bytes */
     uint32_t verified; /*!< Boot partition verified bits */
     uint32_t remaining_boot_attempts; /*!< Rollback boot counter */
     uint32_t error; /*!< Rollback error bits */
-    uint8_t rz[472]; /*!< Reserved, set to zero */
+    uint32_t generation; /*!< Snapshot generation, see note 2 */
+    uint8_t rz[468]; /*!< Reserved, set to zero */
     uint32_t board_regs[PB_STATE_NO_OF_BOARD_REGS]; /*!< Board specific registers */
     uint32_t crc; /*!< State checksum */
 } __attribute__((packed));
@@ -82,6 +82,7 @@ enum bpak_signature_kind {
     BPAK_SIGN_PRIME256v1,
     BPAK_SIGN_SECP384r1,
     BPAK_SIGN_SECP521r1,
+    BPAK_SIGN_ED25519,
 };
 
 /*! \public
@@ -146,6 +147,8 @@ enum bpak_key_kind {
     BPAK_KEY_PRI_PRIME256v1,
     BPAK_KEY_PRI_SECP384r1,
     BPAK_KEY_PRI_SECP521r1,
+    BPAK_KEY_PUB_ED25519,
+    BPAK_KEY_PRI_ED25519,
 };
 
 /*
@@ -25,6 +25,7 @@
 #define BPAK_ID_BPAK_PACKAGE         (0xfb2f1f3f)
 #define BPAK_ID_BPAK_KEY_ID          (0x7da19399)
 #define BPAK_ID_BPAK_KEY_STORE       (0x106c13a7)
+#define BPAK_ID_PB_PART_DIGEST       (0x26ac168f)
 
 /* Algorithm ID's */
 #define BPAK_ID_BSDIFF               (0x9f7aacf9)
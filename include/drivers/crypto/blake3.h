@@ -0,0 +1,21 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef INCLUDE_DRIVERS_CRYPTO_BLAKE3_H
+#define INCLUDE_DRIVERS_CRYPTO_BLAKE3_H
+
+/**
+ * Register the software BLAKE3 hash as a hash provider for HASH_BLAKE3.
+ * Large updates are spread over all cores when CONFIG_SMP is enabled.
+ *
+ * @return PB_OK on success or the result of 'hash_add_ops'
+ */
+int blake3_pb_init(void);
+
+#endif // INCLUDE_DRIVERS_CRYPTO_BLAKE3_H
@@ -0,0 +1,21 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef INCLUDE_DRIVERS_CRYPTO_ED25519_H
+#define INCLUDE_DRIVERS_CRYPTO_ED25519_H
+
+/**
+ * Register the software Ed25519 verifier as a DSA provider for DSA_ED25519.
+ * SHA-512 must be available from one of the hash providers.
+ *
+ * @return PB_OK on success or the result of 'dsa_add_ops'
+ */
+int ed25519_pb_init(void);
+
+#endif // INCLUDE_DRIVERS_CRYPTO_ED25519_H
@@ -14,4 +14,14 @@
 
 int imx_caam_init(uintptr_t base);
 
+/**
+ * Wait for job completion interrupts instead of polling the output ring.
+ * Must be called after 'imx_caam_init'.
+ *
+ * @param[in] irq Job ring interrupt number
+ *
+ * @return PB_OK on success or a negative number
+ */
+int imx_caam_enable_irq(unsigned int irq);
+
 #endif // DRIVERS_CRYPTO_IMX_CAAM_H
@@ -0,0 +1,27 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef INCLUDE_DRIVERS_IRQ_GICV2_H
+#define INCLUDE_DRIVERS_IRQ_GICV2_H
+
+#include <stdint.h>
+
+/**
+ * Initialize the distributor and the CPU interface of the calling core and
+ * register the GIC as the interrupt controller. Interrupt numbers passed to
+ * 'irq_register' are GIC interrupt ID's, i.e. SPI n is ID 32 + n.
+ *
+ * @param[in] gicd_base Distributor base address
+ * @param[in] gicc_base CPU interface base address
+ *
+ * @return PB_OK on success or a negative number
+ */
+int gicv2_init(uintptr_t gicd_base, uintptr_t gicc_base);
+
+#endif // INCLUDE_DRIVERS_IRQ_GICV2_H
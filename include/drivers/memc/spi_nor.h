@@ -0,0 +1,86 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Controller independent SPI-NOR core. It exposes a NOR flash as a block
+ * device and does the page splitting, erase block selection and program
+ * scheduling on top of a thin controller HAL.
+ *
+ * Erase blocks that are already blank and pages that are blank or already
+ * hold the data to be written are skipped. Reading is much faster than
+ * erasing and programming, which dominate the time it takes to flash NOR.
+ *
+ */
+
+#ifndef INCLUDE_DRIVERS_MEMC_SPI_NOR_H
+#define INCLUDE_DRIVERS_MEMC_SPI_NOR_H
+
+#include <pb/bio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SPI_NOR_MAX_ERASE_CMDS   4
+#define SPI_NOR_MAX_PAGE_SIZE    1024
+/* Largest erase block that can be rewritten when a page needs an erase */
+#define SPI_NOR_MAX_REWRITE_SIZE 4096
+
+struct spi_nor_device;
+
+typedef int (*spi_nor_read_t)(const struct spi_nor_device *dev,
+                              uint32_t address,
+                              void *buf,
+                              size_t length);
+typedef int (*spi_nor_program_t)(const struct spi_nor_device *dev,
+                                 uint32_t address,
+                                 const void *buf,
+                                 size_t length);
+typedef int (*spi_nor_erase_t)(const struct spi_nor_device *dev,
+                               uint32_t address,
+                               unsigned int erase_idx);
+
+struct spi_nor_hal {
+    spi_nor_read_t read; /*!< Read, waits for ongoing operations to complete */
+    spi_nor_program_t page_program; /*!< Program at most one page and wait for completion */
+    spi_nor_erase_t erase; /*!< Erase one block with 'erase_sizes[erase_idx]' and wait */
+};
+
+struct spi_nor_stats {
+    unsigned int pages_programmed; /*!< Pages written to the flash */
+    unsigned int pages_skipped; /*!< Blank or unchanged pages */
+    unsigned int blocks_erased; /*!< Erase commands issued */
+    unsigned int blocks_skipped; /*!< Erase blocks that were already blank */
+    unsigned int blocks_rewritten; /*!< Erase blocks that were read, erased
+                                        and programmed again because a
+                                        write needed a bit set */
+};
+
+struct spi_nor_device {
+    const char *name; /*!< Name of the block device */
+    const unsigned char *uuid; /*!< UUID of the block device */
+    size_t capacity; /*!< Size of the flash in bytes */
+    size_t block_size; /*!< Block size of the block device, at least the
+                            smallest erase block */
+    size_t page_size; /*!< Program page size, a power of two */
+    size_t erase_sizes[SPI_NOR_MAX_ERASE_CMDS]; /*!< Erase block sizes in
+                                                     descending order, zero
+                                                     terminated */
+    const struct spi_nor_hal *hal; /*!< Controller HAL */
+    uintptr_t priv; /*!< HAL private data */
+    struct spi_nor_stats stats; /*!< Updated by the core */
+};
+
+/**
+ * Register a NOR flash as a block device
+ *
+ * @param[in] dev Device description, must stay valid
+ *
+ * @return A block device on success,
+ *        -PB_ERR_PARAM, on invalid geometry
+ *        or the result of 'bio_allocate'
+ */
+bio_dev_t spi_nor_init(struct spi_nor_device *dev);
+
+#endif // INCLUDE_DRIVERS_MEMC_SPI_NOR_H
@@ -10,6 +10,7 @@
 #ifndef INCLUDE_PB_MMC_H
 #define INCLUDE_PB_MMC_H
 
+#include <pb/bio.h>
 #include <pb/utils_def.h>
 #include <uuid.h>
 
@@ -298,6 +299,9 @@ typedef uint32_t mmc_cmd_resp_t[4];
 
 typedef int (*mmc_init_t)(void);
 typedef int (*mmc_io_t)(unsigned int lba, size_t length, uintptr_t buf);
+typedef int (*mmc_io_sg_t)(unsigned int lba,
+                           const struct bio_segment *segs,
+                           unsigned int no_of_segs);
 
 typedef int (*mmc_set_bus_clock_t)(unsigned int clk_hz);
 typedef int (*mmc_set_bus_width_t)(enum mmc_bus_width width);
@@ -310,9 +314,15 @@ struct mmc_hal {
     mmc_set_bus_clock_t set_bus_clock; /*!< Set bus clock rate */
     mmc_set_bus_width_t set_bus_width; /*!< Set bus with */
     mmc_io_t prepare; /*!< Prepare DMA and start xfer, this is optional */
+    mmc_io_sg_t prepare_sg; /*!< Prepare a scatter-gather DMA xfer, this is
+                                 optional. 'read' is called for each segment
+                                 when the transfer has completed */
     mmc_io_t read; /*!< Perform read op */
     mmc_io_t write; /*!< Perform write op */
     int (*set_delay_tap)(unsigned int tap); /*!< Select bus delay tap */
+    int (*wait_busy)(unsigned int timeout_ms); /*!< Wait for the card to
+                                                    release DAT0 after a write,
+                                                    this is optional */
     size_t max_chunk_bytes; /*!< Maximum bytes per iop */
 };
 
@@ -333,6 +343,13 @@ struct mmc_device_config {
     uint32_t flags;
     uint8_t boot_mode; /*!< Optional, used to update the boot
                          mode in extcsd, for example, for fast boot */
+    int (*tuning_cache_read)(const mmc_cmd_resp_t cid,
+                             unsigned int *tap); /*!< Optional, read the cached
+                                                   HS200 delay tap of card
+                                                   'cid' */
+    int (*tuning_cache_write)(const mmc_cmd_resp_t cid,
+                              unsigned int tap); /*!< Optional, store HS200
+                                                   delay tap for card 'cid' */
 };
 
 /**
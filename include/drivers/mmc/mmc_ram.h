@@ -0,0 +1,68 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * RAM backed eMMC card behind the MMC core, for testing the core without
+ * hardware. The card answers the commands that the core issues during
+ * enumeration, partition switches and block transfers. A pre-defined block
+ * count (CMD23) must match the length of the transfer that follows it. A
+ * write leaves the card in PRG, where only CMD13 is accepted, until the
+ * status has been polled or the HAL has waited for the busy signal. HS200
+ * tuning blocks are only returned correctly for a window of delay taps.
+ * Every command is counted.
+ *
+ */
+
+#ifndef INCLUDE_DRIVERS_MMC_MMC_RAM_H
+#define INCLUDE_DRIVERS_MMC_MMC_RAM_H
+
+#include <drivers/mmc/mmc_core.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MMC_RAM_MAX_CMDS 64
+
+struct mmc_ram_config {
+    uint8_t *user; /*!< Backing storage of the user area */
+    size_t user_size; /*!< Size of the user area in bytes */
+    uint8_t *boot0; /*!< Backing storage of boot partition 0 */
+    uint8_t *boot1; /*!< Backing storage of boot partition 1 */
+    size_t boot_size; /*!< Size of each boot partition, a multiple of 128 KiB */
+    uint8_t *rpmb; /*!< Backing storage of the RPMB partition */
+    size_t rpmb_size; /*!< Size of the RPMB partition, a multiple of 128 KiB */
+    size_t max_chunk_bytes; /*!< Largest transfer of one command */
+    unsigned int tap_first; /*!< First delay tap that samples correctly */
+    unsigned int tap_last; /*!< Last delay tap that samples correctly */
+    struct mmc_device_config mmc; /*!< Passed to 'mmc_init' */
+};
+
+struct mmc_ram_stats {
+    unsigned int cmds[MMC_RAM_MAX_CMDS]; /*!< Commands issued, by index */
+    unsigned long long read_bytes; /*!< Bytes read from the card */
+    unsigned long long write_bytes; /*!< Bytes written to the card */
+    unsigned int delay_tap; /*!< Currently selected delay tap */
+    unsigned int busy_waits; /*!< DAT0 busy waits after writes */
+};
+
+/**
+ * Initialize the card and register it through 'mmc_init'
+ *
+ * @param[in] cfg Card configuration, must stay valid
+ *
+ * @return PB_OK on success,
+ *        -PB_ERR_PARAM, on invalid partition or chunk sizes
+ *        or the result of 'mmc_init'
+ */
+int mmc_ram_init(const struct mmc_ram_config *cfg);
+
+/**
+ * Command and transfer statistics of the card
+ *
+ * @return Statistics since 'mmc_ram_init'
+ */
+const struct mmc_ram_stats *mmc_ram_stats(void);
+
+#endif // INCLUDE_DRIVERS_MMC_MMC_RAM_H
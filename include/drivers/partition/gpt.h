@@ -18,7 +18,7 @@
 struct gpt_part_table {
     const unsigned char *uu;
     const char *description;
-    size_t size;
+    uint64_t size;
 };
 
 struct gpt_table_list {
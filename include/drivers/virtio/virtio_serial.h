@@ -12,11 +12,12 @@
 
 #include <stdint.h>
 
-int virtio_serial_init(uintptr_t base);
+int virtio_serial_init(uintptr_t base, unsigned int irq);
 int virtio_serial_write(const void *buf, size_t length);
 int virtio_serial_read(void *buf, size_t length);
 int virtio_serial_async_write(const void *buf, size_t length);
 int virtio_serial_async_read(void *buf, size_t length);
 int virtio_serial_async_complete(void);
+struct pb_event *virtio_serial_event(void);
 
 #endif // DRIVERS_VIRTIO_SERIAL_H
@@ -13,6 +13,7 @@
 typedef SSIZE_T ssize_t;
 #endif // _SSIZE_T_DEFINED
 #define sleep(x) Sleep(x * 1000)
+#define usleep(x) Sleep((x) / 1000)
 #endif // _MSC_VER
 
 #endif // INCLUDE_PB_TOOLS_COMPAT_H
@@ -91,6 +91,8 @@ enum pb_commands {
     PB_CMD_STREAM_READ_BUFFER,
     PB_CMD_PART_RESIZE,
     PB_CMD_BOOT_STATUS,
+    PB_CMD_PART_READ_DIGESTS,
+    PB_CMD_CRYPTO_PROVIDERS_READ,
     PB_CMD_END, /* Sentinel, must be the last entry */
 };
 
@@ -138,7 +140,16 @@ PACK(struct pb_result_device_caps {
 
     uint32_t chunk_transfer_max_bytes; /*!< Maximum number of bytes in one
                                                                    transfer */
-    uint8_t rz[18]; /*!< Reserved */
+    uint32_t part_digest_chunk_size; /*!< Chunk size in bytes used for
+                                         per-chunk partition digests, zero if
+                                         not supported */
+    uint8_t stream_read_flags; /*!< Supported stream read flags,
+                                   see PB_STREAM_READ_FLAG_* */
+    uint8_t verify_digest_algs; /*!< Digests supported by the verify command,
+                                    bit n is set for enum pb_digest_alg n */
+    uint8_t verify_digest_preferred; /*!< Fastest digest on this device,
+                                         see enum pb_digest_alg */
+    uint8_t rz[11]; /*!< Reserved */
 });
 
 /**
@@ -201,6 +212,13 @@ PACK(struct pb_command_stream_prepare_buffer {
 
 /**
  * Write data from an internal buffer to a partition
+ *
+ * The device may commit the buffer to storage in the background and reply
+ * before the write has completed. A failed background write is reported in
+ * the result of the next STREAM_PREPARE_BUFFER or STREAM_WRITE_BUFFER. A
+ * prepare into another buffer may be accepted while the write is still in
+ * progress, the error is then reported by the following command. Any other
+ * command, like STREAM_FINALIZE, waits for the write and reports its result.
  */
 PACK(struct pb_command_stream_write_buffer {
     uint32_t size; /*!< Bytes to transfer from buffer to partition */
@@ -209,6 +227,20 @@ PACK(struct pb_command_stream_write_buffer {
     uint8_t rz[19]; /*!< Reserved */
 });
 
+/**
+ * \def PB_STREAM_READ_FLAG_ELIDE_ZERO
+ * Don't transfer chunks that only contain zeros, see
+ * struct pb_result_stream_read_buffer
+ */
+#define PB_STREAM_READ_FLAG_ELIDE_ZERO (1 << 0)
+
+/**
+ * \def PB_STREAM_READ_FLAG_READ_AHEAD
+ * Prefetch 'read_ahead_size' bytes following this chunk into the other
+ * stream buffer while the current chunk is being transferred.
+ */
+#define PB_STREAM_READ_FLAG_READ_AHEAD (1 << 1)
+
 /**
  * Read data from a partition to an internal buffer
  *
@@ -218,7 +250,21 @@ PACK(struct pb_command_stream_read_buffer {
     uint32_t size; /*!< Bytes to transfer from partition to buffer */
     uint64_t offset; /*!< Offset in bytes into the partition */
     uint8_t buffer_id; /*!< Source buffer id */
-    uint8_t rz[19]; /*!< Reserved */
+    uint8_t flags; /*!< Read flags, see PB_STREAM_READ_FLAG_* */
+    uint32_t read_ahead_size; /*!< Bytes to prefetch after this chunk */
+    uint8_t rz[14]; /*!< Reserved */
+});
+
+/**
+ * Read data from a partition result
+ *
+ * Only populated when the command has any flags set. 'size' bytes of
+ * data follows the result, zero if the chunk was elided.
+ */
+PACK(struct pb_result_stream_read_buffer {
+    uint32_t size; /*!< Bytes of data that follows the result */
+    uint8_t zero; /*!< Set to 1 if the chunk only contains zeros */
+    uint8_t rz[27]; /*!< Reserved */
 });
 
 /**
@@ -234,17 +280,69 @@ PACK(struct pb_command_authenticate {
     uint8_t rz[25]; /*!< Reserved */
 });
 
+/**
+ * Digest algorithms for the verify command
+ *
+ * The device reports the supported algorithms in
+ * struct pb_result_device_caps. SHA256 is always supported.
+ */
+enum pb_digest_alg {
+    PB_DIGEST_SHA256 = 0,
+    PB_DIGEST_SHA512 = 1,
+    PB_DIGEST_BLAKE3 = 2,
+};
+
 /**
  * Verify partition
  *
- * The device computes a sha256 hash and compares with the input hash
+ * The device computes a digest of the partition and compares it with the
+ * input digest. A sha256 digest is passed in 'sha256' for compatibility with
+ * older devices, the other algorithms use 'digest'.
+ *
+ * 'size64' takes precedence over 'size' when it is non-zero. Older hosts
+ * leave it cleared and are limited to 4 GiB.
  */
 PACK(struct pb_command_verify_part {
     uint8_t uuid[16]; /*!< UUID of partition to verify */
     uint8_t sha256[32]; /*!< Expected sha256 hash */
-    uint32_t size; /*!< Size in bytes */
+    uint32_t size; /*!< Size in bytes, saturated at UINT32_MAX */
     uint8_t bpak; /*!< Parse bpak header */
-    uint8_t rz[2]; /*!< Reserved */
+    uint8_t digest_alg; /*!< Digest algorithm, see enum pb_digest_alg */
+    uint8_t rz; /*!< Reserved */
+    uint8_t digest[64]; /*!< Expected digest if 'digest_alg' is not sha256 */
+    uint64_t size64; /*!< Size in bytes */
+});
+
+/**
+ * \def PB_WIRE_PART_DIGEST_SIZE
+ * Size in bytes of one per-chunk partition digest (sha256)
+ */
+#define PB_WIRE_PART_DIGEST_SIZE 32
+
+/**
+ * Read per-chunk partition digests
+ *
+ * The device splits the range into 'chunk_size' pieces, the last piece may
+ * be shorter, and computes a sha256 digest of each piece. The digests are
+ * sent to the host after the result, see struct pb_result_part_read_digests.
+ *
+ * 'size64' takes precedence over 'size' when it is non-zero.
+ */
+PACK(struct pb_command_part_read_digests {
+    uint8_t uuid[16]; /*!< UUID of partition */
+    uint64_t offset; /*!< Offset in bytes into the partition */
+    uint32_t size; /*!< Number of bytes to digest, saturated at UINT32_MAX */
+    uint32_t chunk_size; /*!< Chunk size in bytes */
+    uint64_t size64; /*!< Number of bytes to digest */
+    uint8_t rz[8]; /*!< Reserved */
+});
+
+/**
+ * Read per-chunk partition digests result
+ */
+PACK(struct pb_result_part_read_digests {
+    uint32_t size; /*!< Bytes of digest data to read after the result */
+    uint8_t rz[28]; /*!< Reserved */
 });
 
 /**
@@ -269,12 +367,16 @@ PACK(struct pb_command_read_bpak {
 
 /**
  * Erase partition command
+ *
+ * The upper 32 bits of the 64-bit lba and block count were added in
+ * previously reserved fields, older hosts always set them to zero.
  */
 PACK(struct pb_command_erase_part {
     uint8_t uuid[16]; /*!< UUID of partition to erase */
-    uint32_t start_lba; /*!< First lba to erase */
-    uint32_t block_count; /*!< Number of blocks to erase */
-    uint8_t rz[8]; /*!< Reserved */
+    uint32_t start_lba; /*!< First lba to erase, bits 0 - 31 */
+    uint32_t block_count; /*!< Number of blocks to erase, bits 0 - 31 */
+    uint32_t start_lba_hi; /*!< First lba to erase, bits 32 - 63 */
+    uint32_t block_count_hi; /*!< Number of blocks to erase, bits 32 - 63 */
 });
 
 /**
@@ -377,6 +479,37 @@ PACK(struct pb_result_boot_status {
     char status[16]; /*!< Optional, textual status message */
 });
 
+/**
+ * Crypto providers result
+ *
+ * 'size' bytes of struct pb_crypto_provider entries are sent to the host
+ * after the result, one entry for every algorithm of every provider.
+ */
+PACK(struct pb_result_crypto_providers {
+    uint32_t size; /*!< Bytes to read after the result structure */
+    uint8_t rz[28]; /*!< Reserved */
+});
+
+#define PB_CRYPTO_PROVIDER_DSA        (1 << 0) /*!< Signature provider */
+#define PB_CRYPTO_PROVIDER_SMALL      (1 << 1) /*!< Used for small inputs */
+#define PB_CRYPTO_PROVIDER_LARGE      (1 << 2) /*!< Used for large inputs */
+#define PB_CRYPTO_PROVIDER_CALIBRATED (1 << 3) /*!< Costs are measured */
+
+/**
+ * Crypto provider entry
+ *
+ * The measured costs are only valid if PB_CRYPTO_PROVIDER_CALIBRATED is set.
+ */
+PACK(struct pb_crypto_provider {
+    char name[16]; /*!< Provider name, null terminated */
+    char alg[16]; /*!< Algorithm name, null terminated */
+    uint32_t flags; /*!< PB_CRYPTO_PROVIDER_* flags */
+    int32_t priority; /*!< Priority, higher is preferred */
+    uint32_t setup_ns; /*!< Measured cost of one init and final in ns */
+    uint32_t ns_per_kib; /*!< Measured cost of one KiB of input in ns */
+    uint8_t rz[16]; /*!< Reserved */
+});
+
 /**
  * Initializes and resets a command structure. The magic value is populated and
  *  the command code is set.
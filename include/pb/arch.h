@@ -6,4 +6,11 @@
 void arch_init(void);
 void arch_disable_mmu(void);
 
+/* Mask/unmask interrupts on the calling core */
+void arch_irq_enable(void);
+void arch_irq_disable(void);
+
+/* Sleep until an interrupt is pending, also if interrupts are masked */
+void arch_wait_for_interrupt(void);
+
 #endif // INCLUDE_PB_ARCH_H_
@@ -0,0 +1,113 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Buffer arena for large and DMA capable buffers.
+ *
+ * The platform hands over the RAM that is free after DDR init and the arena
+ * takes a share of it from the top, below 4 GiB unless CONFIG_ARENA_32BIT_DMA
+ * is disabled. The arena is split into one budget per subsystem. Boot, drivers
+ * and crypto have fixed budgets, command mode gets the rest.
+ *
+ * Every allocation starts and ends on a cache line boundary, so cache
+ * maintenance on one buffer never touches another one. Nothing is freed,
+ * buffers are allocated once during init.
+ *
+ */
+
+#ifndef INCLUDE_PB_ARENA_H
+#define INCLUDE_PB_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+enum arena_id {
+    ARENA_BOOT,
+    ARENA_DRIVERS,
+    ARENA_CRYPTO,
+    ARENA_CM,
+    ARENA_END,
+};
+
+struct arena_usage {
+    const char *name; /*!< Name of the budget */
+    uintptr_t base; /*!< Start address of the budget */
+    size_t budget; /*!< Size of the budget in bytes */
+    size_t used; /*!< Allocated bytes, including alignment. Nothing is
+                      freed, so this is also the high water mark */
+};
+
+/**
+ * Set up the arena in free RAM. Called by the platform after DDR init, the
+ * range must be mapped as normal memory.
+ *
+ * @param[in] start First free address
+ * @param[in] end End of RAM, exclusive
+ *
+ * @return PB_OK on success,
+ *        -PB_ERR_MEM if the arena can't fit the fixed budgets
+ */
+int arena_init(uintptr_t start, uintptr_t end);
+
+/**
+ * Allocate a buffer aligned to a cache line
+ *
+ * @param[in] id Budget to allocate from
+ * @param[in] size Size in bytes
+ *
+ * @return Pointer to the buffer or NULL if the budget is exhausted
+ */
+void *arena_alloc(enum arena_id id, size_t size);
+
+/**
+ * Allocate a buffer with a stricter alignment than a cache line
+ *
+ * @param[in] id Budget to allocate from
+ * @param[in] size Size in bytes
+ * @param[in] align Alignment in bytes, a power of two
+ *
+ * @return Pointer to the buffer or NULL if the budget is exhausted
+ */
+void *arena_alloc_aligned(enum arena_id id, size_t size, size_t align);
+
+/**
+ * Bytes that are left in a budget, not counting alignment
+ *
+ * @param[in] id Budget
+ *
+ * @return Available bytes
+ */
+size_t arena_available(enum arena_id id);
+
+/**
+ * Check if a memory range overlaps the arena. Used to reject images that
+ * would be loaded on top of the buffers.
+ *
+ * @param[in] start Start address
+ * @param[in] length Length in bytes
+ *
+ * @return true if the range overlaps the arena
+ */
+bool arena_overlaps(uintptr_t start, size_t length);
+
+/**
+ * Read the usage of a budget
+ *
+ * @param[in] id Budget
+ * @param[out] usage Output
+ *
+ * @return PB_OK on success,
+ *        -PB_ERR_PARAM on invalid id
+ */
+int arena_get_usage(enum arena_id id, struct arena_usage *usage);
+
+/**
+ * Print the size and use of every budget
+ */
+void arena_print_usage(void);
+
+#endif // INCLUDE_PB_ARENA_H
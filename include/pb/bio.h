@@ -62,9 +62,23 @@
 #define BIO_FLAG_RFU15              BIT(15)
 
 typedef int bio_dev_t;
-typedef unsigned int lba_t;
+typedef uint64_t lba_t;
+
+/**
+ * Scatter-gather segment
+ *
+ * Segments are read from consecutive blocks on the device.
+ */
+struct bio_segment {
+    void *buf; /*!< Destination buffer */
+    size_t length; /*!< Length in bytes */
+};
 
 typedef int (*bio_read_t)(bio_dev_t dev, lba_t lba, size_t length, void *buf);
+typedef int (*bio_readv_t)(bio_dev_t dev,
+                           lba_t lba,
+                           const struct bio_segment *segs,
+                           unsigned int no_of_segs);
 typedef int (*bio_write_t)(bio_dev_t dev, lba_t lba, size_t length, const void *buf);
 typedef int (*bio_erase_t)(bio_dev_t dev, lba_t first_lba, size_t count);
 typedef int (*bio_call_t)(bio_dev_t dev, int param);
@@ -163,6 +177,19 @@ int bio_set_ios(bio_dev_t dev, bio_read_t read, bio_write_t write);
  */
 int bio_set_ios_erase(bio_dev_t dev, bio_erase_t erase);
 
+/**
+ * Set scatter-gather read op for device
+ *
+ * This is optional. Devices without it fall back to one read per segment.
+ *
+ * @param[in] dev Block device handle
+ * @param[in] readv Scatter-gather read callback function
+ *
+ * @return PB_OK on success,
+ *        -PB_ERR_PARAM on invalid device handle
+ */
+int bio_set_ios_readv(bio_dev_t dev, bio_readv_t readv);
+
 int bio_set_private(bio_dev_t dev, uintptr_t priv);
 uintptr_t bio_get_private(bio_dev_t dev);
 
@@ -272,7 +299,7 @@ const unsigned char *bio_get_uu(bio_dev_t dev);
  * @return Last LBA, on success
  *         -PB_ERR_PARAM, on bad device handle
  */
-int bio_get_last_block(bio_dev_t dev);
+int64_t bio_get_last_block(bio_dev_t dev);
 
 /**
  * Get the first block particular device. This returns the physical block
@@ -283,7 +310,7 @@ int bio_get_last_block(bio_dev_t dev);
  * @return First LBA, on success
  *         -PB_ERR_PARAM, on bad device handle
  */
-int bio_get_first_block(bio_dev_t dev);
+int64_t bio_get_first_block(bio_dev_t dev);
 
 /**
  * Get the number of blocks of particular device.
@@ -293,7 +320,7 @@ int bio_get_first_block(bio_dev_t dev);
  * @return Number of blocks, on success
  *         -PB_ERR_PARAM, on bad device handle
  */
-int bio_get_no_of_blocks(bio_dev_t dev);
+int64_t bio_get_no_of_blocks(bio_dev_t dev);
 
 /**
  * Read data from block device
@@ -310,6 +337,29 @@ int bio_get_no_of_blocks(bio_dev_t dev);
  */
 int bio_read(bio_dev_t dev, lba_t lba, size_t length, void *buf);
 
+/**
+ * Scatter-gather read from block device
+ *
+ * Reads consecutive blocks, starting at 'lba', into a list of buffers. This
+ * allows drivers to load data that is contiguous on the device but not in
+ * memory, like the parts of a BPAK image, with as few device commands as
+ * possible.
+ *
+ * All segments except the last one must be a multiple of the block size.
+ *
+ * @param[in] dev Block device handle
+ * @param[in] lba Start block to read from
+ * @param[in] segs Array of segments
+ * @param[in] no_of_segs Number of segments
+ *
+ * @return -PB_ERR_NOT_SUPPORTED, when there is no underlying read function,
+ *         -PB_ERR_PARAM, lba and/or length is out of range or a segment
+ *              is not a multiple of the block size,
+ *         -PB_ERR_IO, Driver I/O errors,
+ *         -PB_TIMEOUT, Driver timeouts
+ */
+int bio_readv(bio_dev_t dev, lba_t lba, const struct bio_segment *segs, unsigned int no_of_segs);
+
 /**
  * Write data to block device
  *
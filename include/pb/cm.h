@@ -10,6 +10,7 @@
 #ifndef INCLUDE_CM_H
 #define INCLUDE_CM_H
 
+#include <pb/event.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -20,6 +21,10 @@ struct cm_transport_ops {
     int (*read)(void *bfr, size_t length);
     int (*write)(const void *bfr, size_t length);
     int (*complete)(void);
+    /* Optional, an interrupt signalled event that command mode sleeps on
+     * while 'complete' returns -PB_ERR_AGAIN. Note that the watchdog is
+     * not kicked while sleeping. */
+    struct pb_event *(*event)(void);
 };
 
 struct cm_config {
@@ -32,10 +32,19 @@ typedef uint32_t key_id_t;
 #define HASH_SHA256      BIT(2)
 #define HASH_SHA384      BIT(3)
 #define HASH_SHA512      BIT(4)
+#define HASH_BLAKE3      BIT(5)
 
 #define DSA_EC_SECP256r1 BIT(0)
 #define DSA_EC_SECP384r1 BIT(1)
 #define DSA_EC_SECP521r1 BIT(2)
+#define DSA_ED25519      BIT(3)
+
+/**
+ * \def CRYPTO_SMALL_INPUT
+ * Input length in bytes that is reported as 'small' in the provider info.
+ * Headers, tokens and digests that are signed are in this range.
+ */
+#define CRYPTO_SMALL_INPUT 64
 
 struct hash_ops {
     const char *name; /*!< Name of hash op's provider */
@@ -51,6 +60,14 @@ struct hash_ops {
      * hash data */
     int (*final)(uint8_t *digest_out, size_t length);
     /*!< Finialize and output message digest */
+    int (*digest)(
+        hash_t alg, const void *buf, size_t length, uint8_t *digest_out, size_t digest_length);
+    /*!< Optional one-shot digest. This must not use the shared hash context
+     * and must be safe to call from several cores at the same time */
+    int priority; /*!< Higher is preferred when several providers match */
+    size_t min_length;
+    /*!< Inputs shorter than this are hashed by another provider, if there is
+     * one. Used for hardware with a large setup cost per job. */
 };
 
 struct dsa_ops {
@@ -64,6 +81,7 @@ struct dsa_ops {
                   uint8_t *md,
                   size_t md_length,
                   bool *verified);
+    int priority; /*!< Higher is preferred when several providers match */
 };
 
 /**
@@ -77,6 +95,29 @@ struct dsa_ops {
  */
 int hash_init(hash_t alg);
 
+/**
+ * Initialize the hashing context for an input of known length. The length
+ * is only used to select the provider that is expected to be fastest.
+ *
+ * param[in] alg Hashing algorithm to use
+ * param[in] length Total number of bytes that will be hashed, zero if unknown
+ *
+ * @return PB_OK on success,
+ *        -PB_ERR_NOT_SUPPORTED, if no provider implements 'alg'
+ */
+int hash_init_length(hash_t alg, uint64_t length);
+
+/**
+ * Pick the algorithm that hashes large inputs the fastest on this device.
+ * The measured cost is used when the providers are calibrated, otherwise the
+ * provider priority. Ties go to the algorithm with the highest bit.
+ *
+ * @param[in] algs Bit field of candidate algorithms
+ *
+ * @return One of the algorithms in 'algs' or zero if none is supported
+ */
+hash_t hash_fastest(hash_t algs);
+
 /**
  * Update currently running hash context with data
  *
@@ -130,6 +171,39 @@ int hash_copy_update(const void *src, void *dest, size_t length);
  */
 int hash_final(uint8_t *digest_output, size_t length);
 
+/**
+ * Compute a message digest in one call without touching the shared hash
+ * context. This may be called concurrently from several cores, only providers
+ * that implement the 'digest' callback are used.
+ *
+ * @param[in] alg Hashing algorithm to use
+ * @param[in] buf Input buffer to hash
+ * @param[in] length Length of buffer
+ * @param[out] digest_output Message digest output buffer
+ * @param[in] digest_length Length of output buffer
+ *
+ * @return PB_OK on success,
+ *        -PB_ERR_NOT_SUPPORTED if no provider implements a one-shot digest
+ *         for 'alg'
+ */
+int hash_digest(hash_t alg,
+                const void *buf,
+                size_t length,
+                uint8_t *digest_output,
+                size_t digest_length);
+
+/**
+ * Check if the provider that is preferred for inputs of 'length' bytes
+ * implements a one-shot digest, i.e. if 'hash_digest' can be used without
+ * giving up a faster provider.
+ *
+ * @param[in] alg Hashing algorithm
+ * @param[in] length Number of bytes per digest, zero if unknown
+ *
+ * @return true if 'hash_digest' uses the preferred provider for 'alg'
+ */
+bool hash_has_digest(hash_t alg, uint64_t length);
+
 /**
  * Register hash op's
  *
@@ -154,6 +228,30 @@ int dsa_verify(dsa_t alg,
 
 int dsa_add_ops(const struct dsa_ops *ops);
 
+struct crypto_provider_info {
+    const char *name; /*!< Name of the provider */
+    const char *alg_name; /*!< Name of the algorithm */
+    bool dsa; /*!< True for a dsa provider, false for a hash provider */
+    int priority; /*!< Priority of the provider */
+    bool calibrated; /*!< True if the costs below have been measured */
+    uint32_t setup_ns; /*!< Measured cost of one init and final in ns */
+    uint32_t ns_per_kib; /*!< Measured cost of hashing one KiB in ns */
+    bool selected_small; /*!< Used for inputs of CRYPTO_SMALL_INPUT bytes */
+    bool selected_large; /*!< Used for inputs of unknown length */
+};
+
+/**
+ * Read information about one algorithm of one registered provider. Every
+ * algorithm that a provider supports has its own index.
+ *
+ * @param[in] index Index, starting from zero
+ * @param[out] info Output
+ *
+ * @return PB_OK on success,
+ *        -PB_ERR_NOT_FOUND, if 'index' is past the last entry
+ */
+int crypto_get_provider_info(unsigned int index, struct crypto_provider_info *info);
+
 void hash_print(const char *prefix, uint8_t *digest, size_t length);
 
 #endif
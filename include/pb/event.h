@@ -0,0 +1,74 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Completion events. An event is signalled from interrupt context and
+ * waited on by the core, which sleeps in WFI until an interrupt arrives.
+ *
+ * Events without an interrupt source, either because CONFIG_IRQ is not
+ * set or because 'irq_register' failed, never block. The caller is expected
+ * to re-check the hardware state in a loop, which then degrades to polling:
+ *
+ *   while (!transfer_done())
+ *       pb_event_wait(&ev);
+ *
+ */
+
+#ifndef INCLUDE_PB_EVENT_H
+#define INCLUDE_PB_EVENT_H
+
+#include <config.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+struct pb_event {
+    volatile uint32_t signalled;
+    bool has_source; /*!< An interrupt handler will signal this event */
+};
+
+#ifdef CONFIG_IRQ
+/**
+ * Initialize an event
+ *
+ * @param[in] ev Event to initialize
+ * @param[in] has_source True if an interrupt handler signals the event
+ */
+void pb_event_init(struct pb_event *ev, bool has_source);
+
+/**
+ * Signal an event, safe to call from interrupt context
+ *
+ * @param[in] ev Event to signal
+ */
+void pb_event_signal(struct pb_event *ev);
+
+/**
+ * Wait for an event to be signalled and clear it. Returns immediately if the
+ * event has no interrupt source.
+ *
+ * @param[in] ev Event to wait for
+ */
+void pb_event_wait(struct pb_event *ev);
+#else
+static inline void pb_event_init(struct pb_event *ev, bool has_source)
+{
+    ev->signalled = 0;
+    ev->has_source = false;
+    (void)has_source;
+}
+
+static inline void pb_event_signal(struct pb_event *ev)
+{
+    ev->signalled = 1;
+}
+
+static inline void pb_event_wait(struct pb_event *ev)
+{
+    (void)ev;
+}
+#endif
+
+#endif // INCLUDE_PB_EVENT_H
@@ -0,0 +1,105 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Interrupt core. One interrupt controller driver, for example the GIC or
+ * the NVIC, registers itself with 'irq_set_controller'. Drivers then attach
+ * handlers to their interrupt lines with 'irq_register'.
+ *
+ * Handlers run in interrupt context on the primary core and should do as
+ * little as possible, typically acknowledge the device and signal a
+ * 'struct pb_event', see pb/event.h.
+ *
+ */
+
+#ifndef INCLUDE_PB_IRQ_H
+#define INCLUDE_PB_IRQ_H
+
+#include <config.h>
+#include <pb/errors.h>
+#include <stdbool.h>
+
+typedef void (*irq_handler_t)(unsigned int irq, void *arg);
+
+struct irq_controller_ops {
+    const char *name;
+    int (*enable)(unsigned int irq); /*!< Unmask and route 'irq' to this core */
+    int (*disable)(unsigned int irq); /*!< Mask 'irq' */
+    void (*dispatch)(void); /*!< Call 'irq_handle' for all pending interrupts */
+    void (*shutdown)(void); /*!< Mask everything before the next boot stage */
+};
+
+#ifdef CONFIG_IRQ
+/**
+ * Register the interrupt controller and unmask interrupts on the calling
+ * core.
+ *
+ * @param[in] ops Controller operations
+ *
+ * @return PB_OK on success, -PB_ERR_PARAM if a controller is already set
+ */
+int irq_set_controller(const struct irq_controller_ops *ops);
+
+/**
+ * Attach a handler to an interrupt line and enable it
+ *
+ * @param[in] irq Controller specific interrupt number
+ * @param[in] handler Handler function
+ * @param[in] arg Passed to 'handler'
+ *
+ * @return PB_OK on success,
+ *        -PB_ERR_NOT_SUPPORTED if there is no interrupt controller,
+ *        -PB_ERR_MEM if the handler table is full
+ */
+int irq_register(unsigned int irq, irq_handler_t handler, void *arg);
+
+/**
+ * Detach the handler of 'irq' and disable it
+ *
+ * @param[in] irq Controller specific interrupt number
+ *
+ * @return PB_OK on success or a negative number
+ */
+int irq_unregister(unsigned int irq);
+
+/**
+ * Called by the architecture exception vector
+ */
+void irq_dispatch(void);
+
+/**
+ * Called by the controller driver for each pending interrupt
+ *
+ * @param[in] irq Controller specific interrupt number
+ */
+void irq_handle(unsigned int irq);
+
+/**
+ * Mask all interrupts. Must be called before control is handed over to
+ * the next boot stage.
+ */
+void irq_shutdown(void);
+#else
+static inline int irq_register(unsigned int irq, irq_handler_t handler, void *arg)
+{
+    (void)irq;
+    (void)handler;
+    (void)arg;
+    return -PB_ERR_NOT_SUPPORTED;
+}
+
+static inline int irq_unregister(unsigned int irq)
+{
+    (void)irq;
+    return -PB_ERR_NOT_SUPPORTED;
+}
+
+static inline void irq_shutdown(void)
+{
+}
+#endif
+
+#endif // INCLUDE_PB_IRQ_H
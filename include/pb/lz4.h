@@ -0,0 +1,38 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef INCLUDE_PB_LZ4_H
+#define INCLUDE_PB_LZ4_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Decompress one raw LZ4 block.
+ *
+ * The decoder never reads outside of the source buffer or writes outside of
+ * the destination buffer, malformed input is rejected.
+ *
+ * @param[in] src Compressed block
+ * @param[in] src_len Length of the compressed block
+ * @param[out] dst Output buffer
+ * @param[in] dst_len Size of the output buffer
+ * @param[out] out_len Number of bytes written to dst
+ *
+ * @return PB_OK on success,
+ *        -PB_ERR_BUF_TOO_SMALL if the output does not fit in dst,
+ *        -PB_ERR_PARAM on malformed input
+ */
+int lz4_decompress(const uint8_t *src,
+                   size_t src_len,
+                   uint8_t *dst,
+                   size_t dst_len,
+                   size_t *out_len);
+
+#endif // INCLUDE_PB_LZ4_H
@@ -71,4 +71,41 @@ const char *plat_boot_reason_str(void);
  */
 int plat_get_unique_id(uint8_t *output, size_t *length);
 
+#ifdef CONFIG_SMP
+/**
+ * Power on a secondary core.
+ *
+ * @param[in] cpu Logical core index
+ * @param[in] entry Physical entry address
+ * @param[in] context Value passed to the entry point in the first argument
+ *                    register
+ *
+ * @return PB_OK on success or a negative number
+ */
+int plat_smp_cpu_on(unsigned int cpu, uintptr_t entry, uintptr_t context);
+
+/**
+ * Called on a secondary core before it starts to process work. This must
+ * at least enable the MMU with the primary core's translation tables.
+ *
+ * @param[in] cpu Logical core index
+ */
+void plat_smp_secondary_init(unsigned int cpu);
+
+/**
+ * Power off the calling secondary core. May return if the platform can't
+ * power off cores, the core is then left in a WFE loop.
+ */
+void plat_smp_cpu_off(void);
+
+/**
+ * Check if a secondary core has been powered off by the power controller.
+ *
+ * @param[in] cpu Logical core index
+ *
+ * @return true if the core is off, false while it is on or powering off
+ */
+bool plat_smp_cpu_is_off(unsigned int cpu);
+#endif
+
 #endif // INCLUDE_PB_PLAT_H_
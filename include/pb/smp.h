@@ -0,0 +1,74 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Minimal SMP support. Secondary cores are started early, pick work items
+ * from a shared queue and are parked again before the next stage is
+ * started.
+ *
+ * Work functions run on any core, including the primary core while it waits
+ * for completion. They must not use the console, the block device layer or
+ * the single context hash API, see 'hash_digest' for a re-entrant
+ * alternative.
+ *
+ */
+
+#ifndef INCLUDE_PB_SMP_H
+#define INCLUDE_PB_SMP_H
+
+#include <stdint.h>
+
+struct smp_work {
+    void (*fn)(void *arg); /*!< Work function */
+    void *arg; /*!< Argument to 'fn' */
+    uint32_t done; /*!< Set when 'fn' has returned, managed by smp.c */
+};
+
+/**
+ * Start the secondary cores. Cores that fail to start are skipped, work
+ * is still completed by the remaining cores.
+ *
+ * @return PB_OK on success or a negative number
+ */
+int smp_init(void);
+
+/**
+ * Queue a work item. If the queue is full, or no secondary cores are running,
+ * the work item is executed directly by the calling core.
+ *
+ * Must only be called from the primary core.
+ *
+ * @param[in] work Work item, must be valid until 'smp_wait' returns
+ */
+void smp_queue(struct smp_work *work);
+
+/**
+ * Wait for a work item to complete. The calling core executes queued work
+ * while waiting.
+ *
+ * @param[in] work Work item to wait for
+ */
+void smp_wait(struct smp_work *work);
+
+/**
+ * Park all secondary cores. This must be called before control is handed
+ * over to the next boot stage.
+ *
+ * @return PB_OK on success,
+ *        -PB_ERR_TIMEOUT if not all cores were parked, the next stage must
+ *         not be started
+ */
+int smp_park(void);
+
+/**
+ * Secondary core entry point, called by the architecture specific entry
+ * code with a valid stack.
+ *
+ * @param[in] cpu Logical core index, 1 .. CONFIG_SMP_MAX_CPUS - 1
+ */
+void smp_secondary_main(unsigned int cpu);
+
+#endif // INCLUDE_PB_SMP_H
@@ -0,0 +1,47 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Interface between the LZ4 decompression stub (src/stub) and the
+ * bootloader it unpacks.
+ *
+ */
+
+#ifndef INCLUDE_PB_STUB_H
+#define INCLUDE_PB_STUB_H
+
+/* Payload header magic, 'PBZ4' */
+#define PB_STUB_PAYLOAD_MAGIC 0x345a4250
+
+/*
+ * The stub enters the bootloader with r3 = PB_STUB_HANDOFF_MAGIC,
+ * r4 = decompression time in timer ticks, r5 = timer frequency and
+ * r6 = compressed payload size. The bootloader entry stores these in
+ * 'pb_stub_handoff'.
+ */
+#define PB_STUB_HANDOFF_MAGIC 0x4e4f5453
+
+#ifndef __ASSEMBLY__
+#include <stdint.h>
+
+struct pb_stub_payload_header {
+    uint32_t magic; /*!< PB_STUB_PAYLOAD_MAGIC */
+    uint32_t size; /*!< Size of the decompressed image */
+    uint32_t compressed_size; /*!< Size of the LZ4 block following this header */
+    uint32_t rz;
+} __attribute__((packed));
+
+struct pb_stub_handoff {
+    uint32_t magic;
+    uint32_t ticks;
+    uint32_t tick_freq;
+    uint32_t compressed_size;
+};
+
+extern struct pb_stub_handoff pb_stub_handoff;
+#endif
+
+#endif // INCLUDE_PB_STUB_H
@@ -44,6 +44,10 @@
 
 #define IMX6UL_CAAM_BASE            (0x02140000)
 #define IMX6UL_CAAM_JR1_BASE        (0x02141000)
+#define IMX6UL_CAAM_JR1_IRQ         (32 + 106)
+
+#define IMX6UL_GICD_BASE            (0x00A01000)
+#define IMX6UL_GICC_BASE            (0x00A02000)
 
 #define IMX6UL_USBPHY1_BASE         (0x020C9000)
 #define IMX6UL_USBPHY2_BASE         (0x020CA000)
@@ -12,6 +12,8 @@
 #define IMX8M_USDHC1_BASE       (0x30B40000)
 #define IMX8M_USDHC2_BASE       (0x30B50000)
 #define IMX8M_OCOTP_BASE        (0x30350000)
+#define IMX8M_SNVS_BASE         (0x30370000)
+#define SNVS_LPGPR(n)           (IMX8M_SNVS_BASE + 0x90 + (n) * 4)
 
 #define IMX8M_SRC_BASE          (0x30390000)
 #define IMX8M_SRC_SRSR          (0x3039005c)
@@ -24,6 +24,12 @@
 #define FUSE_REVOKE (8)
 #define FUSE_SEC    (9)
 
+#define QEMU_GICD_BASE (0x08000000)
+#define QEMU_GICC_BASE (0x08010000)
+
+/* virtio-mmio transport n is located at 0x0a000000 + n * 0x200 and uses SPI 16 + n */
+#define QEMU_VIRTIO_IRQ(base) (32 + 16 + (((base)-0x0a000000) / 0x200))
+
 int board_init(void);
 
 int qemu_revoke_key(const struct rot_key *key);
@@ -33,4 +39,9 @@ slc_t qemu_slc_read_status(void);
 int qemu_slc_set_configuration_locked(void);
 int qemu_slc_set_eol(void);
 
+/**
+ * Warm reset through PSCI, memory is retained over the reset
+ */
+void qemu_warm_reset(void);
+
 #endif // INCLUDE_PLAT_QEMU_H
@@ -84,6 +84,22 @@ typedef struct mmap_region {
 
 /* Generic translation table APIs */
 void init_xlat_tables(void);
+
+/*
+ * Use the tables generated at build time (CONFIG_LIB_XLAT_TBLS_STATIC)
+ * instead of init_xlat_tables(). Returns 0 on success or -1 if the tables
+ * were generated for another exception level, in which case the caller
+ * must fall back to the regular run-time setup.
+ */
+int init_xlat_tables_static(void);
+
+/*
+ * Build the tables at run-time from the regions added with
+ * mmap_add_region() and compare them with the tables generated at build
+ * time (CONFIG_LIB_XLAT_TBLS_STATIC_VERIFY). The MMU keeps using the
+ * tables selected before. Returns 0 if both describe the same mapping.
+ */
+int verify_xlat_tables_static(void);
 void mmap_add_region(unsigned long long base_pa, uintptr_t base_va,
 		     size_t size, unsigned int attr);
 void mmap_add(const mmap_region_t *mm);
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""
+Add a 'pb-part-digest' meta to every part of a bpak image, with the part
+as reference. The meta holds the raw digest of the part data, including
+padding, using the hash kind of the header. The bpak tool has no encoder
+for raw digests.
+
+The digests are covered by the header signature, so this must be run
+before 'bpak sign'.
+"""
+import argparse
+import hashlib
+import struct
+import sys
+
+BPAK_ID_PB_PART_DIGEST = 0x26AC168F
+
+MAX_META = 32
+MAX_PARTS = 32
+METADATA_BYTES = 1920
+META_OFFSET = 8
+PART_OFFSET = META_OFFSET + MAX_META * 16
+METADATA_OFFSET = PART_OFFSET + MAX_PARTS * 32
+HASH_KIND_OFFSET = METADATA_OFFSET + METADATA_BYTES
+HEADER_SIZE = 4096
+
+HASH_KINDS = {1: hashlib.sha256, 2: hashlib.sha384, 3: hashlib.sha512}
+
+
+def add_part_digests(img):
+    hash_kind = img[HASH_KIND_OFFSET]
+
+    if hash_kind not in HASH_KINDS:
+        raise ValueError(f"Unsupported hash kind {hash_kind}")
+
+    metas = [struct.unpack_from("<IHHI", img, META_OFFSET + i * 16) for i in range(MAX_META)]
+    used = [m for m in metas if m[0] != 0]
+
+    if any(m[0] == BPAK_ID_PB_PART_DIGEST for m in used):
+        raise ValueError("The image already has part digests")
+
+    slot = len(used)
+    data_offset = max([m[2] + ((m[1] + 7) & ~7) for m in used], default=0)
+    part_offset = HEADER_SIZE
+
+    for i in range(MAX_PARTS):
+        part_id, size, _, _, pad_bytes = struct.unpack_from("<IQQQH", img, PART_OFFSET + i * 32)
+
+        if part_id == 0:
+            break
+
+        digest = HASH_KINDS[hash_kind](img[part_offset:part_offset + size + pad_bytes]).digest()
+
+        if slot >= MAX_META or data_offset + len(digest) > METADATA_BYTES:
+            raise ValueError("No room for the part digests in the header")
+
+        struct.pack_into("<IHHI", img, META_OFFSET + slot * 16,
+                         BPAK_ID_PB_PART_DIGEST, len(digest), data_offset, part_id)
+        img[METADATA_OFFSET + data_offset:METADATA_OFFSET + data_offset + len(digest)] = digest
+        slot += 1
+        data_offset += len(digest)
+        part_offset += size + pad_bytes
+
+    return slot - len(used)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("image", help="Unsigned bpak image, modified in place")
+    args = parser.parse_args()
+
+    with open(args.image, "rb") as f:
+        img = bytearray(f.read())
+
+    try:
+        count = add_part_digests(img)
+    except ValueError as e:
+        print(f"{args.image}: {e}", file=sys.stderr)
+        return 1
+
+    with open(args.image, "wb") as f:
+        f.write(img)
+
+    print(f"Added {count} part digests to {args.image}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
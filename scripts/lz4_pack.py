@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""
+Compress the bootloader binary into the payload format used by the
+decompression stub in src/stub: a 16 byte header followed by one raw
+LZ4 block.
+"""
+import argparse
+import struct
+import sys
+
+PAYLOAD_MAGIC = 0x345A4250  # 'PBZ4'
+
+MIN_MATCH = 4
+# The last match must start at least 12 bytes before the end of the block
+# and the last 5 bytes are always literals.
+MF_LIMIT = 12
+LAST_LITERALS = 5
+MAX_OFFSET = 0xFFFF
+HASH_BITS = 16
+
+
+def _hash(seq):
+    return ((seq * 2654435761) & 0xFFFFFFFF) >> (32 - HASH_BITS)
+
+
+def _length(out, n):
+    while n >= 255:
+        out.append(255)
+        n -= 255
+    out.append(n)
+
+
+def _sequence(out, literals, match_len, offset):
+    lit_len = len(literals)
+    token = min(lit_len, 15) << 4
+    if match_len is not None:
+        token |= min(match_len - MIN_MATCH, 15)
+    out.append(token)
+    if lit_len >= 15:
+        _length(out, lit_len - 15)
+    out += literals
+    if match_len is not None:
+        out += struct.pack("<H", offset)
+        if match_len - MIN_MATCH >= 15:
+            _length(out, match_len - MIN_MATCH - 15)
+
+
+def compress(data):
+    out = bytearray()
+    table = {}
+    n = len(data)
+    anchor = 0
+    pos = 0
+    match_limit = n - MF_LIMIT
+
+    while pos < match_limit:
+        seq = int.from_bytes(data[pos:pos + 4], "little")
+        h = _hash(seq)
+        ref = table.get(h)
+        table[h] = pos
+
+        if ref is None or pos - ref > MAX_OFFSET or data[ref:ref + 4] != data[pos:pos + 4]:
+            pos += 1
+            continue
+
+        # Extend the match backwards over pending literals
+        while pos > anchor and ref > 0 and data[pos - 1] == data[ref - 1]:
+            pos -= 1
+            ref -= 1
+
+        match_len = MIN_MATCH
+        end_limit = n - LAST_LITERALS
+        while pos + match_len < end_limit and data[ref + match_len] == data[pos + match_len]:
+            match_len += 1
+
+        _sequence(out, data[anchor:pos], match_len, pos - ref)
+        pos += match_len
+        anchor = pos
+
+    _sequence(out, data[anchor:], None, 0)
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pack a bootloader image for the LZ4 stub")
+    parser.add_argument("input")
+    parser.add_argument("output")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        data = f.read()
+
+    block = compress(data)
+
+    with open(args.output, "wb") as f:
+        f.write(struct.pack("<IIII", PAYLOAD_MAGIC, len(data), len(block), 0))
+        f.write(block)
+
+    print(f"LZ4 {args.input}: {len(data)} -> {len(block)} bytes "
+          f"({100 * len(block) // max(len(data), 1)}%)")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,515 @@
+#!/usr/bin/env python3
+"""
+Build-time generator for the xlat_tables_v2 translation tables.
+
+The platform describes its memory map in a region file, which is run
+through the C pre-processor and contains one entry per line:
+
+    XLAT_REGION(base_pa, base_va, size, attr)
+
+Expressions may use integer literals, MT_* attributes, linker symbols as
+XLAT_SYM(name), parentheses and the C operators + - * / % << >> & ^ | ~.
+They are evaluated by a small parser, nothing in the region file is run as
+Python. Linker symbols are resolved from 'nm' output of a first link
+stage. Table addresses are taken from the same output, the table blob has
+a fixed size so the final link keeps every address intact.
+
+The same region file is included by the platform code with XLAT_SYM and
+XLAT_REGION defined as C macros, so the run-time tables are built from the
+same list.
+
+The walk below mirrors init_xlation_table_inner() in
+src/lib/xlat_tables_v2/xlat_tables_common.c and must be kept in sync.
+"""
+import argparse
+import re
+import sys
+
+PAGE_SHIFT = 12
+TABLE_ENTRIES_SHIFT = 9
+TABLE_ENTRIES = 1 << TABLE_ENTRIES_SHIFT
+L0_SHIFT = PAGE_SHIFT + 3 * TABLE_ENTRIES_SHIFT
+LEVEL_MAX = 3
+MIN_LVL_BLOCK_DESC = 1
+
+INVALID_DESC = 0x0
+BLOCK_DESC = 0x1
+TABLE_DESC = 0x3
+PAGE_DESC = 0x3
+
+
+def lower_attrs(x):
+    return (x & 0xFFF) << 2
+
+
+def upper_attrs(x):
+    return (x & 0x7) << 52
+
+
+XN = 1 << 2
+PXN = 1 << 1
+AP_RO = 1 << 5
+AP_RW = 0
+AP_ONE_VA_RANGE_RES1 = 1 << 4
+NS = 1 << 3
+ACCESS_FLAG = 1 << 8
+OSH = 0x2 << 6
+ISH = 0x3 << 6
+ATTR_IWBWA_OWBWA_NTR_INDEX = 0x0
+ATTR_DEVICE_INDEX = 0x1
+ATTR_NON_CACHEABLE_INDEX = 0x2
+
+MT_ATTRS = {
+    "MT_DEVICE": 0,
+    "MT_NON_CACHEABLE": 1,
+    "MT_MEMORY": 2,
+    "MT_RO": 0 << 3,
+    "MT_RW": 1 << 3,
+    "MT_SECURE": 0 << 4,
+    "MT_NS": 1 << 4,
+    "MT_EXECUTE": 0 << 5,
+    "MT_EXECUTE_NEVER": 1 << 5,
+}
+MT_ATTRS["MT_CODE"] = MT_ATTRS["MT_MEMORY"] | MT_ATTRS["MT_RO"] | MT_ATTRS["MT_EXECUTE"]
+MT_ATTRS["MT_RO_DATA"] = MT_ATTRS["MT_MEMORY"] | MT_ATTRS["MT_RO"] | MT_ATTRS["MT_EXECUTE_NEVER"]
+
+MT_TYPE_MASK = 0x7
+MT_DEVICE = MT_ATTRS["MT_DEVICE"]
+MT_NON_CACHEABLE = MT_ATTRS["MT_NON_CACHEABLE"]
+MT_MEMORY = MT_ATTRS["MT_MEMORY"]
+MT_RW = MT_ATTRS["MT_RW"]
+MT_NS = MT_ATTRS["MT_NS"]
+MT_EXECUTE_NEVER = MT_ATTRS["MT_EXECUTE_NEVER"]
+
+BASE_TABLE_SYM = "xlat_static_base_table"
+TABLES_SYM = "xlat_static_tables"
+SECTION = ".rodata.xlat_static"
+
+
+class XlatError(Exception):
+    pass
+
+
+def level_shift(level):
+    return L0_SHIFT - level * TABLE_ENTRIES_SHIFT
+
+
+def base_level(arch, va_size):
+    if arch == "aarch32":
+        return 1 if va_size > (1 << level_shift(1)) else 2
+    if va_size > (1 << L0_SHIFT):
+        return 0
+    if va_size > (1 << level_shift(1)):
+        return 1
+    if va_size > (1 << level_shift(2)):
+        return 2
+    return 3
+
+
+def num_base_entries(arch, va_size):
+    return va_size >> level_shift(base_level(arch, va_size))
+
+
+def parse_int(text):
+    return int(re.sub(r"[uUlL]+$", "", text), 0)
+
+
+def c_div(a, b):
+    """Integer division that truncates towards zero, like C."""
+    if b == 0:
+        raise XlatError("Division by zero")
+    return abs(a) // abs(b) * (1 if (a < 0) == (b < 0) else -1)
+
+
+def c_mod(a, b):
+    return a - c_div(a, b) * b
+
+
+TOKEN_RE = re.compile(
+    r"\s*(?:(?P<int>0[xX][0-9a-fA-F]+|\d+)[uUlL]*\b"
+    r"|(?P<name>[A-Za-z_]\w*)"
+    r"|(?P<op><<|>>|[-+*/%&|^~()]))"
+)
+
+
+class ExprParser:
+    """Evaluates a C integer constant expression, with C operator precedence.
+
+    Only integer literals, names from 'names', XLAT_SYM(symbol) and the
+    operators in TOKEN_RE are accepted.
+    """
+
+    BINARY_LEVELS = [
+        {"|": lambda a, b: a | b},
+        {"^": lambda a, b: a ^ b},
+        {"&": lambda a, b: a & b},
+        {"<<": lambda a, b: a << b, ">>": lambda a, b: a >> b},
+        {"+": lambda a, b: a + b, "-": lambda a, b: a - b},
+        {"*": lambda a, b: a * b, "/": c_div, "%": c_mod},
+    ]
+
+    def __init__(self, text, names, symbols):
+        self.text = text
+        self.names = names
+        self.symbols = symbols
+        self.tokens = self.tokenize(text)
+        self.pos = 0
+
+    def tokenize(self, text):
+        tokens = []
+        pos = 0
+        text = text.rstrip()
+        while pos < len(text):
+            m = TOKEN_RE.match(text, pos)
+            if m is None or m.end() == pos:
+                raise XlatError(f"Unexpected '{text[pos:].strip()}' in '{text}'")
+            if m.group("int") is not None:
+                digits = m.group("int")
+                if len(digits) > 1 and digits[0] == "0" and digits[1] not in "xX":
+                    tokens.append(("int", int(digits, 8)))
+                else:
+                    tokens.append(("int", int(digits, 0)))
+            elif m.group("name") is not None:
+                tokens.append(("name", m.group("name")))
+            else:
+                tokens.append(("op", m.group("op")))
+            pos = m.end()
+        return tokens
+
+    def peek(self):
+        return self.tokens[self.pos] if self.pos < len(self.tokens) else (None, None)
+
+    def expect(self, op):
+        if self.peek() != ("op", op):
+            raise XlatError(f"Expected '{op}' in '{self.text}'")
+        self.pos += 1
+
+    def evaluate(self):
+        value = self.binary(0)
+        if self.pos != len(self.tokens):
+            raise XlatError(f"Unexpected '{self.peek()[1]}' in '{self.text}'")
+        return value
+
+    def binary(self, level):
+        if level == len(self.BINARY_LEVELS):
+            return self.unary()
+
+        ops = self.BINARY_LEVELS[level]
+        value = self.binary(level + 1)
+        while self.peek()[0] == "op" and self.peek()[1] in ops:
+            op = self.peek()[1]
+            self.pos += 1
+            value = ops[op](value, self.binary(level + 1))
+        return value
+
+    def unary(self):
+        kind, value = self.peek()
+        if kind == "op" and value in ("-", "+", "~"):
+            self.pos += 1
+            operand = self.unary()
+            return {"-": -operand, "+": operand, "~": ~operand}[value]
+        return self.primary()
+
+    def primary(self):
+        kind, value = self.peek()
+        self.pos += 1
+        if kind is None:
+            raise XlatError(f"Unexpected end of '{self.text}'")
+        if kind == "int":
+            return value
+        if kind == "op" and value == "(":
+            result = self.binary(0)
+            self.expect(")")
+            return result
+        if kind == "name" and value == "XLAT_SYM":
+            self.expect("(")
+            kind, sym = self.peek()
+            self.pos += 1
+            self.expect(")")
+            if kind != "name" or sym not in self.symbols:
+                raise XlatError(f"Unknown linker symbol '{sym}' in '{self.text}'")
+            return self.symbols[sym]
+        if kind == "name":
+            if value not in self.names:
+                raise XlatError(f"Unknown symbol '{value}' in '{self.text}'")
+            return self.names[value]
+        raise XlatError(f"Unexpected '{value}' in '{self.text}'")
+
+
+def read_symbols(path):
+    symbols = {}
+    with open(path, "r", encoding="utf-8") as f:
+        for line in f:
+            fields = line.split()
+            if len(fields) == 3:
+                symbols[fields[2]] = int(fields[0], 16)
+    return symbols
+
+
+def split_args(text):
+    args = []
+    depth = 0
+    current = ""
+    for c in text:
+        if c == "(":
+            depth += 1
+        elif c == ")":
+            depth -= 1
+        if c == "," and depth == 0:
+            args.append(current.strip())
+            current = ""
+        else:
+            current += c
+    args.append(current.strip())
+    return args
+
+
+def read_regions(path, symbols):
+    with open(path, "r", encoding="utf-8") as f:
+        text = f.read()
+
+    regions = []
+
+    for m in re.finditer(r"XLAT_REGION\s*\(", text):
+        depth = 1
+        pos = m.end()
+        while depth > 0:
+            if pos >= len(text):
+                raise XlatError("Unterminated XLAT_REGION")
+            if text[pos] == "(":
+                depth += 1
+            elif text[pos] == ")":
+                depth -= 1
+            pos += 1
+        args = split_args(text[m.end():pos - 1])
+        if len(args) != 4:
+            raise XlatError(f"XLAT_REGION takes 4 arguments: {args}")
+
+        regions.append(tuple(ExprParser(arg, MT_ATTRS, symbols).evaluate() for arg in args))
+
+    return regions
+
+
+class XlatContext:
+    def __init__(self, arch, el, va_size, pa_size, tables_addr, max_tables):
+        self.arch = arch
+        self.va_size = va_size
+        self.pa_size = pa_size
+        self.tables_addr = tables_addr
+        self.max_tables = max_tables
+        self.tables = []
+        self.mmap = []
+        self.max_pa = 0
+        self.max_va = 0
+
+        if el == 3:
+            self.execute_never_mask = upper_attrs(XN)
+            self.ap1_mask = lower_attrs(AP_ONE_VA_RANGE_RES1)
+        elif el == 1:
+            self.execute_never_mask = upper_attrs(XN if arch == "aarch32" else PXN)
+            self.ap1_mask = 0
+        else:
+            raise XlatError(f"Unsupported exception level {el}")
+
+    def add_region(self, base_pa, base_va, size, attr):
+        page_mask = (1 << PAGE_SHIFT) - 1
+        if (base_pa | base_va | size) & page_mask:
+            raise XlatError(
+                f"Region PA 0x{base_pa:x} VA 0x{base_va:x} size 0x{size:x} is not page aligned"
+            )
+        if size == 0:
+            return
+        if base_va + size - 1 > self.va_size - 1:
+            raise XlatError(f"Region VA 0x{base_va:x} is outside the VA space")
+        if base_pa + size - 1 > self.pa_size - 1:
+            raise XlatError(f"Region PA 0x{base_pa:x} is outside the PA space")
+
+        # Same ordering rules as mmap_add_region()
+        i = 0
+        while i < len(self.mmap) and self.mmap[i][1] < base_va:
+            i += 1
+        while i < len(self.mmap) and self.mmap[i][1] == base_va and self.mmap[i][2] > size:
+            i += 1
+        self.mmap.insert(i, (base_pa, base_va, size, attr))
+
+        self.max_pa = max(self.max_pa, base_pa + size - 1)
+        self.max_va = max(self.max_va, base_va + size - 1)
+
+    def desc(self, attr, addr_pa, level):
+        if addr_pa & ((1 << level_shift(level)) - 1):
+            raise XlatError(f"PA 0x{addr_pa:x} can't be mapped at level {level}")
+
+        desc = addr_pa
+        desc |= PAGE_DESC if level == LEVEL_MAX else BLOCK_DESC
+        desc |= lower_attrs(NS) if attr & MT_NS else 0
+        desc |= lower_attrs(AP_RW) if attr & MT_RW else lower_attrs(AP_RO)
+        desc |= lower_attrs(ACCESS_FLAG)
+        desc |= self.ap1_mask
+
+        mem_type = attr & MT_TYPE_MASK
+        if mem_type == MT_DEVICE:
+            desc |= lower_attrs(ATTR_DEVICE_INDEX | OSH)
+            desc |= self.execute_never_mask
+        else:
+            if attr & (MT_RW | MT_EXECUTE_NEVER):
+                desc |= self.execute_never_mask
+            if mem_type == MT_MEMORY:
+                desc |= lower_attrs(ATTR_IWBWA_OWBWA_NTR_INDEX | ISH)
+            elif mem_type == MT_NON_CACHEABLE:
+                desc |= lower_attrs(ATTR_NON_CACHEABLE_INDEX | OSH)
+            else:
+                raise XlatError(f"Unknown memory type in attr 0x{attr:x}")
+        return desc
+
+    def region_attr(self, idx, base_va, size):
+        """Mirror of mmap_region_attr(), returns None for MT_UNKNOWN."""
+        attr = None
+        for base_pa_r, base_va_r, size_r, attr_r in self.mmap[idx:]:
+            if base_va_r > base_va + size - 1:
+                return attr
+            if base_va_r + size_r - 1 < base_va:
+                continue
+            if attr is not None and attr_r == attr:
+                continue
+            if base_va_r > base_va or (base_va_r + size_r - 1) < (base_va + size - 1):
+                return None
+            attr = attr_r
+        return attr
+
+    def fill(self, idx, base_va, table, level):
+        size = 1 << level_shift(level)
+        index_mask = (TABLE_ENTRIES - 1) << level_shift(level)
+        pos = 0
+
+        while True:
+            desc = None
+
+            if idx >= len(self.mmap):
+                desc = INVALID_DESC
+            elif self.mmap[idx][1] + self.mmap[idx][2] - 1 < base_va:
+                idx += 1
+                continue
+
+            if idx < len(self.mmap) and self.mmap[idx][1] > base_va + size - 1:
+                desc = INVALID_DESC
+            elif idx < len(self.mmap) and level >= MIN_LVL_BLOCK_DESC:
+                attr = self.region_attr(idx, base_va, size)
+                if attr is not None:
+                    base_pa_r, base_va_r = self.mmap[idx][0], self.mmap[idx][1]
+                    desc = self.desc(attr, base_va - base_va_r + base_pa_r, level)
+
+            if desc is None:
+                if len(self.tables) >= self.max_tables:
+                    raise XlatError(
+                        f"More than {self.max_tables} tables needed, "
+                        "increase CONFIG_LIB_XLAT_TBLS_STATIC_MAX_TABLES"
+                    )
+                new_table = [INVALID_DESC] * TABLE_ENTRIES
+                table_addr = self.tables_addr + len(self.tables) * TABLE_ENTRIES * 8
+                self.tables.append(new_table)
+                desc = TABLE_DESC | table_addr
+                idx = self.fill(idx, base_va, new_table, level + 1)
+
+            table[pos] = desc
+            pos += 1
+            base_va += size
+
+            if not ((base_va & index_mask) and (base_va - 1) < (self.va_size - 1)):
+                break
+
+        return idx
+
+    def generate(self):
+        level = base_level(self.arch, self.va_size)
+        base = [INVALID_DESC] * num_base_entries(self.arch, self.va_size)
+        self.fill(0, 0, base, level)
+        return base
+
+
+def emit_table(out, entries):
+    for i in range(0, len(entries), 4):
+        out.append("    " + ", ".join(f"0x{e:016x}ULL" for e in entries[i:i + 4]) + ",")
+
+
+def emit(path, arch, el, va_size, max_tables, base=None, tables=None, max_pa=0):
+    n_base = num_base_entries(arch, va_size)
+    out = [
+        "/* Generated by scripts/xlat_gen.py, do not edit */",
+        "",
+        "#include <stdint.h>",
+        "",
+        f"const unsigned int xlat_static_el = {el}U;",
+        f"const unsigned long long xlat_static_max_pa = 0x{max_pa:x}ULL;",
+        "",
+        f"const uint64_t {BASE_TABLE_SYM}[{n_base}]",
+        f"    __attribute__((aligned({n_base * 8}), section(\"{SECTION}\"))) = {{",
+    ]
+    emit_table(out, base if base is not None else [INVALID_DESC] * n_base)
+    out.append("};")
+    out.append("")
+    out.append(f"const uint64_t {TABLES_SYM}[{max_tables}][{TABLE_ENTRIES}]")
+    out.append(f"    __attribute__((aligned({TABLE_ENTRIES * 8}), section(\"{SECTION}\"))) = {{")
+    for t in tables or []:
+        out.append("    {")
+        emit_table(out, t)
+        out.append("    },")
+    out.append("};")
+
+    with open(path, "w", encoding="utf-8") as f:
+        f.write("\n".join(out) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate static MMU translation tables")
+    parser.add_argument("--arch", choices=["aarch32", "aarch64"], required=True)
+    parser.add_argument("--el", type=int, default=3)
+    parser.add_argument("--va-size", required=True)
+    parser.add_argument("--pa-size", required=True)
+    parser.add_argument("--max-tables", type=int, required=True)
+    parser.add_argument("--regions", help="Pre-processed region file")
+    parser.add_argument("--symbols", help="nm output of the first link stage")
+    parser.add_argument("--placeholder", action="store_true", help="Emit zeroed tables")
+    parser.add_argument("output")
+    args = parser.parse_args()
+
+    va_size = parse_int(args.va_size)
+    pa_size = parse_int(args.pa_size)
+
+    try:
+        if args.placeholder:
+            emit(args.output, args.arch, args.el, va_size, args.max_tables)
+            return 0
+
+        if not args.regions or not args.symbols:
+            raise XlatError("--regions and --symbols are required")
+
+        symbols = read_symbols(args.symbols)
+        if TABLES_SYM not in symbols:
+            raise XlatError(f"'{TABLES_SYM}' not found in {args.symbols}")
+
+        ctx = XlatContext(
+            args.arch, args.el, va_size, pa_size, symbols[TABLES_SYM], args.max_tables
+        )
+        for region in read_regions(args.regions, symbols):
+            ctx.add_region(*region)
+
+        base = ctx.generate()
+        emit(
+            args.output,
+            args.arch,
+            args.el,
+            va_size,
+            args.max_tables,
+            base=base,
+            tables=ctx.tables,
+            max_pa=ctx.max_pa,
+        )
+    except XlatError as e:
+        print(f"xlat_gen: {e}", file=sys.stderr)
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
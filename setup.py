@@ -19,17 +19,18 @@ elif plat == "Darwin":
     # CI system is expected to set 'PB_MACOS_ARCH' to help out, since we can't
     # get target arch here when cross compiling wheels.
     _target_arch = os.environ["PB_MACOS_ARCH"]
-    _libraries = ["usb-1.0"]
+    _libraries = ["usb-1.0", "pthread"]
     _library_dirs = [f"libusb_{_target_arch}/1.0.27/lib"]
     _include_dirs = ["include", f"libusb_{_target_arch}/1.0.27/include"]
 else:
-    _libraries = ["usb-1.0"]
+    _libraries = ["usb-1.0", "pthread"]
     _library_dirs = []
     _include_dirs = ["include"]
 
 
 _srcs = [
     "src/wire.c",
+    "src/lib/blake3.c",
     "src/lib/bpak.c",
     f"{pb_base_path}/error.c",
     f"{pb_base_path}/api.c",
@@ -44,6 +45,7 @@ _srcs = [
     f"{pb_base_path}/usb.c",
     f"{pb_base_path}/python_wrapper.c",
     f"{pb_base_path}/exceptions.c",
+    f"{pb_base_path}/sha256.c",
 ]
 
 # For now we only enable the 'socket' transport on linux machines, it's only
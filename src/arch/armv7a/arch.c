@@ -22,6 +22,22 @@ void exception(int id)
     plat_reset();
 }
 
+void arch_irq_enable(void)
+{
+    enable_irq();
+}
+
+void arch_irq_disable(void)
+{
+    disable_irq();
+}
+
+void arch_wait_for_interrupt(void)
+{
+    dsb();
+    wfi();
+}
+
 void arch_disable_mmu(void)
 {
     uintptr_t stack_start = (uintptr_t)&_stack_start;
@@ -0,0 +1,35 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef ARCH_ARMV7A_INCLUDE_ARCH_PSCI_H
+#define ARCH_ARMV7A_INCLUDE_ARCH_PSCI_H
+
+#include <stdint.h>
+
+#define PSCI_CPU_OFF       0x84000002
+#define PSCI_CPU_ON        0x84000003
+#define PSCI_AFFINITY_INFO 0x84000004
+#define PSCI_SYSTEM_RESET  0x84000009
+
+#define PSCI_RET_SUCCESS 0
+
+/* AFFINITY_INFO states */
+#define PSCI_AFFINITY_ON         0
+#define PSCI_AFFINITY_OFF        1
+#define PSCI_AFFINITY_ON_PENDING 2
+
+/**
+ * Issue a PSCI call through the SMC or HVC conduit
+ *
+ * @return PSCI return code
+ */
+int32_t arch_psci_smc(uint32_t fn, uint32_t arg0, uint32_t arg1, uint32_t arg2);
+int32_t arch_psci_hvc(uint32_t fn, uint32_t arg0, uint32_t arg1, uint32_t arg2);
+
+#endif // ARCH_ARMV7A_INCLUDE_ARCH_PSCI_H
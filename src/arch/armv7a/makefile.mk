@@ -22,6 +22,8 @@ asm-y += src/arch/armv7a/boot.S
 asm-y += src/arch/armv7a/timer.S
 asm-y += src/arch/armv7a/cp15.S
 asm-y += src/arch/armv7a/misc_helpers.S
+asm-y += src/arch/armv7a/psci.S
+asm-$(CONFIG_SMP) += src/arch/armv7a/smp.S
 
 src-y += src/arch/armv7a/arm32_aeabi_divmod.c
 src-y += src/arch/armv7a/arch.c
@@ -1,3 +1,4 @@
+#include <arch/arch.h>
 #include <pb/arch.h>
 #include <pb/pb.h>
 
@@ -8,3 +9,21 @@ void arch_init(void)
 void arch_disable_mmu(void)
 {
 }
+
+void arch_irq_enable(void)
+{
+    __asm__ volatile("cpsie i" : : : "memory");
+    ARM_ISB();
+}
+
+void arch_irq_disable(void)
+{
+    __asm__ volatile("cpsid i" : : : "memory");
+    ARM_ISB();
+}
+
+void arch_wait_for_interrupt(void)
+{
+    ARM_DSB();
+    __asm__ volatile("wfi" : : : "memory");
+}
@@ -1,5 +1,6 @@
 #include <arch/arch.h>
 #include <pb/console.h>
+#include <pb/irq.h>
 #include <pb/mmio.h>
 #include <pb/pb.h>
 #include <string.h>
@@ -15,7 +16,12 @@ IMPORT_SYM(uintptr_t, _code_end, code_end);
 static void armv7m_entry(void);
 static void armv7m_default_handler(void);
 
+#ifdef CONFIG_IRQ
+/* VTOR requires the table to be aligned to its size, rounded up to a power of two */
+const uintptr_t init_vector[] __section(".vectors") __aligned(1024) = {
+#else
 const uintptr_t init_vector[] __section(".vectors") = {
+#endif
     stack_end,
     (uintptr_t)armv7m_entry,
     (uintptr_t)armv7m_default_handler,
@@ -32,11 +38,15 @@ const uintptr_t init_vector[] __section(".vectors") = {
     (uintptr_t)armv7m_default_handler,
     (uintptr_t)armv7m_default_handler,
     (uintptr_t)armv7m_default_handler,
+#ifdef CONFIG_IRQ
+    [16 ...(16 + CONFIG_ARMV7M_NVIC_IRQS - 1)] = (uintptr_t)irq_dispatch,
+#else
     (uintptr_t)armv7m_default_handler,
     (uintptr_t)armv7m_default_handler,
     (uintptr_t)armv7m_default_handler,
     (uintptr_t)armv7m_default_handler,
     (uintptr_t)armv7m_default_handler,
+#endif
 };
 
 static __section(".vector_handlers") void armv7m_default_handler(void)
@@ -0,0 +1,22 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef INCLUDE_ARCH_ARMV7M_NVIC_H
+#define INCLUDE_ARCH_ARMV7M_NVIC_H
+
+/**
+ * Point VTOR at the bootloader vector table and register the NVIC as the
+ * interrupt controller. Interrupt numbers passed to 'irq_register' are
+ * external interrupt numbers, i.e. exception number - 16.
+ *
+ * @return PB_OK on success or a negative number
+ */
+int nvic_init(void);
+
+#endif // INCLUDE_ARCH_ARMV7M_NVIC_H
@@ -0,0 +1,85 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <arch/arch.h>
+#include <arch/nvic.h>
+#include <pb/irq.h>
+#include <pb/mmio.h>
+#include <pb/pb.h>
+
+#define NVIC_ISER(n)          (0xe000e100 + (n)*4)
+#define NVIC_ICER(n)          (0xe000e180 + (n)*4)
+#define NVIC_ICPR(n)          (0xe000e280 + (n)*4)
+#define NVIC_IPR(n)           (0xe000e400 + (n))
+#define SCB_VTOR              0xe000ed08
+
+#define NVIC_PRIORITY_DEFAULT 0x80
+#define NVIC_EXC_IRQ_START    16
+
+extern const uintptr_t init_vector[];
+
+static int nvic_enable(unsigned int irq)
+{
+    if (irq >= CONFIG_ARMV7M_NVIC_IRQS)
+        return -PB_ERR_PARAM;
+
+    mmio_write_8(NVIC_IPR(irq), NVIC_PRIORITY_DEFAULT);
+    mmio_write_32(NVIC_ICPR(irq / 32), BIT(irq % 32));
+    mmio_write_32(NVIC_ISER(irq / 32), BIT(irq % 32));
+    return PB_OK;
+}
+
+static int nvic_disable(unsigned int irq)
+{
+    if (irq >= CONFIG_ARMV7M_NVIC_IRQS)
+        return -PB_ERR_PARAM;
+
+    mmio_write_32(NVIC_ICER(irq / 32), BIT(irq % 32));
+    ARM_DSB();
+    ARM_ISB();
+    return PB_OK;
+}
+
+static void nvic_dispatch(void)
+{
+    uint32_t ipsr;
+
+    /* The NVIC vectors each interrupt, the active one is found in IPSR */
+    __asm__ volatile("mrs %0, ipsr" : "=r"(ipsr));
+
+    irq_handle((ipsr & 0x1ff) - NVIC_EXC_IRQ_START);
+}
+
+static void nvic_shutdown(void)
+{
+    for (unsigned int n = 0; n < div_round_up(CONFIG_ARMV7M_NVIC_IRQS, 32U); n++)
+        mmio_write_32(NVIC_ICER(n), 0xffffffff);
+
+    ARM_DSB();
+    ARM_ISB();
+}
+
+int nvic_init(void)
+{
+    static const struct irq_controller_ops ops = {
+        .name = "nvic",
+        .enable = nvic_enable,
+        .disable = nvic_disable,
+        .dispatch = nvic_dispatch,
+        .shutdown = nvic_shutdown,
+    };
+
+    nvic_shutdown();
+
+    mmio_write_32(SCB_VTOR, (uint32_t)(uintptr_t)init_vector);
+    ARM_DSB();
+    ARM_ISB();
+
+    return irq_set_controller(&ops);
+}
@@ -8,6 +8,27 @@ extern char _code_start, _code_end, _data_region_start, _data_region_end, _ro_da
 
 void arch_init(void)
 {
+#ifdef CONFIG_IRQ
+    /* Route physical IRQ's to EL3 */
+    write_scr_el3(read_scr_el3() | SCR_IRQ_BIT);
+    isb();
+#endif
+}
+
+void arch_irq_enable(void)
+{
+    enable_irq();
+}
+
+void arch_irq_disable(void)
+{
+    disable_irq();
+}
+
+void arch_wait_for_interrupt(void)
+{
+    dsb();
+    wfi();
 }
 
 /* Generic exception handler */
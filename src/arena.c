@@ -0,0 +1,160 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <pb/arena.h>
+#include <pb/pb.h>
+#include <stdio.h>
+
+/* The budgets start on a page boundary */
+#define ARENA_PAGE_SIZE 4096
+
+#if defined(CONFIG_ARENA_32BIT_DMA) && (UINTPTR_MAX > 0xffffffff)
+#define ARENA_DMA_LIMIT 0x100000000ul
+#endif
+
+static struct arena_budget {
+    const char *name;
+    size_t fixed_size; /* Zero for the budget that gets the rest */
+    uintptr_t base;
+    size_t size;
+    size_t used;
+} budgets[ARENA_END] = {
+    [ARENA_BOOT] = { .name = "boot", .fixed_size = CONFIG_ARENA_BOOT_KiB * 1024 },
+    [ARENA_DRIVERS] = { .name = "drivers", .fixed_size = CONFIG_ARENA_DRIVERS_KiB * 1024 },
+    [ARENA_CRYPTO] = { .name = "crypto", .fixed_size = CONFIG_ARENA_CRYPTO_KiB * 1024 },
+    [ARENA_CM] = { .name = "cm" },
+};
+
+static uintptr_t arena_start;
+static uintptr_t arena_end;
+
+int arena_init(uintptr_t start, uintptr_t end)
+{
+    size_t fixed = 0;
+    size_t size;
+    uintptr_t p;
+
+#ifdef ARENA_DMA_LIMIT
+    if (end > ARENA_DMA_LIMIT)
+        end = ARENA_DMA_LIMIT;
+#endif
+
+    start = round_up(start, ARENA_PAGE_SIZE);
+    end = round_down(end, ARENA_PAGE_SIZE);
+
+    if (end <= start) {
+        LOG_ERR("No free RAM");
+        return -PB_ERR_MEM;
+    }
+
+    /* Take the share from the top, images are usually loaded low in RAM */
+    size = ((uint64_t)(end - start) * CONFIG_ARENA_RAM_PERCENT) / 100;
+    size = MIN(size, (size_t)CONFIG_ARENA_MAX_MiB * 1024 * 1024);
+    size = round_down(size, ARENA_PAGE_SIZE);
+
+    for (int i = 0; i < ARENA_END; i++)
+        fixed += budgets[i].fixed_size;
+
+    if (size <= fixed) {
+        LOG_ERR("Arena too small, %zu KiB for %zu KiB of fixed budgets",
+                size / 1024,
+                fixed / 1024);
+        return -PB_ERR_MEM;
+    }
+
+    arena_start = end - size;
+    arena_end = end;
+    p = arena_start;
+
+    for (int i = 0; i < ARENA_END; i++) {
+        struct arena_budget *b = &budgets[i];
+
+        b->base = p;
+        b->size = b->fixed_size ? b->fixed_size : (size - fixed);
+        b->used = 0;
+        p += b->size;
+    }
+
+    LOG_DBG("Arena at 0x%" PRIxPTR ", %zu KiB", arena_start, size / 1024);
+    return PB_OK;
+}
+
+void *arena_alloc_aligned(enum arena_id id, size_t size, size_t align)
+{
+    struct arena_budget *b;
+    uintptr_t p;
+
+    if ((id >= ARENA_END) || (size == 0) || !IS_POWER_OF_TWO(align))
+        return NULL;
+
+    b = &budgets[id];
+
+    if (b->size == 0)
+        return NULL;
+
+    align = MAX(align, (size_t)CACHE_LINE);
+    p = round_up(b->base + b->used, align);
+    size = round_up(size, CACHE_LINE);
+
+    if ((p + size) > (b->base + b->size)) {
+        LOG_ERR("%s: %zu bytes don't fit, %zu of %zu used",
+                b->name,
+                size,
+                b->used,
+                b->size);
+        return NULL;
+    }
+
+    b->used = (p + size) - b->base;
+
+    return (void *)p;
+}
+
+void *arena_alloc(enum arena_id id, size_t size)
+{
+    return arena_alloc_aligned(id, size, CACHE_LINE);
+}
+
+size_t arena_available(enum arena_id id)
+{
+    if (id >= ARENA_END)
+        return 0;
+
+    return budgets[id].size - budgets[id].used;
+}
+
+bool arena_overlaps(uintptr_t start, size_t length)
+{
+    if (arena_end == arena_start)
+        return false;
+
+    return (start < arena_end) && ((start + length) > arena_start);
+}
+
+int arena_get_usage(enum arena_id id, struct arena_usage *usage)
+{
+    if (id >= ARENA_END)
+        return -PB_ERR_PARAM;
+
+    usage->name = budgets[id].name;
+    usage->base = budgets[id].base;
+    usage->budget = budgets[id].size;
+    usage->used = budgets[id].used;
+    return PB_OK;
+}
+
+void arena_print_usage(void)
+{
+    for (int i = 0; i < ARENA_END; i++) {
+        LOG_INFO("Arena %-8s %8zu KiB, %8zu KiB used",
+                 budgets[i].name,
+                 budgets[i].size / 1024,
+                 budgets[i].used / 1024);
+    }
+}
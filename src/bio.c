@@ -1,3 +1,4 @@
+#include <inttypes.h>
 #include <pb/bio.h>
 #include <pb/errors.h>
 #include <pb/pb.h>
@@ -13,6 +14,7 @@ struct bio_device {
     uint32_t flags;
     size_t block_sz;
     bio_read_t read;
+    bio_readv_t readv;
     bio_write_t write;
     bio_erase_t erase;
     bio_call_t install_partition_table;
@@ -57,7 +59,7 @@ bio_dev_t bio_allocate(lba_t first_lba,
 #if (LOGLEVEL > 1)
     char uu_str[37];
     uuid_unparse(uu, uu_str);
-    LOG_INFO("%s: %i - %i, %s", uu_str, first_lba, last_lba, description);
+    LOG_INFO("%s: %" PRIu64 " - %" PRIu64 ", %s", uu_str, first_lba, last_lba, description);
 #endif
     return n_bios++;
 }
@@ -84,6 +86,7 @@ bio_dev_t bio_allocate_parent(bio_dev_t parent,
     bio_pool[new].flags = bio_pool[parent].flags;
 
     bio_pool[new].read = bio_pool[parent].read;
+    bio_pool[new].readv = bio_pool[parent].readv;
     bio_pool[new].write = bio_pool[parent].write;
     bio_pool[new].erase = bio_pool[parent].erase;
     bio_pool[new].private = bio_pool[parent].private;
@@ -125,6 +128,19 @@ int bio_set_ios_erase(bio_dev_t dev, bio_erase_t erase)
     return PB_OK;
 }
 
+int bio_set_ios_readv(bio_dev_t dev, bio_readv_t readv)
+{
+    int rc;
+
+    rc = check_dev(dev);
+    if (rc != PB_OK)
+        return rc;
+
+    bio_pool[dev].readv = readv;
+
+    return PB_OK;
+}
+
 int bio_set_private(bio_dev_t dev, uintptr_t priv)
 {
     int rc;
@@ -168,11 +184,13 @@ ssize_t bio_block_size(bio_dev_t dev)
 
 static int check_lba_range(bio_dev_t dev, lba_t lba, size_t length)
 {
-    size_t n_blocks = length / bio_pool[dev].block_sz;
+    lba_t no_of_blocks = bio_pool[dev].last_lba - bio_pool[dev].first_lba + 1;
+    lba_t n_blocks = length / bio_pool[dev].block_sz;
     if (length % bio_pool[dev].block_sz)
         n_blocks++;
 
-    if ((bio_pool[dev].first_lba + lba + n_blocks - 1) > bio_pool[dev].last_lba) {
+    /* Written so that it can't wrap around for large lba's */
+    if (lba >= no_of_blocks || n_blocks > (no_of_blocks - lba)) {
         return -1;
     }
 
@@ -189,12 +207,54 @@ int bio_read(bio_dev_t dev, lba_t lba, size_t length, void *buf)
     if (bio_pool[dev].read == NULL)
         return -PB_ERR_NOT_SUPPORTED;
     if (check_lba_range(dev, lba, length) != 0) {
-        LOG_ERR("Range error, lba=%i, length=%zu", lba, length);
+        LOG_ERR("Range error, lba=%" PRIu64 ", length=%zu", lba, length);
         return -PB_ERR_PARAM;
     }
     return bio_pool[dev].read(dev, bio_pool[dev].first_lba + lba, length, buf);
 }
 
+int bio_readv(bio_dev_t dev, lba_t lba, const struct bio_segment *segs, unsigned int no_of_segs)
+{
+    int rc;
+    size_t length = 0;
+    lba_t lba_offset;
+
+    rc = check_dev(dev);
+    if (rc != PB_OK)
+        return rc;
+    if (bio_pool[dev].read == NULL)
+        return -PB_ERR_NOT_SUPPORTED;
+    if (segs == NULL || no_of_segs == 0)
+        return -PB_ERR_PARAM;
+
+    for (unsigned int i = 0; i < no_of_segs; i++) {
+        if ((i < (no_of_segs - 1)) && (segs[i].length % bio_pool[dev].block_sz))
+            return -PB_ERR_PARAM;
+        length += segs[i].length;
+    }
+
+    if (check_lba_range(dev, lba, length) != 0) {
+        LOG_ERR("Range error, lba=%" PRIu64 ", length=%zu", lba, length);
+        return -PB_ERR_PARAM;
+    }
+
+    if (bio_pool[dev].readv != NULL)
+        return bio_pool[dev].readv(dev, bio_pool[dev].first_lba + lba, segs, no_of_segs);
+
+    lba_offset = bio_pool[dev].first_lba + lba;
+
+    for (unsigned int i = 0; i < no_of_segs; i++) {
+        rc = bio_pool[dev].read(dev, lba_offset, segs[i].length, segs[i].buf);
+
+        if (rc != PB_OK)
+            return rc;
+
+        lba_offset += segs[i].length / bio_pool[dev].block_sz;
+    }
+
+    return PB_OK;
+}
+
 int bio_write(bio_dev_t dev, lba_t lba, size_t length, const void *buf)
 {
     int rc;
@@ -291,21 +351,21 @@ const unsigned char *bio_get_uu(bio_dev_t dev)
     return bio_pool[dev].uu;
 }
 
-int bio_get_last_block(bio_dev_t dev)
+int64_t bio_get_last_block(bio_dev_t dev)
 {
     if (check_dev(dev) != PB_OK)
         return -PB_ERR_PARAM;
     return bio_pool[dev].last_lba;
 }
 
-int bio_get_first_block(bio_dev_t dev)
+int64_t bio_get_first_block(bio_dev_t dev)
 {
     if (check_dev(dev) != PB_OK)
         return -PB_ERR_PARAM;
     return bio_pool[dev].first_lba;
 }
 
-int bio_get_no_of_blocks(bio_dev_t dev)
+int64_t bio_get_no_of_blocks(bio_dev_t dev)
 {
     if (check_dev(dev) != PB_OK)
         return -PB_ERR_PARAM;
@@ -8,6 +8,7 @@
  */
 
 #include <drivers/crypto/imx_caam.h>
+#include <drivers/crypto/mbedtls.h>
 #include <drivers/mmc/imx_usdhc.h>
 #include <drivers/partition/gpt.h>
 #include <drivers/uart/imx_uart.h>
@@ -18,6 +19,7 @@
 #include <libfdt.h>
 #include <pb/cm.h>
 #include <pb/console.h>
+#include <pb/crc.h>
 #include <pb/mmio.h>
 #include <pb/pb.h>
 #include <pb/plat.h>
@@ -153,12 +155,43 @@ void board_console_init(struct imx8m_platform *plat_)
     console_init(IMX8M_UART1_BASE, &ops);
 }
 
+/*
+ * The HS200 delay tap is kept in the SNVS low power general purpose
+ * registers, which are retained over resets. LPGPR2 holds a crc32 of the
+ * card CID and LPGPR3 the tap, a cold boot tunes the bus once.
+ */
+#define TUNING_CACHE_MAGIC 0x7a500000
+#define TUNING_CACHE_MASK  0xfff00000
+
+static int tuning_cache_read(const mmc_cmd_resp_t cid, unsigned int *tap)
+{
+    uint32_t value = mmio_read_32(SNVS_LPGPR(3));
+
+    if ((value & TUNING_CACHE_MASK) != TUNING_CACHE_MAGIC)
+        return -PB_ERR_NOT_FOUND;
+
+    if (mmio_read_32(SNVS_LPGPR(2)) != crc32(0, (const uint8_t *)cid, sizeof(mmc_cmd_resp_t)))
+        return -PB_ERR_NOT_FOUND;
+
+    *tap = value & ~TUNING_CACHE_MASK;
+    return PB_OK;
+}
+
+static int tuning_cache_write(const mmc_cmd_resp_t cid, unsigned int tap)
+{
+    mmio_write_32(SNVS_LPGPR(2), crc32(0, (const uint8_t *)cid, sizeof(mmc_cmd_resp_t)));
+    mmio_write_32(SNVS_LPGPR(3), TUNING_CACHE_MAGIC | tap);
+    return PB_OK;
+}
+
 static int usdhc_emmc_setup(void)
 {
     unsigned int rate;
     /* Enable and ungate USDHC1 clock */
     mmio_write_32(CCM_CORE_CLK_ROOT_GEN_TAGET_SET(USDHC1_CLK_ROOT), CLK_ROOT_ON);
     mmio_write_32(CCM_CCGR_SET(CCGR_USDHC1), CCGR_CLK_ON_MASK);
+    /* Ungate SNVS, it holds the delay tap cache */
+    mmio_write_32(CCM_CCGR_SET(CCGR_SNVS), CCGR_CLK_ON_MASK);
 
     /* USDHC1 mux */
     mmio_write_32(IOMUXC_MUX_SD1_CLK, MUX_ALT(0));
@@ -202,6 +235,8 @@ static int usdhc_emmc_setup(void)
             .user_uu = PART_user,
             .rpmb_uu = PART_rpmb,
             .flags = 0,
+            .tuning_cache_read = tuning_cache_read,
+            .tuning_cache_write = tuning_cache_write,
         },
     };
 
@@ -219,6 +254,16 @@ int board_init(struct imx8m_platform *plat_)
         return rc;
     }
 
+#ifdef CONFIG_DRIVERS_CRYPTO_MBEDTLS
+    /* Hashes the inputs that are shorter than the CAAM minimum length */
+    rc = mbedtls_pb_init();
+
+    if (rc != PB_OK) {
+        LOG_ERR("mbedtls init failed (%i)", rc);
+        return rc;
+    }
+#endif
+
     usdhc_emmc_setup();
 
     bio_dev_t user_part = bio_get_part_by_uu(PART_user);
@@ -270,6 +270,13 @@ int board_init(struct imx6ul_platform *plat_)
         return rc;
     }
 
+#ifdef CONFIG_IRQ
+    rc = imx_caam_enable_irq(IMX6UL_CAAM_JR1_IRQ);
+
+    if (rc != PB_OK)
+        LOG_WARN("CAAM interrupt not available (%i), polling", rc);
+#endif
+
     rc = usdhc_emmc_setup();
 
     if (rc != PB_OK) {
@@ -10,8 +10,12 @@
 #include <boot/ab_state.h>
 #include <boot/boot.h>
 #include <boot/linux.h>
+#include <bpak/id.h>
+#include <drivers/crypto/blake3.h>
+#include <drivers/crypto/ed25519.h>
 #include <drivers/crypto/mbedtls.h>
 #include <drivers/fuse/test_fuse_bio.h>
+#include <drivers/mmc/mmc_ram.h>
 #include <drivers/partition/gpt.h>
 #include <drivers/virtio/virtio_block.h>
 #include <drivers/virtio/virtio_serial.h>
@@ -19,6 +23,7 @@
 #include <pb/cm.h>
 #include <pb/plat.h>
 #include <pb/rot.h>
+#include <pb/stub.h>
 #include <plat/qemu/qemu.h>
 #include <plat/qemu/semihosting.h>
 #include <plat/qemu/uart.h>
@@ -42,7 +47,7 @@ static const struct gpt_part_table gpt_tbl_default[] = {
     {
         .uu = UUID_f5f8c9ae_efb5_4071_9ba9_d313b082281e,
         .description = "PB State Primary",
-        .size = 512,
+        .size = SZ_KiB(32), /* Snapshot and 63 journal records */
     },
     {
         .uu = UUID_656ab3fc_5856_4a5e_a2ae_5a018313b3ee,
@@ -75,7 +80,7 @@ static const struct gpt_part_table gpt_tbl_var1[] = {
     {
         .uu = UUID_f5f8c9ae_efb5_4071_9ba9_d313b082281e,
         .description = "PB State Primary",
-        .size = 512,
+        .size = SZ_KiB(32), /* Snapshot and 63 journal records */
     },
     {
         .uu = UUID_656ab3fc_5856_4a5e_a2ae_5a018313b3ee,
@@ -160,6 +165,103 @@ static int early_boot(void)
     return PB_OK;
 }
 
+/* The recovery part is only needed when booting into recovery, which this
+ * board doesn't do. Only used for images with per-part digests. */
+static bool board_skip_part(struct bpak_header *header, bpak_id_t part_id)
+{
+    (void)header;
+
+    if (part_id == 0x96614ca0) { /* bpak_id("recovery") */
+        LOG_INFO("Skipping the recovery part");
+        return true;
+    }
+
+    return false;
+}
+
+/* The test images carry no device tree. When an image has a 'dtb' part
+ * its first word is overwritten in memory, like the in place patching of
+ * 'boot_driver_linux_prepare', so that the part no longer matches its
+ * digest after the boot. */
+static int board_prepare(struct bpak_header *header, uuid_t boot_part_uu)
+{
+    struct bpak_meta_header *mh;
+    bpak_id_t dtb_id = 0xa731df7a; /* bpak_id("dtb") */
+
+    if (bpak_get_meta(header, BPAK_ID_PB_LOAD_ADDR, dtb_id, &mh) == BPAK_OK) {
+        volatile uint32_t *dtb =
+            (volatile uint32_t *)(uintptr_t)*bpak_get_meta_ptr(header, mh, uint64_t);
+
+        LOG_INFO("Patching the dtb part");
+        *dtb = 0xedfe0dd0; /* FDT magic */
+    }
+
+    return boot_driver_linux_prepare(header, boot_part_uu);
+}
+
+#ifdef CONFIG_BOOT_WARM_CACHE
+#define BOARD_WARM_MAGIC 0x57524d42 /* 'WRMB' */
+
+/* Set before a warm reset, QEMU leaves '.no_init' alone on reset */
+static uint32_t board_warm_magic __section(".no_init");
+static bool board_warm;
+
+static bool board_warm_reset(void)
+{
+    return board_warm;
+}
+
+static void board_write_warm_status(void)
+{
+    size_t bytes_to_write = 1;
+    char status = boot_warm_cache_hit() ? 'W' : 'C';
+    long fd = semihosting_file_open("/tmp/pb_warm_status", 6);
+
+    if (fd < 0)
+        return;
+
+    semihosting_file_write(fd, &bytes_to_write, (const uintptr_t)&status);
+    semihosting_file_close(fd);
+}
+
+/* Does one warm reset when '/tmp/pb_warm_reset' exists. With
+ * '/tmp/pb_warm_tamper' the first part is modified in memory before the
+ * reset. */
+static void board_warm_reset_once(struct bpak_header *header)
+{
+    struct bpak_meta_header *mh;
+    long fd;
+
+    if (board_warm)
+        return;
+
+    fd = semihosting_file_open("/tmp/pb_warm_reset", 0);
+
+    if (fd == -1)
+        return;
+
+    semihosting_file_close(fd);
+
+    fd = semihosting_file_open("/tmp/pb_warm_tamper", 0);
+
+    if (fd != -1) {
+        semihosting_file_close(fd);
+
+        if (bpak_get_meta(header, BPAK_ID_PB_LOAD_ADDR, header->parts[0].id, &mh) == BPAK_OK) {
+            volatile uint8_t *payload =
+                (volatile uint8_t *)(uintptr_t)*bpak_get_meta_ptr(header, mh, uint64_t);
+
+            LOG_INFO("Modifying the payload before the warm reset");
+            *payload ^= 0xff;
+        }
+    }
+
+    LOG_INFO("Warm reset");
+    board_warm_magic = BOARD_WARM_MAGIC;
+    qemu_warm_reset();
+}
+#endif
+
 static int late_boot(struct bpak_header *header, uuid_t boot_part_uu)
 {
     LOG_DBG("Boot!");
@@ -182,6 +284,11 @@ static int late_boot(struct bpak_header *header, uuid_t boot_part_uu)
     semihosting_file_write(fd, &bytes_to_write, (const uintptr_t)&name);
 
     semihosting_file_close(fd);
+
+#ifdef CONFIG_BOOT_WARM_CACHE
+    board_write_warm_status();
+    board_warm_reset_once(header);
+#endif
     plat_reset();
     return -PB_ERR; /* Should not be reached */
 }
@@ -221,21 +328,95 @@ static int board_set_slc_configuration(void)
     return PB_OK;
 }
 
+#ifdef CONFIG_MMC_RAM
+/* RAM backed eMMC, used by tests/test_mmc_stream_xfer.sh to count the MMC
+ * commands of block transfers. */
+static uint8_t emmc_user[SZ_MiB(1)];
+static uint8_t emmc_boot0[SZ_KiB(128)];
+static uint8_t emmc_boot1[SZ_KiB(128)];
+static uint8_t emmc_rpmb[SZ_KiB(128)];
+
+static int board_emmc_init(void)
+{
+    int rc;
+    static const struct mmc_ram_config emmc_cfg = {
+        .user = emmc_user,
+        .user_size = sizeof(emmc_user),
+        .boot0 = emmc_boot0,
+        .boot1 = emmc_boot1,
+        .boot_size = sizeof(emmc_boot0),
+        .rpmb = emmc_rpmb,
+        .rpmb_size = sizeof(emmc_rpmb),
+        .max_chunk_bytes = SZ_KiB(64),
+        .tap_first = 0,
+        .tap_last = 127,
+        .mmc = {
+            .mode = MMC_BUS_MODE_DDR52,
+            .width = MMC_BUS_WIDTH_8BIT,
+            .boot_mode = EXT_CSD_BOOT_DDR | EXT_CSD_BOOT_BUS_WIDTH_8,
+            .boot0_uu = PART_emmc_boot0,
+            .boot1_uu = PART_emmc_boot1,
+            .user_uu = PART_emmc_user,
+            .rpmb_uu = PART_emmc_rpmb,
+            .flags = 0,
+        },
+    };
+
+    rc = mmc_ram_init(&emmc_cfg);
+
+    if (rc != PB_OK)
+        return rc;
+
+    bio_dev_t user = bio_get_part_by_uu(PART_emmc_user);
+
+    if (user < 0)
+        return user;
+
+    return bio_clear_set_flags(user, 0, BIO_FLAG_READABLE);
+}
+#endif
+
 int board_init(void)
 {
     int rc;
     LOG_INFO("Board init");
 
-    bio_dev_t disk = virtio_block_init(0x0A003C00, PART_virtio_disk);
+#ifdef CONFIG_BOOT_WARM_CACHE
+    board_warm = (board_warm_magic == BOARD_WARM_MAGIC);
+    board_warm_magic = 0;
+#endif
+
+    bio_dev_t disk = virtio_block_init(0x0A003C00, QEMU_VIRTIO_IRQ(0x0A003C00), PART_virtio_disk);
 
     if (disk < 0)
         return disk;
 
+#ifdef CONFIG_MMC_RAM
+    rc = board_emmc_init();
+
+    if (rc != PB_OK)
+        return rc;
+#endif
+
     rc = mbedtls_pb_init();
 
     if (rc != PB_OK)
         return rc;
 
+#ifdef CONFIG_DRIVERS_CRYPTO_ED25519
+    rc = ed25519_pb_init();
+
+    if (rc != PB_OK)
+        return rc;
+#endif
+
+#ifdef CONFIG_DRIVERS_CRYPTO_BLAKE3
+    rc = blake3_pb_init();
+
+    if (rc != PB_OK)
+        return rc;
+#endif
+
     rc = gpt_ptbl_init(disk, gpt_tables, ARRAY_SIZE(gpt_tables));
 
     if (rc != PB_OK) {
@@ -283,9 +464,13 @@ int board_init(void)
         .get_boot_bio_device = boot_ab_state_get,
         .set_boot_partition = boot_ab_state_set_boot_partition,
         .get_boot_partition = boot_ab_state_get_boot_partition,
-        .prepare = boot_driver_linux_prepare,
+        .skip_part = board_skip_part,
+        .prepare = board_prepare,
         .late_boot_cb = late_boot,
         .jump = boot_driver_linux_jump,
+#ifdef CONFIG_BOOT_WARM_CACHE
+        .warm_reset = board_warm_reset,
+#endif
     };
 
     rc = boot_init(&boot_driver);
@@ -371,6 +556,37 @@ err_out:
     return rc;
 }
 
+#ifdef CONFIG_IMAGE_LZ4
+IMPORT_SYM(uintptr_t, _code_start, code_start);
+IMPORT_SYM(uintptr_t, _ro_data_region_end, ro_data_end);
+
+/* Reads 'length' bytes from the start of the virtio disk, the boot media
+ * of this board, and returns the time it took in us. */
+static unsigned int board_time_read(size_t length)
+{
+    static uint8_t buf[SZ_KiB(64)] __aligned(64);
+    bio_dev_t dev = bio_get_part_by_uu(PART_virtio_disk);
+    unsigned int t_start = plat_get_us_tick();
+    size_t bytes_to_read = (length + 511) & ~511;
+    lba_t lba = 0;
+
+    if (dev < 0)
+        return 0;
+
+    while (bytes_to_read > 0) {
+        size_t chunk = MIN(bytes_to_read, sizeof(buf));
+
+        if (bio_read(dev, lba, chunk, buf) != PB_OK)
+            return 0;
+
+        lba += chunk / 512;
+        bytes_to_read -= chunk;
+    }
+
+    return plat_get_us_tick() - t_start;
+}
+#endif
+
 static int board_command(uint32_t command,
                          uint8_t *bfr,
                          size_t size,
@@ -394,6 +610,49 @@ static int board_command(uint32_t command,
     } else if (command == 0xdfa7c4ad) {
         (*response_size) = snprintf(response, resp_buf_size, "Should return error code -128\n");
         return -128;
+#ifdef CONFIG_MMC_RAM
+    } else if (command == 0x76cb03be) { /* mmc-stats */
+        const struct mmc_ram_stats *s = mmc_ram_stats();
+
+        (*response_size) = snprintf(response,
+                                    resp_buf_size,
+                                    "CMD13 %u\nCMD17 %u\nCMD18 %u\nCMD23 %u\nCMD24 %u\nCMD25 %u\n"
+                                    "busy %u\nread %llu\nwritten %llu\n",
+                                    s->cmds[MMC_CMD_SEND_STATUS],
+                                    s->cmds[MMC_CMD_READ_SINGLE_BLOCK],
+                                    s->cmds[MMC_CMD_READ_MULTIPLE_BLOCK],
+                                    s->cmds[MMC_CMD_SET_BLOCK_COUNT],
+                                    s->cmds[MMC_CMD_WRITE_SINGLE_BLOCK],
+                                    s->cmds[MMC_CMD_WRITE_MULTIPLE_BLOCK],
+                                    s->busy_waits,
+                                    s->read_bytes,
+                                    s->write_bytes);
+        return PB_OK;
+#endif
+#ifdef CONFIG_IMAGE_LZ4
+    } else if (command == 0xf1bcf8f6) { /* lz4-stats */
+        size_t image_size = ro_data_end - code_start;
+        size_t compressed_size = pb_stub_handoff.compressed_size;
+
+        if (pb_stub_handoff.magic != PB_STUB_HANDOFF_MAGIC || pb_stub_handoff.tick_freq == 0) {
+            (*response_size) = snprintf(response, resp_buf_size, "Not started by the stub\n");
+            return -PB_ERR;
+        }
+
+        /* The time to load the compressed and the raw image from the boot
+         * media, next to the decompression time of the stub. */
+        (*response_size) = snprintf(
+            response,
+            resp_buf_size,
+            "unpack %u us\nload compressed %u us\nload raw %u us\nsize %zu -> %zu\n",
+            (unsigned int)(((uint64_t)pb_stub_handoff.ticks * 1000000) /
+                           pb_stub_handoff.tick_freq),
+            board_time_read(compressed_size),
+            board_time_read(image_size),
+            compressed_size,
+            image_size);
+        return PB_OK;
+#endif
     } else {
         LOG_ERR("Unknown command %x", command);
         (*response_size) = 0;
@@ -415,7 +674,7 @@ int cm_board_init(void)
 {
     int rc;
 
-    rc = virtio_serial_init(0x0A003E00);
+    rc = virtio_serial_init(0x0A003E00, QEMU_VIRTIO_IRQ(0x0A003E00));
 
     if (rc != PB_OK) {
         LOG_ERR("Virtio serial failed (%i)", rc);
@@ -434,6 +693,7 @@ int cm_board_init(void)
             .read = virtio_serial_async_read,
             .write = virtio_serial_async_write,
             .complete = virtio_serial_async_complete,
+            .event = virtio_serial_event,
         },
     };
 
@@ -34,4 +34,21 @@
 #define UUID_ff4ddc6c_ad7a_47e8_8773_6729392dd1b5 \
     (const unsigned char *)"\xff\x4d\xdc\x6c\xad\x7a\x47\xe8\x87\x73\x67\x29\x39\x2d\xd1\xb5"
 #define PART_readable UUID_ff4ddc6c_ad7a_47e8_8773_6729392dd1b5
+
+/* RAM backed eMMC */
+#define UUID_0008e1b5_0019_4e10_b312_69d10352e588 \
+    (const unsigned char *)"\x00\x08\xe1\xb5\x00\x19\x4e\x10\xb3\x12\x69\xd1\x03\x52\xe5\x88"
+#define PART_emmc_boot0 UUID_0008e1b5_0019_4e10_b312_69d10352e588
+
+#define UUID_7236ae60_357c_4b24_84f0_a0fd9cb1d7ef \
+    (const unsigned char *)"\x72\x36\xae\x60\x35\x7c\x4b\x24\x84\xf0\xa0\xfd\x9c\xb1\xd7\xef"
+#define PART_emmc_boot1 UUID_7236ae60_357c_4b24_84f0_a0fd9cb1d7ef
+
+#define UUID_0a2624d6_09bc_4633_b94f_58fef9365648 \
+    (const unsigned char *)"\x0a\x26\x24\xd6\x09\xbc\x46\x33\xb9\x4f\x58\xfe\xf9\x36\x56\x48"
+#define PART_emmc_user UUID_0a2624d6_09bc_4633_b94f_58fef9365648
+
+#define UUID_a1ce9e37_f69a_4467_8fe0_052dc7247095 \
+    (const unsigned char *)"\xa1\xce\x9e\x37\xf6\x9a\x44\x67\x8f\xe0\x05\x2d\xc7\x24\x70\x95"
+#define PART_emmc_rpmb UUID_a1ce9e37_f69a_4467_8fe0_052dc7247095
 #endif
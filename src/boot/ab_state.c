@@ -18,23 +18,30 @@
 #include <uuid.h>
 
 static bio_dev_t primary_part, backup_part;
-static struct pb_boot_state boot_state, boot_state_backup;
+static struct pb_boot_state boot_state, boot_state_backup, record;
+static struct pb_boot_state committed; /* State as of the last commit */
 static const struct boot_ab_state_config *cfg;
+static unsigned int journal_slots; /* Number of journal blocks after the snapshot */
+static unsigned int journal_next; /* Next free journal slot */
+
+static uint32_t state_crc(struct pb_boot_state *state)
+{
+    state->crc = 0;
+    return crc32(0, (const uint8_t *)state, sizeof(struct pb_boot_state));
+}
 
 static int validate(struct pb_boot_state *state)
 {
     uint32_t crc = state->crc;
     int err = PB_OK;
 
-    state->crc = 0;
-
     if (state->magic != PB_STATE_MAGIC) {
         LOG_ERR("Incorrect magic");
         err = -PB_ERR;
         goto config_err_out;
     }
 
-    if (crc != crc32(0, (uint8_t *)state, sizeof(struct pb_boot_state))) {
+    if (crc != state_crc(state)) {
         LOG_ERR("CRC failed");
         err = -PB_ERR;
         goto config_err_out;
@@ -44,6 +51,31 @@ config_err_out:
     return err;
 }
 
+static bool journal_record_valid(struct pb_boot_state *rec)
+{
+    uint32_t crc = rec->crc;
+
+    return (rec->magic == PB_STATE_JOURNAL_MAGIC) &&
+           (rec->generation == boot_state.generation) && (crc == state_crc(rec));
+}
+
+/* Applies the journal records on top of the snapshot in 'boot_state' */
+static void journal_replay(void)
+{
+    for (journal_next = 0; journal_next < journal_slots; journal_next++) {
+        if (bio_read(primary_part, 1 + journal_next, sizeof(record), &record) != PB_OK)
+            break;
+
+        if (!journal_record_valid(&record))
+            break;
+
+        memcpy(&boot_state, &record, sizeof(struct pb_boot_state));
+        boot_state.magic = PB_STATE_MAGIC;
+    }
+
+    LOG_DBG("Replayed %u journal records", journal_next);
+}
+
 static int pb_boot_state_defaults(struct pb_boot_state *state)
 {
     memset(state, 0, sizeof(struct pb_boot_state));
@@ -51,30 +83,81 @@ static int pb_boot_state_defaults(struct pb_boot_state *state)
     return PB_OK;
 }
 
-static int pb_boot_state_commit(void)
+/* Writes a new snapshot, which also empties the journal. The backup is
+ * written first so that one of the partitions always has the latest state
+ * if the writes are interrupted. */
+static int pb_boot_state_write_snapshot(void)
 {
     int rc;
 
-    boot_state.crc = 0;
-    uint32_t crc = crc32(0, (const uint8_t *)&boot_state, sizeof(struct pb_boot_state));
-    boot_state.crc = crc;
+    boot_state.magic = PB_STATE_MAGIC;
+    boot_state.generation++;
+    boot_state.crc = state_crc(&boot_state);
 
-    rc = bio_write(primary_part, 0, sizeof(struct pb_boot_state), &boot_state);
+    rc = bio_write(backup_part, 0, sizeof(struct pb_boot_state), &boot_state);
     if (rc != PB_OK)
         goto config_commit_err;
 
-    rc = bio_write(backup_part, 0, sizeof(struct pb_boot_state), &boot_state);
+    rc = bio_write(primary_part, 0, sizeof(struct pb_boot_state), &boot_state);
 
 config_commit_err:
     if (rc != PB_OK) {
         LOG_ERR("Could not write boot state");
     } else {
         LOG_INFO("Boot state written");
+        journal_next = 0;
     }
 
     return rc;
 }
 
+/* Only a change of the boot attempt counter is appended to the journal.
+ * Anything else, like enabling a system or a rollback, is written as a new
+ * snapshot so that the backup partition never has an older selection. */
+static bool journal_commit_allowed(void)
+{
+    if (journal_next >= journal_slots)
+        return false;
+
+    memcpy(&record, &boot_state, sizeof(struct pb_boot_state));
+    record.magic = committed.magic;
+    record.remaining_boot_attempts = committed.remaining_boot_attempts;
+    record.generation = committed.generation;
+    record.crc = committed.crc;
+
+    return (memcmp(&record, &committed, sizeof(struct pb_boot_state)) == 0);
+}
+
+static int pb_boot_state_commit(void)
+{
+    int rc;
+
+    if (!journal_commit_allowed()) {
+        rc = pb_boot_state_write_snapshot();
+
+        if (rc == PB_OK)
+            memcpy(&committed, &boot_state, sizeof(struct pb_boot_state));
+
+        return rc;
+    }
+
+    memcpy(&record, &boot_state, sizeof(struct pb_boot_state));
+    record.magic = PB_STATE_JOURNAL_MAGIC;
+    record.crc = state_crc(&record);
+
+    rc = bio_write(primary_part, 1 + journal_next, sizeof(record), &record);
+
+    if (rc != PB_OK) {
+        LOG_ERR("Could not write boot state");
+        return rc;
+    }
+
+    journal_next++;
+    memcpy(&committed, &boot_state, sizeof(struct pb_boot_state));
+    LOG_INFO("Boot state written (%u/%u)", journal_next, journal_slots);
+    return PB_OK;
+}
+
 int boot_ab_state_init(const struct boot_ab_state_config *state_cfg)
 {
     int rc;
@@ -102,6 +185,14 @@ int boot_ab_state_init(const struct boot_ab_state_config *state_cfg)
 
     if (primary_part < 0) {
         LOG_ERR("Primary boot state partition not found");
+    } else {
+        /* Blocks after the snapshot are used for the journal */
+        int64_t no_of_blocks = bio_get_no_of_blocks(primary_part);
+
+        if (no_of_blocks > (PB_STATE_JOURNAL_MAX_RECORDS + 1))
+            journal_slots = PB_STATE_JOURNAL_MAX_RECORDS;
+        else if (no_of_blocks > 1)
+            journal_slots = no_of_blocks - 1;
     }
 
     backup_part = bio_get_part_by_uu(cfg->backup_state_part_uu);
@@ -116,6 +207,7 @@ int boot_ab_state_init(const struct boot_ab_state_config *state_cfg)
 
     if (rc == PB_OK) {
         primary_state_ok = true;
+        journal_replay();
     } else {
         LOG_ERR("Primary boot state data corrupt");
         primary_state_ok = false;
@@ -135,21 +227,27 @@ int boot_ab_state_init(const struct boot_ab_state_config *state_cfg)
     if (!primary_state_ok && !backup_state_ok) {
         LOG_ERR("No valid state found, installing default");
         pb_boot_state_defaults(&boot_state);
-        pb_boot_state_defaults(&boot_state_backup);
-        rc = pb_boot_state_commit();
+        rc = pb_boot_state_write_snapshot();
     } else if (!backup_state_ok && primary_state_ok) {
+        /* The journal on the primary stays valid, only the backup is written */
         LOG_ERR("Backup state corrupt, repairing");
-        pb_boot_state_defaults(&boot_state_backup);
-        rc = pb_boot_state_commit();
+        boot_state.crc = state_crc(&boot_state);
+        rc = bio_write(backup_part, 0, sizeof(struct pb_boot_state), &boot_state);
     } else if (backup_state_ok && !primary_state_ok) {
         LOG_ERR("Primary state corrupt, reparing");
         memcpy(&boot_state, &boot_state_backup, sizeof(struct pb_boot_state));
-        rc = pb_boot_state_commit();
+        rc = pb_boot_state_write_snapshot();
+    } else if ((int32_t)(boot_state_backup.generation - boot_state.generation) > 0) {
+        /* The last snapshot only reached the backup partition */
+        LOG_ERR("Primary state is older than backup, repairing");
+        memcpy(&boot_state, &boot_state_backup, sizeof(struct pb_boot_state));
+        rc = pb_boot_state_write_snapshot();
     } else {
         LOG_INFO("Boot state loaded");
         rc = PB_OK;
     }
 
+    memcpy(&committed, &boot_state, sizeof(struct pb_boot_state));
     return rc;
 }
 
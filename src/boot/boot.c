@@ -9,15 +9,25 @@
 
 #include <boot/boot.h>
 #include <boot/image_helpers.h>
+#include <bpak/id.h>
 #include <inttypes.h>
+#include <pb/arena.h>
 #include <pb/bio.h>
+#include <pb/crypto.h>
+#include <pb/irq.h>
 #include <pb/pb.h>
+#include <pb/smp.h>
 #include <pb/timestamp.h>
 #include <string.h>
 
 static const struct boot_driver *boot_cfg;
-static struct bpak_header header __section(".no_init") __aligned(4096);
-static struct bpak_header *header_ptr = &header;
+#ifdef CONFIG_ARENA
+static struct bpak_header *header;
+#else
+static struct bpak_header header_buf __section(".no_init") __aligned(4096);
+static struct bpak_header *header = &header_buf;
+#endif
+static struct bpak_header *header_ptr;
 static uint32_t boot_flags;
 static bio_dev_t boot_device;
 static enum boot_source boot_source;
@@ -25,6 +35,22 @@ static uuid_t boot_part_uu;
 static uint8_t payload_digest[64];
 static boot_read_cb_t read_cb;
 static boot_result_cb_t result_cb;
+#ifdef CONFIG_BOOT_WARM_CACHE
+#define BOOT_WARM_MAGIC 0x5741524d /* 'WARM' */
+
+struct boot_warm_record {
+    uint32_t magic;
+    uuid_t part_uu; /* Partition that the image was loaded from */
+    uint8_t header_digest[32]; /* SHA256 of the authenticated header */
+};
+
+static struct boot_warm_record warm_record __section(".no_init") __aligned(64);
+static struct boot_warm_record warm_prev; /* Copy of the record from the last boot */
+static bool warm_prev_valid;
+static uint32_t warm_verified_parts; /* Bit n is set if part n was verified in memory */
+static bool warm_hit;
+static bool warm_taken;
+#endif
 
 int boot_init(const struct boot_driver *cfg)
 {
@@ -34,6 +60,16 @@ int boot_init(const struct boot_driver *cfg)
     if (cfg->jump == NULL)
         return -PB_ERR_PARAM;
 
+#ifdef CONFIG_ARENA
+    if (header == NULL) {
+        header = arena_alloc_aligned(ARENA_BOOT, sizeof(*header), 4096);
+
+        if (header == NULL)
+            return -PB_ERR_MEM;
+    }
+#endif
+
+    header_ptr = header;
     boot_cfg = cfg;
     boot_device = -1;
     boot_source = cfg->default_boot_source;
@@ -88,16 +124,195 @@ void boot_get_boot_partition(uuid_t part_uu)
     boot_cfg->get_boot_partition(part_uu);
 }
 
-static int boot_bio_read(int block_offset, size_t length, void *buf)
+static int boot_bio_read(lba_t block_offset, size_t length, void *buf)
 {
     return bio_read(boot_device, block_offset, length, buf);
 }
 
-static int load_auth_verify_from_bio(void)
+/* Parts that are not loaded from the boot device: parts that the board
+ * skips, and parts that were verified in memory after a warm reset. Only
+ * used for images with per-part digests. */
+static bool boot_load_skip(struct bpak_header *hdr, bpak_id_t part_id)
 {
-    int rc;
-    lba_t header_lba;
+#ifdef CONFIG_BOOT_WARM_CACHE
+    unsigned int i = 0;
+
+    bpak_foreach_part(hdr, p) {
+        if (!p->id)
+            break;
+
+        if (p->id == part_id && (warm_verified_parts & BIT(i)))
+            return true;
+
+        i++;
+    }
+#endif
+    return boot_cfg->skip_part && boot_cfg->skip_part(hdr, part_id);
+}
+
+#ifdef CONFIG_BOOT_LOAD_READV
+/* Parts can only be skipped when each part has its own signed digest */
+static bool boot_skip_part(bpak_id_t part_id)
+{
+    return boot_image_has_part_digests(header) && boot_load_skip(header, part_id);
+}
+#endif
+
+#ifdef CONFIG_BOOT_LOAD_READV
+/* Loads all parts of the payload with one scatter-gather read. Returns
+ * -PB_ERR_NOT_SUPPORTED if the parts are not block aligned on the device
+ * or if a part should be skipped. */
+static int boot_bio_readv(void)
+{
+    struct bio_segment segs[BPAK_MAX_PARTS];
+    struct bpak_meta_header *mh;
+    unsigned int no_of_segs = 0;
+    lba_t lba = 0;
+
+    bpak_foreach_part(header, p) {
+        if (!p->id)
+            break;
+
+        if (boot_skip_part(p->id))
+            return -PB_ERR_NOT_SUPPORTED;
+
+        if (bpak_get_meta(header, BPAK_ID_PB_LOAD_ADDR, p->id, &mh) != BPAK_OK)
+            return -PB_ERR_BAD_META;
+
+        size_t length = bpak_part_size(p);
+
+        if (length == 0)
+            continue;
+
+        if (no_of_segs > 0 && (segs[no_of_segs - 1].length % 512))
+            return -PB_ERR_NOT_SUPPORTED;
+
+        segs[no_of_segs].buf = (void *)(uintptr_t)*bpak_get_meta_ptr(header, mh, uint64_t);
+        segs[no_of_segs].length = length;
+        no_of_segs++;
+    }
+
+    if (no_of_segs == 0)
+        return PB_OK;
+
+    LOG_DBG("Loading %u parts with one read", no_of_segs);
+
+    return bio_readv(boot_device, lba, segs, no_of_segs);
+}
+#endif
+
+#ifdef CONFIG_BOOT_WARM_CACHE
+static int boot_warm_header_digest(uint8_t *digest)
+{
+    int rc = hash_init(HASH_SHA256);
+
+    if (rc == PB_OK)
+        rc = hash_update(header, sizeof(*header));
+    if (rc == PB_OK)
+        rc = hash_final(digest, 32);
+
+    return rc;
+}
+
+/* Takes the record of the last boot out of '.no_init', this is done once
+ * by the first boot attempt. The record is invalidated
+ * before anything is loaded, it is only written again when an image has
+ * been loaded and verified. */
+static void boot_warm_take(void)
+{
+    warm_verified_parts = 0;
+    warm_hit = false;
+
+    if (warm_taken)
+        return;
+
+    warm_taken = true;
+    memcpy(&warm_prev, &warm_record, sizeof(warm_prev));
+    memset(&warm_record, 0, sizeof(warm_record));
+    warm_prev_valid = false;
+
+    if (warm_prev.magic != BOOT_WARM_MAGIC)
+        return;
+
+    if (boot_cfg->warm_reset == NULL || !boot_cfg->warm_reset())
+        return;
+
+    warm_prev_valid = true;
+}
+
+/* Returns true if the authenticated header was loaded from the same
+ * partition on the last boot, the payload it describes is then probably
+ * still in memory. Only images with per-part digests qualify, boot drivers
+ * patch parts in memory, for example the device tree, so a hash over the
+ * complete payload would never match. */
+static bool boot_warm_hit(void)
+{
+    uint8_t digest[32];
+
+    if (!warm_prev_valid)
+        return false;
+
+    if (!boot_image_has_part_digests(header))
+        return false;
+
+    if (uuid_compare(warm_prev.part_uu, boot_part_uu) != 0)
+        return false;
+
+    if (boot_warm_header_digest(digest) != PB_OK)
+        return false;
 
+    return (memcmp(digest, warm_prev.header_digest, sizeof(digest)) == 0);
+}
+
+/* Verifies the payload that is still in memory against the authenticated
+ * header. Every part is checked on its own and the parts that match are
+ * not loaded again. */
+static int boot_warm_verify(void)
+{
+    unsigned int i = 0;
+    bool all_verified = true;
+
+    bpak_foreach_part(header, p) {
+        if (!p->id)
+            break;
+
+        if (boot_cfg->skip_part && boot_cfg->skip_part(header, p->id)) {
+            i++;
+            continue;
+        }
+
+        if (boot_image_verify_part(header, p->id) == PB_OK)
+            warm_verified_parts |= BIT(i);
+        else
+            all_verified = false;
+
+        i++;
+    }
+
+    return all_verified ? PB_OK : -PB_ERR_BAD_PAYLOAD;
+}
+
+static void boot_warm_store(void)
+{
+    warm_prev_valid = false;
+    memset(&warm_prev, 0, sizeof(warm_prev));
+    warm_prev.magic = BOOT_WARM_MAGIC;
+    uuid_copy(warm_prev.part_uu, boot_part_uu);
+
+    if (boot_warm_header_digest(warm_prev.header_digest) != PB_OK)
+        return;
+
+    memcpy(&warm_record, &warm_prev, sizeof(warm_record));
+}
+
+bool boot_warm_cache_hit(void)
+{
+    return warm_hit;
+}
+#endif
+
+static int boot_resolve_bio_device(void)
+{
     if (boot_cfg->get_boot_bio_device == NULL)
         return -PB_ERR_NOT_SUPPORTED;
 
@@ -124,36 +339,95 @@ static int load_auth_verify_from_bio(void)
         return -PB_ERR_PART_NOT_BOOTABLE;
     }
 
+    return PB_OK;
+}
+
+static int boot_load_auth_header_from_bio(void)
+{
+    int rc;
+    lba_t header_lba;
+
     /* Load header located at the end of the partition */
     header_lba = bio_get_no_of_blocks(boot_device) -
                  (sizeof(struct bpak_header) / bio_block_size(boot_device));
 
-    rc = bio_read(boot_device, header_lba, sizeof(struct bpak_header), &header);
+    rc = bio_read(boot_device, header_lba, sizeof(struct bpak_header), header);
 
     if (rc != PB_OK)
         return rc;
 
-    rc = boot_image_auth_header(&header);
+    rc = boot_image_auth_header(header);
+
+    if (rc != PB_OK)
+        return rc;
+
+    return boot_image_verify_parts(header);
+}
+
+static int load_auth_verify_from_bio(void)
+{
+    int rc;
+
+    rc = boot_resolve_bio_device();
 
     if (rc != PB_OK)
         return rc;
 
-    rc = boot_image_verify_parts(&header);
+    rc = boot_load_auth_header_from_bio();
 
     if (rc != PB_OK)
         return rc;
 
-    rc = boot_image_load_and_hash(&header,
+#ifdef CONFIG_BOOT_WARM_CACHE
+    /* Loading is skipped for what is still in memory, verifying is not */
+    if (boot_warm_hit()) {
+        rc = boot_warm_verify();
+        warm_hit = (rc == PB_OK) || (warm_verified_parts != 0);
+
+        if (rc == PB_OK) {
+            LOG_INFO("Warm reset, payload verified in memory");
+            return PB_OK;
+        }
+
+        LOG_INFO("Warm reset, payload modified, loading it again");
+    }
+#endif
+
+#ifdef CONFIG_BOOT_LOAD_READV
+    rc = boot_bio_readv();
+
+    if (rc == PB_OK) {
+        /* Everything is loaded, only hash the parts in place */
+        rc = boot_image_load_and_hash(header,
+                                      CONFIG_BOOT_LOAD_CHUNK_kB * 1024,
+                                      NULL,
+                                      NULL,
+                                      boot_load_skip,
+                                      payload_digest,
+                                      sizeof(payload_digest));
+    } else if (rc == -PB_ERR_NOT_SUPPORTED) {
+        rc = boot_image_load_and_hash(header,
+                                      CONFIG_BOOT_LOAD_CHUNK_kB * 1024,
+                                      boot_bio_read,
+                                      NULL, /* No result function */
+                                      boot_load_skip,
+                                      payload_digest,
+                                      sizeof(payload_digest));
+    }
+#else
+    rc = boot_image_load_and_hash(header,
                                   CONFIG_BOOT_LOAD_CHUNK_kB * 1024,
                                   boot_bio_read,
                                   NULL, /* No result function */
+                                  boot_load_skip,
                                   payload_digest,
                                   sizeof(payload_digest));
+#endif
 
     if (rc != PB_OK)
         return rc;
 
-    return boot_image_verify_payload(&header, payload_digest);
+    return boot_image_verify_payload(header, payload_digest);
 }
 
 static int auth_verify_in_mem(void)
@@ -182,6 +456,7 @@ static int auth_verify_in_mem(void)
                                   CONFIG_BOOT_LOAD_CHUNK_kB * 1024,
                                   NULL,
                                   NULL,
+                                  boot_cfg->skip_part,
                                   payload_digest,
                                   sizeof(payload_digest));
 
@@ -198,11 +473,11 @@ static int load_auth_verify_from_cb(void)
     if (read_cb == NULL)
         return -PB_ERR_NOT_SUPPORTED;
 
-    rc = read_cb(-(int)sizeof(struct bpak_header) / 512, sizeof(struct bpak_header), &header);
+    rc = read_cb(-(int)sizeof(struct bpak_header) / 512, sizeof(struct bpak_header), header);
     if (rc != PB_OK)
         return rc;
 
-    rc = boot_image_auth_header(&header);
+    rc = boot_image_auth_header(header);
 
     if (rc != PB_OK) {
         if (result_cb) {
@@ -212,7 +487,7 @@ static int load_auth_verify_from_cb(void)
         return rc;
     }
 
-    rc = boot_image_verify_parts(&header);
+    rc = boot_image_verify_parts(header);
 
     if (result_cb) {
         result_cb(rc);
@@ -221,17 +496,18 @@ static int load_auth_verify_from_cb(void)
     if (rc != PB_OK)
         return rc;
 
-    rc = boot_image_load_and_hash(&header,
+    rc = boot_image_load_and_hash(header,
                                   CONFIG_BOOT_LOAD_CHUNK_kB * 1024,
                                   read_cb,
                                   result_cb,
+                                  NULL, /* The host streams every part */
                                   payload_digest,
                                   sizeof(payload_digest));
 
     if (rc != PB_OK)
         return rc;
 
-    rc = boot_image_verify_payload(&header, payload_digest);
+    rc = boot_image_verify_payload(header, payload_digest);
 
     if (result_cb) {
         result_cb(rc);
@@ -270,6 +546,10 @@ int boot_load(uuid_t boot_part_override_uu)
         uuid_copy(boot_part_uu, boot_part_override_uu);
     }
 
+#ifdef CONFIG_BOOT_WARM_CACHE
+    boot_warm_take();
+#endif
+
     ts("Boot load");
     switch (boot_source) {
     case BOOT_SOURCE_BIO:
@@ -308,6 +588,11 @@ int boot_load(uuid_t boot_part_override_uu)
         }
     }
 
+#ifdef CONFIG_BOOT_WARM_CACHE
+    if (boot_source == BOOT_SOURCE_BIO)
+        boot_warm_store();
+#endif
+
 err_out:
     boot_flags = 0;
     return rc;
@@ -325,6 +610,14 @@ int boot_jump(void)
         }
     }
 
+#ifdef CONFIG_SMP
+    /* A core that is still running could modify the loaded image */
+    rc = smp_park();
+
+    if (rc != PB_OK)
+        return rc;
+#endif
+    irq_shutdown();
     ts("Boot jump");
     boot_cfg->jump();
     return -PB_ERR;
@@ -11,6 +11,7 @@
 #include <bpak/id.h>
 #include <bpak/keystore.h>
 #include <inttypes.h>
+#include <pb/arena.h>
 #include <pb/crypto.h>
 #include <pb/pb.h>
 #include <pb/plat.h>
@@ -67,6 +68,14 @@ int boot_image_auth_header(struct bpak_header *hdr)
         return rc;
     }
 
+    /* An Ed25519 signature is raw and an ECDSA signature is DER encoded,
+     * the header must state the same scheme as the key. */
+    if ((dsa_kind == DSA_ED25519) != (hdr->signature_kind == BPAK_SIGN_ED25519)) {
+        LOG_ERR("Signature kind %s does not match the key",
+                bpak_signature_kind(hdr->signature_kind));
+        return -PB_ERR_SIGNATURE;
+    }
+
     switch (hdr->hash_kind) {
     case BPAK_HASH_SHA256:
         hash_kind = HASH_SHA256;
@@ -81,7 +90,7 @@ int boot_image_auth_header(struct bpak_header *hdr)
         return -PB_ERR_UNKNOWN_HASH;
     }
 
-    rc = hash_init(hash_kind);
+    rc = hash_init_length(hash_kind, sizeof(*hdr));
 
     if (rc != PB_OK)
         return rc;
@@ -178,22 +187,158 @@ int boot_image_verify_parts(struct bpak_header *hdr)
             LOG_ERR("Part 0x%x overlapping with no_init segment", p->id);
             break;
         }
+
+#ifdef CONFIG_ARENA
+        if (arena_overlaps(load_addr, bytes_to_read)) {
+            rc = -PB_ERR_MEM;
+            LOG_ERR("Part 0x%x overlapping with buffer arena", p->id);
+            break;
+        }
+#endif
     }
 
     return rc;
 }
 
+static int image_hash_kind(const struct bpak_header *hdr, hash_t *hash_kind, size_t *hash_length)
+{
+    switch (hdr->hash_kind) {
+    case BPAK_HASH_SHA256:
+        *hash_kind = HASH_SHA256;
+        *hash_length = 32;
+        break;
+    case BPAK_HASH_SHA384:
+        *hash_kind = HASH_SHA384;
+        *hash_length = 48;
+        break;
+    case BPAK_HASH_SHA512:
+        *hash_kind = HASH_SHA512;
+        *hash_length = 64;
+        break;
+    default:
+        return -PB_ERR_UNKNOWN_HASH;
+    }
+
+    return PB_OK;
+}
+
+/* Returns the signed digest of a part or NULL if there is none */
+static const uint8_t *image_part_digest(struct bpak_header *hdr,
+                                        bpak_id_t part_id,
+                                        size_t hash_length)
+{
+    struct bpak_meta_header *mh;
+
+    if (bpak_get_meta(hdr, BPAK_ID_PB_PART_DIGEST, part_id, &mh) != BPAK_OK)
+        return NULL;
+
+    if (mh->size != hash_length)
+        return NULL;
+
+    return bpak_get_meta_ptr(hdr, mh, uint8_t);
+}
+
+/* Finalizes the hash of one part and compares it with the signed digest */
+static int image_part_digest_check(struct bpak_header *hdr, bpak_id_t part_id, size_t hash_length)
+{
+    int rc;
+    uint8_t digest[64];
+    const uint8_t *expected = image_part_digest(hdr, part_id, hash_length);
+
+    if (expected == NULL)
+        return -PB_ERR_BAD_META;
+
+    rc = hash_final(digest, sizeof(digest));
+
+    if (rc != PB_OK)
+        return rc;
+
+    if (memcmp(digest, expected, hash_length) != 0) {
+        LOG_ERR("Part %x: digest mismatch", part_id);
+        return -PB_ERR_BAD_PAYLOAD;
+    }
+
+    return PB_OK;
+}
+
+bool boot_image_has_part_digests(struct bpak_header *hdr)
+{
+    hash_t hash_kind;
+    size_t hash_length;
+    unsigned int no_of_parts = 0;
+
+    if (bpak_valid_header(hdr) != BPAK_OK)
+        return false;
+
+    if (image_hash_kind(hdr, &hash_kind, &hash_length) != PB_OK)
+        return false;
+
+    bpak_foreach_part(hdr, p) {
+        if (!p->id)
+            break;
+
+        if (image_part_digest(hdr, p->id, hash_length) == NULL)
+            return false;
+
+        no_of_parts++;
+    }
+
+    return (no_of_parts > 0);
+}
+
+int boot_image_verify_part(struct bpak_header *hdr, bpak_id_t part_id)
+{
+    int rc;
+    hash_t hash_kind;
+    size_t hash_length;
+    struct bpak_part_header *part;
+    struct bpak_meta_header *mh;
+
+    rc = bpak_valid_header(hdr);
+
+    if (rc != BPAK_OK) {
+        return -PB_ERR_BAD_HEADER;
+    }
+
+    rc = image_hash_kind(hdr, &hash_kind, &hash_length);
+
+    if (rc != PB_OK)
+        return rc;
+
+    if (bpak_get_part(hdr, part_id, &part) != BPAK_OK)
+        return -PB_ERR_NOT_FOUND;
+
+    if (bpak_get_meta(hdr, BPAK_ID_PB_LOAD_ADDR, part_id, &mh) != BPAK_OK)
+        return -PB_ERR_BAD_META;
+
+    uintptr_t load_addr = (uintptr_t)*bpak_get_meta_ptr(hdr, mh, uint64_t);
+
+    rc = hash_init(hash_kind);
+
+    if (rc != PB_OK)
+        return rc;
+
+    rc = hash_update((void *)load_addr, bpak_part_size(part));
+
+    if (rc != PB_OK)
+        return rc;
+
+    return image_part_digest_check(hdr, part_id, hash_length);
+}
+
 int boot_image_load_and_hash(struct bpak_header *hdr,
                              size_t load_chunk_size,
                              boot_read_cb_t read_f,
                              boot_result_cb_t result_f,
+                             boot_skip_cb_t skip_f,
                              uint8_t *payload_digest,
                              size_t payload_digest_size)
 {
     int rc;
     uintptr_t load_addr;
-    int hash_kind;
+    hash_t hash_kind;
     size_t hash_length;
+    bool per_part;
     struct bpak_meta_header *mh;
 
     rc = bpak_valid_header(hdr);
@@ -202,35 +347,34 @@ int boot_image_load_and_hash(struct bpak_header *hdr,
         return -PB_ERR_BAD_HEADER;
     }
 
-    switch (hdr->hash_kind) {
-    case BPAK_HASH_SHA256:
-        hash_kind = HASH_SHA256;
-        hash_length = 32;
-        break;
-    case BPAK_HASH_SHA384:
-        hash_kind = HASH_SHA384;
-        hash_length = 48;
-        break;
-    case BPAK_HASH_SHA512:
-        hash_kind = HASH_SHA512;
-        hash_length = 64;
-        break;
-    default:
-        return -PB_ERR_UNKNOWN_HASH;
-    }
+    rc = image_hash_kind(hdr, &hash_kind, &hash_length);
+
+    if (rc != PB_OK)
+        return rc;
 
     if (payload_digest_size < hash_length)
         return -PB_ERR_PARAM;
 
-    rc = hash_init(hash_kind);
+    /* With per-part digests every part is verified as soon as it has been
+     * loaded, otherwise all parts are hashed into one payload digest. */
+    per_part = boot_image_has_part_digests(hdr);
 
-    if (rc != PB_OK)
-        return rc;
+    if (!per_part) {
+        rc = hash_init(hash_kind);
+
+        if (rc != PB_OK)
+            return rc;
+    }
 
     bpak_foreach_part(hdr, p) {
         if (!p->id)
             break;
 
+        if (per_part && skip_f && skip_f(hdr, p->id)) {
+            LOG_DBG("Skipping part %x", p->id);
+            continue;
+        }
+
         load_addr = 0;
         rc = bpak_get_meta(hdr, BPAK_ID_PB_LOAD_ADDR, p->id, &mh);
 
@@ -248,13 +392,16 @@ int boot_image_load_and_hash(struct bpak_header *hdr,
         size_t chunk_size = 0;
         size_t offset = 0;
 
-        while (bytes_to_read) {
+        if (per_part)
+            rc = hash_init(hash_kind);
+
+        while (rc == PB_OK && bytes_to_read) {
             chunk_size = (bytes_to_read > load_chunk_size) ? load_chunk_size : bytes_to_read;
 
             uintptr_t addr = load_addr + offset;
 
             if (read_f) {
-                size_t read_lba =
+                lba_t read_lba =
                     (offset + bpak_part_offset(hdr, p) - sizeof(struct bpak_header)) / 512;
 
                 rc = read_f(read_lba, chunk_size, (void *)addr);
@@ -275,17 +422,32 @@ int boot_image_load_and_hash(struct bpak_header *hdr,
             offset += chunk_size;
         }
 
+        if (per_part && rc == PB_OK)
+            rc = image_part_digest_check(hdr, p->id, hash_length);
+
         if (result_f) {
-            rc = result_f(rc);
+            /* A failed part must not be masked by a successful report */
+            int report_rc = result_f(rc);
+
+            if (rc == PB_OK)
+                rc = report_rc;
         }
 
         if (rc != PB_OK)
             return rc;
     }
 
-    if (rc == PB_OK)
-        return hash_final(payload_digest, payload_digest_size);
-    return rc;
+    if (rc != PB_OK)
+        return rc;
+
+    if (per_part) {
+        /* The part digests are covered by the header signature, so every
+         * loaded part is now as trusted as the signed payload hash. */
+        memcpy(payload_digest, hdr->payload_hash, hash_length);
+        return PB_OK;
+    }
+
+    return hash_final(payload_digest, payload_digest_size);
 }
 
 int boot_image_copy_and_hash(struct bpak_header *hdr,
@@ -7,11 +7,13 @@
  *
  */
 
+#include "cm_task.h"
 #include <boot/boot.h>
 #include <bpak/bpak.h>
 #include <bpak/keystore.h>
 #include <inttypes.h>
 #include <pb-tools/wire.h>
+#include <pb/arena.h>
 #include <pb/bio.h>
 #include <pb/cm.h>
 #include <pb/crypto.h>
@@ -21,20 +23,78 @@
 #include <pb/plat.h>
 #include <pb/rot.h>
 #include <pb/slc.h>
+#include <pb/smp.h>
 #include <stdio.h>
 #include <string.h>
 #include <uuid.h>
 
+/* Each partition read fills one buffer with digest chunks. With SMP the
+ * chunks are sized so that every core gets at least one per read. */
+#ifdef CONFIG_SMP
+#define CM_PART_DIGEST_CHUNK_SIZE ((CONFIG_CM_BUF_SIZE_KiB * 1024 / CONFIG_SMP_MAX_CPUS) & ~511)
+#if CM_PART_DIGEST_CHUNK_SIZE < 512
+#error "CM_BUF_SIZE_KiB is too small for one digest chunk per core"
+#endif
+#else
+#define CM_PART_DIGEST_CHUNK_SIZE (CONFIG_CM_BUF_SIZE_KiB * 1024)
+#endif
+
 static struct pb_command cmd __section(".no_init") __aligned(64);
 static struct pb_result result __section(".no_init") __aligned(64);
 static bool authenticated = false;
+#ifdef CONFIG_ARENA
+static uint8_t *buffer[CONFIG_CM_MAX_BUFFERS];
+static uint8_t no_of_buffers;
+#else
 static uint8_t buffer[2][CONFIG_CM_BUF_SIZE_KiB * 1024] __section(".no_init") __aligned(4096);
+static const uint8_t no_of_buffers = 2;
+#endif
 static slc_t slc;
 static uint8_t hash[CRYPTO_MD_MAX_SZ];
 static uuid_t device_uu;
 static bio_dev_t block_dev;
 static bool reboot_requested = false;
 static const struct cm_config *cfg;
+static struct {
+    bool valid;
+    uint8_t buffer_id;
+    lba_t lba;
+    size_t size;
+} read_ahead;
+
+#ifdef CONFIG_CM_TASKS
+/* Background write of a stream buffer */
+static struct {
+    struct cm_task task;
+    bio_dev_t dev;
+    lba_t lba;
+    const uint8_t *buf;
+    size_t length;
+    uint8_t buffer_id;
+} commit;
+
+static int commit_step(struct cm_task *task)
+{
+    size_t step = commit.length;
+    int rc;
+
+    (void)task;
+
+    if (step > (CONFIG_CM_COMMIT_STEP_KiB * 1024))
+        step = CONFIG_CM_COMMIT_STEP_KiB * 1024;
+
+    rc = bio_write(commit.dev, commit.lba, step, commit.buf);
+
+    if (rc != PB_OK)
+        return rc;
+
+    commit.buf += step;
+    commit.lba += step / bio_block_size(commit.dev);
+    commit.length -= step;
+
+    return (commit.length > 0) ? -PB_ERR_AGAIN : PB_OK;
+}
+#endif
 
 #ifdef CONFIG_CM_AUTH_TOKEN
 static int auth_token(uint32_t key_id, uint8_t *sig, size_t size)
@@ -67,13 +127,14 @@ static int auth_token(uint32_t key_id, uint8_t *sig, size_t size)
         hash_kind = HASH_SHA384;
         break;
     case DSA_EC_SECP521r1:
+    case DSA_ED25519:
         hash_kind = HASH_SHA512;
         break;
     default:
         return -PB_ERR_NOT_SUPPORTED;
     }
 
-    rc = hash_init(hash_kind);
+    rc = hash_init_length(hash_kind, 36);
 
     if (rc != PB_OK)
         return rc;
@@ -157,6 +218,27 @@ void cm_board_cmd_request_reboot_on_success(void)
     reboot_requested = true;
 }
 
+static void cm_transport_wait(void)
+{
+#ifdef CONFIG_CM_TASKS
+    /* Use the time for background work, re-check the transport after each step */
+    if (cm_task_run())
+        return;
+#endif
+    if (cfg->tops.event != NULL)
+        pb_event_wait(cfg->tops.event());
+}
+
+static int cm_transport_complete(void)
+{
+    int rc;
+
+    while ((rc = cfg->tops.complete()) == -PB_ERR_AGAIN)
+        cm_transport_wait();
+
+    return rc;
+}
+
 static int cm_write(const void *buf, size_t length)
 {
     int rc;
@@ -166,9 +248,7 @@ static int cm_write(const void *buf, size_t length)
     if (rc != PB_OK)
         return rc;
 
-    do {
-        rc = cfg->tops.complete();
-    } while (rc == -PB_ERR_AGAIN);
+    rc = cm_transport_complete();
 
     return rc;
 }
@@ -182,9 +262,7 @@ static int cm_read(void *buf, size_t length)
     if (rc != PB_OK)
         return rc;
 
-    do {
-        rc = cfg->tops.complete();
-    } while (rc == -PB_ERR_AGAIN);
+    rc = cm_transport_complete();
 
     return rc;
 }
@@ -254,16 +332,16 @@ static int cmd_bpak_read(void)
     lba_t header_lba =
         bio_get_no_of_blocks(dev) - (sizeof(struct bpak_header) / bio_block_size(dev));
 
-    LOG_DBG("Reading bpak header at lba %i", header_lba);
+    LOG_DBG("Reading bpak header at lba %" PRIu64, header_lba);
 
-    rc = bio_read(dev, header_lba, sizeof(struct bpak_header), &buffer);
+    rc = bio_read(dev, header_lba, sizeof(struct bpak_header), buffer[0]);
 
     if (rc != PB_OK) {
         pb_wire_init_result(&result, error_to_wire(rc));
         return rc;
     }
 
-    rc = bpak_valid_header((struct bpak_header *)buffer);
+    rc = bpak_valid_header((struct bpak_header *)buffer[0]);
 
     if (rc != BPAK_OK) {
         LOG_ERR("Invalid bpak header");
@@ -274,7 +352,7 @@ static int cmd_bpak_read(void)
     pb_wire_init_result(&result, error_to_wire(rc));
     cm_write(&result, sizeof(result));
 
-    rc = cm_write(buffer, sizeof(struct bpak_header));
+    rc = cm_write(buffer[0], sizeof(struct bpak_header));
 
     pb_wire_init_result(&result, error_to_wire(rc));
     return rc;
@@ -326,11 +404,31 @@ static int cmd_auth(void)
     return rc;
 }
 
+static bool chunk_is_zero(const void *buf, size_t length)
+{
+    const uint32_t *p = buf;
+    const uint8_t *tail;
+
+    for (; length >= sizeof(uint32_t); length -= sizeof(uint32_t)) {
+        if (*p++ != 0)
+            return false;
+    }
+
+    for (tail = (const uint8_t *)p; length > 0; length--) {
+        if (*tail++ != 0)
+            return false;
+    }
+
+    return true;
+}
+
 static int cmd_stream_read(void)
 {
     int rc = -PB_ERR;
     struct pb_command_stream_read_buffer *stream_read =
         (struct pb_command_stream_read_buffer *)cmd.request;
+    struct pb_result_stream_read_buffer read_result = { 0 };
+    size_t block_size = bio_block_size(block_dev);
 
     LOG_DBG(
         "Stream read %u, %llu, %i", stream_read->buffer_id, stream_read->offset, stream_read->size);
@@ -341,23 +439,74 @@ static int cmd_stream_read(void)
         return -PB_ERR_IO;
     }
 
-    size_t start_lba = (stream_read->offset / bio_block_size(block_dev));
+    if ((stream_read->buffer_id >= no_of_buffers) ||
+        (stream_read->size > (CONFIG_CM_BUF_SIZE_KiB * 1024)) ||
+        (stream_read->read_ahead_size > (CONFIG_CM_BUF_SIZE_KiB * 1024))) {
+        pb_wire_init_result(&result, -PB_RESULT_NO_MEMORY);
+        return -PB_ERR_MEM;
+    }
+
+    lba_t start_lba = (stream_read->offset / block_size);
 
-    LOG_DBG("Reading %u bytes at lba offset %zu", stream_read->size, start_lba);
+    LOG_DBG("Reading %u bytes at lba offset %" PRIu64, stream_read->size, start_lba);
 
-    uintptr_t bfr =
-        ((uintptr_t)buffer) + ((CONFIG_CM_BUF_SIZE_KiB * 1024) * stream_read->buffer_id);
+    uint8_t *bfr = buffer[stream_read->buffer_id];
 
-    rc = bio_read(block_dev, start_lba, stream_read->size, (void *)bfr);
-    pb_wire_init_result(&result, error_to_wire(rc));
+    if (read_ahead.valid && read_ahead.buffer_id == stream_read->buffer_id &&
+        read_ahead.lba == start_lba && read_ahead.size == stream_read->size) {
+        rc = PB_OK;
+    } else {
+        rc = bio_read(block_dev, start_lba, stream_read->size, bfr);
+    }
+
+    read_ahead.valid = false;
+
+    if (rc == PB_OK && stream_read->flags != 0) {
+        read_result.size = stream_read->size;
+
+        if ((stream_read->flags & PB_STREAM_READ_FLAG_ELIDE_ZERO) &&
+            chunk_is_zero(bfr, stream_read->size)) {
+            read_result.zero = 1;
+            read_result.size = 0;
+        }
+    }
+
+    pb_wire_init_result2(&result, error_to_wire(rc), &read_result, sizeof(read_result));
     LOG_DBG("Result = %i", rc);
 
     cm_write(&result, sizeof(result));
 
-    if (rc == PB_OK) {
-        rc = cm_write((const void *)bfr, stream_read->size);
-        pb_wire_init_result(&result, error_to_wire(rc));
+    if (rc != PB_OK)
+        return rc;
+
+    if (read_result.zero == 0) {
+        rc = cfg->tops.write(bfr, stream_read->size);
+
+        if (rc != PB_OK)
+            goto err_out;
+    }
+
+    /* Fill the next buffer while the current chunk is being transferred */
+    if ((stream_read->flags & PB_STREAM_READ_FLAG_READ_AHEAD) &&
+        (stream_read->read_ahead_size > 0)) {
+        lba_t next_lba = start_lba + (stream_read->size / block_size);
+        uint8_t next_buffer_id = (stream_read->buffer_id + 1) % no_of_buffers;
+
+        if (bio_read(block_dev, next_lba, stream_read->read_ahead_size, buffer[next_buffer_id]) ==
+            PB_OK) {
+            read_ahead.buffer_id = next_buffer_id;
+            read_ahead.lba = next_lba;
+            read_ahead.size = stream_read->read_ahead_size;
+            read_ahead.valid = true;
+        }
     }
+
+    if (read_result.zero == 0) {
+        rc = cm_transport_complete();
+    }
+
+err_out:
+    pb_wire_init_result(&result, error_to_wire(rc));
     LOG_DBG("Data sent");
     return rc;
 }
@@ -380,30 +529,108 @@ static int cmd_stream_write(void)
         return rc;
     }
 
-    size_t start_lba = (stream_write->offset / bio_block_size(block_dev));
+    if ((stream_write->buffer_id >= no_of_buffers) ||
+        (stream_write->size > (CONFIG_CM_BUF_SIZE_KiB * 1024))) {
+        pb_wire_init_result(&result, -PB_RESULT_NO_MEMORY);
+        return -PB_ERR_MEM;
+    }
+
+    lba_t start_lba = (stream_write->offset / bio_block_size(block_dev));
+
+    LOG_DBG("Writing %u bytes to lba offset %" PRIu64, stream_write->size, start_lba);
 
-    LOG_DBG("Writing %u bytes to lba offset %zu", stream_write->size, start_lba);
+    uintptr_t bfr = (uintptr_t)buffer[stream_write->buffer_id];
 
-    uintptr_t bfr =
-        ((uintptr_t)buffer) + ((CONFIG_CM_BUF_SIZE_KiB * 1024) * stream_write->buffer_id);
+#ifdef CONFIG_CM_TASKS
+    /* One commit in flight, the result of the previous one is reported here */
+    rc = cm_task_wait(&commit.task);
 
+    if (rc == PB_OK) {
+        commit.task.name = "commit";
+        commit.task.step = commit_step;
+        commit.dev = block_dev;
+        commit.lba = start_lba;
+        commit.buf = (const uint8_t *)bfr;
+        commit.length = stream_write->size;
+        commit.buffer_id = stream_write->buffer_id;
+
+        rc = cm_task_start(&commit.task);
+    }
+#else
     rc = bio_write(block_dev, start_lba, stream_write->size, (void *)bfr);
+#endif
 
     pb_wire_init_result(&result, error_to_wire(rc));
     return rc;
 }
 
+/* Hash algorithm and digest size for each enum pb_digest_alg */
+static const struct {
+    hash_t alg;
+    size_t size;
+} verify_digests[] = {
+    [PB_DIGEST_SHA256] = { HASH_SHA256, 32 },
+    [PB_DIGEST_SHA512] = { HASH_SHA512, 64 },
+    [PB_DIGEST_BLAKE3] = { HASH_BLAKE3, 32 },
+};
+
+static uint8_t verify_digest_algs(void)
+{
+    uint8_t algs = 0;
+
+    for (unsigned int i = 0; i < ARRAY_SIZE(verify_digests); i++) {
+        if (hash_fastest(verify_digests[i].alg) != 0)
+            algs |= (1 << i);
+    }
+
+    return algs;
+}
+
+static uint8_t verify_digest_preferred(void)
+{
+    hash_t candidates = 0;
+    hash_t fastest;
+
+    for (unsigned int i = 0; i < ARRAY_SIZE(verify_digests); i++)
+        candidates |= verify_digests[i].alg;
+
+    fastest = hash_fastest(candidates);
+
+    for (unsigned int i = 0; i < ARRAY_SIZE(verify_digests); i++) {
+        if (verify_digests[i].alg == fastest)
+            return i;
+    }
+
+    return PB_DIGEST_SHA256;
+}
+
 static int cmd_part_verify(void)
 {
     int rc;
     int buffer_id = 0;
     size_t chunk_len;
     struct pb_command_verify_part *verify_cmd = (struct pb_command_verify_part *)cmd.request;
-    size_t bytes_to_verify = verify_cmd->size;
-    int lba_offset = 0;
+    uint64_t verify_size = verify_cmd->size64 ? verify_cmd->size64 : verify_cmd->size;
+    uint64_t bytes_to_verify = verify_size;
+    lba_t lba_offset = 0;
+    const uint8_t *expected;
+    size_t digest_size;
 
     LOG_DBG("Verify part");
 
+    if (verify_cmd->digest_alg >= ARRAY_SIZE(verify_digests)) {
+        LOG_ERR("Unknown digest %u", verify_cmd->digest_alg);
+        pb_wire_init_result(&result, -PB_RESULT_NOT_SUPPORTED);
+        return -PB_ERR_NOT_SUPPORTED;
+    }
+
+    digest_size = verify_digests[verify_cmd->digest_alg].size;
+
+    if (verify_cmd->digest_alg == PB_DIGEST_SHA256)
+        expected = verify_cmd->sha256;
+    else
+        expected = verify_cmd->digest;
+
     block_dev = bio_get_part_by_uu(verify_cmd->uuid);
 
     if (block_dev < 0) {
@@ -412,7 +639,13 @@ static int cmd_part_verify(void)
         return block_dev;
     }
 
-    rc = hash_init(HASH_SHA256);
+    if (verify_size > (uint64_t)bio_size(block_dev) ||
+        (verify_cmd->bpak && verify_size < sizeof(struct bpak_header))) {
+        pb_wire_init_result(&result, -PB_RESULT_INVALID_ARGUMENT);
+        return -PB_ERR_PARAM;
+    }
+
+    rc = hash_init_length(verify_digests[verify_cmd->digest_alg].alg, verify_size);
 
     if (rc != PB_OK) {
         pb_wire_init_result(&result, error_to_wire(rc));
@@ -442,7 +675,7 @@ static int cmd_part_verify(void)
         bytes_to_verify -= sizeof(struct bpak_header);
     }
 
-    LOG_DBG("Reading %zu bytes", bytes_to_verify);
+    LOG_DBG("Reading %llu bytes", (unsigned long long)bytes_to_verify);
 
     while (bytes_to_verify) {
         chunk_len = bytes_to_verify > (CONFIG_CM_BUF_SIZE_KiB * 1024)
@@ -481,14 +714,14 @@ static int cmd_part_verify(void)
         return rc;
     }
 
-    if (memcmp(hash, verify_cmd->sha256, 32) == 0) {
+    if (memcmp(hash, expected, digest_size) == 0) {
         rc = PB_OK;
         pb_wire_init_result(&result, error_to_wire(rc));
     } else {
 #if LOGLEVEL > 2
         printf("Expected hash:");
-        for (int i = 0; i < 32; i++)
-            printf("%x", verify_cmd->sha256[i] & 0xff);
+        for (size_t i = 0; i < digest_size; i++)
+            printf("%x", expected[i] & 0xff);
         printf("\n\r");
 #endif
         LOG_ERR("Verification failed");
@@ -499,15 +732,252 @@ static int cmd_part_verify(void)
     return rc;
 }
 
+#ifdef CONFIG_SMP
+static struct part_digest_work {
+    struct smp_work work;
+    const uint8_t *buf;
+    size_t length;
+    uint8_t *digest;
+    int rc;
+} part_digest_work[CONFIG_SMP_WORK_QUEUE_SIZE];
+
+static void part_digest_work_fn(void *arg)
+{
+    struct part_digest_work *w = (struct part_digest_work *)arg;
+
+    w->rc = hash_digest(HASH_SHA256, w->buf, w->length, w->digest, PB_WIRE_PART_DIGEST_SIZE);
+}
+
+static int part_digest_chunks_smp(const uint8_t *buf,
+                                  size_t length,
+                                  size_t chunk_size,
+                                  uint8_t *digest_out)
+{
+    int rc = PB_OK;
+
+    while (length > 0) {
+        size_t no_of_work = 0;
+
+        for (; (no_of_work < CONFIG_SMP_WORK_QUEUE_SIZE) && (length > 0); no_of_work++) {
+            struct part_digest_work *w = &part_digest_work[no_of_work];
+
+            w->buf = buf;
+            w->length = length > chunk_size ? chunk_size : length;
+            w->digest = digest_out;
+            w->work.fn = part_digest_work_fn;
+            w->work.arg = w;
+            smp_queue(&w->work);
+
+            buf += w->length;
+            length -= w->length;
+            digest_out += PB_WIRE_PART_DIGEST_SIZE;
+        }
+
+        for (size_t i = 0; i < no_of_work; i++) {
+            smp_wait(&part_digest_work[i].work);
+
+            if (part_digest_work[i].rc != PB_OK)
+                rc = part_digest_work[i].rc;
+        }
+
+        if (rc != PB_OK)
+            break;
+    }
+
+    return rc;
+}
+#endif
+
+static int part_digest_chunks(const uint8_t *buf,
+                              size_t length,
+                              size_t chunk_size,
+                              uint8_t *digest_out)
+{
+    int rc = PB_OK;
+
+#ifdef CONFIG_SMP
+    /* Chunks are independent, spread them over all cores if the hash
+     * provider has a re-entrant one-shot digest */
+    if (hash_has_digest(HASH_SHA256, chunk_size))
+        return part_digest_chunks_smp(buf, length, chunk_size, digest_out);
+#endif
+
+    while (length > 0) {
+        size_t chunk_len = length > chunk_size ? chunk_size : length;
+
+        rc = hash_init(HASH_SHA256);
+
+        if (rc != PB_OK)
+            break;
+
+        rc = hash_update(buf, chunk_len);
+
+        if (rc != PB_OK)
+            break;
+
+        rc = hash_final(digest_out, PB_WIRE_PART_DIGEST_SIZE);
+
+        if (rc != PB_OK)
+            break;
+
+        buf += chunk_len;
+        length -= chunk_len;
+        digest_out += PB_WIRE_PART_DIGEST_SIZE;
+    }
+
+    return rc;
+}
+
+static int cmd_part_read_digests(void)
+{
+    int rc = PB_OK;
+    struct pb_command_part_read_digests *digest_cmd =
+        (struct pb_command_part_read_digests *)cmd.request;
+    struct pb_result_part_read_digests digest_result = { 0 };
+    uint64_t bytes_to_digest = digest_cmd->size64 ? digest_cmd->size64 : digest_cmd->size;
+    size_t chunk_size = digest_cmd->chunk_size;
+    uint64_t no_of_chunks;
+    size_t chunks_per_read;
+    lba_t lba;
+    uint8_t *digest_out = buffer[0];
+
+    LOG_DBG("Read digests %llu, %llu, %u",
+            (unsigned long long)digest_cmd->offset,
+            (unsigned long long)bytes_to_digest,
+            digest_cmd->chunk_size);
+
+    bio_dev_t dev = bio_get_part_by_uu(digest_cmd->uuid);
+
+    if (dev < 0) {
+        LOG_ERR("Could not find partition");
+        pb_wire_init_result(&result, error_to_wire(dev));
+        return dev;
+    }
+
+    /* Digests reveal the contents, so they follow the same rule as reads */
+    if (!(bio_get_flags(dev) & BIO_FLAG_READABLE)) {
+        LOG_ERR("Partition may not be read");
+        pb_wire_init_result(&result, -PB_RESULT_IO_ERROR);
+        return -PB_ERR_IO;
+    }
+
+    if (chunk_size == 0 || chunk_size > (CONFIG_CM_BUF_SIZE_KiB * 1024) ||
+        (chunk_size % bio_block_size(dev)) != 0 ||
+        (digest_cmd->offset % bio_block_size(dev)) != 0) {
+        pb_wire_init_result(&result, -PB_RESULT_INVALID_ARGUMENT);
+        return -PB_ERR_PARAM;
+    }
+
+    no_of_chunks = (bytes_to_digest + chunk_size - 1) / chunk_size;
+
+    if ((no_of_chunks * PB_WIRE_PART_DIGEST_SIZE) > (CONFIG_CM_BUF_SIZE_KiB * 1024)) {
+        pb_wire_init_result(&result, -PB_RESULT_NO_MEMORY);
+        return -PB_ERR_MEM;
+    }
+
+    lba = digest_cmd->offset / bio_block_size(dev);
+
+    /* Read as many chunks as fit in the buffer with each request */
+    chunks_per_read = (CONFIG_CM_BUF_SIZE_KiB * 1024) / chunk_size;
+
+    for (size_t n = 0; n < no_of_chunks; n += chunks_per_read) {
+        size_t read_len = chunks_per_read * chunk_size;
+
+        if (read_len > bytes_to_digest)
+            read_len = (size_t)bytes_to_digest;
+
+        rc = bio_read(dev, lba, read_len, buffer[1]);
+
+        if (rc != PB_OK)
+            break;
+
+        rc = part_digest_chunks(
+            buffer[1], read_len, chunk_size, &digest_out[n * PB_WIRE_PART_DIGEST_SIZE]);
+
+        if (rc != PB_OK)
+            break;
+
+        bytes_to_digest -= read_len;
+        lba += read_len / bio_block_size(dev);
+    }
+
+    if (rc != PB_OK) {
+        pb_wire_init_result(&result, error_to_wire(rc));
+        return rc;
+    }
+
+    digest_result.size = no_of_chunks * PB_WIRE_PART_DIGEST_SIZE;
+    pb_wire_init_result2(&result, PB_RESULT_OK, &digest_result, sizeof(digest_result));
+    cm_write(&result, sizeof(result));
+
+    rc = cm_write(digest_out, digest_result.size);
+
+    pb_wire_init_result(&result, error_to_wire(rc));
+    return rc;
+}
+
+static int cmd_crypto_providers_read(void)
+{
+    int rc;
+    struct pb_result_crypto_providers providers_result = { 0 };
+    struct pb_crypto_provider *entries = (struct pb_crypto_provider *)buffer[0];
+    size_t max_entries = (CONFIG_CM_BUF_SIZE_KiB * 1024) / sizeof(*entries);
+    struct crypto_provider_info info;
+    size_t n = 0;
+
+    while (crypto_get_provider_info(n, &info) == PB_OK) {
+        struct pb_crypto_provider *entry;
+
+        if (n >= max_entries) {
+            pb_wire_init_result(&result, -PB_RESULT_NO_MEMORY);
+            return -PB_ERR_MEM;
+        }
+
+        entry = &entries[n];
+
+        memset(entry, 0, sizeof(*entry));
+        strncpy(entry->name, info.name, sizeof(entry->name) - 1);
+        strncpy(entry->alg, info.alg_name, sizeof(entry->alg) - 1);
+        entry->priority = info.priority;
+        entry->setup_ns = info.setup_ns;
+        entry->ns_per_kib = info.ns_per_kib;
+
+        if (info.dsa)
+            entry->flags |= PB_CRYPTO_PROVIDER_DSA;
+        if (info.selected_small)
+            entry->flags |= PB_CRYPTO_PROVIDER_SMALL;
+        if (info.selected_large)
+            entry->flags |= PB_CRYPTO_PROVIDER_LARGE;
+        if (info.calibrated)
+            entry->flags |= PB_CRYPTO_PROVIDER_CALIBRATED;
+        n++;
+    }
+
+    providers_result.size = n * sizeof(*entries);
+    pb_wire_init_result2(&result, PB_RESULT_OK, &providers_result, sizeof(providers_result));
+    cm_write(&result, sizeof(result));
+
+    rc = cm_write(entries, providers_result.size);
+
+    pb_wire_init_result(&result, error_to_wire(rc));
+    return rc;
+}
+
 static int cmd_part_erase(struct pb_command_erase_part *erase_cmd)
 {
-    LOG_DBG("Erase: lba=%" PRIu32 " count=%" PRIu32, erase_cmd->start_lba, erase_cmd->block_count);
+    lba_t start_lba = ((lba_t)erase_cmd->start_lba_hi << 32) | erase_cmd->start_lba;
+    uint64_t block_count = ((uint64_t)erase_cmd->block_count_hi << 32) | erase_cmd->block_count;
+
+    LOG_DBG("Erase: lba=%" PRIu64 " count=%" PRIu64, start_lba, block_count);
     bio_dev_t dev = bio_get_part_by_uu(erase_cmd->uuid);
 
     if (dev < 0)
         return dev;
 
-    return bio_erase(dev, erase_cmd->start_lba, erase_cmd->block_count);
+    if (block_count > SIZE_MAX)
+        return -PB_ERR_PARAM;
+
+    return bio_erase(dev, start_lba, block_count);
 }
 
 static int cmd_part_tbl_read(void)
@@ -515,7 +985,7 @@ static int cmd_part_tbl_read(void)
     LOG_DBG("TBL read");
     struct pb_result_part_table_read tbl_read_result = { 0 };
 
-    struct pb_result_part_table_entry *result_tbl = (struct pb_result_part_table_entry *)buffer;
+    struct pb_result_part_table_entry *result_tbl = (struct pb_result_part_table_entry *)buffer[0];
 
     int entries = 0;
 
@@ -549,7 +1019,7 @@ static int cmd_part_tbl_read(void)
     return PB_RESULT_OK;
 }
 
-static int bpak_boot_read_f(int block_offset, size_t length, void *buf)
+static int bpak_boot_read_f(lba_t block_offset, size_t length, void *buf)
 {
     (void)block_offset;
     return cm_read(buf, length);
@@ -656,15 +1126,27 @@ static int cmd_stream_prep_buffer(void)
         return -PB_ERR_MEM;
     }
 
-    if (stream_prep->id > 1) {
+    if (stream_prep->id >= no_of_buffers) {
         pb_wire_init_result(&result, -PB_RESULT_NO_MEMORY);
         return -PB_ERR_MEM;
     }
 
+#ifdef CONFIG_CM_TASKS
+    /* Receiving into another buffer can overlap the commit */
+    if (!commit.task.busy || (commit.buffer_id == stream_prep->id)) {
+        int rc = cm_task_wait(&commit.task);
+
+        if (rc != PB_OK) {
+            pb_wire_init_result(&result, error_to_wire(rc));
+            return rc;
+        }
+    }
+#endif
+
     pb_wire_init_result(&result, PB_RESULT_OK);
     cm_write(&result, sizeof(result));
 
-    uint8_t *bfr = ((uint8_t *)buffer) + ((CONFIG_CM_BUF_SIZE_KiB * 1024) * stream_prep->id);
+    uint8_t *bfr = buffer[stream_prep->id];
 
     return cm_read(bfr, stream_prep->size);
 }
@@ -695,6 +1177,22 @@ static int pb_command_parse(void)
 
     pb_wire_init_result(&result, -PB_RESULT_NOT_SUPPORTED);
 
+    /* Any other command may reuse the stream buffers or modify the partition */
+    if (cmd.command != PB_CMD_STREAM_READ_BUFFER)
+        read_ahead.valid = false;
+
+#ifdef CONFIG_CM_TASKS
+    if ((cmd.command != PB_CMD_STREAM_PREPARE_BUFFER) &&
+        (cmd.command != PB_CMD_STREAM_WRITE_BUFFER)) {
+        rc = cm_task_wait(&commit.task);
+
+        if (rc != PB_OK) {
+            pb_wire_init_result(&result, error_to_wire(rc));
+            goto err_out;
+        }
+    }
+#endif
+
     switch (cmd.command) {
     case PB_CMD_BOOTLOADER_VERSION_READ: {
         char version_string[30];
@@ -716,9 +1214,13 @@ static int pb_command_parse(void)
     case PB_CMD_DEVICE_READ_CAPS: {
         LOG_INFO("Read caps");
         struct pb_result_device_caps caps = { 0 };
-        caps.stream_no_of_buffers = 2;
+        caps.stream_no_of_buffers = no_of_buffers;
         caps.stream_buffer_size = CONFIG_CM_BUF_SIZE_KiB * 1024;
         caps.chunk_transfer_max_bytes = CONFIG_CM_BUF_SIZE_KiB * 1024;
+        caps.part_digest_chunk_size = CM_PART_DIGEST_CHUNK_SIZE;
+        caps.stream_read_flags = PB_STREAM_READ_FLAG_ELIDE_ZERO | PB_STREAM_READ_FLAG_READ_AHEAD;
+        caps.verify_digest_algs = verify_digest_algs();
+        caps.verify_digest_preferred = verify_digest_preferred();
 
         pb_wire_init_result2(&result, PB_RESULT_OK, &caps, sizeof(caps));
     } break;
@@ -754,6 +1256,12 @@ static int pb_command_parse(void)
     case PB_CMD_PART_VERIFY:
         rc = cmd_part_verify();
         break;
+    case PB_CMD_PART_READ_DIGESTS:
+        rc = cmd_part_read_digests();
+        break;
+    case PB_CMD_CRYPTO_PROVIDERS_READ:
+        rc = cmd_crypto_providers_read();
+        break;
     case PB_CMD_BOOT_PART: {
         struct pb_command_boot_part *boot_cmd = (struct pb_command_boot_part *)cmd.request;
 
@@ -776,7 +1284,7 @@ static int pb_command_parse(void)
     } break;
     case PB_CMD_DEVICE_IDENTIFIER_READ: {
         LOG_INFO("Read identifier");
-        struct pb_result_device_identifier *ident = (struct pb_result_device_identifier *)buffer;
+        struct pb_result_device_identifier *ident = (struct pb_result_device_identifier *)buffer[0];
         memset(ident->board_id, 0, sizeof(ident->board_id));
         memcpy(ident->board_id, cfg->name, strlen(cfg->name));
         memcpy(ident->device_uuid, device_uu, 16);
@@ -884,6 +1392,32 @@ int cm_init(const struct cm_config *cfg_)
     return PB_OK;
 }
 
+#ifdef CONFIG_ARENA
+/* Allocates as many stream buffers as fit in the command mode budget */
+static int cm_alloc_buffers(void)
+{
+    const size_t size = CONFIG_CM_BUF_SIZE_KiB * 1024;
+
+    while ((no_of_buffers < CONFIG_CM_MAX_BUFFERS) && (arena_available(ARENA_CM) >= size)) {
+        buffer[no_of_buffers] = arena_alloc_aligned(ARENA_CM, size, 4096);
+
+        if (buffer[no_of_buffers] == NULL)
+            break;
+
+        no_of_buffers++;
+    }
+
+    if (no_of_buffers < 2) {
+        LOG_ERR("Two stream buffers don't fit in the arena");
+        return -PB_ERR_MEM;
+    }
+
+    LOG_INFO("%u stream buffers of %u KiB", no_of_buffers, CONFIG_CM_BUF_SIZE_KiB);
+    arena_print_usage();
+    return PB_OK;
+}
+#endif
+
 int cm_run(void)
 {
     int rc;
@@ -896,6 +1430,13 @@ int cm_run(void)
         return rc;
     }
 
+#ifdef CONFIG_ARENA
+    rc = cm_alloc_buffers();
+
+    if (rc != PB_OK)
+        return rc;
+#endif
+
 #ifdef CONFIG_CM_AUTH
     authenticated = false;
 #else
@@ -965,6 +1506,7 @@ restart_command_mode:
             } else if (rc == -PB_ERR_TIMEOUT) {
                 continue;
             } else if (rc == -PB_ERR_AGAIN) {
+                cm_transport_wait();
                 continue;
             } else {
                 LOG_ERR("Read error %i", rc);
@@ -0,0 +1,83 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include "cm_task.h"
+#include <pb/pb.h>
+
+#define CM_TASK_MAX 4
+
+static struct cm_task *tasks[CM_TASK_MAX];
+
+int cm_task_start(struct cm_task *task)
+{
+    struct cm_task **slot = NULL;
+
+    if (task->busy)
+        return -PB_ERR_STATE;
+
+    for (unsigned int i = 0; i < CM_TASK_MAX; i++) {
+        if (tasks[i] == task) {
+            slot = &tasks[i];
+            break;
+        }
+
+        if ((slot == NULL) && (tasks[i] == NULL))
+            slot = &tasks[i];
+    }
+
+    if (slot == NULL)
+        return -PB_ERR_MEM;
+
+    *slot = task;
+    task->rc = PB_OK;
+    task->busy = true;
+
+    return PB_OK;
+}
+
+bool cm_task_run(void)
+{
+    bool stepped = false;
+
+    for (unsigned int i = 0; i < CM_TASK_MAX; i++) {
+        struct cm_task *task = tasks[i];
+        int rc;
+
+        if ((task == NULL) || !task->busy)
+            continue;
+
+        rc = task->step(task);
+        stepped = true;
+
+        if (rc == -PB_ERR_AGAIN)
+            continue;
+
+        if (rc != PB_OK)
+            LOG_ERR("Task '%s' failed (%i)", task->name, rc);
+
+        task->rc = rc;
+        task->busy = false;
+        tasks[i] = NULL;
+    }
+
+    return stepped;
+}
+
+int cm_task_wait(struct cm_task *task)
+{
+    int rc;
+
+    while (task->busy)
+        cm_task_run();
+
+    rc = task->rc;
+    task->rc = PB_OK;
+
+    return rc;
+}
@@ -0,0 +1,55 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Cooperative tasks for command mode. A task is a state machine that does a
+ * bounded amount of work each time its 'step' function is called. Tasks are
+ * stepped while command mode waits for the transport, so for example storage
+ * writes make progress while the next buffer is being received.
+ *
+ */
+
+#ifndef SRC_CM_CM_TASK_H
+#define SRC_CM_CM_TASK_H
+
+#include <stdbool.h>
+
+struct cm_task {
+    const char *name;
+    /* Do one step of work. Return -PB_ERR_AGAIN to be called again,
+     * PB_OK when done or a negative error code */
+    int (*step)(struct cm_task *task);
+    int rc; /* Result of the last run, cleared by 'cm_task_wait' */
+    bool busy;
+};
+
+/**
+ * Start a task. The task must not be busy.
+ *
+ * @param[in] task Task to start
+ *
+ * @return PB_OK on success, -PB_ERR_STATE if the task is busy or -PB_ERR_MEM
+ *         if too many tasks are in use
+ */
+int cm_task_start(struct cm_task *task);
+
+/**
+ * Step all busy tasks once
+ *
+ * @return true if at least one task was stepped
+ */
+bool cm_task_run(void);
+
+/**
+ * Step tasks until 'task' is done
+ *
+ * @param[in] task Task to wait for
+ *
+ * @return The result of the task, PB_OK if the task was never started
+ */
+int cm_task_wait(struct cm_task *task);
+
+#endif // SRC_CM_CM_TASK_H
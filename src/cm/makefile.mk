@@ -1 +1,2 @@
 src-$(CONFIG_CM) += src/cm/cm_main.c
+src-$(CONFIG_CM_TASKS) += src/cm/cm_task.c
@@ -10,6 +10,7 @@
 #include <inttypes.h>
 #include <pb/crypto.h>
 #include <pb/pb.h>
+#include <pb/plat.h>
 #include <pb/self_test.h>
 #include <string.h>
 
@@ -19,18 +20,139 @@ static const struct hash_ops *hash_ops[CONFIG_CRYPTO_MAX_HASH_OPS];
 static size_t no_of_hash_ops;
 static const struct hash_ops *current_hash_ops; /* Currently active context */
 
-int hash_init(hash_t alg)
+#define HASH_NO_OF_ALGS 6
+#define DSA_NO_OF_ALGS  4
+
+static const char *hash_alg_names[HASH_NO_OF_ALGS] = {
+    "md5", "md5-broken", "sha256", "sha384", "sha512", "blake3",
+};
+
+static const char *dsa_alg_names[DSA_NO_OF_ALGS] = {
+    "secp256r1", "secp384r1", "secp521r1", "ed25519",
+};
+
+#ifdef CONFIG_CRYPTO_CALIBRATE
+struct hash_cost {
+    bool valid;
+    uint32_t setup_ns;
+    uint32_t ns_per_kib;
+};
+
+static struct hash_cost hash_costs[CONFIG_CRYPTO_MAX_HASH_OPS][HASH_NO_OF_ALGS];
+
+static int hash_alg_index(hash_t alg)
 {
-    current_hash_ops = NULL;
+    for (int i = 0; i < HASH_NO_OF_ALGS; i++) {
+        if (alg & BIT(i))
+            return i;
+    }
+
+    return -1;
+}
+
+/* Modelled cost of hashing 'length' bytes, an unknown length is treated as
+ * larger than anything that a setup cost matters for. */
+static uint64_t hash_cost(size_t index, int alg_idx, uint64_t length)
+{
+    const struct hash_cost *cost = &hash_costs[index][alg_idx];
+
+    if (length == 0)
+        return ((uint64_t)cost->ns_per_kib << 32) | cost->setup_ns;
+
+    return cost->setup_ns + ((uint64_t)cost->ns_per_kib * length) / 1024;
+}
+#endif
+
+/* Returns true if provider 'a' should be used instead of provider 'b' */
+static bool hash_prefer(size_t a, size_t b, hash_t alg, uint64_t length)
+{
+#ifdef CONFIG_CRYPTO_CALIBRATE
+    int alg_idx = hash_alg_index(alg);
+
+    if ((alg_idx >= 0) && hash_costs[a][alg_idx].valid && hash_costs[b][alg_idx].valid)
+        return hash_cost(a, alg_idx, length) < hash_cost(b, alg_idx, length);
+#endif
+    bool a_fits = (length == 0) || (length >= hash_ops[a]->min_length);
+    bool b_fits = (length == 0) || (length >= hash_ops[b]->min_length);
+
+    if (a_fits != b_fits)
+        return a_fits;
+
+    return hash_ops[a]->priority > hash_ops[b]->priority;
+}
+
+/* Selects the provider for 'alg' and an input of 'length' bytes, zero if the
+ * length is unknown. Ties go to the provider that was registered first. */
+static int hash_select(hash_t alg, uint64_t length, bool need_digest)
+{
+    int best = -1;
 
-    for (int i = 0; i < CONFIG_CRYPTO_MAX_HASH_OPS; i++) {
-        if (hash_ops[i] && (hash_ops[i]->alg_bits & alg)) {
-            current_hash_ops = hash_ops[i];
-            return current_hash_ops->init(alg);
+    for (size_t i = 0; i < no_of_hash_ops; i++) {
+        if (!(hash_ops[i]->alg_bits & alg))
+            continue;
+        if (need_digest && (hash_ops[i]->digest == NULL))
+            continue;
+
+        if ((best == -1) || hash_prefer(i, best, alg, length))
+            best = i;
+    }
+
+    return best;
+}
+
+int hash_init_length(hash_t alg, uint64_t length)
+{
+    int index = hash_select(alg, length, false);
+
+    if (index < 0) {
+        current_hash_ops = NULL;
+        return -PB_ERR_NOT_SUPPORTED;
+    }
+
+    current_hash_ops = hash_ops[index];
+    return current_hash_ops->init(alg);
+}
+
+/* Returns true if 'alg_a' on provider 'a' hashes large inputs faster than
+ * 'alg_b' on provider 'b' */
+static bool hash_alg_faster(size_t a, int alg_a, size_t b, int alg_b)
+{
+#ifdef CONFIG_CRYPTO_CALIBRATE
+    if (hash_costs[a][alg_a].valid && hash_costs[b][alg_b].valid)
+        return hash_costs[a][alg_a].ns_per_kib < hash_costs[b][alg_b].ns_per_kib;
+#else
+    (void)alg_a;
+    (void)alg_b;
+#endif
+    return hash_ops[a]->priority > hash_ops[b]->priority;
+}
+
+hash_t hash_fastest(hash_t algs)
+{
+    int best_alg = -1;
+    int best = -1;
+
+    for (int a = HASH_NO_OF_ALGS - 1; a >= 0; a--) {
+        if (!(algs & BIT(a)))
+            continue;
+
+        int index = hash_select(BIT(a), 0, false);
+
+        if (index < 0)
+            continue;
+
+        if ((best == -1) || hash_alg_faster(index, a, best, best_alg)) {
+            best = index;
+            best_alg = a;
         }
     }
 
-    return PB_ERR_NOT_SUPPORTED;
+    return (best_alg < 0) ? 0 : BIT(best_alg);
+}
+
+int hash_init(hash_t alg)
+{
+    return hash_init_length(alg, 0);
 }
 
 int hash_update(const void *buf, size_t length)
@@ -74,17 +196,55 @@ int hash_final(uint8_t *digest_output, size_t length)
     return rc;
 }
 
+int hash_digest(hash_t alg,
+                const void *buf,
+                size_t length,
+                uint8_t *digest_output,
+                size_t digest_length)
+{
+    int index = hash_select(alg, length, true);
+
+    if (index < 0)
+        return -PB_ERR_NOT_SUPPORTED;
+
+    return hash_ops[index]->digest(alg, buf, length, digest_output, digest_length);
+}
+
+bool hash_has_digest(hash_t alg, uint64_t length)
+{
+    int index = hash_select(alg, length, false);
+
+    return (index >= 0) && (hash_ops[index]->digest != NULL);
+}
+
 int hash_add_ops(const struct hash_ops *ops)
 {
     if (no_of_hash_ops >= CONFIG_CRYPTO_MAX_HASH_OPS)
         return -PB_ERR_MEM;
 
-    LOG_INFO("Register hash ops: %s, 0x%x", ops->name, ops->alg_bits);
+    LOG_INFO("Register hash ops: %s, 0x%x, prio %i", ops->name, ops->alg_bits, ops->priority);
     hash_ops[no_of_hash_ops++] = ops;
 
     return PB_OK;
 }
 
+/* There is nothing to benchmark a dsa provider with at runtime, the build
+ * time priority alone decides. Ties go to the provider registered first. */
+static int dsa_select(dsa_t alg)
+{
+    int best = -1;
+
+    for (size_t i = 0; i < no_of_dsa_ops; i++) {
+        if (!(dsa_ops[i]->alg_bits & alg))
+            continue;
+
+        if ((best == -1) || (dsa_ops[i]->priority > dsa_ops[best]->priority))
+            best = i;
+    }
+
+    return best;
+}
+
 int dsa_verify(dsa_t alg,
                const uint8_t *der_signature,
                size_t signature_length,
@@ -95,19 +255,12 @@ int dsa_verify(dsa_t alg,
                size_t md_length,
                bool *verified)
 {
-    const struct dsa_ops *ops = NULL;
+    int index = dsa_select(alg);
 
-    for (size_t i = 0; i < CONFIG_CRYPTO_MAX_DSA_OPS; i++) {
-        if (dsa_ops[i] && (dsa_ops[i]->alg_bits & alg)) {
-            ops = dsa_ops[i];
-            break;
-        }
-    }
-
-    if (ops == NULL)
+    if (index < 0)
         return -PB_ERR_NOT_SUPPORTED;
 
-    return ops->verify(
+    return dsa_ops[index]->verify(
         der_signature, signature_length, der_key, key_length, md_alg, md, md_length, verified);
 }
 
@@ -116,11 +269,62 @@ int dsa_add_ops(const struct dsa_ops *ops)
     if (no_of_dsa_ops >= CONFIG_CRYPTO_MAX_DSA_OPS)
         return -PB_ERR_MEM;
 
-    LOG_INFO("Register dsa ops: %s, 0x%x", ops->name, ops->alg_bits);
+    LOG_INFO("Register dsa ops: %s, 0x%x, prio %i", ops->name, ops->alg_bits, ops->priority);
     dsa_ops[no_of_dsa_ops++] = ops;
     return PB_OK;
 }
 
+int crypto_get_provider_info(unsigned int index, struct crypto_provider_info *info)
+{
+    unsigned int n = 0;
+
+    for (size_t i = 0; i < no_of_hash_ops; i++) {
+        for (int a = 0; a < HASH_NO_OF_ALGS; a++) {
+            hash_t alg = BIT(a);
+
+            if (!(hash_ops[i]->alg_bits & alg))
+                continue;
+            if (n++ != index)
+                continue;
+
+            memset(info, 0, sizeof(*info));
+            info->name = hash_ops[i]->name;
+            info->alg_name = hash_alg_names[a];
+            info->priority = hash_ops[i]->priority;
+#ifdef CONFIG_CRYPTO_CALIBRATE
+            info->calibrated = hash_costs[i][a].valid;
+            info->setup_ns = hash_costs[i][a].setup_ns;
+            info->ns_per_kib = hash_costs[i][a].ns_per_kib;
+#endif
+            info->selected_small = (hash_select(alg, CRYPTO_SMALL_INPUT, false) == (int)i);
+            info->selected_large = (hash_select(alg, 0, false) == (int)i);
+            return PB_OK;
+        }
+    }
+
+    for (size_t i = 0; i < no_of_dsa_ops; i++) {
+        for (int a = 0; a < DSA_NO_OF_ALGS; a++) {
+            dsa_t alg = BIT(a);
+
+            if (!(dsa_ops[i]->alg_bits & alg))
+                continue;
+            if (n++ != index)
+                continue;
+
+            memset(info, 0, sizeof(*info));
+            info->name = dsa_ops[i]->name;
+            info->alg_name = dsa_alg_names[a];
+            info->dsa = true;
+            info->priority = dsa_ops[i]->priority;
+            info->selected_small = (dsa_select(alg) == (int)i);
+            info->selected_large = info->selected_small;
+            return PB_OK;
+        }
+    }
+
+    return -PB_ERR_NOT_FOUND;
+}
+
 void hash_print(const char *prefix, uint8_t *digest, size_t length)
 {
     printf("%s ", prefix);
@@ -224,4 +428,84 @@ DECLARE_SELF_TEST(crypto_test_sha256_1Ma)
     return 0;
 }
 
+#ifdef CONFIG_CRYPTO_CALIBRATE
+#define CALIBRATE_SMALL        CRYPTO_SMALL_INPUT
+#define CALIBRATE_SMALL_ROUNDS 32
+#define CALIBRATE_LARGE        (4 * 1024)
+#define CALIBRATE_LARGE_ROUNDS 8
+
+static uint8_t calibrate_buf[CALIBRATE_LARGE] __aligned(64);
+
+/* Average time in ns of hashing 'length' bytes in one job */
+static int hash_measure(
+    const struct hash_ops *ops, hash_t alg, size_t length, unsigned int rounds, uint32_t *ns)
+{
+    int rc;
+    uint8_t digest[CRYPTO_MD_MAX_SZ];
+    unsigned int start = plat_get_us_tick();
+
+    for (unsigned int n = 0; n < rounds; n++) {
+        rc = ops->init(alg);
+        if (rc == PB_OK)
+            rc = ops->update(calibrate_buf, length);
+        if (rc == PB_OK)
+            rc = ops->final(digest, sizeof(digest));
+        if (rc != PB_OK)
+            return rc;
+    }
+
+    *ns = ((uint64_t)(plat_get_us_tick() - start) * 1000) / rounds;
+    return PB_OK;
+}
+
+/* Measures every algorithm of every hash provider with a short and a long
+ * input and derives a setup cost and a cost per KiB from the two. */
+DECLARE_SELF_TEST(crypto_calibrate_hash)
+{
+    int rc;
+    uint32_t small_ns, large_ns;
+
+    memset(calibrate_buf, 0xa5, sizeof(calibrate_buf));
+
+    for (size_t i = 0; i < no_of_hash_ops; i++) {
+        for (int a = 0; a < HASH_NO_OF_ALGS; a++) {
+            struct hash_cost *cost = &hash_costs[i][a];
+
+            if (!(hash_ops[i]->alg_bits & BIT(a)))
+                continue;
+
+            rc = hash_measure(
+                hash_ops[i], BIT(a), CALIBRATE_SMALL, CALIBRATE_SMALL_ROUNDS, &small_ns);
+            if (rc == PB_OK) {
+                rc = hash_measure(
+                    hash_ops[i], BIT(a), CALIBRATE_LARGE, CALIBRATE_LARGE_ROUNDS, &large_ns);
+            }
+
+            if (rc != PB_OK) {
+                LOG_ERR("%s %s failed (%i)", hash_ops[i]->name, hash_alg_names[a], rc);
+                return -1;
+            }
+
+            if (large_ns > small_ns) {
+                cost->ns_per_kib = ((uint64_t)(large_ns - small_ns) * 1024) /
+                                   (CALIBRATE_LARGE - CALIBRATE_SMALL);
+            } else {
+                cost->ns_per_kib = 0;
+            }
+
+            small_ns -= MIN(small_ns, (cost->ns_per_kib * CALIBRATE_SMALL) / 1024);
+            cost->setup_ns = small_ns;
+            cost->valid = true;
+
+            LOG_INFO("%s %s: %" PRIu32 " ns + %" PRIu32 " ns/KiB",
+                     hash_ops[i]->name,
+                     hash_alg_names[a],
+                     cost->setup_ns,
+                     cost->ns_per_kib);
+        }
+    }
+
+    return 0;
+}
+#endif // CONFIG_CRYPTO_CALIBRATE
 #endif
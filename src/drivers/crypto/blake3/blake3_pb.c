@@ -0,0 +1,296 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * BLAKE3 hash provider.
+ *
+ * With CONFIG_SMP, 'update_async' splits the input into complete subtrees,
+ * queues the subtrees as work items for all cores and returns. The chaining
+ * values are added to the hasher by the next call, which is how
+ * 'cmd_part_verify' reads the next buffer while the current one is hashed.
+ *
+ */
+
+#include <blake3/blake3.h>
+#include <drivers/crypto/blake3.h>
+#include <pb/crypto.h>
+#include <pb/pb.h>
+#include <pb/self_test.h>
+#include <pb/smp.h>
+#include <string.h>
+
+/* Smallest piece of a subtree that is queued as one work item */
+#define BLAKE3_PB_PIECE_MIN (4 * BLAKE3_CHUNK_LEN)
+
+static struct blake3_hasher hasher;
+
+#ifdef CONFIG_SMP
+#define BLAKE3_PB_MAX_WORK CONFIG_SMP_WORK_QUEUE_SIZE
+
+static struct blake3_pb_work {
+    struct smp_work work;
+    const uint8_t *input;
+    size_t length;
+    uint64_t counter;
+    uint8_t cv[BLAKE3_OUT_LEN];
+} work[BLAKE3_PB_MAX_WORK];
+
+/* Subtrees of the current job, in input order */
+static struct {
+    size_t length; /* Subtree length */
+    unsigned int first; /* Index of the first work item */
+    unsigned int count; /* Work items, one or an even number */
+} subtrees[BLAKE3_PB_MAX_WORK];
+
+static struct {
+    bool pending;
+    unsigned int no_of_subtrees;
+    const uint8_t *tail; /* Input that is not part of a queued subtree */
+    size_t tail_length;
+} job;
+
+static uint8_t reduce_buf[BLAKE3_PB_MAX_WORK * BLAKE3_OUT_LEN];
+
+static void blake3_work_fn(void *arg)
+{
+    struct blake3_pb_work *w = (struct blake3_pb_work *)arg;
+
+    blake3_subtree_cv(w->input, w->length, w->counter, w->cv);
+}
+
+/* Wait for the queued subtrees and add them to the hasher */
+static void blake3_job_complete(void)
+{
+    if (!job.pending)
+        return;
+
+    for (unsigned int s = 0; s < job.no_of_subtrees; s++) {
+        unsigned int count = subtrees[s].count;
+
+        for (unsigned int i = 0; i < count; i++) {
+            struct blake3_pb_work *w = &work[subtrees[s].first + i];
+
+            smp_wait(&w->work);
+            memcpy(&reduce_buf[i * BLAKE3_OUT_LEN], w->cv, BLAKE3_OUT_LEN);
+        }
+
+        /* Merge the pieces until the two halves of the subtree remain */
+        while (count > 2) {
+            for (unsigned int i = 0; i < count / 2; i++) {
+                blake3_parent_cv(&reduce_buf[2 * i * BLAKE3_OUT_LEN],
+                                 &reduce_buf[i * BLAKE3_OUT_LEN]);
+            }
+            count /= 2;
+        }
+
+        blake3_hasher_push_subtree(&hasher, reduce_buf, subtrees[s].length);
+    }
+
+    blake3_hasher_update(&hasher, job.tail, job.tail_length);
+    job.pending = false;
+}
+
+static size_t blake3_piece_length(size_t length)
+{
+    size_t piece = BLAKE3_PB_PIECE_MIN;
+
+    /* Leave about half of the work items for the smaller subtrees */
+    while ((piece * (BLAKE3_PB_MAX_WORK / 2)) < length)
+        piece *= 2;
+
+    return piece;
+}
+
+static int blake3_pb_update_async(const void *buf, size_t length)
+{
+    const uint8_t *p = buf;
+    uint64_t counter;
+    size_t piece_length;
+    unsigned int no_of_work = 0;
+    size_t n;
+
+    blake3_job_complete();
+
+    n = blake3_hasher_update_head(&hasher, p, length);
+    p += n;
+    length -= n;
+
+    counter = hasher.chunk.counter;
+    piece_length = blake3_piece_length(length);
+    job.no_of_subtrees = 0;
+
+    while (length > BLAKE3_CHUNK_LEN) {
+        size_t subtree_length = blake3_subtree_len(counter, length);
+        size_t piece = subtree_length;
+        unsigned int count = 1;
+
+        if (subtree_length > BLAKE3_CHUNK_LEN) {
+            /* At least the two halves, the parent of the subtree may be
+             * the root of the whole tree */
+            piece = MIN(piece_length, subtree_length / 2);
+            count = subtree_length / piece;
+        }
+
+        if ((no_of_work + count) > BLAKE3_PB_MAX_WORK)
+            break;
+
+        subtrees[job.no_of_subtrees].length = subtree_length;
+        subtrees[job.no_of_subtrees].first = no_of_work;
+        subtrees[job.no_of_subtrees].count = count;
+        job.no_of_subtrees++;
+
+        for (unsigned int i = 0; i < count; i++) {
+            struct blake3_pb_work *w = &work[no_of_work++];
+
+            w->input = p;
+            w->length = piece;
+            w->counter = counter;
+            w->work.fn = blake3_work_fn;
+            w->work.arg = w;
+            smp_queue(&w->work);
+
+            p += piece;
+            counter += piece / BLAKE3_CHUNK_LEN;
+        }
+
+        length -= subtree_length;
+    }
+
+    job.tail = p;
+    job.tail_length = length;
+    job.pending = true;
+
+    return PB_OK;
+}
+
+static int blake3_pb_update(const void *buf, size_t length)
+{
+    int rc = blake3_pb_update_async(buf, length);
+
+    blake3_job_complete();
+    return rc;
+}
+#else
+static void blake3_job_complete(void)
+{
+}
+
+static int blake3_pb_update(const void *buf, size_t length)
+{
+    blake3_hasher_update(&hasher, buf, length);
+    return PB_OK;
+}
+#endif // CONFIG_SMP
+
+static int blake3_pb_init_hash(hash_t alg)
+{
+    if (alg != HASH_BLAKE3)
+        return -PB_ERR_NOT_SUPPORTED;
+
+    blake3_job_complete();
+    blake3_hasher_init(&hasher);
+    return PB_OK;
+}
+
+static int blake3_pb_final(uint8_t *digest_out, size_t length)
+{
+    if (length < BLAKE3_OUT_LEN)
+        return -PB_ERR_BUF_TOO_SMALL;
+
+    blake3_job_complete();
+    blake3_hasher_finalize(&hasher, digest_out, BLAKE3_OUT_LEN);
+    return PB_OK;
+}
+
+#ifdef CONFIG_SELF_TEST
+/* Official test vectors, the input is i % 251 for i in 0 .. length - 1 */
+static const uint8_t blake3_test_empty[] = {
+    0xaf, 0x13, 0x49, 0xb9, 0xf5, 0xf9, 0xa1, 0xa6, 0xa0, 0x40, 0x4d, 0xea, 0x36, 0xdc, 0xc9, 0x49,
+    0x9b, 0xcb, 0x25, 0xc9, 0xad, 0xc1, 0x12, 0xb7, 0xcc, 0x9a, 0x93, 0xca, 0xe4, 0x1f, 0x32, 0x62,
+};
+
+#define BLAKE3_TEST_VECTOR_LENGTH 31744
+
+static const uint8_t blake3_test_vector[] = {
+    0x62, 0xb6, 0x96, 0x0e, 0x1a, 0x44, 0xbc, 0xc1, 0xeb, 0x1a, 0x61, 0x1a, 0x8d, 0x62, 0x35, 0xb6,
+    0xb4, 0xb7, 0x8f, 0x32, 0xe7, 0xab, 0xc4, 0xfb, 0x4c, 0x6c, 0xdc, 0xce, 0x94, 0x89, 0x5c, 0x47,
+};
+
+static uint8_t blake3_test_buf[BLAKE3_TEST_VECTOR_LENGTH];
+
+DECLARE_SELF_TEST(blake3_test_empty_input)
+{
+    uint8_t digest[BLAKE3_OUT_LEN];
+
+    if (hash_init(HASH_BLAKE3) != PB_OK)
+        return -1;
+
+    if (hash_final(digest, sizeof(digest)) != PB_OK)
+        return -1;
+
+    if (memcmp(digest, blake3_test_empty, sizeof(digest)) != 0) {
+        LOG_ERR("Failed");
+        hash_print("Expected", (uint8_t *)blake3_test_empty, sizeof(digest));
+        hash_print("Output", digest, sizeof(digest));
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Hash the same input in one update, in odd sized updates and with the
+ * asynchronous tree updates, the digests must match the test vector */
+DECLARE_SELF_TEST(blake3_test_tree)
+{
+    uint8_t digest[BLAKE3_OUT_LEN];
+    static const size_t steps[] = { 1, 63, 1024, 1025, 4096, 30000 };
+
+    for (size_t i = 0; i < sizeof(blake3_test_buf); i++)
+        blake3_test_buf[i] = i % 251;
+
+    for (size_t s = 0; s < ARRAY_SIZE(steps); s++) {
+        size_t offset = 0;
+
+        hash_init(HASH_BLAKE3);
+
+        while (offset < sizeof(blake3_test_buf)) {
+            size_t n = MIN(steps[s], sizeof(blake3_test_buf) - offset);
+
+            if (hash_update_async(&blake3_test_buf[offset], n) != PB_OK)
+                return -1;
+
+            offset += n;
+        }
+
+        hash_final(digest, sizeof(digest));
+
+        if (memcmp(digest, blake3_test_vector, sizeof(digest)) != 0) {
+            LOG_ERR("Failed with %zu byte updates", steps[s]);
+            hash_print("Expected", (uint8_t *)blake3_test_vector, sizeof(digest));
+            hash_print("Output", digest, sizeof(digest));
+            return -1;
+        }
+    }
+
+    return 0;
+}
+#endif // CONFIG_SELF_TEST
+
+int blake3_pb_init(void)
+{
+    static const struct hash_ops blake3_ops = {
+        .name = "blake3",
+        .alg_bits = HASH_BLAKE3,
+        .init = blake3_pb_init_hash,
+        .update = blake3_pb_update,
+#ifdef CONFIG_SMP
+        .update_async = blake3_pb_update_async,
+#endif
+        .final = blake3_pb_final,
+    };
+
+    return hash_add_ops(&blake3_ops);
+}
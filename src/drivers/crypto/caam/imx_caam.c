@@ -49,6 +49,8 @@
 #include <inttypes.h>
 #include <pb/crypto.h>
 #include <pb/der_helpers.h>
+#include <pb/event.h>
+#include <pb/irq.h>
 #include <pb/mmio.h>
 #include <pb/pb.h>
 #include <pb/utils_def.h>
@@ -101,6 +103,9 @@
 #define CAAM_VID_MS               0x0ff8
 #define CAAM_VID_LS               0x0ffc
 
+#define CAAM_JRINTR_JRI          BIT(0)
+#define CAAM_JRCFGR_LS_IMSK       BIT(0)
+
 #define CAAM_KEY_MAX_LENGTH       256
 #define CAAM_SIG_MAX_LENGTH       136
 #define CAAM_NO_OF_DESC           16
@@ -141,6 +146,7 @@ struct caam {
     bool init; /* Hash init state variable */
     bool caam_initialized;
     bool async_hashing;
+    struct pb_event job_done; /* Signalled by the job ring interrupt */
 };
 
 static struct caam caam;
@@ -156,7 +162,7 @@ static void caam_shedule_job_async(void)
 static int caam_wait_for_job(void)
 {
     while ((mmio_read_32(caam.base + CAAM_ORSFR) & 1) == 0)
-        __asm__("nop");
+        pb_event_wait(&caam.job_done);
 
     arch_invalidate_cache_range((uintptr_t)&caam.output[0], sizeof(caam.output[0]) * 2);
 
@@ -522,6 +528,34 @@ static int caam_hash_final(uint8_t *output, size_t size)
     return err;
 }
 
+static void caam_irq_handler(unsigned int irq, void *arg)
+{
+    (void)irq;
+    (void)arg;
+
+    mmio_write_32(caam.base + CAAM_JRINTR, CAAM_JRINTR_JRI);
+    pb_event_signal(&caam.job_done);
+}
+
+int imx_caam_enable_irq(unsigned int irq)
+{
+    int rc;
+
+    if (!caam.caam_initialized)
+        return -PB_ERR_STATE;
+
+    rc = irq_register(irq, caam_irq_handler, NULL);
+
+    if (rc != PB_OK)
+        return rc;
+
+    mmio_write_32(caam.base + CAAM_JRINTR, CAAM_JRINTR_JRI);
+    mmio_clrsetbits_32(caam.base + CAAM_JRCFGR_LS, CAAM_JRCFGR_LS_IMSK, 0);
+    pb_event_init(&caam.job_done, true);
+
+    return PB_OK;
+}
+
 int imx_caam_init(uintptr_t base)
 {
     int rc;
@@ -558,6 +592,8 @@ int imx_caam_init(uintptr_t base)
         .update = caam_hash_update,
         .update_async = caam_hash_update_async,
         .final = caam_hash_final,
+        .priority = 10,
+        .min_length = CONFIG_DRIVERS_IMX_CAAM_HASH_MIN_LENGTH,
     };
 
     rc = hash_add_ops(&caam_ops);
@@ -569,6 +605,7 @@ int imx_caam_init(uintptr_t base)
         .name = "caam-dsa",
         .alg_bits = DSA_EC_SECP256r1 | DSA_EC_SECP384r1 | DSA_EC_SECP521r1,
         .verify = caam_ecda_verify,
+        .priority = 10,
     };
 
     rc = dsa_add_ops(&caam_dsa_ops);
@@ -0,0 +1,848 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Ed25519 signature verification (RFC 8032).
+ *
+ * Field elements use ten signed limbs of alternating 26 and 25 bits, like
+ * the ref10 implementation, which keeps all products within 64 bits on
+ * 32-bit cores. Points use extended twisted Edwards coordinates.
+ *
+ * There are no branches or table lookups that depend on the signature, key
+ * or message, even though a verification only handles public data.
+ *
+ */
+
+#include <drivers/crypto/ed25519.h>
+#include <pb/crypto.h>
+#include <pb/pb.h>
+#include <pb/plat.h>
+#include <pb/self_test.h>
+#include <string.h>
+
+#define ED25519_KEY_LENGTH       32
+#define ED25519_SIGNATURE_LENGTH 64
+#define ED25519_WINDOW_BITS      4
+#define ED25519_TABLE_SIZE       (1 << ED25519_WINDOW_BITS)
+
+typedef int32_t fe[10];
+
+struct ge {
+    fe X;
+    fe Y;
+    fe Z;
+    fe T;
+};
+
+/* A point prepared for additions: (Y + X, Y - X, 2d * T, 2 * Z) */
+struct ge_cached {
+    fe YpX;
+    fe YmX;
+    fe T2d;
+    fe Z2;
+};
+
+/* SubjectPublicKeyInfo of an Ed25519 key, followed by the 32 byte key */
+static const uint8_t ed25519_spki_prefix[] = {
+    0x30, 0x2a, 0x30, 0x05, 0x06, 0x03, 0x2b, 0x65, 0x70, 0x03, 0x21, 0x00,
+};
+
+static const fe fe_d2 = {
+    45281625, 27714825, 36363642, 13898781, 229458,
+    15978800, 54557047, 27058993, 29715967, 9444199,
+};
+
+static const fe fe_d = {
+    56195235, 13857412, 51736253, 6949390, 114729,
+    24766616, 60832955, 30306712, 48412415, 21499315,
+};
+
+static const fe fe_sqrtm1 = {
+    34513072, 25610706, 9377949, 3500415, 12389472,
+    33281959, 41962654, 31548777, 326685, 11406482,
+};
+
+static const struct ge ge_base = {
+    .X = { 52811034, 25909283, 16144682, 17082669, 27570973,
+           30858332, 40966398, 8378388, 20764389, 8758491 },
+    .Y = { 40265304, 26843545, 13421772, 20132659, 26843545,
+           6710886, 53687091, 13421772, 40265318, 26843545 },
+    .Z = { 1 },
+    .T = { 28827043, 27438313, 39759291, 244362, 8635006,
+           11264893, 19351346, 13413597, 16611511, 27139452 },
+};
+
+/* Group order L = 2^252 + 27742317777372353535851937790883648493 */
+static const int64_t sc_L[32] = {
+    0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7,
+    0xa2, 0xde, 0xf9, 0xde, 0x14, 0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0x10,
+};
+
+static inline unsigned int fe_limb_bits(unsigned int i)
+{
+    return (i & 1) ? 25 : 26;
+}
+
+/* Propagates the carries of 't' into 'h'. The top limb wraps around with a
+ * factor of 19, since 2^255 = 19 mod p. */
+static void fe_carry(fe h, int64_t t[10])
+{
+    int64_t c;
+
+    for (unsigned int i = 0; i < 10; i++) {
+        c = t[i] >> fe_limb_bits(i);
+        t[i] -= c * ((int64_t)1 << fe_limb_bits(i));
+
+        if (i < 9)
+            t[i + 1] += c;
+        else
+            t[0] += c * 19;
+    }
+
+    c = t[0] >> 26;
+    t[0] -= c * ((int64_t)1 << 26);
+    t[1] += c;
+
+    for (unsigned int i = 0; i < 10; i++)
+        h[i] = (int32_t)t[i];
+}
+
+static void fe_copy(fe h, const fe f)
+{
+    memcpy(h, f, sizeof(fe));
+}
+
+static void fe_set(fe h, int32_t v)
+{
+    memset(h, 0, sizeof(fe));
+    h[0] = v;
+}
+
+static void fe_add(fe h, const fe f, const fe g)
+{
+    int64_t t[10];
+
+    for (unsigned int i = 0; i < 10; i++)
+        t[i] = (int64_t)f[i] + g[i];
+
+    fe_carry(h, t);
+}
+
+static void fe_sub(fe h, const fe f, const fe g)
+{
+    int64_t t[10];
+
+    for (unsigned int i = 0; i < 10; i++)
+        t[i] = (int64_t)f[i] - g[i];
+
+    fe_carry(h, t);
+}
+
+static void fe_neg(fe h, const fe f)
+{
+    static const fe zero;
+
+    fe_sub(h, zero, f);
+}
+
+static void fe_mul(fe h, const fe f, const fe g)
+{
+    int64_t t[10] = { 0 };
+    int32_t g19[10];
+
+    /* Products above 2^255 wrap around with a factor of 19 */
+    for (unsigned int j = 0; j < 10; j++)
+        g19[j] = 19 * g[j];
+
+    for (unsigned int i = 0; i < 10; i++) {
+        /* Two odd limbs are both 2^0.5 short of their weight */
+        int64_t fi = f[i];
+        int64_t fi_odd = (i & 1) ? (2 * fi) : fi;
+
+        for (unsigned int j = 0; j < 10 - i; j++)
+            t[i + j] += ((j & 1) ? fi_odd : fi) * g[j];
+
+        for (unsigned int j = 10 - i; j < 10; j++)
+            t[i + j - 10] += ((j & 1) ? fi_odd : fi) * g19[j];
+    }
+
+    fe_carry(h, t);
+}
+
+/* Same as fe_mul(h, f, f), with each cross product computed once */
+static void fe_sq(fe h, const fe f)
+{
+    int64_t t[10] = { 0 };
+    int32_t f19[10];
+
+    for (unsigned int j = 0; j < 10; j++)
+        f19[j] = 19 * f[j];
+
+    for (unsigned int i = 0; i < 10; i++) {
+        int64_t fi = (i & 1) ? (2 * (int64_t)f[i]) : f[i];
+        int64_t fi2 = 2 * (int64_t)f[i];
+        int64_t fi2_odd = 2 * fi;
+
+        if (2 * i < 10)
+            t[2 * i] += fi * f[i];
+        else
+            t[2 * i - 10] += fi * f19[i];
+
+        for (unsigned int j = i + 1; j < 10 - i; j++)
+            t[i + j] += ((j & 1) ? fi2_odd : fi2) * f[j];
+
+        for (unsigned int j = (i + 1 > 10 - i) ? (i + 1) : (10 - i); j < 10; j++)
+            t[i + j - 10] += ((j & 1) ? fi2_odd : fi2) * f19[j];
+    }
+
+    fe_carry(h, t);
+}
+
+/* h = f^(2^n) */
+static void fe_sqn(fe h, const fe f, unsigned int n)
+{
+    fe_sq(h, f);
+
+    for (unsigned int i = 1; i < n; i++)
+        fe_sq(h, h);
+}
+
+/* Common part of the addition chains for p - 2 and (p - 5) / 8 */
+static void fe_pow_250(fe z_250_0, fe z11, const fe z)
+{
+    fe z2, z9, z_5_0, z_10_0, z_20_0, z_50_0, z_100_0, t;
+
+    fe_sq(z2, z);
+    fe_sqn(t, z2, 2);
+    fe_mul(z9, t, z);
+    fe_mul(z11, z9, z2);
+    fe_sq(t, z11);
+    fe_mul(z_5_0, t, z9);
+    fe_sqn(t, z_5_0, 5);
+    fe_mul(z_10_0, t, z_5_0);
+    fe_sqn(t, z_10_0, 10);
+    fe_mul(z_20_0, t, z_10_0);
+    fe_sqn(t, z_20_0, 20);
+    fe_mul(t, t, z_20_0);
+    fe_sqn(t, t, 10);
+    fe_mul(z_50_0, t, z_10_0);
+    fe_sqn(t, z_50_0, 50);
+    fe_mul(z_100_0, t, z_50_0);
+    fe_sqn(t, z_100_0, 100);
+    fe_mul(t, t, z_100_0);
+    fe_sqn(t, t, 50);
+    fe_mul(z_250_0, t, z_50_0);
+}
+
+/* h = z^(p - 2) = 1 / z */
+static void fe_invert(fe h, const fe z)
+{
+    fe t, z11;
+
+    fe_pow_250(t, z11, z);
+    fe_sqn(t, t, 5);
+    fe_mul(h, t, z11);
+}
+
+/* h = z^((p - 5) / 8) */
+static void fe_pow22523(fe h, const fe z)
+{
+    fe t, z11;
+
+    fe_pow_250(t, z11, z);
+    fe_sqn(t, t, 2);
+    fe_mul(h, t, z);
+}
+
+/* Canonical little endian encoding, reduced mod p */
+static void fe_tobytes(uint8_t *s, const fe f)
+{
+    int32_t h[10];
+    int32_t q;
+    uint64_t acc = 0;
+    unsigned int acc_bits = 0;
+    unsigned int n = 0;
+
+    fe_copy(h, f);
+
+    /* q = 1 if h >= p, the limbs are carried so that |h| < 2^255 + small */
+    q = (19 * h[9] + (1 << 24)) >> 25;
+
+    for (unsigned int i = 0; i < 10; i++)
+        q = (h[i] + q) >> fe_limb_bits(i);
+
+    h[0] += 19 * q;
+
+    for (unsigned int i = 0; i < 9; i++) {
+        int32_t c = h[i] >> fe_limb_bits(i);
+        h[i + 1] += c;
+        h[i] -= c * (1 << fe_limb_bits(i));
+    }
+
+    h[9] &= (1 << 25) - 1;
+
+    for (unsigned int i = 0; i < 10; i++) {
+        acc |= (uint64_t)h[i] << acc_bits;
+        acc_bits += fe_limb_bits(i);
+
+        while (acc_bits >= 8) {
+            s[n++] = (uint8_t)acc;
+            acc >>= 8;
+            acc_bits -= 8;
+        }
+    }
+
+    /* The last 7 bits */
+    s[n] = (uint8_t)acc;
+}
+
+/* Decodes 255 bits, the top bit is ignored */
+static void fe_frombytes(fe h, const uint8_t *s)
+{
+    unsigned int offset = 0;
+
+    for (unsigned int i = 0; i < 10; i++) {
+        uint64_t v = 0;
+        unsigned int first = offset / 8;
+
+        for (unsigned int j = 0; j < 5 && (first + j) < 32; j++)
+            v |= (uint64_t)s[first + j] << (8 * j);
+
+        h[i] = (int32_t)((v >> (offset % 8)) & ((1u << fe_limb_bits(i)) - 1));
+        offset += fe_limb_bits(i);
+    }
+}
+
+static int fe_isnegative(const fe f)
+{
+    uint8_t s[32];
+
+    fe_tobytes(s, f);
+    return s[0] & 1;
+}
+
+static int fe_iszero(const fe f)
+{
+    uint8_t s[32];
+    uint8_t acc = 0;
+
+    fe_tobytes(s, f);
+
+    for (unsigned int i = 0; i < sizeof(s); i++)
+        acc |= s[i];
+
+    return acc == 0;
+}
+
+/* h = g if b == 1, b must be 0 or 1 */
+static void fe_cmov(fe h, const fe g, int32_t b)
+{
+    int32_t mask = -b;
+
+    for (unsigned int i = 0; i < 10; i++)
+        h[i] ^= (h[i] ^ g[i]) & mask;
+}
+
+static void ge_to_cached(struct ge_cached *r, const struct ge *p)
+{
+    fe_add(r->YpX, p->Y, p->X);
+    fe_sub(r->YmX, p->Y, p->X);
+    fe_mul(r->T2d, p->T, fe_d2);
+    fe_add(r->Z2, p->Z, p->Z);
+}
+
+/* r = p + q, complete for all inputs (add-2008-hwcd-3) */
+static void ge_add(struct ge *r, const struct ge *p, const struct ge_cached *q)
+{
+    fe a, b, c, d, e, f, g, h;
+
+    fe_sub(a, p->Y, p->X);
+    fe_mul(a, a, q->YmX);
+    fe_add(b, p->Y, p->X);
+    fe_mul(b, b, q->YpX);
+    fe_mul(c, p->T, q->T2d);
+    fe_mul(d, p->Z, q->Z2);
+    fe_sub(e, b, a);
+    fe_sub(f, d, c);
+    fe_add(g, d, c);
+    fe_add(h, b, a);
+    fe_mul(r->X, e, f);
+    fe_mul(r->Y, g, h);
+    fe_mul(r->T, e, h);
+    fe_mul(r->Z, f, g);
+}
+
+/* r = 2 * p (dbl-2008-hwcd with a = -1) */
+static void ge_double(struct ge *r, const struct ge *p)
+{
+    fe a, b, c, e, f, g, h;
+
+    fe_sq(a, p->X);
+    fe_sq(b, p->Y);
+    fe_sq(c, p->Z);
+    fe_add(c, c, c);
+    fe_add(h, p->X, p->Y);
+    fe_sq(h, h);
+    fe_sub(e, h, a);
+    fe_sub(e, e, b);
+    fe_sub(g, b, a);
+    fe_sub(f, g, c);
+    fe_add(h, a, b);
+    fe_neg(h, h);
+    fe_mul(r->X, e, f);
+    fe_mul(r->Y, g, h);
+    fe_mul(r->T, e, h);
+    fe_mul(r->Z, f, g);
+}
+
+/* Decodes a point and negates it, since the verification needs -A */
+static int ge_frombytes_negate(struct ge *r, const uint8_t *s)
+{
+    fe u, v, v3, vxx, check;
+    uint8_t y_bytes[32];
+
+    fe_frombytes(r->Y, s);
+
+    /* Reject a non-canonical y */
+    fe_tobytes(y_bytes, r->Y);
+    y_bytes[31] |= s[31] & 0x80;
+
+    if (memcmp(y_bytes, s, sizeof(y_bytes)) != 0)
+        return -PB_ERR_SIGNATURE;
+
+    fe_set(r->Z, 1);
+    fe_sq(u, r->Y);
+    fe_mul(v, u, fe_d);
+    fe_sub(u, u, r->Z); /* u = y^2 - 1 */
+    fe_add(v, v, r->Z); /* v = d * y^2 + 1 */
+
+    /* x = u * v^3 * (u * v^7)^((p - 5) / 8) */
+    fe_sq(v3, v);
+    fe_mul(v3, v3, v);
+    fe_sq(r->X, v3);
+    fe_mul(r->X, r->X, v);
+    fe_mul(r->X, r->X, u);
+    fe_pow22523(r->X, r->X);
+    fe_mul(r->X, r->X, v3);
+    fe_mul(r->X, r->X, u);
+
+    fe_sq(vxx, r->X);
+    fe_mul(vxx, vxx, v);
+    fe_sub(check, vxx, u);
+
+    if (!fe_iszero(check)) {
+        fe_add(check, vxx, u);
+
+        if (!fe_iszero(check))
+            return -PB_ERR_SIGNATURE;
+
+        fe_mul(r->X, r->X, fe_sqrtm1);
+    }
+
+    if (fe_iszero(r->X) && (s[31] >> 7))
+        return -PB_ERR_SIGNATURE;
+
+    if (fe_isnegative(r->X) == (s[31] >> 7))
+        fe_neg(r->X, r->X);
+
+    fe_mul(r->T, r->X, r->Y);
+    return PB_OK;
+}
+
+static void ge_tobytes(uint8_t *s, const struct ge *p)
+{
+    fe recip, x, y;
+
+    fe_invert(recip, p->Z);
+    fe_mul(x, p->X, recip);
+    fe_mul(y, p->Y, recip);
+    fe_tobytes(s, y);
+    s[31] ^= fe_isnegative(x) << 7;
+}
+
+static void ge_cached_cmov(struct ge_cached *r, const struct ge_cached *p, int32_t b)
+{
+    fe_cmov(r->YpX, p->YpX, b);
+    fe_cmov(r->YmX, p->YmX, b);
+    fe_cmov(r->T2d, p->T2d, b);
+    fe_cmov(r->Z2, p->Z2, b);
+}
+
+/* 0 * p, 1 * p, ..., 15 * p */
+static void ge_table(struct ge_cached *table, const struct ge *p)
+{
+    struct ge sum = *p;
+
+    memset(&table[0], 0, sizeof(table[0]));
+    fe_set(table[0].YpX, 1);
+    fe_set(table[0].YmX, 1);
+    fe_set(table[0].Z2, 2);
+    ge_to_cached(&table[1], p);
+
+    for (unsigned int i = 2; i < ED25519_TABLE_SIZE; i++) {
+        ge_add(&sum, &sum, &table[1]);
+        ge_to_cached(&table[i], &sum);
+    }
+}
+
+/* r = table[idx], reads every entry */
+static void ge_table_select(struct ge_cached *r, const struct ge_cached *table, unsigned int idx)
+{
+    *r = table[0];
+
+    for (unsigned int j = 1; j < ED25519_TABLE_SIZE; j++)
+        ge_cached_cmov(r, &table[j], (int32_t)((((idx ^ j) - 1) >> 31) & 1));
+}
+
+/* r = a * B + b * A, where B is the base point. Four bit fixed windows of
+ * both scalars, interleaved so that the doublings are shared. */
+static void ge_double_scalarmult(struct ge *r,
+                                 const uint8_t *a,
+                                 const struct ge *A,
+                                 const uint8_t *b)
+{
+    /* Too large for the stack on some boards */
+    static struct ge_cached table_B[ED25519_TABLE_SIZE];
+    static struct ge_cached table_A[ED25519_TABLE_SIZE];
+    struct ge_cached sel;
+
+    ge_table(table_B, &ge_base);
+    ge_table(table_A, A);
+
+    memset(r, 0, sizeof(*r));
+    fe_set(r->Y, 1);
+    fe_set(r->Z, 1);
+
+    for (int i = 63; i >= 0; i--) {
+        unsigned int shift = (i & 1) * 4;
+
+        if (i != 63) {
+            for (unsigned int j = 0; j < ED25519_WINDOW_BITS; j++)
+                ge_double(r, r);
+        }
+
+        ge_table_select(&sel, table_B, (a[i / 2] >> shift) & 0xf);
+        ge_add(r, r, &sel);
+        ge_table_select(&sel, table_A, (b[i / 2] >> shift) & 0xf);
+        ge_add(r, r, &sel);
+    }
+}
+
+/* r = x mod L, for a 512-bit little endian x stored one byte per element */
+static void sc_reduce(uint8_t *r, int64_t x[64])
+{
+    int64_t carry;
+    int i, j;
+
+    for (i = 63; i >= 32; i--) {
+        carry = 0;
+
+        for (j = i - 32; j < i - 12; j++) {
+            x[j] += carry - 16 * x[i] * sc_L[j - (i - 32)];
+            carry = (x[j] + 128) >> 8;
+            x[j] -= carry * 256;
+        }
+
+        x[j] += carry;
+        x[i] = 0;
+    }
+
+    carry = 0;
+
+    for (j = 0; j < 32; j++) {
+        x[j] += carry - (x[31] >> 4) * sc_L[j];
+        carry = x[j] >> 8;
+        x[j] &= 255;
+    }
+
+    for (j = 0; j < 32; j++)
+        x[j] -= carry * sc_L[j];
+
+    for (i = 0; i < 32; i++) {
+        x[i + 1] += x[i] >> 8;
+        r[i] = (uint8_t)(x[i] & 255);
+    }
+}
+
+/* Returns true if the little endian scalar s is below L */
+static bool sc_is_canonical(const uint8_t *s)
+{
+    int32_t borrow = 0;
+
+    /* Sign of s - L, computed over all bytes */
+    for (unsigned int i = 0; i < 32; i++)
+        borrow = ((int32_t)s[i] - (int32_t)sc_L[i] + borrow) >> 8;
+
+    return borrow != 0;
+}
+
+static int ed25519_key(const uint8_t *der_key, size_t key_length, const uint8_t **key)
+{
+    if (key_length == ED25519_KEY_LENGTH) {
+        *key = der_key;
+        return PB_OK;
+    }
+
+    if ((key_length == sizeof(ed25519_spki_prefix) + ED25519_KEY_LENGTH) &&
+        (memcmp(der_key, ed25519_spki_prefix, sizeof(ed25519_spki_prefix)) == 0)) {
+        *key = der_key + sizeof(ed25519_spki_prefix);
+        return PB_OK;
+    }
+
+    return -PB_ERR_PARAM;
+}
+
+/* The signed message is the digest computed by the caller, 'md_alg' selects
+ * how many bytes of 'md' that are used. Callers pass the digest in a buffer
+ * that fits the largest digest, like for ECDSA. With 'md_alg' set to zero
+ * all of 'md' is the message. */
+static int ed25519_message_length(hash_t md_alg, size_t md_length, size_t *length)
+{
+    size_t digest_length;
+
+    switch (md_alg) {
+    case 0:
+        digest_length = md_length;
+        break;
+    case HASH_SHA256:
+        digest_length = 32;
+        break;
+    case HASH_SHA384:
+        digest_length = 48;
+        break;
+    case HASH_SHA512:
+        digest_length = 64;
+        break;
+    default:
+        return -PB_ERR_PARAM;
+    }
+
+    if (digest_length > md_length)
+        return -PB_ERR_BUF_TOO_SMALL;
+
+    *length = digest_length;
+    return PB_OK;
+}
+
+
+static int ed25519_verify(const uint8_t *signature,
+                          size_t signature_length,
+                          const uint8_t *der_key,
+                          size_t key_length,
+                          hash_t md_alg,
+                          uint8_t *md,
+                          size_t md_length,
+                          bool *verified)
+{
+    int rc;
+    const uint8_t *key;
+    struct ge A;
+    struct ge R;
+    int64_t x[64];
+    uint8_t h[64];
+    uint8_t k[32];
+    uint8_t r_bytes[32];
+    uint8_t diff = 0;
+
+    *verified = false;
+
+    if (signature_length != ED25519_SIGNATURE_LENGTH)
+        return -PB_ERR_SIGNATURE;
+
+    rc = ed25519_message_length(md_alg, md_length, &md_length);
+
+    if (rc != PB_OK)
+        return rc;
+
+    rc = ed25519_key(der_key, key_length, &key);
+
+    if (rc != PB_OK)
+        return rc;
+
+    if (!sc_is_canonical(&signature[32]))
+        return -PB_ERR_SIGNATURE;
+
+    rc = ge_frombytes_negate(&A, key);
+
+    if (rc != PB_OK)
+        return rc;
+
+    /* k = SHA-512(R || A || M) mod L */
+    rc = hash_init_length(HASH_SHA512, 32 + ED25519_KEY_LENGTH + md_length);
+
+    if (rc != PB_OK)
+        return rc;
+
+    rc = hash_update(signature, 32);
+
+    if (rc != PB_OK)
+        return rc;
+
+    rc = hash_update(key, ED25519_KEY_LENGTH);
+
+    if (rc != PB_OK)
+        return rc;
+
+    rc = hash_update(md, md_length);
+
+    if (rc != PB_OK)
+        return rc;
+
+    rc = hash_final(h, sizeof(h));
+
+    if (rc != PB_OK)
+        return rc;
+
+    for (unsigned int i = 0; i < 64; i++)
+        x[i] = h[i];
+
+    sc_reduce(k, x);
+
+    /* R' = s * B - k * A, must encode to R */
+    ge_double_scalarmult(&R, &signature[32], &A, k);
+    ge_tobytes(r_bytes, &R);
+
+    for (unsigned int i = 0; i < sizeof(r_bytes); i++)
+        diff |= r_bytes[i] ^ signature[i];
+
+    if (diff != 0)
+        return -PB_ERR_SIGNATURE;
+
+    *verified = true;
+    return PB_OK;
+}
+
+#ifdef CONFIG_SELF_TEST
+/* RFC 8032, section 7.1 */
+static const uint8_t ed25519_test1_key[] = {
+    0xd7, 0x5a, 0x98, 0x01, 0x82, 0xb1, 0x0a, 0xb7, 0xd5, 0x4b, 0xfe, 0xd3, 0xc9, 0x64, 0x07, 0x3a,
+    0x0e, 0xe1, 0x72, 0xf3, 0xda, 0xa6, 0x23, 0x25, 0xaf, 0x02, 0x1a, 0x68, 0xf7, 0x07, 0x51, 0x1a,
+};
+
+static const uint8_t ed25519_test1_sig[] = {
+    0xe5, 0x56, 0x43, 0x00, 0xc3, 0x60, 0xac, 0x72, 0x90, 0x86, 0xe2, 0xcc, 0x80, 0x6e, 0x82, 0x8a,
+    0x84, 0x87, 0x7f, 0x1e, 0xb8, 0xe5, 0xd9, 0x74, 0xd8, 0x73, 0xe0, 0x65, 0x22, 0x49, 0x01, 0x55,
+    0x5f, 0xb8, 0x82, 0x15, 0x90, 0xa3, 0x3b, 0xac, 0xc6, 0x1e, 0x39, 0x70, 0x1c, 0xf9, 0xb4, 0x6b,
+    0xd2, 0x5b, 0xf5, 0xf0, 0x59, 0x5b, 0xbe, 0x24, 0x65, 0x51, 0x41, 0x43, 0x8e, 0x7a, 0x10, 0x0b,
+};
+
+static const uint8_t ed25519_test2_key[] = {
+    0x3d, 0x40, 0x17, 0xc3, 0xe8, 0x43, 0x89, 0x5a, 0x92, 0xb7, 0x0a, 0xa7, 0x4d, 0x1b, 0x7e, 0xbc,
+    0x9c, 0x98, 0x2c, 0xcf, 0x2e, 0xc4, 0x96, 0x8c, 0xc0, 0xcd, 0x55, 0xf1, 0x2a, 0xf4, 0x66, 0x0c,
+};
+
+static const uint8_t ed25519_test2_sig[] = {
+    0x92, 0xa0, 0x09, 0xa9, 0xf0, 0xd4, 0xca, 0xb8, 0x72, 0x0e, 0x82, 0x0b, 0x5f, 0x64, 0x25, 0x40,
+    0xa2, 0xb2, 0x7b, 0x54, 0x16, 0x50, 0x3f, 0x8f, 0xb3, 0x76, 0x22, 0x23, 0xeb, 0xdb, 0x69, 0xda,
+    0x08, 0x5a, 0xc1, 0xe4, 0x3e, 0x15, 0x99, 0x6e, 0x45, 0x8f, 0x36, 0x13, 0xd0, 0xf1, 0x1d, 0x8c,
+    0x38, 0x7b, 0x2e, 0xae, 0xb4, 0x30, 0x2a, 0xee, 0xb0, 0x0d, 0x29, 0x16, 0x12, 0xbb, 0x0c, 0x00,
+};
+
+static uint8_t ed25519_test2_msg[] = { 0x72 };
+
+DECLARE_SELF_TEST(ed25519_test_rfc8032_1)
+{
+    bool verified = false;
+    uint8_t msg[1] = { 0 };
+    unsigned int ts = plat_get_us_tick();
+    int rc = ed25519_verify(ed25519_test1_sig,
+                            sizeof(ed25519_test1_sig),
+                            ed25519_test1_key,
+                            sizeof(ed25519_test1_key),
+                            0,
+                            msg,
+                            0,
+                            &verified);
+
+    if (rc != PB_OK || !verified) {
+        LOG_ERR("Failed (%i)", rc);
+        return -1;
+    }
+
+    LOG_INFO("Verified in %u us", plat_get_us_tick() - ts);
+    return 0;
+}
+
+DECLARE_SELF_TEST(ed25519_test_rfc8032_2)
+{
+    bool verified = false;
+    int rc = ed25519_verify(ed25519_test2_sig,
+                            sizeof(ed25519_test2_sig),
+                            ed25519_test2_key,
+                            sizeof(ed25519_test2_key),
+                            0,
+                            ed25519_test2_msg,
+                            sizeof(ed25519_test2_msg),
+                            &verified);
+
+    if (rc != PB_OK || !verified) {
+        LOG_ERR("Failed (%i)", rc);
+        return -1;
+    }
+
+    return 0;
+}
+
+DECLARE_SELF_TEST(ed25519_test_bad_signature)
+{
+    bool verified = false;
+    uint8_t sig[ED25519_SIGNATURE_LENGTH];
+    uint8_t msg[] = { 0x73 };
+    int rc;
+
+    /* Wrong message */
+    rc = ed25519_verify(ed25519_test2_sig,
+                        sizeof(ed25519_test2_sig),
+                        ed25519_test2_key,
+                        sizeof(ed25519_test2_key),
+                        0,
+                        msg,
+                        sizeof(msg),
+                        &verified);
+
+    if (rc != -PB_ERR_SIGNATURE || verified) {
+        LOG_ERR("Wrong message accepted (%i)", rc);
+        return -1;
+    }
+
+    /* s + L, the same signature in a non-canonical form */
+    memcpy(sig, ed25519_test2_sig, sizeof(sig));
+
+    for (unsigned int i = 0, carry = 0; i < 32; i++) {
+        carry += sig[32 + i] + (unsigned int)sc_L[i];
+        sig[32 + i] = (uint8_t)carry;
+        carry >>= 8;
+    }
+
+    rc = ed25519_verify(sig,
+                        sizeof(sig),
+                        ed25519_test2_key,
+                        sizeof(ed25519_test2_key),
+                        0,
+                        ed25519_test2_msg,
+                        sizeof(ed25519_test2_msg),
+                        &verified);
+
+    if (rc != -PB_ERR_SIGNATURE || verified) {
+        LOG_ERR("Non-canonical s accepted (%i)", rc);
+        return -1;
+    }
+
+    return 0;
+}
+#endif // CONFIG_SELF_TEST
+
+int ed25519_pb_init(void)
+{
+    static const struct dsa_ops ed25519_ops = {
+        .name = "ed25519",
+        .alg_bits = DSA_ED25519,
+        .verify = ed25519_verify,
+    };
+
+    return dsa_add_ops(&ed25519_ops);
+}
@@ -1,3 +1,5 @@
 src-$(CONFIG_DRIVERS_IMX_CAAM) += src/drivers/crypto/caam/imx_caam.c
+src-$(CONFIG_DRIVERS_CRYPTO_ED25519) += src/drivers/crypto/ed25519/ed25519.c
+src-$(CONFIG_DRIVERS_CRYPTO_BLAKE3) += src/drivers/crypto/blake3/blake3_pb.c
 
 include src/drivers/crypto/mbedtls/makefile.mk
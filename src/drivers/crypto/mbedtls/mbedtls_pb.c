@@ -7,6 +7,7 @@
  *
  */
 
+#include <pb/arena.h>
 #include <pb/pb.h>
 #include <stddef.h>
 #include <stdlib.h>
@@ -23,6 +24,8 @@
 #include <mbedtls/version.h>
 #include <pb/crypto.h>
 
+#define MBEDTLS_PB_HEAP_SIZE (16 * 1024)
+
 static union {
 #if defined(CONFIG_MBEDTLS_MD_SHA256)
     mbedtls_sha256_context sha256;
@@ -142,6 +145,40 @@ static int mbedtls_hash_final(uint8_t *output, size_t size)
     return PB_OK;
 }
 
+static int mbedtls_hash_digest(
+    hash_t alg, const void *buf, size_t length, uint8_t *output, size_t size)
+{
+    int rc;
+
+    switch (alg) {
+#if defined(CONFIG_MBEDTLS_MD_SHA512)
+    case HASH_SHA512:
+        if (size < 64)
+            return -PB_ERR_BUF_TOO_SMALL;
+        rc = mbedtls_sha512((const unsigned char *)buf, length, output, 0);
+        break;
+#endif
+#if defined(CONFIG_MBEDTLS_MD_SHA384)
+    case HASH_SHA384:
+        if (size < 48)
+            return -PB_ERR_BUF_TOO_SMALL;
+        rc = mbedtls_sha512((const unsigned char *)buf, length, output, 1);
+        break;
+#endif
+#if defined(CONFIG_MBEDTLS_MD_SHA256)
+    case HASH_SHA256:
+        if (size < 32)
+            return -PB_ERR_BUF_TOO_SMALL;
+        rc = mbedtls_sha256((const unsigned char *)buf, length, output, 0);
+        break;
+#endif
+    default:
+        return -PB_ERR_NOT_SUPPORTED;
+    }
+
+    return (rc == 0) ? PB_OK : -PB_ERR;
+}
+
 #ifdef CONFIG_MBEDTLS_ECDSA
 static int mbed_ecda_verify(const uint8_t *der_signature,
                             size_t signature_length,
@@ -207,8 +244,15 @@ static int mbed_ecda_verify(const uint8_t *der_signature,
 int mbedtls_pb_init(void)
 {
     int rc;
-    static unsigned char heap[16 * 1024];
-    mbedtls_memory_buffer_alloc_init(heap, sizeof(heap));
+#ifdef CONFIG_ARENA
+    unsigned char *heap = arena_alloc(ARENA_CRYPTO, MBEDTLS_PB_HEAP_SIZE);
+
+    if (heap == NULL)
+        return -PB_ERR_MEM;
+#else
+    static unsigned char heap[MBEDTLS_PB_HEAP_SIZE];
+#endif
+    mbedtls_memory_buffer_alloc_init(heap, MBEDTLS_PB_HEAP_SIZE);
 
 #if defined(CONFIG_MBEDTLS_MD_SHA256) || defined(CONFIG_MBEDTLS_MD_SHA384) || \
     defined(CONFIG_MBEDTLS_MD_SHA512) || defined(CONFIG_MBEDTLS_MD_MD5)
@@ -231,6 +275,7 @@ int mbedtls_pb_init(void)
         .init = mbedtls_hash_init,
         .update = mbedtls_hash_update,
         .final = mbedtls_hash_final,
+        .digest = mbedtls_hash_digest,
     };
 
     rc = hash_add_ops(&mbed_ops);
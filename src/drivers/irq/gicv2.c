@@ -0,0 +1,127 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Minimal GICv2 driver. All interrupts are configured as group 0, level
+ * sensitive and are routed to the core that initialized the driver.
+ *
+ */
+
+#include <drivers/irq/gicv2.h>
+#include <inttypes.h>
+#include <pb/irq.h>
+#include <pb/mmio.h>
+#include <pb/pb.h>
+
+#define GICD_CTLR             0x000
+#define GICD_TYPER            0x004
+#define GICD_ISENABLER(n)     (0x100 + (n)*4)
+#define GICD_ICENABLER(n)     (0x180 + (n)*4)
+#define GICD_ICPENDR(n)       (0x280 + (n)*4)
+#define GICD_IPRIORITYR(n)    (0x400 + (n))
+#define GICD_ITARGETSR(n)     (0x800 + (n))
+
+#define GICC_CTLR             0x000
+#define GICC_PMR              0x004
+#define GICC_IAR              0x00c
+#define GICC_EOIR             0x010
+
+#define GICD_CTLR_ENABLE      BIT(0)
+#define GICC_CTLR_ENABLE      BIT(0)
+#define GICD_TYPER_LINES_MASK 0x1f
+#define GICC_IAR_ID_MASK      0x3ff
+#define GIC_ID_SPURIOUS       1020
+#define GIC_ID_SPI_START      32
+#define GIC_PRIORITY_DEFAULT  0xa0
+#define GIC_PRIORITY_MASK_ALL 0xff
+
+static struct {
+    uintptr_t gicd;
+    uintptr_t gicc;
+    unsigned int no_of_lines;
+    uint8_t cpu_mask;
+} gic;
+
+static int gicv2_enable(unsigned int irq)
+{
+    if (irq >= gic.no_of_lines)
+        return -PB_ERR_PARAM;
+
+    mmio_write_8(gic.gicd + GICD_IPRIORITYR(irq), GIC_PRIORITY_DEFAULT);
+
+    /* Target registers of SGI's and PPI's are read only */
+    if (irq >= GIC_ID_SPI_START)
+        mmio_write_8(gic.gicd + GICD_ITARGETSR(irq), gic.cpu_mask);
+
+    mmio_write_32(gic.gicd + GICD_ISENABLER(irq / 32), BIT(irq % 32));
+    return PB_OK;
+}
+
+static int gicv2_disable(unsigned int irq)
+{
+    if (irq >= gic.no_of_lines)
+        return -PB_ERR_PARAM;
+
+    mmio_write_32(gic.gicd + GICD_ICENABLER(irq / 32), BIT(irq % 32));
+    return PB_OK;
+}
+
+static void gicv2_dispatch(void)
+{
+    for (;;) {
+        uint32_t iar = mmio_read_32(gic.gicc + GICC_IAR);
+        unsigned int irq = iar & GICC_IAR_ID_MASK;
+
+        if (irq >= GIC_ID_SPURIOUS)
+            break;
+
+        irq_handle(irq);
+        mmio_write_32(gic.gicc + GICC_EOIR, iar);
+    }
+}
+
+static void gicv2_shutdown(void)
+{
+    for (unsigned int n = 0; n < (gic.no_of_lines / 32); n++)
+        mmio_write_32(gic.gicd + GICD_ICENABLER(n), 0xffffffff);
+
+    mmio_write_32(gic.gicc + GICC_CTLR, 0);
+    mmio_write_32(gic.gicd + GICD_CTLR, 0);
+}
+
+int gicv2_init(uintptr_t gicd_base, uintptr_t gicc_base)
+{
+    static const struct irq_controller_ops ops = {
+        .name = "gicv2",
+        .enable = gicv2_enable,
+        .disable = gicv2_disable,
+        .dispatch = gicv2_dispatch,
+        .shutdown = gicv2_shutdown,
+    };
+
+    gic.gicd = gicd_base;
+    gic.gicc = gicc_base;
+    gic.no_of_lines =
+        ((mmio_read_32(gic.gicd + GICD_TYPER) & GICD_TYPER_LINES_MASK) + 1) * 32;
+
+    /* The banked target register of SGI 0 reads as the mask of this core */
+    gic.cpu_mask = mmio_read_8(gic.gicd + GICD_ITARGETSR(0));
+
+    mmio_write_32(gic.gicd + GICD_CTLR, 0);
+
+    for (unsigned int n = 0; n < (gic.no_of_lines / 32); n++) {
+        mmio_write_32(gic.gicd + GICD_ICENABLER(n), 0xffffffff);
+        mmio_write_32(gic.gicd + GICD_ICPENDR(n), 0xffffffff);
+    }
+
+    mmio_write_32(gic.gicd + GICD_CTLR, GICD_CTLR_ENABLE);
+    mmio_write_32(gic.gicc + GICC_PMR, GIC_PRIORITY_MASK_ALL);
+    mmio_write_32(gic.gicc + GICC_CTLR, GICC_CTLR_ENABLE);
+
+    LOG_INFO("GICv2 @ 0x%" PRIxPTR ", %u lines", gic.gicd, gic.no_of_lines);
+
+    return irq_set_controller(&ops);
+}
@@ -0,0 +1 @@
+src-$(CONFIG_DRIVER_GICV2) += src/drivers/irq/gicv2.c
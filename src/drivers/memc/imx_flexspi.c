@@ -16,10 +16,12 @@
 #include <pb/pb.h>
 
 #include <drivers/memc/imx_flexspi.h>
+#include <drivers/memc/spi_nor.h>
 
 #include "imx_flexspi_private.h"
 
 static const struct flexspi_core_config *cfg;
+static struct spi_nor_device nor_devs[FLEXSPI_PORT_COUNT];
 
 static inline bool imx_flexspi_getbusidle(void)
 {
@@ -251,7 +253,7 @@ static int imx_flexspi_xfer(enum flexspi_port port,
 }
 
 // TODO: Timeout?
-static int imx_flexspi_busy_wait(struct flexspi_nor_config *cfg_nor, int polling_time_us)
+static int imx_flexspi_busy_wait(const struct flexspi_nor_config *cfg_nor, int polling_time_us)
 {
     int rc;
     uint8_t sts[4];
@@ -270,10 +272,13 @@ static int imx_flexspi_busy_wait(struct flexspi_nor_config *cfg_nor, int polling
     return PB_OK;
 }
 
-static int
-imx_flexspi_pp(struct flexspi_nor_config *cfg_nor, uint32_t address, uint8_t *data, size_t size)
+static int imx_flexspi_pp(const struct spi_nor_device *dev,
+                          uint32_t address,
+                          const void *data,
+                          size_t size)
 {
     int rc = 0;
+    const struct flexspi_nor_config *cfg_nor = (const struct flexspi_nor_config *)dev->priv;
     uint32_t bytes_to_next_page_boundry =
         (uint32_t)cfg_nor->page_size - (address & (uint32_t)(cfg_nor->page_size - 1));
 
@@ -296,118 +301,52 @@ imx_flexspi_pp(struct flexspi_nor_config *cfg_nor, uint32_t address, uint8_t *da
     if (rc != PB_OK)
         return rc;
 
-    if (rc != 0) {
-        LOG_ERR("Page program failed at address 0x%x, status: %i\n", address, rc);
-        return rc;
-    }
-
     return imx_flexspi_busy_wait(cfg_nor, cfg_nor->time_page_program_ms);
 }
 
-static int imx_flexspi_read(bio_dev_t dev, lba_t lba, size_t length, void *buf)
+static int
+imx_flexspi_read(const struct spi_nor_device *dev, uint32_t address, void *buf, size_t length)
 {
-    uint8_t *buffer = (uint8_t *)buf;
-    uint32_t address = lba * bio_block_size(dev);
-    struct flexspi_nor_config *cfg_nor = (struct flexspi_nor_config *)bio_get_private(dev);
+    const struct flexspi_nor_config *cfg_nor = (const struct flexspi_nor_config *)dev->priv;
 
     imx_flexspi_busy_wait(cfg_nor, 100);
 
     return imx_flexspi_xfer(
-        cfg_nor->port, cfg_nor->lut_id_read, address, FLEXSPI_READ, buffer, length);
+        cfg_nor->port, cfg_nor->lut_id_read, address, FLEXSPI_READ, buf, length);
 }
 
-static int imx_flexspi_write(bio_dev_t dev, lba_t lba, size_t length, const void *buf)
-{
-    int rc = 0;
-    struct flexspi_nor_config *cfg_nor = (struct flexspi_nor_config *)bio_get_private(dev);
-    uint8_t *buffer = (uint8_t *)buf;
-    uint32_t address = lba * bio_block_size(dev);
-    uint32_t bytes_to_next_page_boundry =
-        (uint32_t)cfg_nor->page_size - (address & (uint32_t)(cfg_nor->page_size - 1));
-
-    LOG_DBG("Write buffer to flash at address: 0x%x, size: 0x%x", address, length);
-
-    if ((bytes_to_next_page_boundry < cfg_nor->page_size) &&
-        (length > bytes_to_next_page_boundry)) {
-        rc = imx_flexspi_pp(cfg_nor, address, buffer, bytes_to_next_page_boundry);
-        if (rc != PB_OK)
-            return rc;
-
-        buffer += bytes_to_next_page_boundry;
-        address += bytes_to_next_page_boundry;
-        length -= bytes_to_next_page_boundry;
-    }
-
-    while (length > cfg_nor->page_size) {
-        rc = imx_flexspi_pp(cfg_nor, address, buffer, cfg_nor->page_size);
-        if (rc != PB_OK)
-            return rc;
-
-        buffer += cfg_nor->page_size;
-        address += cfg_nor->page_size;
-        length -= cfg_nor->page_size;
-    }
-
-    if (length > 0) {
-        rc = imx_flexspi_pp(cfg_nor, address, buffer, length);
-    }
-
-    return rc;
-}
-
-static int imx_flexspi_erase_part(bio_dev_t dev, lba_t first_lba, size_t count)
+static int
+imx_flexspi_erase(const struct spi_nor_device *dev, uint32_t address, unsigned int erase_idx)
 {
     int rc;
-    struct flexspi_nor_config *cfg_nor = (struct flexspi_nor_config *)bio_get_private(dev);
-    uint32_t addr;
-    uint32_t part_start_addr = (uint32_t)first_lba * bio_block_size(dev);
-    size_t bytes_to_erase = count * bio_block_size(dev);
-    size_t bytes_erased = 0;
-    /* We select the largest erase block to begin with */
-    uint8_t lut_id = cfg_nor->erase_cmds[0].lut_id;
-    size_t erase_block_sz = cfg_nor->erase_cmds[0].block_size;
-    unsigned int erase_time_ms = cfg_nor->erase_cmds[0].erase_time_ms;
-
-    if (!erase_block_sz) {
-        return -PB_ERR_IO;
-    }
+    const struct flexspi_nor_config *cfg_nor = (const struct flexspi_nor_config *)dev->priv;
+    const struct flexspi_nor_erase_cmds *erase_cmd = &cfg_nor->erase_cmds[erase_idx];
 
-    while (bytes_to_erase) {
-        /* The current erase block size is larger than the remaining bytes
-         * we want to erase, search for a smaller erase block
-         */
-        if (bytes_to_erase < erase_block_sz) {
-            LOG_DBG("Switching to smaller erase block");
-            for (unsigned int i = 0; cfg_nor->erase_cmds[i].lut_id; i++) {
-                if (bytes_to_erase >= cfg_nor->erase_cmds[i].block_size) {
-                    lut_id = cfg_nor->erase_cmds[i].lut_id;
-                    erase_block_sz = cfg_nor->erase_cmds[i].block_size;
-                    erase_time_ms = cfg_nor->erase_cmds[i].erase_time_ms;
-                    break;
-                }
-            }
-        }
-
-        addr = part_start_addr + bytes_erased;
-        LOG_DBG("Erasing addr=0x%08x, block_sz=%u, lut_id=%u", addr, erase_block_sz, lut_id);
+    /* Write enable */
+    rc = imx_flexspi_xfer(cfg_nor->port, cfg_nor->lut_id_wr_enable, 0, FLEXSPI_COMMAND, NULL, 0);
 
-        /* Write enable */
-        imx_flexspi_xfer(cfg_nor->port, cfg_nor->lut_id_wr_enable, 0, FLEXSPI_COMMAND, NULL, 0);
+    if (rc != 0)
+        return rc;
 
-        rc = imx_flexspi_xfer(cfg_nor->port, lut_id, addr, FLEXSPI_COMMAND, NULL, 0);
+    rc = imx_flexspi_xfer(cfg_nor->port, erase_cmd->lut_id, address, FLEXSPI_COMMAND, NULL, 0);
 
-        if (rc != 0)
-            return rc;
+    if (rc != 0)
+        return rc;
 
-        imx_flexspi_busy_wait(cfg_nor, erase_time_ms);
+    rc = imx_flexspi_busy_wait(cfg_nor, erase_cmd->erase_time_ms);
 
-        bytes_erased += erase_block_sz;
-        bytes_to_erase -= (erase_block_sz > bytes_to_erase) ? bytes_to_erase : erase_block_sz;
-    }
+    if (rc != 0)
+        return rc;
 
     return imx_flexspi_xfer(cfg_nor->port, cfg_nor->lut_id_wr_disable, 0, FLEXSPI_COMMAND, NULL, 0);
 }
 
+static const struct spi_nor_hal imx_flexspi_nor_hal = {
+    .read = imx_flexspi_read,
+    .page_program = imx_flexspi_pp,
+    .erase = imx_flexspi_erase,
+};
+
 static void imx_flexspi_config_lut(void)
 {
     /* Wait for bus idle before change flash configuration. */
@@ -442,7 +381,7 @@ static int imx_flexspi_mem_config(const struct flexspi_nor_config *nor_config)
     return PB_OK;
 }
 
-static int imx_flexspi_mem_probe(const struct flexspi_nor_config *nor_config)
+static int imx_flexspi_mem_probe(unsigned int index, const struct flexspi_nor_config *nor_config)
 {
     int rc;
     uint8_t cmd_buf[4];
@@ -464,29 +403,26 @@ static int imx_flexspi_mem_probe(const struct flexspi_nor_config *nor_config)
         return -PB_ERR_NOT_FOUND;
     }
 
-    bio_dev_t d = bio_allocate(0,
-                               nor_config->capacity / nor_config->block_size - 1,
-                               nor_config->block_size,
-                               nor_config->uuid,
-                               nor_config->name);
-
-    if (d < 0)
-        return d;
-
-    bio_set_flags(d, BIO_FLAG_WRITABLE | BIO_FLAG_VISIBLE | BIO_FLAG_ERASE_BEFORE_WRITE);
-
-    rc = bio_set_ios(d, imx_flexspi_read, imx_flexspi_write);
-
-    if (rc != 0)
-        return rc;
-
-    rc = bio_set_ios_erase(d, imx_flexspi_erase_part);
+    struct spi_nor_device *nor = &nor_devs[index];
+
+    nor->name = nor_config->name;
+    nor->uuid = nor_config->uuid;
+    nor->capacity = nor_config->capacity;
+    nor->block_size = nor_config->block_size;
+    nor->page_size = nor_config->page_size;
+    nor->hal = &imx_flexspi_nor_hal;
+    nor->priv = (uintptr_t)nor_config;
+
+    /* Note: Erase commands must be sorted in descending block size order */
+    for (unsigned int i = 0; i < ARRAY_SIZE(nor_config->erase_cmds); i++) {
+        if (nor_config->erase_cmds[i].lut_id == 0)
+            break;
+        nor->erase_sizes[i] = nor_config->erase_cmds[i].block_size;
+    }
 
-    if (rc != 0)
-        return rc;
+    bio_dev_t d = spi_nor_init(nor);
 
-    rc = bio_set_private(d, (uintptr_t)nor_config);
-    return PB_OK;
+    return (d < 0) ? d : PB_OK;
 }
 
 /*
@@ -564,6 +500,9 @@ int imx_flexspi_init(const struct flexspi_core_config *config)
     mmio_write_32(cfg->base + FLEXSPI_DLLACR, cfg->dllacr);
     mmio_write_32(cfg->base + FLEXSPI_DLLBCR, cfg->dllbcr);
 
+    if (cfg->mem_length > ARRAY_SIZE(nor_devs))
+        return -PB_ERR_PARAM;
+
     /* Configure memories */
     for (unsigned int i = 0; i < cfg->mem_length; i++) {
         if (cfg->mem[i]->capacity % cfg->mem[i]->block_size != 0)
@@ -599,7 +538,7 @@ int imx_flexspi_init(const struct flexspi_core_config *config)
 
     /* Probe memories */
     for (unsigned int i = 0; i < cfg->mem_length; i++) {
-        rc = imx_flexspi_mem_probe(cfg->mem[i]);
+        rc = imx_flexspi_mem_probe(i, cfg->mem[i]);
 
         if (rc != 0)
             return rc;
@@ -1 +1,2 @@
+src-$(CONFIG_SPI_NOR_CORE) += src/drivers/memc/spi_nor.c
 src-$(CONFIG_IMX_FLEXSPI)  += src/drivers/memc/imx_flexspi.c
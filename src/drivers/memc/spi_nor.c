@@ -0,0 +1,311 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <drivers/memc/spi_nor.h>
+#include <pb/bio.h>
+#include <pb/errors.h>
+#include <pb/pb.h>
+#include <string.h>
+
+/* Holds the current flash contents of one page, or one chunk of an erase
+ * block during blank checks. */
+static uint8_t nor_buf[SPI_NOR_MAX_PAGE_SIZE] __aligned(4);
+/* Copy of an erase block that is rewritten */
+static uint8_t nor_block_buf[SPI_NOR_MAX_REWRITE_SIZE] __aligned(4);
+
+static bool spi_nor_is_blank(const uint8_t *buf, size_t length)
+{
+    const uint32_t *p = (const uint32_t *)buf;
+
+    for (size_t i = 0; i < (length / 4); i++) {
+        if (p[i] != 0xffffffff)
+            return false;
+    }
+
+    for (size_t i = length & ~3; i < length; i++) {
+        if (buf[i] != 0xff)
+            return false;
+    }
+
+    return true;
+}
+
+static int spi_nor_block_is_blank(struct spi_nor_device *nor, uint32_t address, size_t length)
+{
+    int rc;
+
+    while (length > 0) {
+        size_t chunk = (length > sizeof(nor_buf)) ? sizeof(nor_buf) : length;
+
+        rc = nor->hal->read(nor, address, nor_buf, chunk);
+
+        if (rc != PB_OK)
+            return rc;
+
+        if (!spi_nor_is_blank(nor_buf, chunk))
+            return 0;
+
+        address += chunk;
+        length -= chunk;
+    }
+
+    return 1;
+}
+
+static int spi_nor_read(bio_dev_t dev, lba_t lba, size_t length, void *buf)
+{
+    struct spi_nor_device *nor = (struct spi_nor_device *)bio_get_private(dev);
+
+    return nor->hal->read(nor, lba * nor->block_size, buf, length);
+}
+
+/* True if programming 'data' over 'old' gives 'data', programming can only
+ * clear bits. */
+static bool spi_nor_can_program(const uint8_t *old, const uint8_t *data, size_t length)
+{
+    for (size_t i = 0; i < length; i++) {
+        if ((old[i] & data[i]) != data[i])
+            return false;
+    }
+
+    return true;
+}
+
+/* Read-modify-erase-write of the smallest erase block that holds 'address'.
+ * The data from 'address' up to the end of that block is merged, the number
+ * of bytes taken from 'data' is returned in 'consumed'. */
+static int spi_nor_rewrite_block(struct spi_nor_device *nor,
+                                 uint32_t address,
+                                 const uint8_t *data,
+                                 size_t length,
+                                 size_t *consumed)
+{
+    int rc;
+    unsigned int idx = 0;
+    size_t erase_sz;
+    uint32_t base;
+    size_t offset;
+
+    while (((idx + 1) < SPI_NOR_MAX_ERASE_CMDS) && nor->erase_sizes[idx + 1])
+        idx++;
+
+    erase_sz = nor->erase_sizes[idx];
+
+    if (erase_sz > sizeof(nor_block_buf)) {
+        LOG_ERR("Page at 0x%x must be erased, the %zu byte erase block is too large",
+                address,
+                erase_sz);
+        return -PB_ERR_NOT_SUPPORTED;
+    }
+
+    base = address - (address % erase_sz);
+    offset = address - base;
+    *consumed = erase_sz - offset;
+
+    if (*consumed > length)
+        *consumed = length;
+
+    rc = nor->hal->read(nor, base, nor_block_buf, erase_sz);
+
+    if (rc != PB_OK)
+        return rc;
+
+    memcpy(&nor_block_buf[offset], data, *consumed);
+
+    LOG_DBG("Rewriting addr=0x%08x, block_sz=%zu", base, erase_sz);
+
+    rc = nor->hal->erase(nor, base, idx);
+
+    if (rc != PB_OK) {
+        LOG_ERR("Erase failed at address 0x%x (%i)", base, rc);
+        return rc;
+    }
+
+    nor->stats.blocks_erased++;
+    nor->stats.blocks_rewritten++;
+
+    for (uint32_t i = 0; i < erase_sz; i += nor->page_size) {
+        if (spi_nor_is_blank(&nor_block_buf[i], nor->page_size)) {
+            nor->stats.pages_skipped++;
+            continue;
+        }
+
+        rc = nor->hal->page_program(nor, base + i, &nor_block_buf[i], nor->page_size);
+
+        if (rc != PB_OK) {
+            LOG_ERR("Page program failed at address 0x%x (%i)", base + i, rc);
+            return rc;
+        }
+
+        nor->stats.pages_programmed++;
+    }
+
+    return PB_OK;
+}
+
+/* Programs one page, unless it already holds the data. When the data needs
+ * a bit to go from 0 to 1 the containing erase block is rewritten instead,
+ * 'consumed' is the number of bytes from 'data' that were written. */
+static int spi_nor_program_page(struct spi_nor_device *nor,
+                                uint32_t address,
+                                const uint8_t *data,
+                                size_t length,
+                                size_t *consumed)
+{
+    int rc;
+
+    *consumed = length;
+
+    /* The controller may transfer whole words, page_size is a multiple of 4 */
+    rc = nor->hal->read(nor, address, nor_buf, (length + 3) & ~3);
+
+    if (rc != PB_OK)
+        return rc;
+
+    if (memcmp(nor_buf, data, length) == 0) {
+        nor->stats.pages_skipped++;
+        return PB_OK;
+    }
+
+    if (!spi_nor_can_program(nor_buf, data, length))
+        return spi_nor_rewrite_block(nor, address, data, length, consumed);
+
+    rc = nor->hal->page_program(nor, address, data, length);
+
+    if (rc != PB_OK) {
+        LOG_ERR("Page program failed at address 0x%x (%i)", address, rc);
+        return rc;
+    }
+
+    nor->stats.pages_programmed++;
+    return PB_OK;
+}
+
+static int spi_nor_write(bio_dev_t dev, lba_t lba, size_t length, const void *buf)
+{
+    int rc;
+    struct spi_nor_device *nor = (struct spi_nor_device *)bio_get_private(dev);
+    const uint8_t *p = (const uint8_t *)buf;
+    uint32_t address = lba * nor->block_size;
+
+    LOG_DBG("Write buffer to flash at address: 0x%x, size: 0x%zx", address, length);
+
+    while (length > 0) {
+        /* Up to the next page boundary */
+        size_t chunk = nor->page_size - (address & (nor->page_size - 1));
+
+        if (chunk > length)
+            chunk = length;
+
+        rc = spi_nor_program_page(nor, address, p, chunk, &chunk);
+
+        if (rc != PB_OK)
+            return rc;
+
+        p += chunk;
+        address += chunk;
+        length -= chunk;
+    }
+
+    return PB_OK;
+}
+
+static int spi_nor_erase_part(bio_dev_t dev, lba_t first_lba, size_t count)
+{
+    int rc;
+    struct spi_nor_device *nor = (struct spi_nor_device *)bio_get_private(dev);
+    uint32_t address = first_lba * nor->block_size;
+    uint32_t end = address + count * nor->block_size;
+
+    while (address < end) {
+        unsigned int idx;
+        size_t erase_sz = 0;
+
+        /* Largest erase block that is aligned to the address and that does
+         * not extend past the end of the range */
+        for (idx = 0; idx < SPI_NOR_MAX_ERASE_CMDS && nor->erase_sizes[idx]; idx++) {
+            if (((address % nor->erase_sizes[idx]) == 0) &&
+                (nor->erase_sizes[idx] <= (end - address))) {
+                erase_sz = nor->erase_sizes[idx];
+                break;
+            }
+        }
+
+        if (erase_sz == 0) {
+            LOG_ERR("No erase block fits address 0x%x", address);
+            return -PB_ERR_ALIGN;
+        }
+
+        rc = spi_nor_block_is_blank(nor, address, erase_sz);
+
+        if (rc < 0)
+            return rc;
+
+        if (rc == 1) {
+            nor->stats.blocks_skipped++;
+        } else {
+            LOG_DBG("Erasing addr=0x%08x, block_sz=%zu", address, erase_sz);
+
+            rc = nor->hal->erase(nor, address, idx);
+
+            if (rc != PB_OK) {
+                LOG_ERR("Erase failed at address 0x%x (%i)", address, rc);
+                return rc;
+            }
+
+            nor->stats.blocks_erased++;
+        }
+
+        address += erase_sz;
+    }
+
+    return PB_OK;
+}
+
+bio_dev_t spi_nor_init(struct spi_nor_device *nor)
+{
+    int rc;
+    size_t smallest_erase_sz = 0;
+
+    if ((nor->page_size == 0) || (nor->page_size > SPI_NOR_MAX_PAGE_SIZE) ||
+        (nor->page_size & (nor->page_size - 1)) || (nor->page_size % 4))
+        return -PB_ERR_PARAM;
+
+    for (unsigned int i = 0; i < SPI_NOR_MAX_ERASE_CMDS && nor->erase_sizes[i]; i++)
+        smallest_erase_sz = nor->erase_sizes[i];
+
+    if ((smallest_erase_sz == 0) || (nor->block_size % smallest_erase_sz) ||
+        (nor->capacity % nor->block_size))
+        return -PB_ERR_PARAM;
+
+    bio_dev_t d =
+        bio_allocate(0, nor->capacity / nor->block_size - 1, nor->block_size, nor->uuid, nor->name);
+
+    if (d < 0)
+        return d;
+
+    bio_set_flags(d, BIO_FLAG_WRITABLE | BIO_FLAG_VISIBLE | BIO_FLAG_ERASE_BEFORE_WRITE);
+
+    rc = bio_set_ios(d, spi_nor_read, spi_nor_write);
+
+    if (rc != 0)
+        return rc;
+
+    rc = bio_set_ios_erase(d, spi_nor_erase_part);
+
+    if (rc != 0)
+        return rc;
+
+    rc = bio_set_private(d, (uintptr_t)nor);
+
+    if (rc != 0)
+        return rc;
+
+    return d;
+}
@@ -8,6 +8,7 @@
  */
 
 #include <arch/arch.h>
+#include <pb/arena.h>
 #include <pb/delay.h>
 #include <pb/mmio.h>
 #include <pb/pb.h>
@@ -20,8 +21,14 @@
 
 static const struct imx_usdhc_config *usdhc;
 static unsigned int input_clock_hz;
-static struct usdhc_adma2_desc tbl[512] __section(".no_init") __aligned(64);
+#ifdef CONFIG_ARENA
+static struct usdhc_adma2_desc (*tbl)[ADMA2_TBL_ENTRIES];
+#else
+static struct usdhc_adma2_desc tbl[ADMA2_NO_OF_TBLS][ADMA2_TBL_ENTRIES] __section(".no_init")
+__aligned(64);
+#endif
 static bool bus_ddr_enable = false;
+static bool block_count_set = false;
 
 static int imx_usdhc_set_bus_clock(unsigned int clk_hz)
 {
@@ -162,9 +169,13 @@ static int imx_usdhc_send_cmd(uint16_t idx, uint32_t arg, uint16_t resp_type, mm
     if (multiple) {
         mixctl |= MIXCTRL_MSBSEL;
         mixctl |= MIXCTRL_BCEN;
-        mixctl |= MIXCTRL_AC12EN;
+        /* The card stops by itself after a pre-defined block count (CMD23) */
+        if (!block_count_set)
+            mixctl |= MIXCTRL_AC12EN;
     }
 
+    block_count_set = (idx == MMC_CMD_SET_BLOCK_COUNT);
+
     if (data) {
         xfertype |= XFERTYPE_DPSEL;
         mixctl |= MIXCTRL_DMAEN;
@@ -297,60 +308,95 @@ static int imx_usdhc_set_bus_width(enum mmc_bus_width width)
     return 0;
 }
 
-static int imx_usdhc_prepare(unsigned int lba, size_t length, uintptr_t buf)
+static int imx_usdhc_prepare_sg(unsigned int lba,
+                                const struct bio_segment *segs,
+                                unsigned int no_of_segs)
 {
-    struct usdhc_adma2_desc *tbl_ptr = tbl;
-    uintptr_t buf_ptr = buf;
-    size_t bytes_to_transfer = length;
+    struct usdhc_adma2_desc *tbl_ptr = tbl[0];
+    unsigned int tbl_idx = 0;
+    unsigned int tbl_entry = 0;
+    size_t length = 0;
+    size_t bytes_left;
     size_t chunk_length;
     size_t n_descriptors = 0;
 
+    for (unsigned int i = 0; i < no_of_segs; i++)
+        length += segs[i].length;
+
+    bytes_left = length;
+
     /* For now we don't support transfers of more than 512*0xffff bytes.
      * This is because we set block size 512 in BLK_ATT which limits the block
      * count portion of the register to 0xffff.
      *
-     * Another hard limitation on transfer size is the number of allocated
-     * adma2 descriptors, which is now 512, which translates to ~32 MByte.
-     *
+     * The adma2 descriptors are split into ADMA2_NO_OF_TBLS tables that
+     * are chained with link descriptors, which is enough for the
+     * maximum block count. Each segment starts a new descriptor.
      * */
     if ((length / 512) > 0xffff) {
         return -PB_ERR_IO;
     }
 
 #ifdef CONFIG_IMX_USDHC_XTRA_DEBUG
-    LOG_DBG("lba = %d, length = %zu, buf = %p", lba, length, (void *)buf);
+    LOG_DBG("lba = %d, length = %zu, segments = %u", lba, length, no_of_segs);
 #endif
 
-    if (buf && length) {
-        arch_clean_cache_range(buf, length);
-    }
+    for (unsigned int i = 0; i < no_of_segs; i++) {
+        uintptr_t buf_ptr = (uintptr_t)segs[i].buf;
+        size_t bytes_to_transfer = segs[i].length;
 
-    do {
-        if (bytes_to_transfer > ADMA2_MAX_BYTES_PER_DESC)
-            chunk_length = ADMA2_MAX_BYTES_PER_DESC;
-        else
-            chunk_length = bytes_to_transfer;
+        if (buf_ptr && bytes_to_transfer) {
+            arch_clean_cache_range(buf_ptr, bytes_to_transfer);
+        }
 
-        bytes_to_transfer -= chunk_length;
+        while (bytes_to_transfer) {
+            /* Chain to the next table when reaching the last entry */
+            if (tbl_entry == (ADMA2_TBL_ENTRIES - 1)) {
+                if (++tbl_idx == ADMA2_NO_OF_TBLS)
+                    return -PB_ERR_IO;
+
+                tbl_ptr->len = 0;
+                tbl_ptr->cmd = ADMA2_LINK_VALID;
+                tbl_ptr->addr = (uint32_t)(uintptr_t)tbl[tbl_idx];
+                tbl_ptr = tbl[tbl_idx];
+                tbl_entry = 0;
+                n_descriptors++;
+            }
 
-        tbl_ptr->len = chunk_length;
-        tbl_ptr->cmd = ADMA2_TRAN_VALID;
-        tbl_ptr->addr = (uint32_t)buf_ptr;
+            if (bytes_to_transfer > ADMA2_MAX_BYTES_PER_DESC)
+                chunk_length = ADMA2_MAX_BYTES_PER_DESC;
+            else
+                chunk_length = bytes_to_transfer;
 
-        if (!bytes_to_transfer)
-            tbl_ptr->cmd |= ADMA2_END;
+            bytes_to_transfer -= chunk_length;
+            bytes_left -= chunk_length;
 
-        buf_ptr += chunk_length;
-        tbl_ptr++;
-        n_descriptors++;
-    } while (bytes_to_transfer);
+            tbl_ptr->len = chunk_length;
+            tbl_ptr->cmd = ADMA2_TRAN_VALID;
+            tbl_ptr->addr = (uint32_t)buf_ptr;
 
-    arch_clean_cache_range((uintptr_t)tbl, sizeof(struct usdhc_adma2_desc) * n_descriptors);
+            if (!bytes_left)
+                tbl_ptr->cmd |= ADMA2_END;
+
+            buf_ptr += chunk_length;
+            tbl_ptr++;
+            tbl_entry++;
+            n_descriptors++;
+        }
+    }
+
+    if (n_descriptors == 0)
+        return -PB_ERR_PARAM;
+
+    for (unsigned int i = 0; i <= tbl_idx; i++) {
+        size_t entries = (i == tbl_idx) ? tbl_entry : ADMA2_TBL_ENTRIES;
+        arch_clean_cache_range((uintptr_t)tbl[i], sizeof(struct usdhc_adma2_desc) * entries);
+    }
 
 #ifdef CONFIG_IMX_USDHC_XTRA_DEBUG
     LOG_DBG("Configured %zu adma2 descriptors", n_descriptors);
 #endif
-    mmio_write_32(usdhc->base + USDHC_ADMA_SYS_ADDR, (uint32_t)(uintptr_t)tbl);
+    mmio_write_32(usdhc->base + USDHC_ADMA_SYS_ADDR, (uint32_t)(uintptr_t)tbl[0]);
 
     if (length > 512) {
         mmio_write_32(usdhc->base + USDHC_BLK_ATT, 0x00000200 | ((length / 512) << 16));
@@ -361,6 +407,16 @@ static int imx_usdhc_prepare(unsigned int lba, size_t length, uintptr_t buf)
     return 0;
 }
 
+static int imx_usdhc_prepare(unsigned int lba, size_t length, uintptr_t buf)
+{
+    const struct bio_segment seg = {
+        .buf = (void *)buf,
+        .length = length,
+    };
+
+    return imx_usdhc_prepare_sg(lba, &seg, 1);
+}
+
 static int imx_usdhc_read(unsigned int lba, size_t length, uintptr_t buf)
 {
     /* All transfers are performed with ADMA2 */
@@ -376,6 +432,23 @@ static int imx_usdhc_write(unsigned int lba, size_t length, uintptr_t buf)
     return 0;
 }
 
+/* The card holds DAT0 low while it programs the written blocks */
+static int imx_usdhc_wait_busy(unsigned int timeout_ms)
+{
+    struct pb_timeout timeout;
+
+    pb_timeout_init_us(&timeout, timeout_ms * 1000);
+
+    while (!(mmio_read_32(usdhc->base + PSTATE) & PSTATE_DAT0)) {
+        if (pb_timeout_has_expired(&timeout)) {
+            LOG_ERR("DAT0 busy timeout");
+            return -PB_ERR_TIMEOUT;
+        }
+    }
+
+    return PB_OK;
+}
+
 int imx_usdhc_init(const struct imx_usdhc_config *cfg, unsigned int clk_hz)
 {
     static const struct mmc_hal hal = {
@@ -384,12 +457,23 @@ int imx_usdhc_init(const struct imx_usdhc_config *cfg, unsigned int clk_hz)
         .set_bus_clock = imx_usdhc_set_bus_clock,
         .set_bus_width = imx_usdhc_set_bus_width,
         .prepare = imx_usdhc_prepare,
+        .prepare_sg = imx_usdhc_prepare_sg,
         .read = imx_usdhc_read,
         .write = imx_usdhc_write,
         .set_delay_tap = imx_usdhc_set_delay_tap,
-        .max_chunk_bytes = SZ_MiB(30),
+        .wait_busy = imx_usdhc_wait_busy,
+        .max_chunk_bytes = 0xffff * 512,
     };
 
+#ifdef CONFIG_ARENA
+    if (tbl == NULL) {
+        tbl = arena_alloc_aligned(ARENA_DRIVERS, sizeof(*tbl) * ADMA2_NO_OF_TBLS, 64);
+
+        if (tbl == NULL)
+            return -PB_ERR_MEM;
+    }
+#endif
+
     usdhc = cfg;
     input_clock_hz = clk_hz;
 
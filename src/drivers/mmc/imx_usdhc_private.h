@@ -165,7 +165,10 @@ struct usdhc_adma2_desc {
 } __attribute__((packed));
 
 #define ADMA2_TRAN_VALID         0x21
+#define ADMA2_LINK_VALID         0x31
 #define ADMA2_NOP_END_VALID      0x3
 #define ADMA2_END                0x2
 #define ADMA2_MAX_BYTES_PER_DESC 65024
+#define ADMA2_TBL_ENTRIES        512
+#define ADMA2_NO_OF_TBLS         2
 #endif
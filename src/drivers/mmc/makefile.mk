@@ -1,2 +1,3 @@
 src-$(CONFIG_MMC_CORE)  += src/drivers/mmc/mmc_core.c
+src-$(CONFIG_MMC_RAM)   += src/drivers/mmc/mmc_ram.c
 src-$(CONFIG_IMX_USDHC) += src/drivers/mmc/imx_usdhc.c
@@ -40,6 +40,7 @@ static enum mmc_part mmc_current_part;
 static unsigned int power_off_long_time_ms = 2550;
 static unsigned int generic_cmd6_time_ms = 2550;
 static unsigned int partition_switch_time_ms = 2550;
+static mmc_cmd_resp_t mmc_cid;
 
 #ifdef CONFIG_MMC_CORE_HS200_TUNE
 static uint8_t mmc_tuning_rsp[128] __aligned(16);
@@ -275,6 +276,100 @@ static int mmc_set_bus_width(enum mmc_bus_width bus_width)
     return mmc_hal->set_bus_width(bus_width);
 }
 
+/* Commands carry a 32-bit block address, the whole range must fit */
+static bool mmc_lba_range_valid(lba_t lba, size_t length)
+{
+    lba_t last = lba + ((length > 0) ? (length - 1) / MMC_BLOCK_SIZE : 0);
+
+    return last <= UINT32_MAX;
+}
+
+#ifdef CONFIG_MMC_CORE_STREAM_XFER
+static int mmc_wait_tran(void)
+{
+    int rc;
+
+    do {
+        rc = mmc_device_state(MMC_DEFAULT_TIMEOUT_ms);
+        if (rc < 0)
+            return rc;
+    } while (rc != MMC_STATE_TRAN);
+
+    return PB_OK;
+}
+
+/*
+ * Streaming transfers use pre-defined block counts (CMD23). The card
+ * returns to TRAN by itself when the last block of a chunk has been
+ * transferred, so there is no need for CMD12 or for polling the card
+ * status between chunks when reading. Writes have to wait for the card to
+ * leave the PRG state before the next CMD23 can be issued. The card holds
+ * DAT0 low until then, HALs that can sample DAT0 wait for it instead of
+ * polling with CMD13.
+ */
+static int mmc_stream_xfer(lba_t lba, size_t length, uintptr_t buf, bool write)
+{
+    int rc = PB_OK;
+    size_t max_len = mmc_hal->max_chunk_bytes;
+    size_t bytes_left = length;
+    unsigned int lba_offset = lba;
+    uintptr_t buf_ptr = buf;
+
+    if (!mmc_lba_range_valid(lba, length))
+        return -PB_ERR_PARAM;
+
+    while (bytes_left) {
+        size_t chunk_len = (max_len && bytes_left > max_len) ? max_len : bytes_left;
+        size_t blocks = chunk_len / MMC_BLOCK_SIZE;
+
+        if (blocks > 0xffff)
+            return -PB_ERR_IO;
+
+        rc = mmc_hal->prepare(lba_offset, chunk_len, buf_ptr);
+        if (rc != 0)
+            return rc;
+
+        rc = mmc_send_cmd(MMC_CMD_SET_BLOCK_COUNT, blocks, MMC_RSP_R1, NULL);
+        if (rc != 0)
+            return rc;
+
+        if (write) {
+            rc = mmc_send_cmd(MMC_CMD_WRITE_MULTIPLE_BLOCK, lba_offset, MMC_RSP_R1, NULL);
+            if (rc != 0)
+                return rc;
+
+            rc = mmc_hal->write(lba_offset, chunk_len, buf_ptr);
+        } else {
+            rc = mmc_send_cmd(MMC_CMD_READ_MULTIPLE_BLOCK, lba_offset, MMC_RSP_R1, NULL);
+            if (rc != 0)
+                return rc;
+
+            rc = mmc_hal->read(lba_offset, chunk_len, buf_ptr);
+        }
+
+        if (rc != 0)
+            return rc;
+
+        bytes_left -= chunk_len;
+        buf_ptr += chunk_len;
+        lba_offset += blocks;
+
+        if (write) {
+            if (mmc_hal->wait_busy)
+                rc = mmc_hal->wait_busy(MMC_DEFAULT_TIMEOUT_ms);
+            else if (bytes_left)
+                rc = mmc_wait_tran();
+
+            if (rc != PB_OK)
+                return rc;
+        }
+    }
+
+    /* Check status once for the whole extent */
+    return mmc_wait_tran();
+}
+#endif
+
 static void select_part(bio_dev_t dev)
 {
     int flags = bio_get_hal_flags(dev);
@@ -300,8 +395,16 @@ static int mmc_bio_read(bio_dev_t dev, lba_t lba, size_t length, void *buf)
     if (block_sz < 0)
         return block_sz;
 
+    if (!mmc_lba_range_valid(lba, length))
+        return -PB_ERR_PARAM;
+
     select_part(dev);
 
+#ifdef CONFIG_MMC_CORE_STREAM_XFER
+    if (mmc_current_part != MMC_PART_RPMB)
+        return mmc_stream_xfer(lba, length, buf_ptr, false);
+#endif
+
     size_t max_len = mmc_hal->max_chunk_bytes;
     while (bytes_to_read) {
         size_t chunk_len = (bytes_to_read > max_len) ? max_len : bytes_to_read;
@@ -329,8 +432,16 @@ static int mmc_bio_write(bio_dev_t dev, lba_t lba, size_t length, const void *bu
     if (block_sz < 0)
         return block_sz;
 
+    if (!mmc_lba_range_valid(lba, length))
+        return -PB_ERR_PARAM;
+
     select_part(dev);
 
+#ifdef CONFIG_MMC_CORE_STREAM_XFER
+    if (mmc_current_part != MMC_PART_RPMB)
+        return mmc_stream_xfer(lba, length, buf_ptr, true);
+#endif
+
     size_t max_len = mmc_hal->max_chunk_bytes;
     while (bytes_to_write) {
         size_t chunk_len = (bytes_to_write > max_len) ? max_len : bytes_to_write;
@@ -347,10 +458,175 @@ static int mmc_bio_write(bio_dev_t dev, lba_t lba, size_t length, const void *bu
     return rc;
 }
 
+/* Maximum number of DMA segments in one command */
+#define MMC_SG_MAX_SEGMENTS 32
+
+static int mmc_read_sg(lba_t lba,
+                       const struct bio_segment *segs,
+                       unsigned int no_of_segs,
+                       size_t length)
+{
+    int rc;
+    unsigned int cmd_idx;
+
+    if (!mmc_lba_range_valid(lba, length))
+        return -PB_ERR_PARAM;
+
+    rc = mmc_hal->prepare_sg(lba, segs, no_of_segs);
+    if (rc != 0)
+        return rc;
+
+#ifdef CONFIG_MMC_CORE_STREAM_XFER
+    rc = mmc_send_cmd(MMC_CMD_SET_BLOCK_COUNT, length / MMC_BLOCK_SIZE, MMC_RSP_R1, NULL);
+    if (rc != 0)
+        return rc;
+
+    cmd_idx = MMC_CMD_READ_MULTIPLE_BLOCK;
+#else
+    if (length > MMC_BLOCK_SIZE)
+        cmd_idx = MMC_CMD_READ_MULTIPLE_BLOCK;
+    else
+        cmd_idx = MMC_CMD_READ_SINGLE_BLOCK;
+#endif
+
+    rc = mmc_send_cmd(cmd_idx, lba, MMC_RSP_R1, NULL);
+    if (rc != 0)
+        return rc;
+
+    for (unsigned int i = 0; i < no_of_segs; i++) {
+        rc = mmc_hal->read(lba, segs[i].length, (uintptr_t)segs[i].buf);
+        if (rc != 0)
+            return rc;
+    }
+
+    do {
+        rc = mmc_device_state(MMC_DEFAULT_TIMEOUT_ms);
+        if (rc < 0)
+            return rc;
+    } while ((rc != MMC_STATE_TRAN) && (rc != MMC_STATE_DATA));
+
+    return PB_OK;
+}
+
+/*
+ * Scatter-gather reads are packed into as few multi block commands as the
+ * host allows. A command ends when it reaches 'max_chunk_bytes' or
+ * MMC_SG_MAX_SEGMENTS segments, a segment that does not fit is split and
+ * continues in the next command.
+ */
+static int mmc_bio_readv(bio_dev_t dev,
+                         lba_t lba,
+                         const struct bio_segment *segs,
+                         unsigned int no_of_segs)
+{
+    int rc;
+    struct bio_segment cmd_segs[MMC_SG_MAX_SEGMENTS];
+    size_t max_len = mmc_hal->max_chunk_bytes;
+    unsigned int seg_idx = 0;
+    size_t seg_offset = 0;
+    lba_t lba_offset = lba;
+
+    /* The DMA transfer can't end with a partial block */
+    if (segs[no_of_segs - 1].length % MMC_BLOCK_SIZE) {
+        for (unsigned int i = 0; i < no_of_segs; i++) {
+            rc = mmc_bio_read(dev, lba_offset, segs[i].length, segs[i].buf);
+            if (rc < 0)
+                return rc;
+            lba_offset += segs[i].length / MMC_BLOCK_SIZE;
+        }
+
+        return PB_OK;
+    }
+
+    select_part(dev);
+
+    while (seg_idx < no_of_segs) {
+        unsigned int n = 0;
+        size_t cmd_len = 0;
+
+        while (seg_idx < no_of_segs && n < MMC_SG_MAX_SEGMENTS) {
+            size_t len = segs[seg_idx].length - seg_offset;
+
+            if (max_len && (cmd_len + len) > max_len)
+                len = max_len - cmd_len;
+
+            if (len == 0 && segs[seg_idx].length > 0)
+                break;
+
+            if (len > 0) {
+                cmd_segs[n].buf = (uint8_t *)segs[seg_idx].buf + seg_offset;
+                cmd_segs[n].length = len;
+                cmd_len += len;
+                seg_offset += len;
+                n++;
+            }
+
+            if (seg_offset == segs[seg_idx].length) {
+                seg_idx++;
+                seg_offset = 0;
+            }
+        }
+
+        if (n == 0)
+            break;
+
+        rc = mmc_read_sg(lba_offset, cmd_segs, n, cmd_len);
+
+        if (rc != PB_OK)
+            return rc;
+
+        lba_offset += cmd_len / MMC_BLOCK_SIZE;
+    }
+
+    return PB_OK;
+}
+
 #ifdef CONFIG_MMC_CORE_HS200_TUNE
-static int hs200_tune(void)
+static int hs200_test_tap(unsigned int tap)
 {
     int rc;
+    const uint8_t *pattern = tuning_blk_pattern_8bit;
+    size_t blk_len = sizeof(tuning_blk_pattern_8bit);
+
+    if (mmc_cfg->width == MMC_BUS_WIDTH_4BIT) {
+        pattern = tuning_blk_pattern_4bit;
+        blk_len = sizeof(tuning_blk_pattern_4bit);
+    }
+
+    mmc_hal->set_delay_tap(tap);
+    pb_delay_ms(10);
+    rc = mmc_hal->prepare(0, blk_len, (uintptr_t)mmc_tuning_rsp);
+    if (rc != 0) {
+        return rc;
+    }
+
+    rc = mmc_send_cmd(MMC_CMD_SEND_TUNING_BLOCK_HS200, 0, MMC_RSP_R1, NULL);
+
+    if (rc != 0) {
+        return rc;
+    }
+
+    rc = mmc_hal->read(0, blk_len, (uintptr_t)mmc_tuning_rsp);
+    if (rc != 0) {
+        return rc;
+    }
+
+    do {
+        rc = mmc_device_state(MMC_DEFAULT_TIMEOUT_ms);
+        if (rc < 0) {
+            return rc;
+        }
+    } while (rc != MMC_STATE_TRAN);
+
+    if (memcmp(pattern, mmc_tuning_rsp, blk_len) != 0) {
+        return -PB_ERR_IO;
+    }
+
+    return PB_OK;
+}
+
+static int hs200_tune(unsigned int *tap_out)
+{
     uint8_t result[127];
 
     /*
@@ -361,45 +637,11 @@ static int hs200_tune(void)
      *  - delay_tap_start
      *  - delay_tap_end
      *  - delay_tap_step
-     *
-     *  This also assumes 8-bit bus width.
      */
 
     LOG_INFO("Starting, this will produce I/O errors for bad delay taps...");
     for (int i = 0; i < 127; i++) {
-        mmc_hal->set_delay_tap(i);
-        pb_delay_ms(10);
-        rc = mmc_hal->prepare(0, sizeof(mmc_tuning_rsp), (uintptr_t)mmc_tuning_rsp);
-        if (rc != 0) {
-            goto tune_tap_fail;
-        }
-
-        rc = mmc_send_cmd(MMC_CMD_SEND_TUNING_BLOCK_HS200, 0, MMC_RSP_R1, NULL);
-
-        if (rc != 0) {
-            goto tune_tap_fail;
-        }
-
-        rc = mmc_hal->read(0, sizeof(mmc_tuning_rsp), (uintptr_t)mmc_tuning_rsp);
-        if (rc != 0) {
-            goto tune_tap_fail;
-        }
-
-        do {
-            rc = mmc_device_state(MMC_DEFAULT_TIMEOUT_ms);
-            if (rc < 0) {
-                goto tune_tap_fail;
-            }
-        } while (rc != MMC_STATE_TRAN);
-
-        if (memcmp(tuning_blk_pattern_8bit, mmc_tuning_rsp, 128) == 0) {
-            result[i] = 1;
-        } else {
-            goto tune_tap_fail;
-        }
-        continue;
-tune_tap_fail:
-        result[i] = 0;
+        result[i] = (hs200_test_tap(i) == PB_OK) ? 1 : 0;
     }
 
     LOG_INFO("Done");
@@ -407,7 +649,7 @@ tune_tap_fail:
     unsigned int start_tap = 0;
     bool find_next_good = true;
     unsigned int high_score = 0;
-    unsigned int selected_tap;
+    unsigned int selected_tap = 0;
     size_t good_count = 0;
 
     for (int i = 0; i < 127; i++) {
@@ -446,6 +688,36 @@ tune_tap_fail:
 
     LOG_INFO("Optimal delay tap = %i", selected_tap);
     mmc_hal->set_delay_tap(selected_tap);
+    *tap_out = selected_tap;
+
+    return PB_OK;
+}
+
+static int hs200_tune_cached(void)
+{
+    int rc;
+    unsigned int tap;
+
+    if (mmc_cfg->tuning_cache_read != NULL && mmc_cfg->tuning_cache_read(mmc_cid, &tap) == PB_OK &&
+        tap < 127) {
+        if (hs200_test_tap(tap) == PB_OK) {
+            LOG_INFO("Using cached delay tap = %u", tap);
+            return PB_OK;
+        }
+
+        LOG_INFO("Cached delay tap %u failed, re-tuning", tap);
+    }
+
+    rc = hs200_tune(&tap);
+
+    if (rc != PB_OK)
+        return rc;
+
+    if (mmc_cfg->tuning_cache_write != NULL) {
+        if (mmc_cfg->tuning_cache_write(mmc_cid, tap) != PB_OK) {
+            LOG_WARN("Could not store delay tap");
+        }
+    }
 
     return PB_OK;
 }
@@ -475,7 +747,7 @@ static int mmc_setup(void)
     }
 
     /* CMD2: Card Identification */
-    rc = mmc_send_cmd(MMC_CMD_ALL_SEND_CID, 0, MMC_RSP_R2, NULL);
+    rc = mmc_send_cmd(MMC_CMD_ALL_SEND_CID, 0, MMC_RSP_R2, mmc_cid);
     if (rc != 0) {
         return rc;
     }
@@ -553,7 +825,7 @@ static int mmc_setup(void)
         }
 #ifdef CONFIG_MMC_CORE_HS200_TUNE
         ts("hs200 tune begin");
-        rc = hs200_tune();
+        rc = hs200_tune_cached();
         ts("hs200 tune end");
         if (rc != 0)
             return rc;
@@ -662,6 +934,11 @@ static int mmc_setup(void)
 
     rc = bio_set_ios(d, mmc_bio_read, mmc_bio_write);
 
+    if (rc < 0)
+        return rc;
+
+    rc = bio_set_ios_readv(d, mmc_hal->prepare_sg ? mmc_bio_readv : NULL);
+
     if (rc < 0)
         return rc;
 
@@ -680,6 +957,11 @@ static int mmc_setup(void)
 
     rc = bio_set_ios(d, mmc_bio_read, mmc_bio_write);
 
+    if (rc < 0)
+        return rc;
+
+    rc = bio_set_ios_readv(d, mmc_hal->prepare_sg ? mmc_bio_readv : NULL);
+
     if (rc < 0)
         return rc;
 
@@ -714,6 +996,11 @@ static int mmc_setup(void)
 
     rc = bio_set_ios(d, mmc_bio_read, mmc_bio_write);
 
+    if (rc < 0)
+        return rc;
+
+    rc = bio_set_ios_readv(d, mmc_hal->prepare_sg ? mmc_bio_readv : NULL);
+
     if (rc < 0)
         return rc;
 
@@ -0,0 +1,276 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <drivers/mmc/mmc_ram.h>
+#include <pb/pb.h>
+#include <string.h>
+
+#define MMC_RAM_PART_MULT SZ_KiB(128)
+/* Status polls that still see the card in PRG after a write */
+#define MMC_RAM_PRG_POLLS 1
+
+static const uint8_t tuning_blk_pattern_8bit[] = {
+    0xff, 0xff, 0x00, 0xff, 0xff, 0xff, 0x00, 0x00, 0xff, 0xff, 0xcc, 0xcc, 0xcc, 0x33, 0xcc, 0xcc,
+    0xcc, 0x33, 0x33, 0xcc, 0xcc, 0xcc, 0xff, 0xff, 0xff, 0xee, 0xff, 0xff, 0xff, 0xee, 0xee, 0xff,
+    0xff, 0xff, 0xdd, 0xff, 0xff, 0xff, 0xdd, 0xdd, 0xff, 0xff, 0xff, 0xbb, 0xff, 0xff, 0xff, 0xbb,
+    0xbb, 0xff, 0xff, 0xff, 0x77, 0xff, 0xff, 0xff, 0x77, 0x77, 0xff, 0x77, 0xbb, 0xdd, 0xee, 0xff,
+    0xff, 0xff, 0xff, 0x00, 0xff, 0xff, 0xff, 0x00, 0x00, 0xff, 0xff, 0xcc, 0xcc, 0xcc, 0x33, 0xcc,
+    0xcc, 0xcc, 0x33, 0x33, 0xcc, 0xcc, 0xcc, 0xff, 0xff, 0xff, 0xee, 0xff, 0xff, 0xff, 0xee, 0xee,
+    0xff, 0xff, 0xff, 0xdd, 0xff, 0xff, 0xff, 0xdd, 0xdd, 0xff, 0xff, 0xff, 0xbb, 0xff, 0xff, 0xff,
+    0xbb, 0xbb, 0xff, 0xff, 0xff, 0x77, 0xff, 0xff, 0xff, 0x77, 0x77, 0xff, 0x77, 0xbb, 0xdd, 0xee,
+};
+
+static const mmc_cmd_resp_t card_cid = { 0x00a1b2c3, 0x4d5e6f70, 0x4d4d4353, 0x15010050 };
+static const mmc_cmd_resp_t card_csd = { 0x0a400000, 0xdbd37f80, 0x0f5903ff, 0xd0270132 };
+
+enum mmc_ram_xfer {
+    XFER_NONE,
+    XFER_BUF,
+    XFER_TUNING,
+};
+
+struct mmc_ram_part {
+    uint8_t *data;
+    size_t size;
+};
+
+static const struct mmc_ram_config *cfg;
+static struct mmc_ram_part parts[MMC_PART_END];
+static uint8_t ext_csd[512];
+static unsigned int card_state;
+static unsigned int prg_polls;
+static unsigned int block_count;
+static enum mmc_ram_xfer xfer;
+static uint8_t *xfer_ptr;
+static size_t xfer_left;
+static struct mmc_ram_stats stats;
+
+static int mmc_ram_start_xfer(uint32_t lba)
+{
+    struct mmc_ram_part *part = &parts[ext_csd[EXT_CSD_PART_CONFIG] & 0x07];
+
+    if (((size_t)lba * MMC_BLOCK_SIZE) >= part->size)
+        return -PB_ERR_IO;
+
+    xfer = XFER_BUF;
+    xfer_ptr = part->data + (size_t)lba * MMC_BLOCK_SIZE;
+    xfer_left = part->size - (size_t)lba * MMC_BLOCK_SIZE;
+    return PB_OK;
+}
+
+static int mmc_ram_send_cmd(uint16_t idx, uint32_t arg, uint16_t resp_type, mmc_cmd_resp_t resp)
+{
+    int rc = PB_OK;
+
+    if (idx < MMC_RAM_MAX_CMDS)
+        stats.cmds[idx]++;
+
+    /* Only the status can be read while the card is programming */
+    if ((card_state == MMC_STATE_PRG) && (idx != MMC_CMD_SEND_STATUS)) {
+        LOG_ERR("CMD%u while programming", idx);
+        return -PB_ERR_IO;
+    }
+
+    switch (idx) {
+    case MMC_CMD_GO_IDLE_STATE:
+        card_state = MMC_STATE_IDLE;
+        break;
+    case MMC_CMD_SEND_OP_COND:
+        card_state = MMC_STATE_READY;
+        resp[0] = OCR_POWERUP | OCR_SECTOR_MODE | OCR_VDD_MIN_1V7;
+        break;
+    case MMC_CMD_ALL_SEND_CID:
+        card_state = MMC_STATE_IDENT;
+        memcpy(resp, card_cid, sizeof(mmc_cmd_resp_t));
+        break;
+    case MMC_CMD_SET_RELATIVE_ADDR:
+        card_state = MMC_STATE_STBY;
+        break;
+    case MMC_CMD_SEND_CSD:
+        memcpy(resp, card_csd, sizeof(mmc_cmd_resp_t));
+        break;
+    case MMC_CMD_SELECT_CARD:
+        card_state = MMC_STATE_TRAN;
+        break;
+    case MMC_CMD_SWITCH:
+        if ((arg & EXTCSD_WRITE_BYTES) != EXTCSD_WRITE_BYTES)
+            return -PB_ERR_NOT_IMPLEMENTED;
+        ext_csd[(arg >> 16) & 0xff] = (arg >> 8) & 0xff;
+        break;
+    case MMC_CMD_SEND_EXT_CSD:
+        xfer = XFER_BUF;
+        xfer_ptr = ext_csd;
+        xfer_left = sizeof(ext_csd);
+        break;
+    case MMC_CMD_SEND_STATUS:
+        if (card_state == MMC_STATE_PRG) {
+            if (prg_polls == 0)
+                card_state = MMC_STATE_TRAN;
+            else
+                prg_polls--;
+        }
+        resp[0] = (card_state << 9) | STATUS_READY_FOR_DATA;
+        break;
+    case MMC_CMD_SEND_TUNING_BLOCK_HS200:
+        xfer = XFER_TUNING;
+        break;
+    case MMC_CMD_SET_BLOCK_COUNT:
+        block_count = arg & 0xffff;
+        break;
+    case MMC_CMD_READ_SINGLE_BLOCK:
+    case MMC_CMD_READ_MULTIPLE_BLOCK:
+    case MMC_CMD_WRITE_SINGLE_BLOCK:
+    case MMC_CMD_WRITE_MULTIPLE_BLOCK:
+        rc = mmc_ram_start_xfer(arg);
+        break;
+    default:
+        LOG_ERR("Unsupported command %u", idx);
+        rc = -PB_ERR_NOT_IMPLEMENTED;
+    }
+
+    return rc;
+}
+
+static int mmc_ram_check_xfer(size_t length)
+{
+    if (xfer != XFER_BUF || length > xfer_left)
+        return -PB_ERR_IO;
+
+    /* A pre-defined block count must match the transfer */
+    if (block_count && length != (size_t)block_count * MMC_BLOCK_SIZE)
+        return -PB_ERR_IO;
+
+    return PB_OK;
+}
+
+static int mmc_ram_read(unsigned int lba, size_t length, uintptr_t buf)
+{
+    if (xfer == XFER_TUNING) {
+        xfer = XFER_NONE;
+        memcpy((void *)buf, tuning_blk_pattern_8bit, MIN(length, sizeof(tuning_blk_pattern_8bit)));
+
+        /* Outside of the window the data is sampled on the wrong edge */
+        if (stats.delay_tap < cfg->tap_first || stats.delay_tap > cfg->tap_last)
+            ((uint8_t *)buf)[stats.delay_tap % length] ^= 0xff;
+
+        return PB_OK;
+    }
+
+    if (mmc_ram_check_xfer(length) != PB_OK)
+        return -PB_ERR_IO;
+
+    memcpy((void *)buf, xfer_ptr, length);
+    stats.read_bytes += length;
+    xfer = XFER_NONE;
+    block_count = 0;
+    return PB_OK;
+}
+
+static int mmc_ram_write(unsigned int lba, size_t length, uintptr_t buf)
+{
+    if (mmc_ram_check_xfer(length) != PB_OK)
+        return -PB_ERR_IO;
+
+    memcpy(xfer_ptr, (const void *)buf, length);
+    stats.write_bytes += length;
+    xfer = XFER_NONE;
+    block_count = 0;
+    card_state = MMC_STATE_PRG;
+    prg_polls = MMC_RAM_PRG_POLLS;
+    return PB_OK;
+}
+
+/* Programming is instant, DAT0 is released on the first sample */
+static int mmc_ram_wait_busy(unsigned int timeout_ms)
+{
+    if (card_state == MMC_STATE_PRG)
+        card_state = MMC_STATE_TRAN;
+
+    stats.busy_waits++;
+    return PB_OK;
+}
+
+static int mmc_ram_init_hal(void)
+{
+    return PB_OK;
+}
+
+static int mmc_ram_prepare(unsigned int lba, size_t length, uintptr_t buf)
+{
+    return PB_OK;
+}
+
+static int mmc_ram_set_bus_clock(unsigned int clk_hz)
+{
+    return PB_OK;
+}
+
+static int mmc_ram_set_bus_width(enum mmc_bus_width width)
+{
+    return PB_OK;
+}
+
+static int mmc_ram_set_delay_tap(unsigned int tap)
+{
+    stats.delay_tap = tap;
+    return PB_OK;
+}
+
+static struct mmc_hal mmc_ram_hal = {
+    .init = mmc_ram_init_hal,
+    .send_cmd = mmc_ram_send_cmd,
+    .set_bus_clock = mmc_ram_set_bus_clock,
+    .set_bus_width = mmc_ram_set_bus_width,
+    .prepare = mmc_ram_prepare,
+    .prepare_sg = NULL,
+    .read = mmc_ram_read,
+    .write = mmc_ram_write,
+    .set_delay_tap = mmc_ram_set_delay_tap,
+    .wait_busy = mmc_ram_wait_busy,
+};
+
+int mmc_ram_init(const struct mmc_ram_config *cfg_)
+{
+    uint32_t sectors = cfg_->user_size / MMC_BLOCK_SIZE;
+
+    if ((cfg_->boot_size == 0) || (cfg_->boot_size % MMC_RAM_PART_MULT) ||
+        (cfg_->rpmb_size == 0) || (cfg_->rpmb_size % MMC_RAM_PART_MULT) ||
+        (cfg_->user_size == 0) || (cfg_->user_size % MMC_BLOCK_SIZE) ||
+        (cfg_->max_chunk_bytes == 0))
+        return -PB_ERR_PARAM;
+
+    cfg = cfg_;
+    parts[MMC_PART_USER] = (struct mmc_ram_part){ cfg->user, cfg->user_size };
+    parts[MMC_PART_BOOT0] = (struct mmc_ram_part){ cfg->boot0, cfg->boot_size };
+    parts[MMC_PART_BOOT1] = (struct mmc_ram_part){ cfg->boot1, cfg->boot_size };
+    parts[MMC_PART_RPMB] = (struct mmc_ram_part){ cfg->rpmb, cfg->rpmb_size };
+
+    memset(ext_csd, 0, sizeof(ext_csd));
+    ext_csd[EXT_CSD_SEC_CNT + 0] = sectors & 0xff;
+    ext_csd[EXT_CSD_SEC_CNT + 1] = (sectors >> 8) & 0xff;
+    ext_csd[EXT_CSD_SEC_CNT + 2] = (sectors >> 16) & 0xff;
+    ext_csd[EXT_CSD_SEC_CNT + 3] = (sectors >> 24) & 0xff;
+    ext_csd[EXT_CSD_BOOT_MULT] = cfg->boot_size / MMC_RAM_PART_MULT;
+    ext_csd[EXT_CSD_RPMB_MULT] = cfg->rpmb_size / MMC_RAM_PART_MULT;
+    ext_csd[EXT_CSD_CARD_TYPE] = 0x13; /* HS200 1.8 V, HS 52 MHz and 26 MHz */
+    ext_csd[EXT_CSD_GENERIC_CMD6_TIME] = 1;
+    ext_csd[EXT_CSD_PART_SWITCH_TIME] = 1;
+    ext_csd[EXT_CSD_POWER_OFF_LONG_TIME] = 1;
+    ext_csd[EXT_CSD_PART_CONFIG] = (1 << 3);
+
+    memset(&stats, 0, sizeof(stats));
+    mmc_ram_hal.max_chunk_bytes = cfg->max_chunk_bytes;
+
+    return mmc_init(&mmc_ram_hal, &cfg->mmc);
+}
+
+const struct mmc_ram_stats *mmc_ram_stats(void)
+{
+    return &stats;
+}
@@ -132,10 +132,13 @@ static int gpt_is_valid(struct gpt_header *hdr, struct gpt_part_hdr *part)
 static int gpt_init_tbl(bio_dev_t dev)
 {
     struct gpt_header *hdr = &primary.hdr;
-    unsigned int last_lba = bio_get_last_block(dev);
+    int64_t last_lba = bio_get_last_block(dev);
     prng_state = plat_get_us_tick();
 
-    LOG_INFO("Initializing table at lba 1, last lba: %u", last_lba);
+    if (last_lba < 0)
+        return (int)last_lba;
+
+    LOG_INFO("Initializing table at lba 1, last lba: %" PRIi64, last_lba);
 
     memset((uint8_t *)&primary, 0, sizeof(primary));
     memset((uint8_t *)&backup, 0, sizeof(backup));
@@ -159,8 +162,10 @@ static int gpt_init_tbl(bio_dev_t dev)
     return PB_OK;
 }
 
-static int
-gpt_add_part(int part_idx, unsigned int no_of_blocks, const uuid_t type_uuid, const char *part_name)
+static int gpt_add_part(int part_idx,
+                        lba_t no_of_blocks,
+                        const uuid_t type_uuid,
+                        const char *part_name)
 {
     struct gpt_part_hdr *part = &primary.part[part_idx];
     struct gpt_part_hdr *prev_part = NULL;
@@ -223,7 +228,9 @@ static int gpt_write_tbl(bio_dev_t dev)
     gpt_pmbr[453] = 0xFF;
     gpt_pmbr[454] = 0x01;
 
-    uint32_t llba = (uint32_t)bio_get_last_block(dev);
+    /* The protective MBR covers at most 2^32 - 1 blocks */
+    int64_t last_block = bio_get_last_block(dev);
+    uint32_t llba = (last_block > UINT32_MAX) ? UINT32_MAX : (uint32_t)last_block;
     memcpy(&gpt_pmbr[458], &llba, sizeof(uint32_t));
     gpt_pmbr[510] = 0x55;
     gpt_pmbr[511] = 0xAA;
@@ -236,7 +243,7 @@ static int gpt_write_tbl(bio_dev_t dev)
     }
 
     /* Write primary GPT Table */
-    LOG_DBG("writing primary gpt tbl to lba %llu", primary.hdr.current_lba);
+    LOG_DBG("writing primary gpt tbl to lba %" PRIu64, primary.hdr.current_lba);
 
     err = bio_write(dev, primary.hdr.current_lba, sizeof(primary), &primary);
 
@@ -266,7 +273,7 @@ static int gpt_write_tbl(bio_dev_t dev)
     backup.hdr.hdr_crc = crc_tmp;
 
     /* Write backup GPT table */
-    LOG_INFO("Writing backup GPT tbl to LBA %llu", backup.hdr.entries_start_lba);
+    LOG_INFO("Writing backup GPT tbl to LBA %" PRIu64, backup.hdr.entries_start_lba);
 
     return bio_write(dev, backup.hdr.entries_start_lba, sizeof(backup), &backup);
 }
@@ -328,7 +335,7 @@ int gpt_ptbl_init(bio_dev_t dev, const struct gpt_table_list *default_tables, si
     if (rc != PB_OK)
         return rc;
 
-    size_t backup_lba = bio_get_last_block(dev) - ((128 * sizeof(struct gpt_part_hdr)) / 512);
+    lba_t backup_lba = bio_get_last_block(dev) - ((128 * sizeof(struct gpt_part_hdr)) / 512);
 
     rc = bio_read(dev, backup_lba, sizeof(backup), &backup);
 
@@ -25,6 +25,7 @@
 #include <drivers/usb/imx_ci_udc.h>
 #include <drivers/usb/usbd.h>
 #include <inttypes.h>
+#include <pb/arena.h>
 #include <pb/mmio.h>
 #include <pb/pb.h>
 #include <stdio.h>
@@ -118,11 +119,17 @@ struct imx_ci_udc_queue_head {
 } __attribute__((packed));
 
 /* No data structure seen by the controller should span a 4k page boundary */
+#ifdef CONFIG_ARENA
+static struct imx_ci_udc_transfer_head *dtds;
+static struct imx_ci_udc_queue_head *dqhs;
+static uint8_t *align_buffer;
+#else
 static struct imx_ci_udc_transfer_head dtds[IMX_CI_UDC_NO_OF_DESCRIPTORS] __section(".no_init")
     __aligned(4096);
 static struct imx_ci_udc_queue_head dqhs[IMX_CI_UDC_NO_OF_EPS * 2] __section(".no_init")
     __aligned(4096);
 static uint8_t align_buffer[4096] __aligned(4096);
+#endif
 static uintptr_t xfer_bfr;
 static size_t xfer_length;
 static struct imx_ci_udc_transfer_head *xfer_head;
@@ -602,6 +609,21 @@ static int imx_ci_udc_xfer_zlp(usb_ep_t ep)
 
 int imx_ci_udc_init(uintptr_t base)
 {
+#ifdef CONFIG_ARENA
+    if (dtds == NULL) {
+        dtds = arena_alloc_aligned(ARENA_DRIVERS,
+                                   sizeof(dtds[0]) * IMX_CI_UDC_NO_OF_DESCRIPTORS,
+                                   4096);
+        dqhs = arena_alloc_aligned(ARENA_DRIVERS,
+                                   sizeof(dqhs[0]) * IMX_CI_UDC_NO_OF_EPS * 2,
+                                   4096);
+        align_buffer = arena_alloc_aligned(ARENA_DRIVERS, 4096, 4096);
+
+        if ((dtds == NULL) || (dqhs == NULL) || (align_buffer == NULL))
+            return -PB_ERR_MEM;
+    }
+#endif
+
     imx_ci_udc_base = base;
 
     static const struct usbd_hal_ops ops = {
@@ -12,6 +12,8 @@
 #include <arch/arch.h>
 #include <drivers/virtio/virtio_block.h>
 #include <inttypes.h>
+#include <pb/event.h>
+#include <pb/irq.h>
 #include <pb/mmio.h>
 #include <pb/pb.h>
 
@@ -53,42 +55,56 @@ struct virtio_blk_req {
     uint32_t sector_hi;
 };
 
-#define VIRTIO_BLK_QUEUE_SZ 4
+/* One request uses a header and a status descriptor, the rest can be used
+ * for data segments */
+#define VIRTIO_BLK_QUEUE_SZ 16
+#define VIRTIO_BLK_MAX_SEGS (VIRTIO_BLK_QUEUE_SZ - 2)
 
 static uint8_t status __aligned(64);
 static uint8_t queue_data[VIRTIO_QUEUE_SZ(VIRTIO_BLK_QUEUE_SZ, 64)] __aligned(4096);
 static struct virtq queue;
 static struct virtio_blk_req request __aligned(64);
 static uintptr_t base;
+static struct pb_event xfer_done;
 
-static int virtio_xfer(bio_dev_t dev, bool read, lba_t lba, size_t length, uintptr_t buf)
+static int virtio_xfer(bio_dev_t dev,
+                       bool read,
+                       lba_t lba,
+                       const struct bio_segment *segs,
+                       unsigned int no_of_segs)
 {
     uint16_t idx = (queue.avail->idx % queue.num);
+    unsigned int n = 0;
     status = VIRTIO_BLK_S_UNSUPP;
 
     request.type = read ? VIRTIO_BLK_T_IN : VIRTIO_BLK_T_OUT;
     request.reserved = 0;
     request.sector_low = lba & 0xffffffff;
-    request.sector_hi = 0; // TODO: Handle really large disks on 64-bit platforms
+    request.sector_hi = lba >> 32;
 
     arch_clean_cache_range((uintptr_t)&request, sizeof(request));
 
-    queue.desc[0].addr = (uint32_t)((uintptr_t)&request);
-    queue.desc[0].len = sizeof(struct virtio_blk_req);
-    queue.desc[0].flags = VIRTQ_DESC_F_NEXT;
-    queue.desc[0].next = 1;
-
-    queue.desc[1].addr = (uint32_t)buf;
-    queue.desc[1].len = length;
-    queue.desc[1].flags = VIRTQ_DESC_F_NEXT | (read ? VIRTQ_DESC_F_WRITE : 0);
-    queue.desc[1].next = 2;
+    queue.desc[n].addr = (uint32_t)((uintptr_t)&request);
+    queue.desc[n].len = sizeof(struct virtio_blk_req);
+    queue.desc[n].flags = VIRTQ_DESC_F_NEXT;
+    queue.desc[n].next = n + 1;
+    n++;
+
+    for (unsigned int i = 0; i < no_of_segs; i++) {
+        queue.desc[n].addr = (uint32_t)((uintptr_t)segs[i].buf);
+        queue.desc[n].len = segs[i].length;
+        queue.desc[n].flags = VIRTQ_DESC_F_NEXT | (read ? VIRTQ_DESC_F_WRITE : 0);
+        queue.desc[n].next = n + 1;
+        n++;
+    }
 
-    queue.desc[2].addr = (uint32_t)((uintptr_t)&status);
-    queue.desc[2].len = 1;
-    queue.desc[2].flags = VIRTQ_DESC_F_WRITE;
-    queue.desc[2].next = 0;
+    queue.desc[n].addr = (uint32_t)((uintptr_t)&status);
+    queue.desc[n].len = 1;
+    queue.desc[n].flags = VIRTQ_DESC_F_WRITE;
+    queue.desc[n].next = 0;
+    n++;
 
-    arch_clean_cache_range((uintptr_t)&queue.desc[0], sizeof(queue.desc[0]) * 3);
+    arch_clean_cache_range((uintptr_t)&queue.desc[0], sizeof(queue.desc[0]) * n);
     queue.avail->ring[idx] = 0;
     queue.avail->idx++;
 
@@ -96,8 +112,13 @@ static int virtio_xfer(bio_dev_t dev, bool read, lba_t lba, size_t length, uintp
 
     mmio_write_32(base + VIRTIO_MMIO_QUEUE_NOTIFY, 0);
 
-    while (queue.avail->idx != queue.used->idx) {
+    for (;;) {
         arch_invalidate_cache_range((uintptr_t)queue.used, sizeof(*queue.used));
+
+        if (queue.avail->idx == queue.used->idx)
+            break;
+
+        pb_event_wait(&xfer_done);
     }
 
     arch_invalidate_cache_range((uintptr_t)&status, sizeof(status));
@@ -112,15 +133,66 @@ static int virtio_xfer(bio_dev_t dev, bool read, lba_t lba, size_t length, uintp
 
 static int virtio_bio_read(bio_dev_t dev, lba_t lba, size_t length, void *buf)
 {
-    return virtio_xfer(dev, true, lba, length, (uintptr_t)buf);
+    const struct bio_segment seg = {
+        .buf = buf,
+        .length = length,
+    };
+
+    return virtio_xfer(dev, true, lba, &seg, 1);
+}
+
+static int virtio_bio_readv(bio_dev_t dev,
+                            lba_t lba,
+                            const struct bio_segment *segs,
+                            unsigned int no_of_segs)
+{
+    int rc;
+    ssize_t block_sz = bio_block_size(dev);
+
+    if (block_sz < 0)
+        return block_sz;
+
+    /* Requests with more segments than there are free descriptors are
+     * split up */
+    while (no_of_segs) {
+        unsigned int n = (no_of_segs > VIRTIO_BLK_MAX_SEGS) ? VIRTIO_BLK_MAX_SEGS : no_of_segs;
+
+        rc = virtio_xfer(dev, true, lba, segs, n);
+
+        if (rc != PB_OK)
+            return rc;
+
+        for (unsigned int i = 0; i < n; i++)
+            lba += segs[i].length / block_sz;
+
+        segs += n;
+        no_of_segs -= n;
+    }
+
+    return PB_OK;
 }
 
 static int virtio_bio_write(bio_dev_t dev, lba_t lba, size_t length, const void *buf)
 {
-    return virtio_xfer(dev, false, lba, length, (uintptr_t)buf);
+    const struct bio_segment seg = {
+        .buf = (void *)buf,
+        .length = length,
+    };
+
+    return virtio_xfer(dev, false, lba, &seg, 1);
+}
+
+static void virtio_block_irq(unsigned int irq, void *arg)
+{
+    uint32_t status = mmio_read_32(base + VIRTIO_MMIO_INTERRUPT_STATUS);
+    (void)irq;
+    (void)arg;
+
+    mmio_write_32(base + VIRTIO_MMIO_INTERRUPT_ACK, status);
+    pb_event_signal(&xfer_done);
 }
 
-bio_dev_t virtio_block_init(uintptr_t base_, const uuid_t uu)
+bio_dev_t virtio_block_init(uintptr_t base_, unsigned int irq, const uuid_t uu)
 {
     int rc;
     base = base_;
@@ -160,6 +232,8 @@ bio_dev_t virtio_block_init(uintptr_t base_, const uuid_t uu)
 
     mmio_clrsetbits_32(base + VIRTIO_MMIO_STATUS, 0, VIRTIO_STATUS_DRIVER_OK);
 
+    pb_event_init(&xfer_done, irq_register(irq, virtio_block_irq, NULL) == PB_OK);
+
     bio_dev_t dev = bio_allocate(0, cfg->capacity - 1, cfg->blk_size, uu, "Virtio disk");
 
     if (dev < 0)
@@ -167,6 +241,11 @@ bio_dev_t virtio_block_init(uintptr_t base_, const uuid_t uu)
 
     rc = bio_set_ios(dev, virtio_bio_read, virtio_bio_write);
 
+    if (rc < 0)
+        return rc;
+
+    rc = bio_set_ios_readv(dev, virtio_bio_readv);
+
     if (rc < 0)
         return rc;
 
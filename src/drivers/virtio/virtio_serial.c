@@ -11,6 +11,8 @@
 #include <arch/arch.h>
 #include <drivers/virtio/virtio_serial.h>
 #include <inttypes.h>
+#include <pb/event.h>
+#include <pb/irq.h>
 #include <pb/mmio.h>
 #include <pb/pb.h>
 #include <stdio.h>
@@ -48,6 +50,7 @@ static struct virtq ctrl_tx;
 static struct virtq *cur_xfer_q;
 static struct virtio_serial_control ctrlm __aligned(64);
 static uintptr_t base;
+static struct pb_event xfer_done;
 
 static int
 virtio_xfer(struct virtq *q, bool read, uint32_t queue_index, uintptr_t buf, size_t length)
@@ -112,9 +115,8 @@ int virtio_serial_write(const void *buf, size_t length)
     if (rc != PB_OK)
         return rc;
 
-    do {
-        rc = virtio_xfer_complete(&tx);
-    } while (rc == -PB_ERR_AGAIN);
+    while ((rc = virtio_xfer_complete(&tx)) == -PB_ERR_AGAIN)
+        pb_event_wait(&xfer_done);
 
     return rc;
 }
@@ -128,9 +130,8 @@ int virtio_serial_read(void *buf, size_t length)
     if (rc != PB_OK)
         return rc;
 
-    do {
-        rc = virtio_xfer_complete(&rx);
-    } while (rc == -PB_ERR_AGAIN);
+    while ((rc = virtio_xfer_complete(&rx)) == -PB_ERR_AGAIN)
+        pb_event_wait(&xfer_done);
 
     return rc;
 }
@@ -152,6 +153,21 @@ int virtio_serial_async_complete(void)
     return virtio_xfer_complete(cur_xfer_q);
 }
 
+struct pb_event *virtio_serial_event(void)
+{
+    return &xfer_done;
+}
+
+static void virtio_serial_irq(unsigned int irq, void *arg)
+{
+    uint32_t status = mmio_read_32(base + VIRTIO_MMIO_INTERRUPT_STATUS);
+    (void)irq;
+    (void)arg;
+
+    mmio_write_32(base + VIRTIO_MMIO_INTERRUPT_ACK, status);
+    pb_event_signal(&xfer_done);
+}
+
 static void queue_init(struct virtq *q, uint8_t *buf, uint32_t queue_id)
 {
     q->num = VIRTIO_SERIAL_QSZ;
@@ -165,7 +181,7 @@ static void queue_init(struct virtq *q, uint8_t *buf, uint32_t queue_id)
     mmio_write_32(base + VIRTIO_MMIO_QUEUE_PFN, (uint32_t)((uintptr_t)q->desc >> 12));
 }
 
-int virtio_serial_init(uintptr_t base_)
+int virtio_serial_init(uintptr_t base_, unsigned int irq)
 {
     uint32_t device_id;
     uint32_t features;
@@ -207,6 +223,8 @@ int virtio_serial_init(uintptr_t base_)
 
     mmio_clrsetbits_32(base + VIRTIO_MMIO_STATUS, 0, VIRTIO_STATUS_DRIVER_OK);
 
+    pb_event_init(&xfer_done, irq_register(irq, virtio_serial_irq, NULL) == PB_OK);
+
     ctrlm.id = 1;
     ctrlm.event = VIRTIO_CONSOLE_PORT_OPEN;
     ctrlm.value = 1;
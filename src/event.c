@@ -0,0 +1,48 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <pb/arch.h>
+#include <pb/event.h>
+#include <pb/pb.h>
+
+void pb_event_init(struct pb_event *ev, bool has_source)
+{
+    ev->signalled = 0;
+    ev->has_source = has_source;
+}
+
+void pb_event_signal(struct pb_event *ev)
+{
+    ev->signalled = 1;
+}
+
+void pb_event_wait(struct pb_event *ev)
+{
+    if (!ev->has_source)
+        return;
+
+    /*
+     * Interrupts are masked while the event is checked, otherwise the
+     * handler could run between the check and WFI and the wakeup would be
+     * lost. WFI still wakes up on a pending, masked, interrupt which is then
+     * taken as soon as interrupts are unmasked again.
+     */
+    for (;;) {
+        arch_irq_disable();
+
+        if (ev->signalled) {
+            ev->signalled = 0;
+            arch_irq_enable();
+            return;
+        }
+
+        arch_wait_for_interrupt();
+        arch_irq_enable();
+    }
+}
@@ -0,0 +1,120 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <pb/arch.h>
+#include <pb/irq.h>
+#include <pb/pb.h>
+
+static const struct irq_controller_ops *controller;
+
+static struct irq_handler_entry {
+    unsigned int irq;
+    irq_handler_t handler;
+    void *arg;
+} handlers[CONFIG_IRQ_MAX_HANDLERS];
+
+static struct irq_handler_entry *irq_find(unsigned int irq)
+{
+    for (unsigned int i = 0; i < CONFIG_IRQ_MAX_HANDLERS; i++) {
+        if ((handlers[i].handler != NULL) && (handlers[i].irq == irq))
+            return &handlers[i];
+    }
+
+    return NULL;
+}
+
+int irq_set_controller(const struct irq_controller_ops *ops)
+{
+    if (controller != NULL)
+        return -PB_ERR_PARAM;
+
+    controller = ops;
+    LOG_INFO("Interrupt controller: %s", ops->name);
+    arch_irq_enable();
+
+    return PB_OK;
+}
+
+int irq_register(unsigned int irq, irq_handler_t handler, void *arg)
+{
+    struct irq_handler_entry *entry;
+
+    if (controller == NULL)
+        return -PB_ERR_NOT_SUPPORTED;
+
+    if (handler == NULL)
+        return -PB_ERR_PARAM;
+
+    entry = irq_find(irq);
+
+    if (entry == NULL) {
+        for (unsigned int i = 0; i < CONFIG_IRQ_MAX_HANDLERS; i++) {
+            if (handlers[i].handler == NULL) {
+                entry = &handlers[i];
+                break;
+            }
+        }
+    }
+
+    if (entry == NULL)
+        return -PB_ERR_MEM;
+
+    arch_irq_disable();
+    entry->irq = irq;
+    entry->arg = arg;
+    entry->handler = handler;
+    arch_irq_enable();
+
+    LOG_DBG("IRQ %u registered", irq);
+    return controller->enable(irq);
+}
+
+int irq_unregister(unsigned int irq)
+{
+    struct irq_handler_entry *entry = irq_find(irq);
+    int rc;
+
+    if (entry == NULL)
+        return -PB_ERR_NOT_FOUND;
+
+    rc = controller->disable(irq);
+
+    arch_irq_disable();
+    entry->handler = NULL;
+    arch_irq_enable();
+
+    return rc;
+}
+
+void irq_dispatch(void)
+{
+    if (controller != NULL)
+        controller->dispatch();
+}
+
+void irq_handle(unsigned int irq)
+{
+    struct irq_handler_entry *entry = irq_find(irq);
+
+    if (entry == NULL) {
+        /* Should not happen, only registered lines are enabled */
+        (void)controller->disable(irq);
+        return;
+    }
+
+    entry->handler(irq, entry->arg);
+}
+
+void irq_shutdown(void)
+{
+    arch_irq_disable();
+
+    if ((controller != NULL) && (controller->shutdown != NULL))
+        controller->shutdown();
+}
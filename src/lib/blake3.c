@@ -0,0 +1,445 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Portable BLAKE3, following the reference implementation in the BLAKE3
+ * specification. The hasher keeps a stack of chaining values that are merged
+ * lazily, the top of the tree can not be merged until it's known if it is
+ * the root.
+ *
+ */
+
+#include <blake3/blake3.h>
+#include <string.h>
+
+#define CHUNK_START (1 << 0)
+#define CHUNK_END   (1 << 1)
+#define PARENT      (1 << 2)
+#define ROOT        (1 << 3)
+
+static const uint32_t blake3_iv[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+static const uint8_t msg_schedule[7][16] = {
+    { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+    { 2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8 },
+    { 3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1 },
+    { 10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6 },
+    { 12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4 },
+    { 9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7 },
+    { 11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13 },
+};
+
+/* Pending output of a chunk or a parent node, not compressed yet since
+ * the root flag is not known */
+struct blake3_output {
+    uint32_t cv[8];
+    uint8_t block[BLAKE3_BLOCK_LEN];
+    uint8_t block_len;
+    uint64_t counter;
+    uint8_t flags;
+};
+
+static inline uint32_t rotr32(uint32_t w, unsigned int c)
+{
+    return (w >> c) | (w << (32 - c));
+}
+
+static inline uint32_t load32(const uint8_t *p)
+{
+    return ((uint32_t)p[0]) | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+}
+
+static inline void store32(uint8_t *p, uint32_t w)
+{
+    p[0] = w & 0xff;
+    p[1] = (w >> 8) & 0xff;
+    p[2] = (w >> 16) & 0xff;
+    p[3] = (w >> 24) & 0xff;
+}
+
+static inline void store_cv(uint8_t *out, const uint32_t cv[8])
+{
+    for (int i = 0; i < 8; i++)
+        store32(&out[i * 4], cv[i]);
+}
+
+static inline void load_cv(uint32_t cv[8], const uint8_t *in)
+{
+    for (int i = 0; i < 8; i++)
+        cv[i] = load32(&in[i * 4]);
+}
+
+static inline void g(uint32_t *s, int a, int b, int c, int d, uint32_t x, uint32_t y)
+{
+    s[a] = s[a] + s[b] + x;
+    s[d] = rotr32(s[d] ^ s[a], 16);
+    s[c] = s[c] + s[d];
+    s[b] = rotr32(s[b] ^ s[c], 12);
+    s[a] = s[a] + s[b] + y;
+    s[d] = rotr32(s[d] ^ s[a], 8);
+    s[c] = s[c] + s[d];
+    s[b] = rotr32(s[b] ^ s[c], 7);
+}
+
+static void compress(uint32_t state[16],
+                     const uint32_t cv[8],
+                     const uint8_t block[BLAKE3_BLOCK_LEN],
+                     uint8_t block_len,
+                     uint64_t counter,
+                     uint8_t flags)
+{
+    uint32_t m[16];
+
+    for (int i = 0; i < 16; i++)
+        m[i] = load32(&block[i * 4]);
+
+    for (int i = 0; i < 8; i++)
+        state[i] = cv[i];
+
+    state[8] = blake3_iv[0];
+    state[9] = blake3_iv[1];
+    state[10] = blake3_iv[2];
+    state[11] = blake3_iv[3];
+    state[12] = (uint32_t)counter;
+    state[13] = (uint32_t)(counter >> 32);
+    state[14] = block_len;
+    state[15] = flags;
+
+    for (int r = 0; r < 7; r++) {
+        const uint8_t *ms = msg_schedule[r];
+
+        g(state, 0, 4, 8, 12, m[ms[0]], m[ms[1]]);
+        g(state, 1, 5, 9, 13, m[ms[2]], m[ms[3]]);
+        g(state, 2, 6, 10, 14, m[ms[4]], m[ms[5]]);
+        g(state, 3, 7, 11, 15, m[ms[6]], m[ms[7]]);
+        g(state, 0, 5, 10, 15, m[ms[8]], m[ms[9]]);
+        g(state, 1, 6, 11, 12, m[ms[10]], m[ms[11]]);
+        g(state, 2, 7, 8, 13, m[ms[12]], m[ms[13]]);
+        g(state, 3, 4, 9, 14, m[ms[14]], m[ms[15]]);
+    }
+}
+
+static void compress_in_place(uint32_t cv[8],
+                              const uint8_t block[BLAKE3_BLOCK_LEN],
+                              uint8_t block_len,
+                              uint64_t counter,
+                              uint8_t flags)
+{
+    uint32_t state[16];
+
+    compress(state, cv, block, block_len, counter, flags);
+
+    for (int i = 0; i < 8; i++)
+        cv[i] = state[i] ^ state[i + 8];
+}
+
+static void chunk_state_init(struct blake3_chunk_state *self, uint64_t counter)
+{
+    memcpy(self->cv, blake3_iv, sizeof(self->cv));
+    memset(self->buf, 0, sizeof(self->buf));
+    self->counter = counter;
+    self->buf_len = 0;
+    self->blocks_compressed = 0;
+}
+
+static size_t chunk_state_len(const struct blake3_chunk_state *self)
+{
+    return (BLAKE3_BLOCK_LEN * (size_t)self->blocks_compressed) + self->buf_len;
+}
+
+static uint8_t chunk_state_start_flag(const struct blake3_chunk_state *self)
+{
+    return (self->blocks_compressed == 0) ? CHUNK_START : 0;
+}
+
+/* The last block of a chunk is kept in 'buf', since it needs the
+ * CHUNK_END flag and possibly the ROOT flag */
+static void chunk_state_update(struct blake3_chunk_state *self, const uint8_t *input, size_t length)
+{
+    while (length > 0) {
+        if (self->buf_len == BLAKE3_BLOCK_LEN) {
+            compress_in_place(self->cv,
+                              self->buf,
+                              BLAKE3_BLOCK_LEN,
+                              self->counter,
+                              chunk_state_start_flag(self));
+            self->blocks_compressed++;
+            self->buf_len = 0;
+            memset(self->buf, 0, sizeof(self->buf));
+        }
+
+        if ((self->buf_len == 0) && (length > BLAKE3_BLOCK_LEN)) {
+            compress_in_place(
+                self->cv, input, BLAKE3_BLOCK_LEN, self->counter, chunk_state_start_flag(self));
+            self->blocks_compressed++;
+            input += BLAKE3_BLOCK_LEN;
+            length -= BLAKE3_BLOCK_LEN;
+            continue;
+        }
+
+        size_t take = BLAKE3_BLOCK_LEN - self->buf_len;
+
+        if (take > length)
+            take = length;
+
+        memcpy(&self->buf[self->buf_len], input, take);
+        self->buf_len += take;
+        input += take;
+        length -= take;
+    }
+}
+
+static void chunk_state_output(const struct blake3_chunk_state *self, struct blake3_output *out)
+{
+    memcpy(out->cv, self->cv, sizeof(out->cv));
+    memcpy(out->block, self->buf, sizeof(out->block));
+    out->block_len = self->buf_len;
+    out->counter = self->counter;
+    out->flags = chunk_state_start_flag(self) | CHUNK_END;
+}
+
+static void parent_output(const uint8_t *children, struct blake3_output *out)
+{
+    memcpy(out->cv, blake3_iv, sizeof(out->cv));
+    memcpy(out->block, children, BLAKE3_BLOCK_LEN);
+    out->block_len = BLAKE3_BLOCK_LEN;
+    out->counter = 0;
+    out->flags = PARENT;
+}
+
+static void output_cv(const struct blake3_output *self, uint8_t *cv_out)
+{
+    uint32_t cv[8];
+
+    memcpy(cv, self->cv, sizeof(cv));
+    compress_in_place(cv, self->block, self->block_len, self->counter, self->flags);
+    store_cv(cv_out, cv);
+}
+
+static void output_root_bytes(const struct blake3_output *self, uint8_t *out, size_t out_length)
+{
+    uint64_t counter = 0;
+    uint32_t state[16];
+    uint8_t block[BLAKE3_BLOCK_LEN];
+
+    while (out_length > 0) {
+        size_t take = out_length > BLAKE3_BLOCK_LEN ? BLAKE3_BLOCK_LEN : out_length;
+
+        compress(state, self->cv, self->block, self->block_len, counter++, self->flags | ROOT);
+
+        for (int i = 0; i < 8; i++) {
+            store32(&block[i * 4], state[i] ^ state[i + 8]);
+            store32(&block[(i + 8) * 4], state[i + 8] ^ self->cv[i]);
+        }
+
+        memcpy(out, block, take);
+        out += take;
+        out_length -= take;
+    }
+}
+
+static void chunk_cv(const uint8_t *input, size_t length, uint64_t counter, uint8_t *cv)
+{
+    struct blake3_chunk_state chunk;
+    struct blake3_output output;
+
+    chunk_state_init(&chunk, counter);
+    chunk_state_update(&chunk, input, length);
+    chunk_state_output(&chunk, &output);
+    output_cv(&output, cv);
+}
+
+static unsigned int popcount64(uint64_t x)
+{
+    unsigned int n = 0;
+
+    while (x) {
+        x &= x - 1;
+        n++;
+    }
+
+    return n;
+}
+
+/* Merge complete subtrees until the stack has one entry for every set bit in
+ * 'total_chunks'. The top entry is left as is, it could be the root. */
+static void hasher_merge_cv_stack(struct blake3_hasher *self, uint64_t total_chunks)
+{
+    unsigned int post_merge_len = popcount64(total_chunks);
+
+    while (self->cv_stack_len > post_merge_len) {
+        uint8_t *children = &self->cv_stack[(self->cv_stack_len - 2) * BLAKE3_OUT_LEN];
+
+        blake3_parent_cv(children, children);
+        self->cv_stack_len--;
+    }
+}
+
+static void hasher_push_cv(struct blake3_hasher *self, const uint8_t *cv, uint64_t counter)
+{
+    hasher_merge_cv_stack(self, counter);
+    memcpy(&self->cv_stack[self->cv_stack_len * BLAKE3_OUT_LEN], cv, BLAKE3_OUT_LEN);
+    self->cv_stack_len++;
+}
+
+void blake3_parent_cv(const uint8_t *children, uint8_t *cv)
+{
+    struct blake3_output output;
+
+    parent_output(children, &output);
+    output_cv(&output, cv);
+}
+
+void blake3_subtree_cv(const uint8_t *input, size_t length, uint64_t counter, uint8_t *cv)
+{
+    uint8_t children[2 * BLAKE3_OUT_LEN];
+    size_t half = length / 2;
+
+    if (length <= BLAKE3_CHUNK_LEN) {
+        chunk_cv(input, length, counter, cv);
+        return;
+    }
+
+    blake3_subtree_cv(input, half, counter, children);
+    blake3_subtree_cv(&input[half], half, counter + (half / BLAKE3_CHUNK_LEN), &children[32]);
+    blake3_parent_cv(children, cv);
+}
+
+void blake3_subtree_cvs(const uint8_t *input, size_t length, uint64_t counter, uint8_t *cvs)
+{
+    size_t half = length / 2;
+
+    if (length <= BLAKE3_CHUNK_LEN) {
+        chunk_cv(input, length, counter, cvs);
+        return;
+    }
+
+    blake3_subtree_cv(input, half, counter, cvs);
+    blake3_subtree_cv(
+        &input[half], half, counter + (half / BLAKE3_CHUNK_LEN), &cvs[BLAKE3_OUT_LEN]);
+}
+
+size_t blake3_subtree_len(uint64_t counter, size_t length)
+{
+    size_t subtree_len = 1;
+    uint64_t count_so_far = counter * BLAKE3_CHUNK_LEN;
+
+    while (subtree_len <= (length / 2))
+        subtree_len *= 2;
+
+    /* The subtree must start at a multiple of its own size */
+    while ((((uint64_t)subtree_len - 1) & count_so_far) != 0)
+        subtree_len /= 2;
+
+    return subtree_len;
+}
+
+void blake3_hasher_init(struct blake3_hasher *self)
+{
+    chunk_state_init(&self->chunk, 0);
+    self->cv_stack_len = 0;
+}
+
+size_t blake3_hasher_update_head(struct blake3_hasher *self, const void *input, size_t length)
+{
+    size_t take;
+    uint8_t cv[BLAKE3_OUT_LEN];
+    struct blake3_output output;
+
+    if (chunk_state_len(&self->chunk) == 0)
+        return 0;
+
+    take = BLAKE3_CHUNK_LEN - chunk_state_len(&self->chunk);
+
+    if (take > length)
+        take = length;
+
+    chunk_state_update(&self->chunk, input, take);
+
+    /* The chunk is only complete if there is more input */
+    if (take < length) {
+        chunk_state_output(&self->chunk, &output);
+        output_cv(&output, cv);
+        hasher_push_cv(self, cv, self->chunk.counter);
+        chunk_state_init(&self->chunk, self->chunk.counter + 1);
+    }
+
+    return take;
+}
+
+void blake3_hasher_push_subtree(struct blake3_hasher *self, const uint8_t *cvs, size_t length)
+{
+    uint64_t chunks = length / BLAKE3_CHUNK_LEN;
+
+    if (chunks <= 1) {
+        hasher_push_cv(self, cvs, self->chunk.counter);
+    } else {
+        /* The parent of the two halves could be the root, leave it to
+         * the merge */
+        hasher_push_cv(self, cvs, self->chunk.counter);
+        hasher_push_cv(self, &cvs[BLAKE3_OUT_LEN], self->chunk.counter + (chunks / 2));
+    }
+
+    self->chunk.counter += chunks;
+}
+
+void blake3_hasher_update(struct blake3_hasher *self, const void *input, size_t length)
+{
+    const uint8_t *p = input;
+    size_t n = blake3_hasher_update_head(self, p, length);
+    uint8_t cvs[2 * BLAKE3_OUT_LEN];
+
+    p += n;
+    length -= n;
+
+    while (length > BLAKE3_CHUNK_LEN) {
+        size_t subtree_len = blake3_subtree_len(self->chunk.counter, length);
+
+        blake3_subtree_cvs(p, subtree_len, self->chunk.counter, cvs);
+        blake3_hasher_push_subtree(self, cvs, subtree_len);
+        p += subtree_len;
+        length -= subtree_len;
+    }
+
+    if (length > 0) {
+        chunk_state_update(&self->chunk, p, length);
+        hasher_merge_cv_stack(self, self->chunk.counter);
+    }
+}
+
+void blake3_hasher_finalize(const struct blake3_hasher *self, uint8_t *out, size_t out_length)
+{
+    struct blake3_output output;
+    uint8_t children[2 * BLAKE3_OUT_LEN];
+    size_t cvs_remaining;
+
+    if (self->cv_stack_len == 0) {
+        chunk_state_output(&self->chunk, &output);
+        output_root_bytes(&output, out, out_length);
+        return;
+    }
+
+    if (chunk_state_len(&self->chunk) > 0) {
+        cvs_remaining = self->cv_stack_len;
+        chunk_state_output(&self->chunk, &output);
+    } else {
+        /* There are at least two entries on the stack in this case */
+        cvs_remaining = self->cv_stack_len - 2;
+        parent_output(&self->cv_stack[cvs_remaining * BLAKE3_OUT_LEN], &output);
+    }
+
+    while (cvs_remaining > 0) {
+        cvs_remaining--;
+        memcpy(children, &self->cv_stack[cvs_remaining * BLAKE3_OUT_LEN], BLAKE3_OUT_LEN);
+        output_cv(&output, &children[BLAKE3_OUT_LEN]);
+        parent_output(children, &output);
+    }
+
+    output_root_bytes(&output, out, out_length);
+}
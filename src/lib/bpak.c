@@ -300,6 +300,8 @@ const char *bpak_signature_kind(uint8_t signature_kind)
         return "secp384r1";
     case BPAK_SIGN_SECP521r1:
         return "secp521r1";
+    case BPAK_SIGN_ED25519:
+        return "ed25519";
     case BPAK_SIGN_RSA4096:
         return "rsa4096";
     default:
@@ -0,0 +1,97 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * LZ4 block decoder, see
+ * https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+ *
+ */
+
+#include <pb/errors.h>
+#include <pb/lz4.h>
+
+static int lz4_read_length(const uint8_t **ip, const uint8_t *iend, size_t *len)
+{
+    uint8_t b;
+
+    do {
+        if (*ip >= iend)
+            return -PB_ERR_PARAM;
+        b = *(*ip)++;
+        *len += b;
+    } while (b == 255);
+
+    return PB_OK;
+}
+
+int lz4_decompress(const uint8_t *src,
+                   size_t src_len,
+                   uint8_t *dst,
+                   size_t dst_len,
+                   size_t *out_len)
+{
+    int rc;
+    const uint8_t *ip = src;
+    const uint8_t *iend = src + src_len;
+    uint8_t *op = dst;
+    uint8_t *oend = dst + dst_len;
+
+    while (ip < iend) {
+        uint8_t token = *ip++;
+        size_t len = token >> 4;
+
+        /* Literals */
+        if (len == 15) {
+            rc = lz4_read_length(&ip, iend, &len);
+            if (rc != PB_OK)
+                return rc;
+        }
+
+        if ((size_t)(iend - ip) < len)
+            return -PB_ERR_PARAM;
+        if ((size_t)(oend - op) < len)
+            return -PB_ERR_BUF_TOO_SMALL;
+
+        while (len--)
+            *op++ = *ip++;
+
+        /* The last sequence only contains literals */
+        if (ip == iend)
+            break;
+
+        /* Match */
+        if ((iend - ip) < 2)
+            return -PB_ERR_PARAM;
+
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+
+        if ((offset == 0) || (offset > (size_t)(op - dst)))
+            return -PB_ERR_PARAM;
+
+        len = token & 0x0f;
+
+        if (len == 15) {
+            rc = lz4_read_length(&ip, iend, &len);
+            if (rc != PB_OK)
+                return rc;
+        }
+
+        len += 4;
+
+        if ((size_t)(oend - op) < len)
+            return -PB_ERR_BUF_TOO_SMALL;
+
+        /* Matches may overlap the output, copy byte by byte */
+        const uint8_t *match = op - offset;
+
+        while (len--)
+            *op++ = *match++;
+    }
+
+    *out_len = op - dst;
+    return PB_OK;
+}
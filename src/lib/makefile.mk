@@ -1,6 +1,7 @@
 src-$(CONFIG_LIB_BPAK) += src/lib/bpak.c
 src-$(CONFIG_LIB_ZLIB_CRC) += src/lib/crc.c
 src-$(CONFIG_LIB_DER_HELPERS) += src/lib/der_helpers.c
+src-$(CONFIG_LIB_BLAKE3) += src/lib/blake3.c
 
 # C standard library functions
 src-y  += src/lib/libc/string.c
@@ -52,3 +53,6 @@ src-$(CONFIG_LIB_XLAT_TBLS_ARMV8) += src/lib/xlat_tables_v2/aarch64/xlat_tables.
 cflags-$(CONFIG_LIB_XLAT_TBLS) += -I include/xlat_tables
 cflags-$(CONFIG_LIB_XLAT_TBLS_ARMV7) += -I include/xlat_tables/aarch32
 cflags-$(CONFIG_LIB_XLAT_TBLS_ARMV8) += -I include/xlat_tables/aarch64
+xlat-gen-arch-$(CONFIG_LIB_XLAT_TBLS_ARMV7) = aarch32
+xlat-gen-arch-$(CONFIG_LIB_XLAT_TBLS_ARMV8) = aarch64
+XLAT_STATIC_EL ?= 3
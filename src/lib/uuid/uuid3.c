@@ -24,7 +24,7 @@ int uuid_gen_uuid3(const uuid_t namespace_uu,
 {
     int err;
 
-    err = hash_init(HASH_MD5);
+    err = hash_init_length(HASH_MD5, 16 + unique_length);
 
     if (err != PB_OK)
         return err;
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <config.h>
 #include <pb/assert.h>
 #include <arch/arch.h>
 #include <arch/arch_helpers.h>
@@ -22,6 +23,9 @@
 static uint64_t base_xlation_table[NUM_BASE_LEVEL_ENTRIES]
         __aligned(NUM_BASE_LEVEL_ENTRIES * sizeof(uint64_t));
 
+/* Table that is programmed into TTBR0 by enable_mmu_svc_mon() */
+static const uint64_t *ttbr0_table = base_xlation_table;
+
 static unsigned long long get_max_supported_pa(void)
 {
     /* Physical address space size for long descriptor format. */
@@ -56,7 +60,37 @@ void init_xlat_tables(void)
                         &max_va, &max_pa);
 
     assert((PLAT_PHY_ADDR_SPACE_SIZE - 1U) <= get_max_supported_pa());
+    ttbr0_table = base_xlation_table;
+}
+
+#ifdef CONFIG_LIB_XLAT_TBLS_STATIC
+int init_xlat_tables_static(void)
+{
+    if (xlat_static_el != xlat_arch_current_el())
+        return -1;
+
+    assert(xlat_static_max_pa <= get_max_supported_pa());
+    ttbr0_table = xlat_static_base_table;
+    return 0;
+}
+#endif
+
+#ifdef CONFIG_LIB_XLAT_TBLS_STATIC_VERIFY
+int verify_xlat_tables_static(void)
+{
+    unsigned long long max_pa;
+    uintptr_t max_va;
+
+    init_xlation_table(0U, base_xlation_table, XLAT_TABLE_LEVEL_BASE,
+                        &max_va, &max_pa);
+
+    if (max_pa != xlat_static_max_pa)
+        return -1;
+
+    return xlat_tables_compare(base_xlation_table, xlat_static_base_table,
+                               NUM_BASE_LEVEL_ENTRIES, XLAT_TABLE_LEVEL_BASE);
 }
+#endif
 
 void enable_mmu_svc_mon(unsigned int flags)
 {
@@ -97,7 +131,7 @@ void enable_mmu_svc_mon(unsigned int flags)
     write_ttbcr(ttbcr);
 
     /* Set TTBR0 bits as well */
-    ttbr0 = (uintptr_t) base_xlation_table;
+    ttbr0 = (uintptr_t) ttbr0_table;
     write64_ttbr0(ttbr0);
     write64_ttbr1(0U);
 
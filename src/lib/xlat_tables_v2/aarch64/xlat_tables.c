@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <config.h>
 #include <pb/assert.h>
 #include <stdint.h>
 #include <arch/arch.h>
@@ -23,6 +24,9 @@
 static uint64_t base_xlation_table[NUM_BASE_LEVEL_ENTRIES]
 		__aligned(NUM_BASE_LEVEL_ENTRIES * sizeof(uint64_t));
 
+/* Table that is programmed into TTBR0 by enable_mmu_elx() */
+static const uint64_t *ttbr0_table = base_xlation_table;
+
 static unsigned long long tcr_ps_bits;
 
 static unsigned long long calc_physical_addr_size_bits(
@@ -127,7 +131,40 @@ void init_xlat_tables(void)
 	assert((PLAT_PHY_ADDR_SPACE_SIZE - 1U) <= get_max_supported_pa());
 
 	tcr_ps_bits = calc_physical_addr_size_bits(max_pa);
+	ttbr0_table = base_xlation_table;
+}
+
+#ifdef CONFIG_LIB_XLAT_TBLS_STATIC
+int init_xlat_tables_static(void)
+{
+	if (xlat_static_el != xlat_arch_current_el())
+		return -1;
+
+	assert(xlat_static_max_pa <= (PLAT_PHY_ADDR_SPACE_SIZE - 1U));
+	assert((PLAT_PHY_ADDR_SPACE_SIZE - 1U) <= get_max_supported_pa());
+
+	tcr_ps_bits = calc_physical_addr_size_bits(xlat_static_max_pa);
+	ttbr0_table = xlat_static_base_table;
+	return 0;
+}
+#endif
+
+#ifdef CONFIG_LIB_XLAT_TBLS_STATIC_VERIFY
+int verify_xlat_tables_static(void)
+{
+	unsigned long long max_pa;
+	uintptr_t max_va;
+
+	init_xlation_table(0U, base_xlation_table, XLAT_TABLE_LEVEL_BASE,
+			   &max_va, &max_pa);
+
+	if (max_pa != xlat_static_max_pa)
+		return -1;
+
+	return xlat_tables_compare(base_xlation_table, xlat_static_base_table,
+				   NUM_BASE_LEVEL_ENTRIES, XLAT_TABLE_LEVEL_BASE);
 }
+#endif
 
 /*******************************************************************************
  * Macro generating the code for the function enabling the MMU in the given
@@ -178,7 +215,7 @@ void init_xlat_tables(void)
 		write_tcr_el##_el(tcr);					\
 									\
 		/* Set TTBR bits as well */				\
-		ttbr = (uint64_t) base_xlation_table;			\
+		ttbr = (uint64_t) ttbr0_table;				\
 		write_ttbr0_el##_el(ttbr);				\
 									\
 		/* Ensure all translation table writes have drained */	\
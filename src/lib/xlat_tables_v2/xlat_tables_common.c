@@ -387,6 +387,38 @@ static mmap_region_t *init_xlation_table_inner(mmap_region_t *mm,
     return mm;
 }
 
+#ifdef CONFIG_LIB_XLAT_TBLS_STATIC_VERIFY
+/*
+ * The two trees are built in different storage, so table descriptors only
+ * have to agree on their attributes and the walk continues in the next
+ * level tables they point to. Block, page and invalid descriptors must be
+ * identical.
+ */
+int xlat_tables_compare(const uint64_t *table, const uint64_t *ref,
+                        unsigned int entries, unsigned int level)
+{
+    for (unsigned int i = 0; i < entries; i++) {
+        uint64_t desc = table[i];
+        uint64_t ref_desc = ref[i];
+
+        if ((level < XLAT_TABLE_LEVEL_MAX) && ((desc & DESC_MASK) == TABLE_DESC)) {
+            if (((ref_desc & DESC_MASK) != TABLE_DESC) ||
+                ((desc & ~TABLE_ADDR_MASK) != (ref_desc & ~TABLE_ADDR_MASK)))
+                return -1;
+
+            if (xlat_tables_compare((const uint64_t *)(uintptr_t)(desc & TABLE_ADDR_MASK),
+                                    (const uint64_t *)(uintptr_t)(ref_desc & TABLE_ADDR_MASK),
+                                    XLAT_TABLE_ENTRIES, level + 1U) != 0)
+                return -1;
+        } else if (desc != ref_desc) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+#endif
+
 void reset_xlat_tables(void)
 {
     memset(xlat_tables, 0, sizeof(uint64_t) * MAX_XLAT_TABLES *
@@ -28,4 +28,16 @@ void init_xlation_table(uintptr_t base_va, uint64_t *table,
 			unsigned int level, uintptr_t *max_va,
 			unsigned long long *max_pa);
 
+/*
+ * Compare the tree at 'table' with the tree at 'ref', starting at 'level'.
+ * Returns 0 if both describe the same mapping.
+ */
+int xlat_tables_compare(const uint64_t *table, const uint64_t *ref,
+			unsigned int entries, unsigned int level);
+
+/* Generated by scripts/xlat_gen.py when CONFIG_LIB_XLAT_TBLS_STATIC is set */
+extern const unsigned int xlat_static_el;
+extern const unsigned long long xlat_static_max_pa;
+extern const uint64_t xlat_static_base_table[];
+
 #endif /* XLAT_TABLES_PRIVATE_H */
@@ -13,10 +13,29 @@
 #include <pb/pb.h>
 #include <pb/plat.h>
 #include <pb/self_test.h>
+#include <pb/smp.h>
+#include <pb/stub.h>
 #include <pb/timestamp.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+#ifdef CONFIG_IMAGE_LZ4
+struct pb_stub_handoff pb_stub_handoff;
+
+static void stub_report(void)
+{
+    if ((pb_stub_handoff.magic != PB_STUB_HANDOFF_MAGIC) || (pb_stub_handoff.tick_freq == 0))
+        return;
+
+    unsigned int us =
+        (unsigned int)(((uint64_t)pb_stub_handoff.ticks * 1000000) / pb_stub_handoff.tick_freq);
+
+    LOG_INFO("LZ4 stub: unpacked %u byte payload in %u us",
+             (unsigned int)pb_stub_handoff.compressed_size,
+             us);
+}
+#endif
+
 void main(void)
 {
     int rc;
@@ -28,6 +47,14 @@ void main(void)
     if (rc != PB_OK)
         goto enter_command_mode;
 
+#ifdef CONFIG_IMAGE_LZ4
+    stub_report();
+#endif
+
+#ifdef CONFIG_SMP
+    (void)smp_init();
+#endif
+
     rc = plat_board_init();
 
     if (rc != PB_OK)
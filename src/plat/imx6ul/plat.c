@@ -8,8 +8,10 @@
  */
 
 #include <drivers/fuse/imx_ocotp.h>
+#include <drivers/irq/gicv2.h>
 #include <drivers/timer/imx_gpt.h>
 #include <drivers/wdog/imx_wdog.h>
+#include <pb/arena.h>
 #include <pb/mmio.h>
 #include <pb/pb.h>
 #include <pb/plat.h>
@@ -70,6 +72,10 @@ static const mmap_region_t imx_mmap[] = {
     MAP_REGION_FLAT(0x02000000, (1024 * 1024), MT_DEVICE | MT_RW),
     /* AIPS-2 */
     MAP_REGION_FLAT(0x02100000, (1024 * 1024), MT_DEVICE | MT_RW),
+#ifdef CONFIG_DRIVER_GICV2
+    /* ARM GIC-400 */
+    MAP_REGION_FLAT(0x00A00000, (32 * 1024), MT_DEVICE | MT_RW),
+#endif
     { 0 }
 };
 
@@ -278,6 +284,18 @@ int plat_init(void)
     imx_wdog_kick();
     plat_mmu_init();
 
+#ifdef CONFIG_ARENA
+    if (arena_init(rw_nox_end, BOARD_RAM_END) != PB_OK)
+        return -PB_ERR_MEM;
+#endif
+
+#ifdef CONFIG_DRIVER_GICV2
+    int rc = gicv2_init(IMX6UL_GICD_BASE, IMX6UL_GICC_BASE);
+
+    if (rc != PB_OK)
+        LOG_WARN("GIC init failed (%i)", rc);
+#endif
+
     return PB_OK;
 }
 
@@ -10,6 +10,7 @@
 #include <drivers/fuse/imx_ocotp.h>
 #include <drivers/timer/imx_gpt.h>
 #include <drivers/wdog/imx_wdog.h>
+#include <pb/arena.h>
 #include <pb/mmio.h>
 #include <pb/pb.h>
 #include <pb/plat.h>
@@ -210,6 +211,11 @@ int plat_init(void)
     imx_wdog_kick();
     plat_mmu_init();
 
+#ifdef CONFIG_ARENA
+    if (arena_init(rw_nox_end, BOARD_RAM_END) != PB_OK)
+        return -PB_ERR_MEM;
+#endif
+
     LOG_DBG("Plat init done");
     return PB_OK;
 }
@@ -10,6 +10,7 @@
 #include <drivers/timer/imx_gpt.h>
 #include <drivers/uart/imx_lpuart.h>
 #include <drivers/usb/imx_ci_udc.h>
+#include <pb/arena.h>
 #include <pb/console.h>
 #include <pb/crypto.h>
 #include <pb/pb.h>
@@ -236,6 +237,11 @@ int plat_init(void)
     imx8x_mmu_init();
     ts("MMU end");
 
+#ifdef CONFIG_ARENA
+    if (arena_init(rw_nox_end, BOARD_RAM_END) != PB_OK)
+        return -PB_ERR_MEM;
+#endif
+
     imx8x_fuse_init(plat.ipc);
     imx8x_rot_helpers_init(plat.ipc);
     imx8x_slc_helpers_init(plat.ipc);
@@ -1,4 +1,6 @@
+#include <arch/nvic.h>
 #include <boot/boot.h>
+#include <drivers/crypto/ed25519.h>
 #include <drivers/crypto/mbedtls.h>
 #include <drivers/fuse/imx_ocotp.h>
 #include <drivers/timer/imx_gpt.h>
@@ -116,8 +118,20 @@ int plat_init(void)
 
     imx_gpt_init(IMXRT_GPT1_BASE, MHz(plat.ipg_root_clk_MHz));
 
+#ifdef CONFIG_IRQ
+    rc = nvic_init();
+
+    if (rc != PB_OK)
+        LOG_WARN("NVIC init failed (%i)", rc);
+#endif
+
     rc = mbedtls_pb_init();
 
+#ifdef CONFIG_DRIVERS_CRYPTO_ED25519
+    if (rc == PB_OK)
+        rc = ed25519_pb_init();
+#endif
+
     return rc;
 }
 
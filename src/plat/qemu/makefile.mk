@@ -32,6 +32,8 @@ cflags-$(CONFIG_QEMU_ENABLE_TEST_COVERAGE) += -g -fprofile-arcs -ftest-coverage
 
 ldflags-y += -Tsrc/plat/qemu/link.lds
 
+xlat-regions-$(CONFIG_LIB_XLAT_TBLS_STATIC) = src/plat/qemu/xlat_regions.def
+
 QEMU ?= qemu-system-arm
 QEMU_AUDIO_DRV = "none"
 QEMU_FLAGS  = -machine virt -cpu cortex-a15 -m $(CONFIG_QEMU_RAM_MB)
@@ -45,8 +47,17 @@ QEMU_FLAGS += -device virtio-blk-device,drive=disk
 QEMU_FLAGS += -drive id=disk,file=$(CONFIG_QEMU_VIRTIO_DISK),cache=none,if=none,format=raw
 # Disable default NIC
 QEMU_FLAGS += -net none
+ifdef CONFIG_SMP
+QEMU_FLAGS += -smp $(CONFIG_SMP_MAX_CPUS)
+endif
+
+ifdef CONFIG_IMAGE_LZ4
+QEMU_KERNEL = $(BUILD_DIR)/$(TARGET)_stub
+else
+QEMU_KERNEL = $(BUILD_DIR)/$(TARGET)
+endif
 
-qemu: $(BUILD_DIR)/$(TARGET)
-	$(Q)$(QEMU) $(QEMU_FLAGS) $(QEMU_AUX_FLAGS) -kernel $(BUILD_DIR)/$(TARGET)
+qemu: $(QEMU_KERNEL)
+	$(Q)$(QEMU) $(QEMU_FLAGS) $(QEMU_AUX_FLAGS) -kernel $(QEMU_KERNEL)
 
 endif
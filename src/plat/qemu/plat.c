@@ -9,10 +9,13 @@
 
 #include "gcov.h"
 #include "uart.h"
+#include <arch/arch_helpers.h>
 #include <board/config.h>
 #include <board_defs.h>
 #include <bpak/bpak.h>
+#include <drivers/irq/gicv2.h>
 #include <drivers/fuse/test_fuse_bio.h>
+#include <pb/arena.h>
 #include <pb/console.h>
 #include <pb/plat.h>
 #include <plat/qemu/qemu.h>
@@ -21,7 +24,11 @@
 #include <string.h>
 #include <uuid.h>
 #include <xlat_tables.h>
+#ifdef CONFIG_SMP
+#include <arch/psci.h>
+#endif
 
+/* Linker symbols, also used by xlat_regions.def */
 IMPORT_SYM(uintptr_t, _code_start, code_start);
 IMPORT_SYM(uintptr_t, _code_end, code_end);
 IMPORT_SYM(uintptr_t, _data_region_start, data_start);
@@ -40,11 +47,6 @@ IMPORT_SYM(uintptr_t, __fini_array_end2, fini_array_end);
 static const uint8_t device_unique_id[8] = "\xbe\x4e\xfc\xb4\x32\x58\xcd\x63";
 const char *platform_ns_uuid = "\x3f\xaf\xc6\xd3\xc3\x42\x4e\xdf\xa5\xa6\x0e\xb1\x39\xa7\x83\xb5";
 
-static const mmap_region_t qemu_mmap[] = {
-    MAP_REGION_FLAT(0x00000000, (1024 * 1024 * 1024), MT_DEVICE | MT_RW),
-    { 0 }
-};
-
 int plat_boot_reason(void)
 {
     return 0;
@@ -65,48 +67,40 @@ int plat_get_unique_id(uint8_t *output, size_t *length)
     return PB_OK;
 }
 
-static void mmu_init(void)
+static void mmu_add_regions(void)
 {
     reset_xlat_tables();
 
-    mmap_add_region(code_start, code_start, code_end - code_start, MT_RO | MT_MEMORY | MT_EXECUTE);
-
-    mmap_add_region(
-        data_start, data_start, data_end - data_start, MT_RW | MT_MEMORY | MT_EXECUTE_NEVER);
-
-    mmap_add_region(ro_data_start,
-                    ro_data_start,
-                    ro_data_end - ro_data_start,
-                    MT_RO | MT_MEMORY | MT_EXECUTE_NEVER);
-
-    mmap_add_region(
-        stack_start, stack_start, stack_end - stack_start, MT_RW | MT_MEMORY | MT_EXECUTE_NEVER);
-
-    mmap_add_region(rw_nox_start,
-                    rw_nox_start,
-                    rw_nox_end - rw_nox_start,
-                    MT_RW | MT_MEMORY | MT_EXECUTE_NEVER);
+    /* Same regions as the static tables */
+#define XLAT_SYM(sym)                   ((uintptr_t)(sym))
+#define XLAT_REGION(pa, va, size, attr) mmap_add_region(pa, va, size, attr);
+#include "xlat_regions.def"
+#undef XLAT_REGION
+#undef XLAT_SYM
+}
 
-#ifdef CONFIG_QEMU_ENABLE_TEST_COVERAGE
-    mmap_add_region(init_array_start,
-                    init_array_start,
-                    init_array_end - init_array_start,
-                    MT_RW | MT_MEMORY | MT_EXECUTE);
-
-    mmap_add_region(fini_array_start,
-                    fini_array_start,
-                    fini_array_end - fini_array_start,
-                    MT_RW | MT_MEMORY | MT_EXECUTE);
+static void mmu_init(void)
+{
+#ifdef CONFIG_LIB_XLAT_TBLS_STATIC
+    /* Tables generated from xlat_regions.def at build time */
+    if (init_xlat_tables_static() == 0) {
+#ifdef CONFIG_LIB_XLAT_TBLS_STATIC_VERIFY
+        mmu_add_regions();
+
+        /* Halt, a fall back to the run-time tables would hide this from
+         * the test suite */
+        if (verify_xlat_tables_static() != 0) {
+            LOG_ERR("Static xlat tables differ from the run-time tables");
+            while (1)
+                ;
+        }
 #endif
-
-    /* Add the rest of the RAM */
-    mmap_add_region(
-        rw_nox_end, rw_nox_end, BOARD_RAM_END - rw_nox_end, MT_RW | MT_MEMORY | MT_EXECUTE_NEVER);
-    mmap_add_region(
-        data_start, data_start, data_end - data_start, MT_RW | MT_MEMORY | MT_EXECUTE_NEVER);
-
-    mmap_add(qemu_mmap);
-
+        enable_mmu_svc_mon(0);
+        LOG_DBG("MMU Enabled, static tables");
+        return;
+    }
+#endif
+    mmu_add_regions();
     init_xlat_tables();
     LOG_DBG("About to enable MMU");
     enable_mmu_svc_mon(0);
@@ -123,10 +117,22 @@ int plat_init(void)
 
     mmu_init();
 
+#ifdef CONFIG_ARENA
+    if (arena_init(rw_nox_end, BOARD_RAM_END) != PB_OK)
+        return -PB_ERR_MEM;
+#endif
+
 #ifdef CONFIG_QEMU_ENABLE_TEST_COVERAGE
     gcov_init();
 #endif
 
+#ifdef CONFIG_DRIVER_GICV2
+    int rc = gicv2_init(QEMU_GICD_BASE, QEMU_GICC_BASE);
+
+    if (rc != PB_OK)
+        LOG_WARN("GIC init failed (%i)", rc);
+#endif
+
     return PB_OK;
 }
 
@@ -135,7 +141,43 @@ int plat_board_init(void)
     return board_init();
 }
 
+#ifdef CONFIG_SMP
+/* QEMU 'virt' implements PSCI through the HVC conduit when EL2 is not emulated */
+int plat_smp_cpu_on(unsigned int cpu, uintptr_t entry, uintptr_t context)
+{
+    int32_t rc = arch_psci_hvc(PSCI_CPU_ON, cpu, entry, context);
+
+    if (rc != PSCI_RET_SUCCESS)
+        return -PB_ERR_IO;
+
+    return PB_OK;
+}
+
+void plat_smp_secondary_init(unsigned int cpu)
+{
+    (void)cpu;
+    enable_mmu_svc_mon(0);
+}
+
+void plat_smp_cpu_off(void)
+{
+    (void)arch_psci_hvc(PSCI_CPU_OFF, 0, 0, 0);
+}
+
+bool plat_smp_cpu_is_off(unsigned int cpu)
+{
+    /* Affinity level 0, the core itself */
+    return arch_psci_hvc(PSCI_AFFINITY_INFO, cpu, 0, 0) == PSCI_AFFINITY_OFF;
+}
+#endif
+
+/* The generic timer of the emulated core */
 uint32_t plat_get_us_tick(void)
 {
-    return 0;
+    uint32_t freq = read_cntfrq();
+
+    if (freq == 0)
+        return 0;
+
+    return (uint32_t)((read64_cntpct() * 1000000ULL) / freq);
 }
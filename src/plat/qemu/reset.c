@@ -9,8 +9,10 @@
  */
 
 #include "gcov.h"
+#include <arch/psci.h>
 #include <pb/pb.h>
 #include <pb/plat.h>
+#include <plat/qemu/qemu.h>
 #include <plat/qemu/semihosting.h>
 #include <stdio.h>
 
@@ -26,3 +28,11 @@ void plat_reset(void)
 #endif
     semihosting_sys_exit(rc);
 }
+
+void qemu_warm_reset(void)
+{
+    /* QEMU resets the machine and reloads the image, RAM outside of the
+     * loaded sections keeps its contents */
+    (void)arch_psci_hvc(PSCI_SYSTEM_RESET, 0, 0, 0);
+    semihosting_sys_exit(1); /* Should not be reached */
+}
@@ -95,7 +95,7 @@ int rot_get_dsa_key(key_id_t id, dsa_t *dsa_kind, const uint8_t **der_data, size
     const struct bpak_key *key = NULL;
     int rc;
 
-    if (!cfg || !cfg->key_map || !cfg->key_map_length)
+    if (!cfg || !cfg->key_map_length)
         return -PB_ERR_NOT_SUPPORTED;
 
     rc = rot_read_key_status(id);
@@ -123,6 +123,9 @@ int rot_get_dsa_key(key_id_t id, dsa_t *dsa_kind, const uint8_t **der_data, size
     case BPAK_KEY_PUB_SECP521r1:
         *dsa_kind = DSA_EC_SECP521r1;
         break;
+    case BPAK_KEY_PUB_ED25519:
+        *dsa_kind = DSA_ED25519;
+        break;
     default:
         return -PB_ERR_NOT_SUPPORTED;
     }
@@ -0,0 +1,177 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <arch/arch.h>
+#include <arch/arch_helpers.h>
+#include <pb/delay.h>
+#include <pb/pb.h>
+#include <pb/plat.h>
+#include <pb/smp.h>
+
+#define SMP_PARK_TIMEOUT_US 100000
+
+/* Defined by the architecture specific secondary entry code */
+extern void arch_smp_secondary_entry(void);
+
+uint8_t smp_stacks[CONFIG_SMP_MAX_CPUS - 1][CONFIG_SMP_STACK_SIZE_KiB * 1024] __aligned(16);
+
+/*
+ * Work queue with one producer, the primary core, and any number of
+ * consumers. 'head' is only written by the producer, consumers claim items
+ * by advancing 'tail' with a compare-and-swap. The slot at 'tail' can't be
+ * reused by the producer before it has been claimed.
+ */
+static struct {
+    struct smp_work *ring[CONFIG_SMP_WORK_QUEUE_SIZE];
+    uint32_t head;
+    uint32_t tail;
+} wq;
+
+static uint32_t cores_started;
+static bool cpu_started[CONFIG_SMP_MAX_CPUS];
+static uint32_t park_request;
+
+static struct smp_work *smp_dequeue(void)
+{
+    struct smp_work *work;
+    uint32_t tail = __atomic_load_n(&wq.tail, __ATOMIC_ACQUIRE);
+
+    do {
+        if (tail == __atomic_load_n(&wq.head, __ATOMIC_ACQUIRE))
+            return NULL;
+        work = wq.ring[tail % CONFIG_SMP_WORK_QUEUE_SIZE];
+    } while (!__atomic_compare_exchange_n(
+        &wq.tail, &tail, tail + 1, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    return work;
+}
+
+static void smp_run(struct smp_work *work)
+{
+    work->fn(work->arg);
+    __atomic_store_n(&work->done, 1, __ATOMIC_RELEASE);
+    dsbish();
+    sev();
+}
+
+void smp_queue(struct smp_work *work)
+{
+    uint32_t head = wq.head;
+
+    work->done = 0;
+
+    if ((__atomic_load_n(&cores_started, __ATOMIC_ACQUIRE) == 0) ||
+        ((head - __atomic_load_n(&wq.tail, __ATOMIC_ACQUIRE)) >= CONFIG_SMP_WORK_QUEUE_SIZE)) {
+        smp_run(work);
+        return;
+    }
+
+    wq.ring[head % CONFIG_SMP_WORK_QUEUE_SIZE] = work;
+    __atomic_store_n(&wq.head, head + 1, __ATOMIC_RELEASE);
+    dsbish();
+    sev();
+}
+
+void smp_wait(struct smp_work *work)
+{
+    while (!__atomic_load_n(&work->done, __ATOMIC_ACQUIRE)) {
+        struct smp_work *w = smp_dequeue();
+
+        if (w != NULL)
+            smp_run(w);
+        else
+            wfe();
+    }
+}
+
+void smp_secondary_main(unsigned int cpu)
+{
+    plat_smp_secondary_init(cpu);
+
+    while (!__atomic_load_n(&park_request, __ATOMIC_ACQUIRE)) {
+        struct smp_work *work = smp_dequeue();
+
+        if (work != NULL)
+            smp_run(work);
+        else
+            wfe();
+    }
+
+    /* The primary core waits for the power controller to report this core
+     * as off, a core that returns from here is never counted as parked */
+    plat_smp_cpu_off();
+
+    for (;;)
+        wfe();
+}
+
+int smp_init(void)
+{
+    int rc;
+
+    /* The secondary cores start with the MMU off and must not see stale
+     * lines of their stacks once the MMU is enabled */
+    arch_clean_cache_range((uintptr_t)smp_stacks, sizeof(smp_stacks));
+    arch_invalidate_cache_range((uintptr_t)smp_stacks, sizeof(smp_stacks));
+
+    for (unsigned int cpu = 1; cpu < CONFIG_SMP_MAX_CPUS; cpu++) {
+        rc = plat_smp_cpu_on(cpu, (uintptr_t)arch_smp_secondary_entry, cpu);
+
+        if (rc != PB_OK) {
+            LOG_WARN("Could not start core %u (%i)", cpu, rc);
+            continue;
+        }
+
+        cpu_started[cpu] = true;
+        __atomic_add_fetch(&cores_started, 1, __ATOMIC_ACQ_REL);
+    }
+
+    LOG_INFO("%u secondary core(s) started", (unsigned int)cores_started);
+    return PB_OK;
+}
+
+int smp_park(void)
+{
+    unsigned int started = __atomic_load_n(&cores_started, __ATOMIC_ACQUIRE);
+    unsigned int cores_parked;
+    struct pb_timeout timeout;
+
+    if (started == 0)
+        return PB_OK;
+
+    /* Drain the queue before the cores are stopped */
+    for (struct smp_work *w = smp_dequeue(); w != NULL; w = smp_dequeue())
+        smp_run(w);
+
+    __atomic_store_n(&park_request, 1, __ATOMIC_RELEASE);
+    dsbish();
+    sev();
+
+    pb_timeout_init_us(&timeout, SMP_PARK_TIMEOUT_US);
+
+    /* A core is parked when it has left the bootloader's memory, that is
+     * when the platform reports it as powered off */
+    do {
+        cores_parked = 0;
+
+        for (unsigned int cpu = 1; cpu < CONFIG_SMP_MAX_CPUS; cpu++) {
+            if (cpu_started[cpu] && plat_smp_cpu_is_off(cpu))
+                cores_parked++;
+        }
+
+        if (cores_parked == started) {
+            LOG_DBG("Parked %u core(s)", started);
+            __atomic_store_n(&cores_started, 0, __ATOMIC_RELEASE);
+            return PB_OK;
+        }
+    } while (!pb_timeout_has_expired(&timeout));
+
+    LOG_ERR("Timeout waiting for secondary cores to park (%u/%u off)", cores_parked, started);
+    return -PB_ERR_TIMEOUT;
+}
@@ -0,0 +1,52 @@
+#
+# Punch BOOT
+#
+# Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+#
+ifdef CONFIG_IMAGE_LZ4
+
+stub-src-y  = src/stub/stub.c
+stub-src-y += src/lib/lz4.c
+
+stub-asm-y  = src/stub/entry_armv7a.S
+stub-asm-y += src/stub/payload.S
+
+STUB_OBJS  = $(patsubst %.c, $(BUILD_DIR)/stub/%.o, $(stub-src-y))
+STUB_OBJS += $(patsubst %.S, $(BUILD_DIR)/stub/%.o, $(stub-asm-y))
+
+STUB_PAYLOAD = $(BUILD_DIR)/$(TARGET).bin.lz4
+
+stub-cflags-y  = $(cflags-y)
+stub-cflags-y += -DPB_STUB_LOAD_ADDR=$(PB_ENTRY)
+stub-cflags-y += -DPB_STUB_PAYLOAD=\"$(STUB_PAYLOAD)\"
+
+plat-y += $(BUILD_DIR)/$(TARGET)_stub.bin
+
+$(STUB_PAYLOAD): $(BUILD_DIR)/$(TARGET).bin scripts/lz4_pack.py
+	$(Q)$(PYTHON) scripts/lz4_pack.py $< $@
+
+$(BUILD_DIR)/stub/src/stub/payload.o: $(STUB_PAYLOAD)
+
+$(BUILD_DIR)/stub/%.o: %.S
+	@mkdir -p $(@D)
+	@echo AS $<
+	$(Q)$(CC) -D__ASSEMBLY__ -c $(stub-cflags-y) $< -o $@
+
+$(BUILD_DIR)/stub/%.o: %.c
+	@mkdir -p $(@D)
+	@echo CC $<
+	$(Q)$(CC) -c $(stub-cflags-y) $< -o $@
+
+$(BUILD_DIR)/$(TARGET)_stub: $(STUB_OBJS) src/stub/link.lds
+	@echo LD $@
+	$(Q)$(LD) --defsym=PB_STUB_ENTRY=$(CONFIG_IMAGE_LZ4_STUB_ENTRY) -Tsrc/stub/link.lds \
+		--build-id=none --gc-sections $(STUB_OBJS) -o $@
+
+$(BUILD_DIR)/$(TARGET)_stub.bin: $(BUILD_DIR)/$(TARGET)_stub
+	@echo OBJCOPY $< $@
+	$(Q)$(OBJCOPY) -O binary -R .comment $< $@
+
+endif
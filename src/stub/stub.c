@@ -0,0 +1,129 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Decompression stub. The boot ROM loads this small uncompressed program
+ * together with the LZ4 compressed bootloader. The stub unpacks the
+ * bootloader to its link address and jumps to it, see entry_armv7a.S.
+ * The decompression runs with the MMU and D$ enabled, through a flat
+ * section table where only the stub and the output are cacheable.
+ *
+ */
+
+#include <pb/errors.h>
+#include <pb/lz4.h>
+#include <pb/stub.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Short-descriptor 1 MiB sections, TEX remap disabled, AP = full access */
+#define SECTION_SHIFT  20
+#define SECTION_COUNT  4096
+#define SECTION_NORMAL 0x00001c0e /* TEX = 001, C, B: write-back, write-allocate */
+#define SECTION_DEVICE 0x00000c16 /* B: shareable device, XN */
+
+extern const uint8_t _stub_start[];
+extern const uint8_t _stub_end[];
+extern const uint8_t _payload_start[];
+
+struct pb_stub_handoff stub_handoff __attribute__((section(".data")));
+
+static uint32_t stub_xlat[SECTION_COUNT] __attribute__((section(".xlat"), aligned(16384)));
+
+void stub_main(void);
+void stub_dcache_invalidate(void);
+void stub_caches_off(void);
+
+static uint64_t read_cntpct(void)
+{
+    uint32_t lo, hi;
+
+    __asm__ volatile("isb\n\tmrrc p15, 0, %0, %1, c14" : "=r"(lo), "=r"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static uint32_t read_cntfrq(void)
+{
+    uint32_t freq;
+
+    __asm__ volatile("mrc p15, 0, %0, c14, c0, 0" : "=r"(freq));
+    return freq;
+}
+
+static void stub_map_normal(uintptr_t start, size_t length)
+{
+    if (length == 0)
+        return;
+
+    for (uintptr_t i = start >> SECTION_SHIFT; i <= (start + length - 1) >> SECTION_SHIFT; i++)
+        stub_xlat[i] = (i << SECTION_SHIFT) | SECTION_NORMAL;
+}
+
+/* Identity map everything, the stub and the output as normal memory. The
+ * table is written with the D$ disabled and walked non-cacheable. */
+static void stub_caches_on(size_t out_size)
+{
+    uint32_t sctlr;
+
+    for (uint32_t i = 0; i < SECTION_COUNT; i++)
+        stub_xlat[i] = (i << SECTION_SHIFT) | SECTION_DEVICE;
+
+    stub_map_normal((uintptr_t)_stub_start, _stub_end - _stub_start);
+    stub_map_normal(PB_STUB_LOAD_ADDR, out_size);
+
+    stub_dcache_invalidate();
+
+    __asm__ volatile("mcr p15, 0, %0, c8, c7, 0\n\t" /* TLBIALL */
+                     "mcr p15, 0, %0, c2, c0, 2\n\t" /* TTBCR, TTBR0 only */
+                     "mcr p15, 0, %1, c2, c0, 0\n\t" /* TTBR0 */
+                     "mcr p15, 0, %2, c3, c0, 0\n\t" /* DACR, domain 0 client */
+                     "dsb\n\tisb"
+                     :
+                     : "r"(0), "r"((uintptr_t)stub_xlat), "r"(1)
+                     : "memory");
+
+    __asm__ volatile("mrc p15, 0, %0, c1, c0, 0" : "=r"(sctlr));
+    sctlr |= (1 << 2) | 0x1; /* D$, MMU */
+    __asm__ volatile("mcr p15, 0, %0, c1, c0, 0\n\tisb" : : "r"(sctlr) : "memory");
+}
+
+void stub_main(void)
+{
+    const struct pb_stub_payload_header *hdr =
+        (const struct pb_stub_payload_header *)_payload_start;
+    size_t out_len;
+    uint64_t t_start, t_end;
+    int rc;
+
+    if (hdr->magic != PB_STUB_PAYLOAD_MAGIC)
+        goto err_halt;
+
+    t_start = read_cntpct();
+    stub_caches_on(hdr->size);
+
+    rc = lz4_decompress(_payload_start + sizeof(*hdr),
+                        hdr->compressed_size,
+                        (uint8_t *)PB_STUB_LOAD_ADDR,
+                        hdr->size,
+                        &out_len);
+
+    stub_caches_off();
+    t_end = read_cntpct();
+
+    if ((rc != PB_OK) || (out_len != hdr->size))
+        goto err_halt;
+
+    stub_handoff.magic = PB_STUB_HANDOFF_MAGIC;
+    stub_handoff.ticks = (uint32_t)(t_end - t_start);
+    stub_handoff.tick_freq = read_cntfrq();
+    stub_handoff.compressed_size = hdr->compressed_size;
+    return;
+
+err_halt:
+    /* There is no console this early, a corrupt payload just stops here */
+    for (;;)
+        ;
+}
@@ -32,7 +32,14 @@ start_qemu()
     done
 
     #( $QEMU $QEMU_FLAGS -kernel pb >> qemu.log 2>&1 ) &
-    ( $QEMU $QEMU_FLAGS -kernel build-test/pb ) &
+    if [ "$CONFIG_IMAGE_LZ4" = "y" ];
+    then
+        PB_KERNEL=build-test/pb_stub
+    else
+        PB_KERNEL=build-test/pb
+    fi
+
+    ( $QEMU $QEMU_FLAGS -kernel $PB_KERNEL ) &
     qemu_pid=$!
 
 }
@@ -99,4 +106,9 @@ PB=punchboot
 PBSTATE=pbstate
 BOOT_A=2af755d8-8de5-45d5-a862-014cfa735ce0
 BOOT_B=c046ccd8-0f2e-4036-984d-76c14dc73992
+# Location of the A/B state partitions on the test board disk, in 512 byte
+# blocks. The primary partition has a snapshot and 63 journal records.
+STATE_PRIMARY_LBA=2082
+STATE_PRIMARY_BLOCKS=64
+STATE_BACKUP_LBA=2146
 echo QEMU running, PID=$qemu_pid
@@ -2,6 +2,7 @@
 # Integration tests
 
 INTEGRATION_TESTS  = test_reset
+INTEGRATION_TESTS += test_dev_wait
 INTEGRATION_TESTS += test_part
 INTEGRATION_TESTS += test_device_setup
 INTEGRATION_TESTS += test_corrupt_gpt
@@ -10,6 +11,7 @@ INTEGRATION_TESTS += test_corrupt_gpt3
 INTEGRATION_TESTS += test_corrupt_gpt4
 INTEGRATION_TESTS += test_corrupt_gpt5
 INTEGRATION_TESTS += test_part_flash
+INTEGRATION_TESTS += test_part_delta_write
 INTEGRATION_TESTS += test_boot_bpak
 INTEGRATION_TESTS += test_boot_bpak2
 INTEGRATION_TESTS += test_boot_bpak3
@@ -20,7 +22,11 @@ INTEGRATION_TESTS += test_boot_bpak7
 INTEGRATION_TESTS += test_boot_bpak8
 INTEGRATION_TESTS += test_boot_bpak9
 INTEGRATION_TESTS += test_boot_bpak10
+INTEGRATION_TESTS += test_boot_part_digests
+INTEGRATION_TESTS += test_boot_warm
 INTEGRATION_TESTS += test_verify_bpak
+INTEGRATION_TESTS += test_verify_digests
+INTEGRATION_TESTS += test_provision
 # INTEGRATION_TESTS += test_bpak_show
 INTEGRATION_TESTS += test_invalid_key_index
 INTEGRATION_TESTS += test_gpt_boot_activate
@@ -33,6 +39,7 @@ INTEGRATION_TESTS += test_rollback
 INTEGRATION_TESTS += test_cli
 # INTEGRATION_TESTS += test_part_offset_write
 INTEGRATION_TESTS += test_overlapping_region
+INTEGRATION_TESTS += test_arena_overlap
 INTEGRATION_TESTS += test_corrupt_backup_gpt
 INTEGRATION_TESTS += test_corrupt_primary_config
 INTEGRATION_TESTS += test_corrupt_backup_config
@@ -44,7 +51,12 @@ INTEGRATION_TESTS += test_authentication
 INTEGRATION_TESTS += test_revoke_key
 INTEGRATION_TESTS += test_part_dump
 INTEGRATION_TESTS += test_part_dump2
+INTEGRATION_TESTS += test_part_dump_sparse
 INTEGRATION_TESTS += test_board_regs
+INTEGRATION_TESTS += test_state_journal
+INTEGRATION_TESTS += test_crypto_providers
+INTEGRATION_TESTS += test_mmc_stream_xfer
+INTEGRATION_TESTS += test_lz4_stub
 
 check: all
 	@mkdir -p $(BUILD_DIR)/tests
@@ -0,0 +1,52 @@
+#!/bin/bash
+source tests/common.sh
+wait_for_qemu_start
+
+# Create pbimage
+dd if=/dev/urandom of=/tmp/random_data bs=512k count=1
+
+set -e
+BPAK=bpak
+IMG=/tmp/img.bpak
+PKG_UUID=8df597ff-2cf5-42ea-b2b6-47c348721b75
+PKG_UNIQUE_ID=$(uuidgen -t)
+V=-vvv
+
+$BPAK create $IMG -Y --hash-kind sha256 --signature-kind prime256v1 $V
+
+$BPAK add $IMG --meta bpak-package --from-string $PKG_UUID --encoder uuid $V
+$BPAK add $IMG --meta bpak-package-uid --from-string $PKG_UNIQUE_ID --encoder uuid $V
+
+# The buffer arena is at the top of RAM, 0x7c000000 - 0x80000000 with
+# the test configuration
+$BPAK add $IMG --meta pb-load-addr --from-string 0x7ff00000 --part-ref kernel \
+                      --encoder integer $V
+
+$BPAK add $IMG --part kernel \
+               --from-file /tmp/random_data $V
+
+$BPAK set $IMG --key-id pb-development \
+               --keystore-id pb $V
+
+$BPAK sign $IMG --key pki/secp256r1-key-pair.pem
+set +e
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+# Loading image to ram and execute should fail because it
+# overlaps with the stream buffers in the arena
+
+$PB -t socket boot bpak /tmp/img.bpak
+result_code=$?
+
+if [ $result_code -ne 1 ];
+then
+    echo "result_code = $result_code"
+    test_end_error
+fi
+
+test_end_ok
@@ -2,16 +2,16 @@
 source tests/common.sh
 wait_for_qemu_start
 
-dd if=$CONFIG_QEMU_VIRTIO_DISK of=/tmp/pb_config_primary bs=512 count=1 skip=2082
-dd if=$CONFIG_QEMU_VIRTIO_DISK of=/tmp/pb_config_backup bs=512 count=1 skip=2083
+dd if=$CONFIG_QEMU_VIRTIO_DISK of=/tmp/pb_config_primary bs=512 count=$STATE_PRIMARY_BLOCKS skip=$STATE_PRIMARY_LBA
+dd if=$CONFIG_QEMU_VIRTIO_DISK of=/tmp/pb_config_backup bs=512 count=1 skip=$STATE_BACKUP_LBA
 
 $PBSTATE -p /tmp/pb_config_primary -b /tmp/pb_config_backup --write-board-reg 0 0x00000001
 $PBSTATE -p /tmp/pb_config_primary -b /tmp/pb_config_backup --write-board-reg 1 0x00000000
 $PBSTATE -p /tmp/pb_config_primary -b /tmp/pb_config_backup --write-board-reg 2 0x00000000
 $PBSTATE -p /tmp/pb_config_primary -b /tmp/pb_config_backup --write-board-reg 3 0x00000000
 
-dd if=/tmp/pb_config_primary of=$CONFIG_QEMU_VIRTIO_DISK bs=512 count=1 seek=2082 conv=notrunc
-dd if=/tmp/pb_config_backup of=$CONFIG_QEMU_VIRTIO_DISK bs=512 count=1 seek=2083 conv=notrunc
+dd if=/tmp/pb_config_primary of=$CONFIG_QEMU_VIRTIO_DISK bs=512 count=$STATE_PRIMARY_BLOCKS seek=$STATE_PRIMARY_LBA conv=notrunc
+dd if=/tmp/pb_config_backup of=$CONFIG_QEMU_VIRTIO_DISK bs=512 count=1 seek=$STATE_BACKUP_LBA conv=notrunc
 
 # Reset
 sync
@@ -28,8 +28,8 @@ echo "Starting qemu"
 start_qemu
 wait_for_qemu_start
 
-dd if=$CONFIG_QEMU_VIRTIO_DISK of=/tmp/pb_config_primary bs=512 count=1 skip=2082
-dd if=$CONFIG_QEMU_VIRTIO_DISK of=/tmp/pb_config_backup bs=512 count=1 skip=2083
+dd if=$CONFIG_QEMU_VIRTIO_DISK of=/tmp/pb_config_primary bs=512 count=$STATE_PRIMARY_BLOCKS skip=$STATE_PRIMARY_LBA
+dd if=$CONFIG_QEMU_VIRTIO_DISK of=/tmp/pb_config_backup bs=512 count=1 skip=$STATE_BACKUP_LBA
 
 echo "Sending reset"
 $PB -t socket dev reset
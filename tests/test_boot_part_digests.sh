@@ -0,0 +1,140 @@
+#!/bin/bash
+source tests/common.sh
+wait_for_qemu_start
+
+# Flips one byte in the middle of part number $2 of image $1
+tamper_part()
+{
+python3 - $1 $2 <<'EOF'
+import struct
+import sys
+
+img = bytearray(open(sys.argv[1], "rb").read())
+offset = 4096
+
+for i in range(int(sys.argv[2])):
+    _, size, _, _, pad_bytes = struct.unpack_from("<IQQQH", img, 520 + i * 32)
+    offset += size + pad_bytes
+
+_, size, _, _, _ = struct.unpack_from("<IQQQH", img, 520 + int(sys.argv[2]) * 32)
+img[offset + size // 2] ^= 0xFF
+open(sys.argv[1], "wb").write(img)
+EOF
+}
+
+dd if=/dev/urandom of=/tmp/random_kernel bs=64k count=1
+dd if=/dev/urandom of=/tmp/random_ramdisk bs=64k count=1
+dd if=/dev/urandom of=/tmp/random_recovery bs=16k count=1
+
+set -e
+BPAK=bpak
+IMG=/tmp/img.bpak
+PKG_UUID=8df597ff-2cf5-42ea-b2b6-47c348721b75
+PKG_UNIQUE_ID=$(uuidgen -t)
+V=-vvv
+
+$BPAK create $IMG -Y --hash-kind sha256 --signature-kind prime256v1 $V
+
+$BPAK add $IMG --meta bpak-package --from-string $PKG_UUID --encoder uuid $V
+$BPAK add $IMG --meta bpak-package-uid --from-string $PKG_UNIQUE_ID --encoder uuid $V
+
+$BPAK add $IMG --meta pb-load-addr --from-string 0x49000000 --part-ref kernel \
+                      --encoder integer $V
+$BPAK add $IMG --meta pb-load-addr --from-string 0x49100000 --part-ref ramdisk \
+                      --encoder integer $V
+$BPAK add $IMG --meta pb-load-addr --from-string 0x49200000 --part-ref recovery \
+                      --encoder integer $V
+
+$BPAK add $IMG --part kernel \
+               --from-file /tmp/random_kernel $V
+$BPAK add $IMG --part ramdisk \
+               --from-file /tmp/random_ramdisk $V
+$BPAK add $IMG --part recovery \
+               --from-file /tmp/random_recovery $V
+
+python3 scripts/bpak_part_digests.py $IMG
+
+$BPAK set $IMG --key-id pb-development \
+               --keystore-id pb $V
+
+$BPAK sign $IMG --key pki/secp256r1-key-pair.pem
+set +e
+
+# Every part has a valid digest
+$PB -t socket part write $IMG $BOOT_A
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+$PB -t socket boot partition $BOOT_A
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+wait_for_qemu
+start_qemu
+wait_for_qemu_start
+
+# The board skips the recovery part, it is neither loaded nor verified
+cp $IMG /tmp/img_recovery.bpak
+tamper_part /tmp/img_recovery.bpak 2
+
+$PB -t socket part write /tmp/img_recovery.bpak $BOOT_A
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+$PB -t socket boot partition $BOOT_A
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    echo "A modified part that is skipped should not fail the boot"
+    test_end_error
+fi
+
+wait_for_qemu
+start_qemu
+wait_for_qemu_start
+
+# The ramdisk does not match its digest
+cp $IMG /tmp/img_ramdisk.bpak
+tamper_part /tmp/img_ramdisk.bpak 1
+
+$PB -t socket part write /tmp/img_ramdisk.bpak $BOOT_A
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+$PB -t socket boot partition $BOOT_A
+result_code=$?
+
+if [ $result_code -ne 1 ];
+then
+    echo "Result code: $result_code"
+    test_end_error
+fi
+
+# Streamed, the device stops at the part that fails
+$PB -t socket boot bpak /tmp/img_ramdisk.bpak
+result_code=$?
+
+if [ $result_code -ne 1 ];
+then
+    echo "Result code: $result_code"
+    test_end_error
+fi
+
+test_end_ok
@@ -0,0 +1,118 @@
+#!/bin/bash
+source tests/common.sh
+wait_for_qemu_start
+
+rm -f /tmp/pb_warm_reset /tmp/pb_warm_tamper /tmp/pb_warm_status
+
+dd if=/dev/urandom of=/tmp/random_data bs=1k count=256
+dd if=/dev/urandom of=/tmp/random_dtb bs=1k count=16
+set -e
+BPAK=bpak
+IMG=/tmp/img.bpak
+PKG_UUID=8df597ff-2cf5-42ea-b2b6-47c348721b75
+PKG_UNIQUE_ID=$(uuidgen -t)
+V=-vvv
+
+$BPAK create $IMG -Y --hash-kind sha256 --signature-kind prime256v1 $V
+
+$BPAK add $IMG --meta bpak-package --from-string $PKG_UUID --encoder uuid $V
+$BPAK add $IMG --meta bpak-package-uid --from-string $PKG_UNIQUE_ID --encoder uuid $V
+
+$BPAK add $IMG --meta pb-load-addr --from-string 0x49000000 --part-ref kernel \
+                      --encoder integer $V
+
+$BPAK add $IMG --meta pb-load-addr --from-string 0x49100000 --part-ref dtb \
+                      --encoder integer $V
+
+$BPAK add $IMG --part kernel \
+               --from-file /tmp/random_data $V
+$BPAK add $IMG --part dtb \
+               --from-file /tmp/random_dtb $V
+
+# Only images with per-part digests are verified in place
+python3 scripts/bpak_part_digests.py $IMG
+
+$BPAK set $IMG --key-id pb-development \
+               --keystore-id pb $V
+
+$BPAK sign $IMG --key pki/secp256r1-key-pair.pem
+set +e
+
+echo "Flashing A"
+$PB -t socket part write /tmp/img.bpak $BOOT_A
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+$PB -t socket boot enable $BOOT_A
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+force_recovery_mode_off
+sync
+$PB -t socket dev reset
+wait_for_qemu
+
+# Cold boot, then one warm reset. The kernel is still in memory and
+# matches its digest, so it is verified in place and not loaded again.
+# The board patches the dtb part during boot, like the linux boot driver
+# does with the device tree, so that part is loaded again.
+touch /tmp/pb_warm_reset
+start_qemu
+wait_for_qemu
+
+boot_status=$(</tmp/pb_boot_status)
+warm_status=$(</tmp/pb_warm_status)
+echo "Boot status $boot_status, warm status $warm_status"
+
+if [ "$boot_status" != "A" ] || [ "$warm_status" != "W" ];
+then
+    rm -f /tmp/pb_warm_reset
+    force_recovery_mode_on
+    start_qemu
+    wait_for_qemu_start
+    test_end_error
+fi
+
+# The board modifies the kernel in memory before the warm reset, no part
+# matches its digest and the image is loaded again.
+touch /tmp/pb_warm_tamper
+start_qemu
+wait_for_qemu
+
+boot_status=$(</tmp/pb_boot_status)
+warm_status=$(</tmp/pb_warm_status)
+echo "Boot status $boot_status, warm status $warm_status"
+
+rm -f /tmp/pb_warm_reset /tmp/pb_warm_tamper
+
+if [ "$boot_status" != "A" ] || [ "$warm_status" != "C" ];
+then
+    force_recovery_mode_on
+    start_qemu
+    wait_for_qemu_start
+    test_end_error
+fi
+
+force_recovery_mode_on
+start_qemu
+wait_for_qemu_start
+
+$PB -t socket boot disable
+result_code=$?
+
+force_recovery_mode_off
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+test_end_ok
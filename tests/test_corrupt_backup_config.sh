@@ -22,8 +22,8 @@ fi
 # First make sure that the current configs are OK
 echo Checking disk
 
-dd if=$CONFIG_QEMU_VIRTIO_DISK of=/tmp/pb_config_primary bs=512 count=1 skip=2082
-dd if=$CONFIG_QEMU_VIRTIO_DISK of=/tmp/pb_config_backup bs=512 count=1 skip=2083
+dd if=$CONFIG_QEMU_VIRTIO_DISK of=/tmp/pb_config_primary bs=512 count=1 skip=$STATE_PRIMARY_LBA
+dd if=$CONFIG_QEMU_VIRTIO_DISK of=/tmp/pb_config_backup bs=512 count=1 skip=$STATE_BACKUP_LBA
 
 primary_sha256=$(sha256sum /tmp/pb_config_primary | cut -d ' ' -f 1)
 backup_sha256=$(sha256sum /tmp/pb_config_backup | cut -d ' ' -f 1)
@@ -38,7 +38,7 @@ fi
 echo
 echo Trashing backup config
 echo
-dd if=/dev/urandom of=$CONFIG_QEMU_VIRTIO_DISK conv=notrunc bs=512 count=1 seek=2083
+dd if=/dev/urandom of=$CONFIG_QEMU_VIRTIO_DISK conv=notrunc bs=512 count=1 seek=$STATE_BACKUP_LBA
 echo
 echo Restarting....
 echo
@@ -49,7 +49,7 @@ echo
 echo Checking config
 echo
 
-dd if=$CONFIG_QEMU_VIRTIO_DISK of=/tmp/pb_config_primary bs=512 count=1 skip=2082
+dd if=$CONFIG_QEMU_VIRTIO_DISK of=/tmp/pb_config_primary bs=512 count=1 skip=$STATE_PRIMARY_LBA
 primary_sha256=$(sha256sum /tmp/pb_config_primary | cut -d ' ' -f 1)
 
 if [ $primary_sha256 != $backup_sha256  ];
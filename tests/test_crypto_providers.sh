@@ -0,0 +1,41 @@
+#!/bin/bash
+source tests/common.sh
+wait_for_qemu_start
+
+providers=$($PB -t socket dev crypto)
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+echo "$providers"
+
+# The mbedtls provider is the only sha256 provider, it must be used for both
+# small and large inputs and have been calibrated during the self tests
+echo "$providers" | grep -E "^mbedtls-hash +sha256 +SL .* ns/KiB"
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+echo "$providers" | grep -E "^blake3 +blake3 +SL .* ns/KiB"
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+echo "$providers" | grep -E "^ed25519 +ed25519 +SL"
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+test_end_ok
@@ -0,0 +1,21 @@
+#!/bin/bash
+source tests/common.sh
+
+# Returns as soon as the device answers, instead of polling with 'dev show'
+$PB -t socket dev wait --timeout 30
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+$PB -t socket dev show
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+test_end_ok
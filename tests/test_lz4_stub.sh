@@ -0,0 +1,42 @@
+#!/bin/bash
+source tests/common.sh
+wait_for_qemu_start
+
+if [ "$CONFIG_IMAGE_LZ4" != "y" ];
+then
+    test_end_ok
+    exit 0
+fi
+
+# common.sh boots build-test/pb_stub, which unpacks the bootloader. The
+# board command reports the decompression time of the stub and the time
+# to read the compressed and the raw image from the virtio disk.
+$PB -t socket board command lz4-stats | tee /tmp/pb_lz4_stats
+result_code=${PIPESTATUS[0]}
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+if ! grep -q "^unpack [0-9]* us$" /tmp/pb_lz4_stats;
+then
+    test_end_error
+fi
+
+# The command runs on the unpacked bootloader, make sure it still boots
+# an image after the stub.
+$PB -t socket dev reset
+wait_for_qemu
+start_qemu
+wait_for_qemu_start
+
+$PB -t socket board command lz4-stats > /dev/null
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+test_end_ok
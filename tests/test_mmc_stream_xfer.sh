@@ -0,0 +1,109 @@
+#!/bin/bash
+source tests/common.sh
+wait_for_qemu_start
+
+EMMC_USER=0a2624d6-09bc-4633-b94f-58fef9365648
+
+# Prints the count of counter $1 from the 'mmc-stats' board command
+mmc_stat()
+{
+    $PB -t socket board command mmc-stats | grep "^$1 " | cut -d ' ' -f 2
+}
+
+# Saves the counters of the RAM backed eMMC, see 'mmc_stat_delta'
+mmc_stat_save()
+{
+    for c in CMD13 CMD17 CMD18 CMD23 CMD24 CMD25 busy;
+    do
+        eval "saved_$c=$(mmc_stat $c)"
+    done
+}
+
+# Prints how much counter $1 increased since 'mmc_stat_save'
+mmc_stat_delta()
+{
+    local saved=saved_$1
+    echo $(( $(mmc_stat $1) - ${!saved} ))
+}
+
+# One block is written with a pre-defined block count, never with CMD24
+dd if=/dev/urandom of=/tmp/mmc_data_in bs=512 count=1
+mmc_stat_save
+
+$PB -t socket part write /tmp/mmc_data_in $EMMC_USER
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+if [ $(mmc_stat_delta CMD24) -ne 0 ] || [ $(mmc_stat_delta CMD25) -ne 1 ] ||
+   [ $(mmc_stat_delta CMD23) -ne 1 ];
+then
+    echo "Single block write: CMD23 $(mmc_stat_delta CMD23), CMD24 $(mmc_stat_delta CMD24)," \
+         "CMD25 $(mmc_stat_delta CMD25)"
+    test_end_error
+fi
+
+# The whole user area, in several chunks
+dd if=/dev/urandom of=/tmp/mmc_data_in bs=1024k count=1
+data_in_sha256=$(sha256sum /tmp/mmc_data_in | cut -d ' ' -f 1)
+mmc_stat_save
+
+$PB -t socket part write /tmp/mmc_data_in $EMMC_USER
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+# Every written chunk waits for the card to release DAT0 and the status is
+# only polled once per write request, not while the card is programming
+cmd13=$(mmc_stat_delta CMD13)
+cmd25=$(mmc_stat_delta CMD25)
+busy=$(mmc_stat_delta busy)
+
+echo "Write: CMD25 $cmd25, busy waits $busy, CMD13 $cmd13"
+
+if [ $busy -ne $cmd25 ] || [ $cmd13 -gt $cmd25 ];
+then
+    test_end_error
+fi
+
+$PB -t socket part read $EMMC_USER /tmp/mmc_data_out
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+data_out_sha256=$(sha256sum /tmp/mmc_data_out | cut -d ' ' -f 1)
+
+if [ $data_in_sha256 != $data_out_sha256 ];
+then
+    echo "SHA comparison failed $data_in_sha256 != $data_out_sha256"
+    test_end_error
+fi
+
+# Every multi block command has its own block count and no single block
+# commands are used
+cmd23=$(mmc_stat_delta CMD23)
+cmd18=$(mmc_stat_delta CMD18)
+cmd25=$(mmc_stat_delta CMD25)
+
+echo "CMD23 $cmd23, CMD18 $cmd18, CMD25 $cmd25, CMD13 $(mmc_stat_delta CMD13)"
+
+if [ $cmd23 -ne $((cmd18 + cmd25)) ] || [ $cmd18 -eq 0 ] || [ $cmd25 -eq 0 ];
+then
+    test_end_error
+fi
+
+if [ $(mmc_stat_delta CMD17) -ne 0 ] || [ $(mmc_stat_delta CMD24) -ne 0 ];
+then
+    test_end_error
+fi
+
+test_end_ok
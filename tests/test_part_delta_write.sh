@@ -0,0 +1,79 @@
+#!/bin/bash
+source tests/common.sh
+wait_for_qemu_start
+
+sync
+
+# Write an initial image to the readable partition, chunk digests are
+# only available for partitions that may be read back.
+dd if=/dev/urandom of=/tmp/part_data_a bs=1024k count=1
+
+$PB -t socket part write /tmp/part_data_a ff4ddc6c-ad7a-47e8-8773-6729392dd1b5
+
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+# Modify a few bytes in two different chunks and write again using delta mode
+printf 'punchboot' | dd of=/tmp/part_data_a bs=1 seek=1000 conv=notrunc
+printf 'delta' | dd of=/tmp/part_data_a bs=1 seek=300000 conv=notrunc
+
+part_a_sha256=$(sha256sum /tmp/part_data_a | cut -d ' ' -f 1)
+
+$PB -t socket part write --delta /tmp/part_data_a ff4ddc6c-ad7a-47e8-8773-6729392dd1b5
+
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    echo Delta write failed
+    test_end_error
+fi
+
+$PB -t socket part read ff4ddc6c-ad7a-47e8-8773-6729392dd1b5 /tmp/readback_a
+
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    echo Could not read from partition
+    test_end_error
+fi
+
+readback_a_sha256=$(sha256sum /tmp/readback_a | cut -d ' ' -f 1)
+
+if [ $part_a_sha256 != $readback_a_sha256  ];
+then
+    echo "SHA comparison failed $readback_a_sha256 != $part_a_sha256"
+    test_end_error
+fi
+
+# System A is write only, a delta write falls back to writing everything
+dd if=/dev/urandom of=/tmp/part_data_b bs=512k count=1
+part_b_sha256=$(sha256sum /tmp/part_data_b | cut -d ' ' -f 1)
+
+$PB -t socket part write --delta /tmp/part_data_b 2af755d8-8de5-45d5-a862-014cfa735ce0
+
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    echo Delta write to write only partition failed
+    test_end_error
+fi
+
+sync
+
+dd if=/tmp/disk of=/tmp/readback_b bs=512 skip=34 count=1024
+readback_b_sha256=$(sha256sum /tmp/readback_b | cut -d ' ' -f 1)
+
+if [ $part_b_sha256 != $readback_b_sha256  ];
+then
+    echo "SHA comparison failed $readback_b_sha256 != $part_b_sha256"
+    test_end_error
+fi
+
+test_end_ok
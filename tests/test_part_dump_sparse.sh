@@ -0,0 +1,74 @@
+#!/bin/bash
+source tests/common.sh
+wait_for_qemu_start
+
+sync
+
+# Mostly zero data with a few non-zero regions, including the last chunk
+dd if=/dev/zero of=/tmp/dump_data_in bs=1024k count=1
+dd if=/dev/urandom of=/tmp/dump_data_in bs=4096 seek=3 count=1 conv=notrunc
+dd if=/dev/urandom of=/tmp/dump_data_in bs=4096 seek=100 count=2 conv=notrunc
+dd if=/dev/urandom of=/tmp/dump_data_in bs=4096 seek=255 count=1 conv=notrunc
+
+dump_in_sha256=$(sha256sum /tmp/dump_data_in | cut -d ' ' -f 1)
+
+echo Writing data
+$PB -t socket part write /tmp/dump_data_in ff4ddc6c-ad7a-47e8-8773-6729392dd1b5
+result_code=$?
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+echo Dumping data
+rm -f /tmp/dump_data_out
+$PB -t socket part read ff4ddc6c-ad7a-47e8-8773-6729392dd1b5 /tmp/dump_data_out
+result_code=$?
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+dump_out_size=$(stat -c %s /tmp/dump_data_out)
+dump_out_sha256=$(sha256sum /tmp/dump_data_out | cut -d ' ' -f 1)
+
+if [ $dump_out_size -ne 1048576 ];
+then
+    echo "Unexpected dump size $dump_out_size"
+    test_end_error
+fi
+
+if [ $dump_in_sha256 != $dump_out_sha256  ];
+then
+    echo "SHA comparison failed $dump_in_sha256 != $dump_out_sha256"
+    test_end_error
+fi
+
+# Now try with a zero chunk at the end of the partition
+dd if=/dev/zero of=/tmp/dump_data_in bs=4096 seek=255 count=1 conv=notrunc
+dump_in_sha256=$(sha256sum /tmp/dump_data_in | cut -d ' ' -f 1)
+
+$PB -t socket part write /tmp/dump_data_in ff4ddc6c-ad7a-47e8-8773-6729392dd1b5
+result_code=$?
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+rm -f /tmp/dump_data_out
+$PB -t socket part read ff4ddc6c-ad7a-47e8-8773-6729392dd1b5 /tmp/dump_data_out
+result_code=$?
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+dump_out_sha256=$(sha256sum /tmp/dump_data_out | cut -d ' ' -f 1)
+
+if [ $dump_in_sha256 != $dump_out_sha256  ];
+then
+    echo "SHA comparison failed $dump_in_sha256 != $dump_out_sha256"
+    test_end_error
+fi
+
+test_end_ok
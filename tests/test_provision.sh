@@ -0,0 +1,56 @@
+#!/bin/bash
+source tests/common.sh
+wait_for_qemu_start
+
+PART_A=2af755d8-8de5-45d5-a862-014cfa735ce0
+PART_B=c046ccd8-0f2e-4036-984d-76c14dc73992
+
+dd if=/dev/urandom of=/tmp/provision_a bs=1k count=1537
+dd if=/dev/urandom of=/tmp/provision_b bs=1k count=700
+
+cat > /tmp/provision.json <<EOM
+{
+    "steps": [
+        {"op": "part write", "file": "provision_a", "part": "$PART_A"},
+        {"op": "part write", "file": "provision_b", "part": "$PART_B"},
+        {"op": "part verify", "file": "provision_a", "part": "$PART_A"},
+        {"op": "part verify", "file": "provision_b", "part": "$PART_B", "digest": "sha256"},
+        {"op": "boot disable"}
+    ]
+}
+EOM
+
+rm -f /tmp/provision_report.json
+$PB -t socket provision --report /tmp/provision_report.json /tmp/provision.json
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+if [ ! -s /tmp/provision_report.json ];
+then
+    echo "No report"
+    test_end_error
+fi
+
+# Verifying the wrong file must stop the run
+cat > /tmp/provision.json <<EOM
+{
+    "steps": [
+        {"op": "part verify", "file": "provision_b", "part": "$PART_A"},
+        {"op": "boot disable"}
+    ]
+}
+EOM
+
+$PB -t socket provision /tmp/provision.json
+result_code=$?
+
+if [ $result_code -eq 0 ];
+then
+    test_end_error
+fi
+
+test_end_ok
@@ -0,0 +1,175 @@
+#!/bin/bash
+source tests/common.sh
+wait_for_qemu_start
+
+dd if=/dev/urandom of=/tmp/random_data bs=1k count=16
+set -e
+BPAK=bpak
+IMG=/tmp/img.bpak
+PKG_UUID=8df597ff-2cf5-42ea-b2b6-47c348721b75
+PKG_UNIQUE_ID=$(uuidgen -t)
+V=-vvv
+
+$BPAK create $IMG -Y --hash-kind sha256 --signature-kind prime256v1 $V
+
+$BPAK add $IMG --meta bpak-package --from-string $PKG_UUID --encoder uuid $V
+$BPAK add $IMG --meta bpak-package-uid --from-string $PKG_UNIQUE_ID --encoder uuid $V
+
+$BPAK add $IMG --meta pb-load-addr --from-string 0x49000000 --part-ref kernel \
+                      --encoder integer $V
+
+$BPAK add $IMG --part kernel \
+               --from-file /tmp/random_data $V
+
+$BPAK set $IMG --key-id pb-development \
+               --keystore-id pb $V
+
+$BPAK sign $IMG --key pki/secp256r1-key-pair.pem
+set +e
+
+echo "Flashing A"
+$PB -t socket part write /tmp/img.bpak $BOOT_A
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+echo "Flashing B"
+$PB -t socket part write /tmp/img.bpak $BOOT_B
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+read_state()
+{
+    dd if=$CONFIG_QEMU_VIRTIO_DISK of=/tmp/pb_config_primary bs=512 \
+        count=$STATE_PRIMARY_BLOCKS skip=$STATE_PRIMARY_LBA
+    dd if=$CONFIG_QEMU_VIRTIO_DISK of=/tmp/pb_config_backup bs=512 count=1 skip=$STATE_BACKUP_LBA
+}
+
+write_state()
+{
+    dd if=/tmp/pb_config_primary of=$CONFIG_QEMU_VIRTIO_DISK bs=512 \
+        count=$STATE_PRIMARY_BLOCKS seek=$STATE_PRIMARY_LBA conv=notrunc
+    dd if=/tmp/pb_config_backup of=$CONFIG_QEMU_VIRTIO_DISK bs=512 count=1 \
+        seek=$STATE_BACKUP_LBA conv=notrunc
+    sync
+}
+
+# Prints the magic of journal record '$1' on the primary partition
+journal_magic()
+{
+    dd if=/tmp/pb_config_primary bs=512 count=1 skip=$1 2>/dev/null | od -A n -t x4 -N 4 | tr -d ' '
+}
+
+check_attempts()
+{
+    $PBSTATE -p $1 -b /tmp/pb_config_backup --info | grep "Remaining boot attempts: $2$"
+
+    if [ $? -ne 0 ];
+    then
+        echo "Expected $2 remaining boot attempts in $1"
+        test_end_error
+    fi
+}
+
+boot_system()
+{
+    start_qemu
+    wait_for_qemu
+    boot_status=$(</tmp/pb_boot_status)
+
+    if [ "$boot_status" != "A" ];
+    then
+        echo "Expected A, booted $boot_status"
+        force_recovery_mode_on
+        start_qemu
+        wait_for_qemu_start
+        test_end_error
+    fi
+
+    read_state
+}
+
+# A is not verified and has 100 boot attempts, which keeps every boot in
+# this test on A. Changing the selection writes a snapshot to both.
+read_state
+$PBSTATE -p /tmp/pb_config_primary -b /tmp/pb_config_backup -v b
+$PBSTATE -p /tmp/pb_config_primary -b /tmp/pb_config_backup -s a -c 100
+write_state
+backup_sha256=$(sha256sum /tmp/pb_config_backup | cut -d ' ' -f 1)
+
+force_recovery_mode_off
+$PB -t socket dev reset
+wait_for_qemu
+
+# Append: the boot attempt decrement is one journal record on the primary
+echo 1/3
+boot_system
+
+if [ "$(journal_magic 1)" != "4a6f7572" ];
+then
+    echo "No journal record after the first boot"
+    test_end_error
+fi
+
+if [ "$(sha256sum /tmp/pb_config_backup | cut -d ' ' -f 1)" != "$backup_sha256" ];
+then
+    echo "Backup state was written for a journaled commit"
+    test_end_error
+fi
+
+check_attempts /tmp/pb_config_primary 99
+
+# Replay: the bootloader continues from the record of the last boot
+echo 2/3
+boot_system
+
+if [ "$(journal_magic 2)" != "4a6f7572" ];
+then
+    echo "No second journal record"
+    test_end_error
+fi
+
+check_attempts /tmp/pb_config_primary 98
+
+# Full journal: fill the remaining records, the next commit is a new
+# snapshot on both partitions.
+echo 3/3
+for i in $(seq 61);
+do
+    $PBSTATE -p /tmp/pb_config_primary -b /tmp/pb_config_backup -s a -c 98
+done
+
+if [ "$(journal_magic 63)" != "4a6f7572" ];
+then
+    echo "Journal is not full"
+    test_end_error
+fi
+
+write_state
+boot_system
+
+check_attempts /tmp/pb_config_primary 97
+check_attempts /tmp/pb_config_backup 97
+
+force_recovery_mode_on
+start_qemu
+wait_for_qemu_start
+
+$PB -t socket boot disable
+result_code=$?
+
+force_recovery_mode_off
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+test_end_ok
@@ -0,0 +1,46 @@
+#!/bin/bash
+source tests/common.sh
+wait_for_qemu_start
+
+# Larger than the command mode buffer so that the asynchronous BLAKE3 tree
+# updates overlap with the partition reads
+dd if=/dev/urandom of=/tmp/random_data bs=1k count=1537
+
+PART=2af755d8-8de5-45d5-a862-014cfa735ce0
+
+$PB -t socket part write /tmp/random_data $PART
+result_code=$?
+
+if [ $result_code -ne 0 ];
+then
+    test_end_error
+fi
+
+sync
+
+for digest in auto sha256 sha512 blake3
+do
+    $PB -t socket part verify --digest $digest /tmp/random_data $PART
+    result_code=$?
+
+    if [ $result_code -ne 0 ];
+    then
+        test_end_error
+    fi
+done
+
+# A modified file must fail with every digest
+dd if=/dev/zero of=/tmp/random_data bs=1 count=1 seek=1500000 conv=notrunc
+
+for digest in sha256 sha512 blake3
+do
+    $PB -t socket part verify --digest $digest /tmp/random_data $PART
+    result_code=$?
+
+    if [ $result_code -eq 0 ];
+    then
+        test_end_error
+    fi
+done
+
+test_end_ok
@@ -0,0 +1,18 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Stand-in for the architecture header included by 'strtoul.c', which only
+ * needs ULONG_MAX from it.
+ *
+ */
+
+#ifndef PB_BENCH_ARCH_ARCH_H
+#define PB_BENCH_ARCH_ARCH_H
+
+#include <limits.h>
+
+#endif // PB_BENCH_ARCH_ARCH_H
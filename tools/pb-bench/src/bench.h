@@ -0,0 +1,43 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef PB_BENCH_BENCH_H
+#define PB_BENCH_BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct bench {
+    const char *name; /*!< Unique name, '<module>/<operation>[/<size>]' */
+    size_t bytes; /*!< Bytes processed by one operation, 0 if not applicable */
+    int (*setup)(const struct bench *b); /*!< Optional, called once before timing */
+    void (*run)(const struct bench *b); /*!< Perform one operation */
+};
+
+/* Results that the compiler must not optimize away are written here */
+extern volatile uintptr_t bench_sink;
+
+/* Benchmark tables, terminated by an entry without a name */
+extern const struct bench bpak_benchmarks[];
+extern const struct bench crc_benchmarks[];
+extern const struct bench der_benchmarks[];
+extern const struct bench fdt_benchmarks[];
+extern const struct bench libc_benchmarks[];
+extern const struct bench uuid_benchmarks[];
+
+/* The bootloader's C library, renamed by 'libc_names.h' */
+void *pb_memchr(const void *s, int c, size_t n);
+int pb_memcmp(const void *s1, const void *s2, size_t n);
+void *pb_memcpy(void *dest, const void *src, size_t n);
+void *pb_memmove(void *dest, const void *src, size_t n);
+void *pb_memset(void *s, int c, size_t n);
+int pb_strcmp(const char *s1, const char *s2);
+size_t pb_strlen(const char *s);
+
+#endif // PB_BENCH_BENCH_H
@@ -0,0 +1,89 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Header checks and look-ups done for every boot and 'part verify'. The
+ * header resembles a linux image: a kernel, device tree and ramdisk, each
+ * with a load address.
+ *
+ */
+
+#include "bench.h"
+#include <bpak/bpak.h>
+#include <bpak/id.h>
+#include <string.h>
+
+#define ID_KERNEL  0xec103b08 /* bpak_id("kernel") */
+#define ID_DT      0x56f91b86 /* bpak_id("dt") */
+#define ID_RAMDISK 0xf4cdac1f /* bpak_id("ramdisk") */
+
+static struct bpak_header header;
+
+static int bpak_setup(const struct bench *b)
+{
+    static const bpak_id_t part_ids[] = { ID_KERNEL, ID_DT, ID_RAMDISK };
+    struct bpak_meta_header *meta;
+    struct bpak_part_header *part;
+    int rc;
+
+    bpak_init_header(&header);
+
+    rc = bpak_add_meta(&header, BPAK_ID_BPAK_PACKAGE, 0, 16, &meta);
+
+    if (rc != BPAK_OK)
+        return rc;
+
+    rc = bpak_add_meta(&header, BPAK_ID_KEYSTORE_PROVIDER_ID, 0, sizeof(uint32_t), &meta);
+
+    if (rc != BPAK_OK)
+        return rc;
+
+    for (unsigned int i = 0; i < sizeof(part_ids) / sizeof(part_ids[0]); i++) {
+        rc = bpak_add_part(&header, part_ids[i], &part);
+
+        if (rc != BPAK_OK)
+            return rc;
+
+        part->size = (i + 1) * 1024 * 1024;
+
+        rc = bpak_add_meta(&header, BPAK_ID_PB_LOAD_ADDR, part_ids[i], sizeof(uint64_t), &meta);
+
+        if (rc != BPAK_OK)
+            return rc;
+
+        *bpak_get_meta_ptr(&header, meta, uint64_t) = 0x40000000 + i * 0x4000000;
+    }
+
+    return bpak_valid_header(&header);
+}
+
+static void bpak_valid_header_run(const struct bench *b)
+{
+    bench_sink = bpak_valid_header(&header);
+}
+
+static void bpak_get_meta_run(const struct bench *b)
+{
+    struct bpak_meta_header *meta;
+
+    bench_sink = bpak_get_meta(&header, BPAK_ID_PB_LOAD_ADDR, ID_RAMDISK, &meta);
+    bench_sink = (uintptr_t)meta;
+}
+
+static void bpak_get_part_run(const struct bench *b)
+{
+    struct bpak_part_header *part;
+
+    bench_sink = bpak_get_part(&header, ID_RAMDISK, &part);
+    bench_sink = (uintptr_t)part;
+}
+
+const struct bench bpak_benchmarks[] = {
+    { "bpak/valid_header", 0, bpak_setup, bpak_valid_header_run },
+    { "bpak/get_meta", 0, bpak_setup, bpak_get_meta_run },
+    { "bpak/get_part", 0, bpak_setup, bpak_get_part_run },
+    { 0 },
+};
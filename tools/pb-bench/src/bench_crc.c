@@ -0,0 +1,39 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * crc32 is used for the GPT header and entries and the A/B state blobs.
+ *
+ */
+
+#include "bench.h"
+#include <pb/crc.h>
+
+static uint8_t data[64 * 1024];
+
+static int crc_setup(const struct bench *b)
+{
+    uint32_t x = 0x12345678;
+
+    for (size_t i = 0; i < sizeof(data); i++) {
+        x = x * 1103515245 + 12345;
+        data[i] = x >> 24;
+    }
+
+    return 0;
+}
+
+static void crc_run(const struct bench *b)
+{
+    bench_sink = crc32(0, data, b->bytes);
+}
+
+const struct bench crc_benchmarks[] = {
+    { "crc32/512", 512, crc_setup, crc_run },
+    { "crc32/16K", 16 * 1024, crc_setup, crc_run },
+    { "crc32/64K", 64 * 1024, crc_setup, crc_run },
+    { 0 },
+};
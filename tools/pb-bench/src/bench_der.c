@@ -0,0 +1,74 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * DER decoding done by the hardware crypto drivers before each signature
+ * verification. The signature is a prime256v1 signature where 's' has a
+ * leading zero byte, the key is 'pki/secp256r1-pub-key.der'.
+ *
+ */
+
+#include "bench.h"
+#include <pb/der_helpers.h>
+
+static const uint8_t sig_der[] = {
+    0x30, 0x45, 0x02, 0x20, 0x20, 0x39, 0xc7, 0x2a, 0xa0, 0x11, 0xe2, 0xee, 0xd9, 0x15, 0xe4,
+    0x0c, 0x59, 0xa4, 0x12, 0x53, 0xc0, 0xfc, 0x27, 0xf8, 0x46, 0x17, 0xa0, 0xc7, 0xf8, 0xce,
+    0x41, 0x34, 0x8b, 0x0d, 0xe7, 0x96, 0x02, 0x21, 0x00, 0xc4, 0xc7, 0x60, 0x35, 0xac, 0xa7,
+    0xb8, 0x32, 0x89, 0x20, 0x3a, 0xce, 0x54, 0x2d, 0x36, 0x71, 0x19, 0x30, 0xd6, 0xa3, 0xda,
+    0xa5, 0x2d, 0xd8, 0x20, 0xe7, 0x7e, 0x45, 0x23, 0x5e, 0x33, 0xf5,
+};
+
+static const uint8_t key_der[] = {
+    0x30, 0x59, 0x30, 0x13, 0x06, 0x07, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x02, 0x01, 0x06, 0x08,
+    0x2a, 0x86, 0x48, 0xce, 0x3d, 0x03, 0x01, 0x07, 0x03, 0x42, 0x00, 0x04, 0x43, 0x75, 0x53,
+    0x46, 0x77, 0x1f, 0x31, 0x36, 0x17, 0x99, 0x72, 0xcc, 0x7a, 0xd2, 0xb0, 0x91, 0x0d, 0x58,
+    0xd3, 0x93, 0x2e, 0x9a, 0x9e, 0x42, 0x35, 0x2d, 0x45, 0x11, 0x56, 0x12, 0x64, 0xaa, 0xe0,
+    0xad, 0x98, 0x8f, 0x89, 0x11, 0xa8, 0xbb, 0xd1, 0xf6, 0x4f, 0x2c, 0xa8, 0xa6, 0x33, 0x1d,
+    0xd0, 0x82, 0x18, 0xa5, 0x15, 0xad, 0x71, 0x82, 0xec, 0x68, 0xb2, 0xae, 0xc2, 0xbf, 0x80,
+    0x9e,
+};
+
+static uint8_t r[32];
+static uint8_t s[32];
+static uint8_t key[128];
+
+static int der_setup(const struct bench *b)
+{
+    dsa_t kind;
+    int rc;
+
+    rc = der_ecsig_to_rs(sig_der, r, s, sizeof(r), true);
+
+    if (rc != 0)
+        return rc;
+
+    rc = der_ec_public_key_data(key_der, key, sizeof(key), &kind);
+
+    if (rc != 0)
+        return rc;
+
+    return (kind == DSA_EC_SECP256r1) ? 0 : -1;
+}
+
+static void der_ecsig_to_rs_run(const struct bench *b)
+{
+    bench_sink = der_ecsig_to_rs(sig_der, r, s, sizeof(r), true);
+}
+
+static void der_ec_public_key_data_run(const struct bench *b)
+{
+    dsa_t kind;
+
+    bench_sink = der_ec_public_key_data(key_der, key, sizeof(key), &kind);
+    bench_sink = kind;
+}
+
+const struct bench der_benchmarks[] = {
+    { "der/ecsig_to_rs", 0, der_setup, der_ecsig_to_rs_run },
+    { "der/ec_public_key_data", 0, der_setup, der_ec_public_key_data_run },
+    { 0 },
+};
@@ -0,0 +1,139 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Device tree operations done by 'boot_linux_prepare' before jumping to a
+ * linux kernel. The tree has a few hundred nodes and, as a worst case for
+ * the search, the chosen node is the last node in the tree.
+ *
+ */
+
+#include "bench.h"
+#include <libfdt.h>
+#include <stdio.h>
+
+#define FDT_NO_OF_DEVICES 128
+
+static uint8_t fdt[64 * 1024];
+static int chosen_offset;
+
+static const char *device_uu_str = "2af755d8-8de5-45d5-a862-014cfa735ce0";
+
+static int fdt_find_chosen(const void *fdt)
+{
+    int depth = 0;
+    int offset = 0;
+
+    for (;;) {
+        offset = fdt_next_node(fdt, offset, &depth);
+
+        if (offset < 0)
+            return offset;
+
+        const char *name = fdt_get_name(fdt, offset, NULL);
+
+        if (!name)
+            continue;
+
+        if (pb_strcmp(name, "chosen") == 0)
+            return offset;
+    }
+}
+
+static int fdt_build(void *buf, size_t size)
+{
+    char name[32];
+    int rc = 0;
+
+    rc |= fdt_create(buf, size);
+    rc |= fdt_finish_reservemap(buf);
+    rc |= fdt_begin_node(buf, "");
+    rc |= fdt_property_string(buf, "compatible", "pb,bench");
+    rc |= fdt_property_u32(buf, "#address-cells", 1);
+    rc |= fdt_property_u32(buf, "#size-cells", 1);
+    rc |= fdt_begin_node(buf, "soc");
+
+    for (int i = 0; i < FDT_NO_OF_DEVICES; i++) {
+        snprintf(name, sizeof(name), "device@%08x", 0x30000000 + i * 0x10000);
+        rc |= fdt_begin_node(buf, name);
+        rc |= fdt_property_string(buf, "compatible", "pb,bench-device");
+        rc |= fdt_property_u32(buf, "reg", 0x30000000 + i * 0x10000);
+        rc |= fdt_property_string(buf, "status", "okay");
+        rc |= fdt_begin_node(buf, "port");
+        rc |= fdt_property_u32(buf, "phandle", i + 1);
+        rc |= fdt_end_node(buf);
+        rc |= fdt_end_node(buf);
+    }
+
+    rc |= fdt_end_node(buf);
+    rc |= fdt_begin_node(buf, "chosen");
+    rc |= fdt_property_string(buf, "bootargs", "console=ttyAMA0 root=/dev/vda2 rootwait ro");
+    rc |= fdt_property_u32(buf, "pb,slc-available-keys", 0);
+    rc |= fdt_end_node(buf);
+    rc |= fdt_end_node(buf);
+    rc |= fdt_finish(buf);
+
+    if (rc != 0)
+        return -1;
+
+    /* Leave room for the properties added by the patch benchmark */
+    return fdt_open_into(buf, buf, size);
+}
+
+static void fdt_patch_chosen_run(const struct bench *b)
+{
+    int rc = 0;
+
+    rc |= fdt_setprop_string(fdt, chosen_offset, "pb,device-uuid", device_uu_str);
+    rc |= fdt_setprop_u32(fdt, chosen_offset, "pb,slc", 1);
+    rc |= fdt_setprop_u32(fdt, chosen_offset, "pb,slc-active-key", 0xa90f9680);
+    rc |= fdt_delprop(fdt, chosen_offset, "pb,slc-available-keys");
+    rc |= fdt_appendprop_u32(fdt, chosen_offset, "pb,slc-available-keys", 0xa90f9680);
+    rc |= fdt_appendprop_u32(fdt, chosen_offset, "pb,slc-available-keys", 0x25c6dd36);
+    rc |= fdt_appendprop_u32(fdt, chosen_offset, "pb,slc-available-keys", 0x52c1eda0);
+
+    bench_sink = rc;
+}
+
+static int fdt_setup(const struct bench *b)
+{
+    int rc;
+
+    rc = fdt_build(fdt, sizeof(fdt));
+
+    if (rc != 0)
+        return rc;
+
+    chosen_offset = fdt_find_chosen(fdt);
+
+    if (chosen_offset < 0)
+        return chosen_offset;
+
+    /* The patch sequence must succeed and must not move the chosen node */
+    fdt_patch_chosen_run(b);
+
+    if (bench_sink != 0)
+        return -1;
+
+    return (fdt_find_chosen(fdt) == chosen_offset) ? 0 : -1;
+}
+
+static void fdt_check_header_run(const struct bench *b)
+{
+    bench_sink = fdt_check_header(fdt);
+}
+
+static void fdt_find_chosen_run(const struct bench *b)
+{
+    bench_sink = fdt_find_chosen(fdt);
+}
+
+const struct bench fdt_benchmarks[] = {
+    { "fdt/check_header", 0, fdt_setup, fdt_check_header_run },
+    { "fdt/find_chosen", 0, fdt_setup, fdt_find_chosen_run },
+    { "fdt/patch_chosen", 0, fdt_setup, fdt_patch_chosen_run },
+    { 0 },
+};
@@ -0,0 +1,89 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * The bootloader's C library. memcpy and memset are used for every block
+ * that passes through the bio and command mode layers, the string functions
+ * mostly for partition and device tree look-ups.
+ *
+ */
+
+#include "bench.h"
+
+#define LIBC_BUF_SIZE (1024 * 1024)
+
+static uint8_t src[LIBC_BUF_SIZE + 64];
+static uint8_t dst[LIBC_BUF_SIZE + 64];
+
+static int libc_setup(const struct bench *b)
+{
+    pb_memset(src, 'a', sizeof(src));
+    pb_memset(dst, 'a', sizeof(dst));
+
+    /* Strings of 'bytes' length for the str* functions */
+    src[b->bytes] = 0;
+    dst[b->bytes] = 0;
+    return 0;
+}
+
+static void memcpy_run(const struct bench *b)
+{
+    bench_sink = (uintptr_t)pb_memcpy(dst, src, b->bytes);
+}
+
+static void memcpy_unaligned_run(const struct bench *b)
+{
+    bench_sink = (uintptr_t)pb_memcpy(dst + 1, src + 3, b->bytes);
+}
+
+static void memmove_run(const struct bench *b)
+{
+    /* Overlapping, forces a backwards copy */
+    bench_sink = (uintptr_t)pb_memmove(dst + 16, dst, b->bytes);
+}
+
+static void memset_run(const struct bench *b)
+{
+    bench_sink = (uintptr_t)pb_memset(dst, 'a', b->bytes);
+}
+
+static void memcmp_run(const struct bench *b)
+{
+    bench_sink = pb_memcmp(dst, src, b->bytes);
+}
+
+static void memchr_run(const struct bench *b)
+{
+    bench_sink = (uintptr_t)pb_memchr(src, 'b', b->bytes);
+}
+
+static void strlen_run(const struct bench *b)
+{
+    bench_sink = pb_strlen((const char *)src);
+}
+
+static void strcmp_run(const struct bench *b)
+{
+    bench_sink = pb_strcmp((const char *)dst, (const char *)src);
+}
+
+const struct bench libc_benchmarks[] = {
+    { "libc/memcpy/64", 64, libc_setup, memcpy_run },
+    { "libc/memcpy/4K", 4096, libc_setup, memcpy_run },
+    { "libc/memcpy/1M", LIBC_BUF_SIZE, libc_setup, memcpy_run },
+    { "libc/memcpy_unaligned/4K", 4096, libc_setup, memcpy_unaligned_run },
+    { "libc/memmove/4K", 4096, libc_setup, memmove_run },
+    { "libc/memset/64", 64, libc_setup, memset_run },
+    { "libc/memset/4K", 4096, libc_setup, memset_run },
+    { "libc/memset/1M", LIBC_BUF_SIZE, libc_setup, memset_run },
+    { "libc/memcmp/4K", 4096, libc_setup, memcmp_run },
+    { "libc/memchr/4K", 4096, libc_setup, memchr_run },
+    { "libc/strlen/64", 64, libc_setup, strlen_run },
+    { "libc/strlen/4K", 4096, libc_setup, strlen_run },
+    { "libc/strcmp/64", 64, libc_setup, strcmp_run },
+    { "libc/strcmp/4K", 4096, libc_setup, strcmp_run },
+    { 0 },
+};
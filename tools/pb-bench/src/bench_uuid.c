@@ -0,0 +1,53 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * UUID conversions, used when partitions are looked up by string and when
+ * the device UUID is patched into the device tree.
+ *
+ */
+
+#include "bench.h"
+#include <uuid.h>
+
+static const char *uu_str = "2af755d8-8de5-45d5-a862-014cfa735ce0";
+static uuid_t uu;
+
+static int uuid_setup(const struct bench *b)
+{
+    return uuid_parse(uu_str, uu);
+}
+
+static void uuid_parse_run(const struct bench *b)
+{
+    uuid_t out;
+
+    bench_sink = uuid_parse(uu_str, out);
+    bench_sink = out[15];
+}
+
+static void uuid_unparse_run(const struct bench *b)
+{
+    char out[37];
+
+    uuid_unparse(uu, out);
+    bench_sink = out[35];
+}
+
+static void uuid_compare_run(const struct bench *b)
+{
+    uuid_t other;
+
+    uuid_copy(other, uu);
+    bench_sink = uuid_compare(uu, other);
+}
+
+const struct bench uuid_benchmarks[] = {
+    { "uuid/parse", 0, uuid_setup, uuid_parse_run },
+    { "uuid/unparse", 0, uuid_setup, uuid_unparse_run },
+    { "uuid/copy_compare", 0, uuid_setup, uuid_compare_run },
+    { 0 },
+};
@@ -0,0 +1,22 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Replaces the Kconfig generated config.h. The libraries under test do not
+ * depend on any configuration options.
+ *
+ */
+
+#ifndef PB_BENCH_CONFIG_H
+#define PB_BENCH_CONFIG_H
+
+#define CONFIG_LIB_ZLIB_CRC     1
+#define CONFIG_LIB_BPAK         1
+#define CONFIG_LIB_DER_HELPERS  1
+#define CONFIG_LIB_FDT          1
+#define CONFIG_LIB_UUID         1
+
+#endif // PB_BENCH_CONFIG_H
@@ -0,0 +1,34 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Included before every library source under test. The bootloader's own C
+ * library is linked into the same process as glibc, so its functions are
+ * renamed with a 'pb_' prefix. The libraries then call the same mem/str
+ * implementations as they do in the bootloader.
+ *
+ */
+
+#ifndef PB_BENCH_LIBC_NAMES_H
+#define PB_BENCH_LIBC_NAMES_H
+
+#define memchr   pb_memchr
+#define memcmp   pb_memcmp
+#define memcpy   pb_memcpy
+#define memmove  pb_memmove
+#define memset   pb_memset
+#define snprintf pb_snprintf
+#define strchr   pb_strchr
+#define strcmp   pb_strcmp
+#define strcpy   pb_strcpy
+#define strcspn  pb_strcspn
+#define strlen   pb_strlen
+#define strncmp  pb_strncmp
+#define strncpy  pb_strncpy
+#define strspn   pb_strspn
+#define strtoul  pb_strtoul
+
+#endif // PB_BENCH_LIBC_NAMES_H
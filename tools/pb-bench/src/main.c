@@ -0,0 +1,354 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * pb-bench runs microbenchmarks of the libraries in 'src/lib', built with
+ * the same flags as the bootloader. Results can be saved and compared with
+ * a later run to catch regressions:
+ *
+ *   $ pb-bench -o baseline.csv
+ *   $ pb-bench -c baseline.csv -t 5
+ *
+ */
+
+#include "bench.h"
+#include <getopt.h>
+#include <pb/utils_def.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC
+#endif
+
+#define BENCH_SAMPLES 5
+#define BENCH_MAX_BASELINE 256
+
+struct bench_result {
+    const struct bench *b;
+    double ns_per_op;
+};
+
+struct baseline_entry {
+    char name[64];
+    double ns_per_op;
+};
+
+volatile uintptr_t bench_sink;
+
+static const struct bench *bench_tables[] = {
+    bpak_benchmarks, crc_benchmarks,  der_benchmarks,
+    fdt_benchmarks,  libc_benchmarks, uuid_benchmarks,
+};
+
+static struct baseline_entry baseline[BENCH_MAX_BASELINE];
+static unsigned int baseline_count;
+
+static void print_version(void)
+{
+    printf("pb-bench v%s (punchboot %s)\n", PROJECT_VERSION, PB_VERSION);
+}
+
+static void print_help(void)
+{
+    print_version();
+    printf("\n");
+    printf("Usage: pb-bench [options]\n\n");
+    printf("Options:\n");
+    printf("  -f, --filter <str>     Only run benchmarks with names containing <str>\n");
+    printf("  -l, --list             List benchmarks and exit\n");
+    printf("  -T, --time <ms>        Minimum duration of each sample (default: 100)\n");
+    printf("  -m, --mhz <MHz>        CPU frequency used for cycle counts\n");
+    printf("                         (default: measured TSC frequency on x86)\n");
+    printf("  -o, --output <file>    Write results as CSV\n");
+    printf("  -c, --compare <file>   Compare with results from an earlier '-o'\n");
+    printf("  -t, --threshold <%%>    Slow down that counts as a regression (default: 5)\n");
+    printf("  -V, --version          Print version and exit\n");
+    printf("  -h, --help             Print this help and exit\n");
+    printf("\n");
+    printf("The exit code is 1 if any benchmark regressed compared to '-c'.\n");
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static double time_ops(const struct bench *b, unsigned long ops)
+{
+    double start = now_ns();
+
+    for (unsigned long i = 0; i < ops; i++)
+        b->run(b);
+
+    return now_ns() - start;
+}
+
+static double estimate_mhz(void)
+{
+#ifdef BENCH_HAVE_TSC
+    double start = now_ns();
+    uint64_t tsc_start = __rdtsc();
+
+    while (now_ns() - start < 50e6)
+        ;
+
+    return (double)(__rdtsc() - tsc_start) * 1e3 / (now_ns() - start);
+#else
+    return 0.0;
+#endif
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* Grows the number of operations until one sample takes at least
+ * 'sample_ns' and returns the median time of BENCH_SAMPLES samples */
+static double bench_measure(const struct bench *b, double sample_ns)
+{
+    double samples[BENCH_SAMPLES];
+    unsigned long ops = 1;
+    double elapsed;
+
+    /* Warm up caches and branch predictors */
+    time_ops(b, 1);
+
+    for (;;) {
+        elapsed = time_ops(b, ops);
+
+        if (elapsed >= sample_ns)
+            break;
+
+        if (elapsed < sample_ns / 100)
+            ops *= 10;
+        else
+            ops = (unsigned long)(ops * (sample_ns * 1.1 / elapsed)) + 1;
+    }
+
+    samples[0] = elapsed / ops;
+
+    for (int i = 1; i < BENCH_SAMPLES; i++)
+        samples[i] = time_ops(b, ops) / ops;
+
+    qsort(samples, BENCH_SAMPLES, sizeof(samples[0]), compare_double);
+
+    return samples[BENCH_SAMPLES / 2];
+}
+
+static int baseline_load(const char *path)
+{
+    char line[256];
+    FILE *fp = fopen(path, "r");
+
+    if (fp == NULL) {
+        fprintf(stderr, "Error: Could not open '%s'\n", path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        struct baseline_entry *e = &baseline[baseline_count];
+        unsigned long bytes;
+
+        /* 'name,bytes,ns_per_op', the header line does not match */
+        if (sscanf(line, "%63[^,],%lu,%lf", e->name, &bytes, &e->ns_per_op) != 3)
+            continue;
+
+        if (++baseline_count == BENCH_MAX_BASELINE)
+            break;
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+static const struct baseline_entry *baseline_find(const char *name)
+{
+    for (unsigned int i = 0; i < baseline_count; i++) {
+        if (strcmp(baseline[i].name, name) == 0)
+            return &baseline[i];
+    }
+
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    static struct bench_result results[BENCH_MAX_BASELINE];
+    unsigned int no_of_results = 0;
+    const char *filter = NULL;
+    const char *output_path = NULL;
+    const char *compare_path = NULL;
+    double threshold = 5.0;
+    double sample_ns = 100e6;
+    double mhz = 0.0;
+    bool list = false;
+    int regressions = 0;
+    int opt;
+
+    static const struct option long_options[] = {
+        { "filter", required_argument, 0, 'f' },
+        { "list", no_argument, 0, 'l' },
+        { "time", required_argument, 0, 'T' },
+        { "mhz", required_argument, 0, 'm' },
+        { "output", required_argument, 0, 'o' },
+        { "compare", required_argument, 0, 'c' },
+        { "threshold", required_argument, 0, 't' },
+        { "version", no_argument, 0, 'V' },
+        { "help", no_argument, 0, 'h' },
+        { 0, 0, 0, 0 },
+    };
+
+    while ((opt = getopt_long(argc, argv, "f:lT:m:o:c:t:Vh", long_options, NULL)) != -1) {
+        switch (opt) {
+        case 'f':
+            filter = optarg;
+            break;
+        case 'l':
+            list = true;
+            break;
+        case 'T':
+            sample_ns = strtod(optarg, NULL) * 1e6;
+            break;
+        case 'm':
+            mhz = strtod(optarg, NULL);
+            break;
+        case 'o':
+            output_path = optarg;
+            break;
+        case 'c':
+            compare_path = optarg;
+            break;
+        case 't':
+            threshold = strtod(optarg, NULL);
+            break;
+        case 'V':
+            print_version();
+            return 0;
+        case 'h':
+            print_help();
+            return 0;
+        default:
+            print_help();
+            return -1;
+        }
+    }
+
+    if (compare_path != NULL && baseline_load(compare_path) != 0)
+        return -1;
+
+    if (!list && mhz == 0.0)
+        mhz = estimate_mhz();
+
+    if (!list) {
+        printf("%-28s %12s %14s %10s %12s %10s", "Benchmark", "ns/op", "ops/s", "MB/s",
+               "cycles/op", "cycles/B");
+        printf(compare_path ? " %9s\n" : "\n", "change");
+    }
+
+    for (unsigned int t = 0; t < ARRAY_SIZE(bench_tables); t++) {
+        for (const struct bench *b = bench_tables[t]; b->name != NULL; b++) {
+            struct bench_result *r = &results[no_of_results];
+            const struct baseline_entry *e;
+            double cycles;
+
+            if (filter != NULL && strstr(b->name, filter) == NULL)
+                continue;
+
+            if (list) {
+                printf("%s\n", b->name);
+                continue;
+            }
+
+            if (b->setup != NULL && b->setup(b) != 0) {
+                fprintf(stderr, "Error: Setup of '%s' failed\n", b->name);
+                return -1;
+            }
+
+            r->b = b;
+            r->ns_per_op = bench_measure(b, sample_ns);
+            cycles = r->ns_per_op * mhz / 1e3;
+
+            printf("%-28s %12.1f %14.0f", b->name, r->ns_per_op, 1e9 / r->ns_per_op);
+
+            if (b->bytes > 0)
+                printf(" %10.1f", b->bytes * 1e3 / r->ns_per_op);
+            else
+                printf(" %10s", "-");
+
+            if (mhz > 0.0)
+                printf(" %12.1f", cycles);
+            else
+                printf(" %12s", "-");
+
+            if (mhz > 0.0 && b->bytes > 0)
+                printf(" %10.3f", cycles / b->bytes);
+            else
+                printf(" %10s", "-");
+
+            e = compare_path ? baseline_find(b->name) : NULL;
+
+            if (e != NULL) {
+                double change = (r->ns_per_op - e->ns_per_op) * 100.0 / e->ns_per_op;
+                bool regressed = change > threshold;
+
+                printf(" %+8.1f%%%s", change, regressed ? " REGRESSION" : "");
+
+                if (regressed)
+                    regressions++;
+            } else if (compare_path) {
+                printf(" %9s", "new");
+            }
+
+            printf("\n");
+
+            if (++no_of_results == ARRAY_SIZE(results))
+                break;
+        }
+    }
+
+    if (list)
+        return 0;
+
+    if (mhz > 0.0)
+        printf("\nCycle counts are based on %.0f MHz\n", mhz);
+
+    if (output_path != NULL) {
+        FILE *fp = fopen(output_path, "w");
+
+        if (fp == NULL) {
+            fprintf(stderr, "Error: Could not open '%s'\n", output_path);
+            return -1;
+        }
+
+        fprintf(fp, "name,bytes,ns_per_op\n");
+
+        for (unsigned int i = 0; i < no_of_results; i++)
+            fprintf(fp, "%s,%zu,%.3f\n", results[i].b->name, results[i].b->bytes,
+                    results[i].ns_per_op);
+
+        fclose(fp);
+    }
+
+    if (regressions > 0) {
+        printf("%i benchmark(s) slower than '%s' by more than %.1f%%\n", regressions,
+               compare_path, threshold);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,291 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Board setup of the simulator. It follows the qemu test board so that the
+ * partition UUID's, key map and fuse layout are the same.
+ *
+ */
+
+#include "crypto_openssl.h"
+#include "file_bio.h"
+#include "mmc_sim.h"
+#include "nor_sim.h"
+#include "sim.h"
+#include "socket_transport.h"
+#include <boot/ab_state.h>
+#include <drivers/crypto/blake3.h>
+#include <drivers/fuse/test_fuse_bio.h>
+#include <drivers/partition/gpt.h>
+#include <pb/arena.h>
+#include <pb/bio.h>
+#include <pb/cm.h>
+#include <pb/pb.h>
+#include <pb/rot.h>
+#include <pb/slc.h>
+#include <plat/qemu/qemu.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "partitions.h"
+
+static const struct gpt_part_table gpt_tbl_default[] = {
+    {
+        .uu = UUID_2af755d8_8de5_45d5_a862_014cfa735ce0,
+        .description = "System A",
+        .size = SZ_KiB(512),
+    },
+    {
+        .uu = UUID_c046ccd8_0f2e_4036_984d_76c14dc73992,
+        .description = "System B",
+        .size = SZ_KiB(512),
+    },
+    {
+        .uu = UUID_f5f8c9ae_efb5_4071_9ba9_d313b082281e,
+        .description = "PB State Primary",
+        .size = 512,
+    },
+    {
+        .uu = UUID_656ab3fc_5856_4a5e_a2ae_5a018313b3ee,
+        .description = "PB State Backup",
+        .size = 512,
+    },
+    {
+        .uu = UUID_44acdcbe_dcb0_4d89_b0ad_8f96967f8c95,
+        .description = "Fuse array",
+        .size = 512,
+    },
+    {
+        .uu = UUID_ff4ddc6c_ad7a_47e8_8773_6729392dd1b5,
+        .description = "Readable",
+        .size = SZ_MiB(1),
+    },
+};
+
+/* Large system partitions for throughput measurements, needs a disk
+ * image of at least 2 * 128 MiB + 8 MiB */
+static const struct gpt_part_table gpt_tbl_bench[] = {
+    {
+        .uu = UUID_2af755d8_8de5_45d5_a862_014cfa735ce0,
+        .description = "System A",
+        .size = SZ_MiB(128),
+    },
+    {
+        .uu = UUID_c046ccd8_0f2e_4036_984d_76c14dc73992,
+        .description = "System B",
+        .size = SZ_MiB(128),
+    },
+    {
+        .uu = UUID_f5f8c9ae_efb5_4071_9ba9_d313b082281e,
+        .description = "PB State Primary",
+        .size = SZ_KiB(32), /* Snapshot and 63 journal records */
+    },
+    {
+        .uu = UUID_656ab3fc_5856_4a5e_a2ae_5a018313b3ee,
+        .description = "PB State Backup",
+        .size = 512,
+    },
+    {
+        .uu = UUID_44acdcbe_dcb0_4d89_b0ad_8f96967f8c95,
+        .description = "Fuse array",
+        .size = 512,
+    },
+    {
+        .uu = UUID_ff4ddc6c_ad7a_47e8_8773_6729392dd1b5,
+        .description = "Readable",
+        .size = SZ_MiB(8),
+    },
+};
+
+static const struct gpt_table_list gpt_tables[] = {
+    {
+        .name = "Default",
+        .variant = 0,
+        .table = gpt_tbl_default,
+        .table_length = ARRAY_SIZE(gpt_tbl_default),
+    },
+    {
+        .name = "Benchmark",
+        .variant = 1,
+        .table = gpt_tbl_bench,
+        .table_length = ARRAY_SIZE(gpt_tbl_bench),
+    },
+};
+
+static int sim_set_slc_configuration(void)
+{
+    return test_fuse_write(FUSE_BOOT0, 0x12341234);
+}
+
+int sim_board_init(const struct sim_config *cfg)
+{
+    int rc;
+
+#ifdef CONFIG_ARENA
+    /* Stands in for the RAM that is free after DDR init, 'arena_init' aligns
+     * it to pages. CONFIG_ARENA_32BIT_DMA is not set on the host. */
+    size_t ram_size = SZ_MiB(CONFIG_ARENA_MAX_MiB);
+    void *ram = malloc(ram_size);
+
+    if (ram == NULL)
+        return -PB_ERR_MEM;
+
+    rc = arena_init((uintptr_t)ram, (uintptr_t)ram + ram_size);
+
+    if (rc != PB_OK)
+        return rc;
+#endif
+
+    bio_dev_t disk = file_bio_init(cfg->disk_path, cfg->disk_size, PART_virtio_disk);
+
+    if (disk < 0)
+        return disk;
+
+    if (cfg->nor) {
+        bio_dev_t nor = nor_sim_init();
+
+        if (nor < 0)
+            return nor;
+    }
+
+    if (cfg->mmc) {
+        static char tap_cache_path[256];
+
+        snprintf(tap_cache_path, sizeof(tap_cache_path), "%s.tap", cfg->disk_path);
+        rc = mmc_sim_init(tap_cache_path);
+
+        if (rc != PB_OK)
+            return rc;
+    }
+
+    rc = crypto_openssl_init();
+
+    if (rc != PB_OK)
+        return rc;
+
+    rc = blake3_pb_init();
+
+    if (rc != PB_OK)
+        return rc;
+
+    rc = gpt_ptbl_init(disk, gpt_tables, ARRAY_SIZE(gpt_tables));
+
+    if (rc != PB_OK) {
+        /* Not fatal, the host is expected to install a table */
+        LOG_WARN("GPT Init failed (%i)", rc);
+        return PB_OK;
+    }
+
+    bio_dev_t readable_part = bio_get_part_by_uu(PART_readable);
+
+    if (readable_part >= 0)
+        (void)bio_clear_set_flags(readable_part, 0, BIO_FLAG_READABLE);
+
+    static const struct boot_ab_state_config boot_state_cfg = {
+        .primary_state_part_uu = PART_primary_state,
+        .backup_state_part_uu = PART_backup_state,
+        .sys_a_uu = PART_sys_a,
+        .sys_b_uu = PART_sys_b,
+        .rollback_mode = AB_ROLLBACK_MODE_NORMAL,
+    };
+
+    rc = boot_ab_state_init(&boot_state_cfg);
+
+    if (rc != PB_OK)
+        return rc;
+
+    bio_dev_t fusebox_dev = bio_get_part_by_uu(PART_fusebox);
+
+    if (fusebox_dev < 0)
+        return fusebox_dev;
+
+    rc = test_fuse_init(fusebox_dev);
+
+    if (rc != PB_OK) {
+        LOG_ERR("Fusebox init failed");
+        return rc;
+    }
+
+    static const struct rot_config rot_config = {
+        .revoke_key = qemu_revoke_key,
+        .read_key_status = qemu_read_key_status,
+        .key_map_length = 3,
+        .key_map = {
+            {
+                .name = "pb-development",
+                .id = 0xa90f9680,
+                .param1 = 0,
+            },
+            {
+                .name = "pb-development2",
+                .id = 0x25c6dd36,
+                .param1 = 1,
+            },
+            {
+                .name = "pb-development3",
+                .id = 0x52c1eda0,
+                .param1 = 2,
+            },
+        },
+    };
+
+    rc = rot_init(&rot_config);
+
+    if (rc != PB_OK) {
+        LOG_ERR("RoT init failed (%i)", rc);
+        return rc;
+    }
+
+    static const struct slc_config slc_config = {
+        .read_status = qemu_slc_read_status,
+        .set_configuration = sim_set_slc_configuration,
+        .set_configuration_locked = qemu_slc_set_configuration_locked,
+        .set_eol = qemu_slc_set_eol,
+    };
+
+    return slc_init(&slc_config);
+}
+
+static int board_command(uint32_t command,
+                         uint8_t *bfr,
+                         size_t size,
+                         uint8_t *response_bfr,
+                         size_t *response_size)
+{
+    LOG_ERR("Unknown command %x", command);
+    (*response_size) = 0;
+    return -PB_ERR_NOT_SUPPORTED;
+}
+
+static int board_status(uint8_t *response_bfr, size_t *response_size)
+{
+    char *response = (char *)response_bfr;
+    size_t resp_buf_size = *response_size;
+
+    (*response_size) = snprintf(response, resp_buf_size, "Simulator OK\n");
+    return PB_OK;
+}
+
+int cm_board_init(void)
+{
+    static const struct cm_config cfg = {
+        .name = "pb-sim",
+        .status = board_status,
+        .password_auth = NULL,
+        .command = board_command,
+        .tops = {
+            .init = socket_transport_init,
+            .connect = socket_transport_connect,
+            .disconnect = socket_transport_disconnect,
+            .read = socket_transport_read,
+            .write = socket_transport_write,
+            .complete = socket_transport_complete,
+            .event = NULL,
+        },
+    };
+
+    return cm_init(&cfg);
+}
@@ -0,0 +1,83 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Boot interface of the simulator. Boot partition selection is handled by
+ * the A/B state driver, like on the qemu test board, but images are never
+ * loaded. Loading writes to the physical addresses in the BPAK meta data,
+ * which does not work in a host process.
+ *
+ */
+
+#include <boot/ab_state.h>
+#include <boot/boot.h>
+#include <bpak/bpak.h>
+#include <pb/pb.h>
+
+static uint32_t boot_flags;
+static enum boot_source boot_source = BOOT_SOURCE_BIO;
+static boot_read_cb_t read_cb;
+static boot_result_cb_t result_cb;
+
+int boot_set_source(enum boot_source source)
+{
+    if (source <= BOOT_SOURCE_INVALID || source >= BOOT_SOURCE_END)
+        return -PB_ERR_PARAM;
+    boot_source = source;
+    return PB_OK;
+}
+
+void boot_configure_load_cb(boot_read_cb_t read_f, boot_result_cb_t result_f)
+{
+    read_cb = read_f;
+    result_cb = result_f;
+}
+
+uint32_t boot_get_flags(void)
+{
+    return boot_flags;
+}
+
+void boot_clear_set_flags(uint32_t clear_flags, uint32_t set_flags)
+{
+    boot_flags = ((uint32_t)boot_flags & ~clear_flags) | set_flags;
+}
+
+int boot_set_boot_partition(uuid_t part_uu)
+{
+    return boot_ab_state_set_boot_partition(part_uu);
+}
+
+void boot_get_boot_partition(uuid_t part_uu)
+{
+    boot_ab_state_get_boot_partition(part_uu);
+}
+
+int boot_load(uuid_t boot_part_override_uu)
+{
+    static struct bpak_header header;
+    int rc = -PB_ERR_NOT_SUPPORTED;
+
+    (void)boot_part_override_uu;
+
+    /* Consume the header so that the host sees an error result and not
+     * a stalled transfer */
+    if ((boot_source == BOOT_SOURCE_CB) && (read_cb != NULL)) {
+        int read_rc = read_cb(-(int)sizeof(header) / 512, sizeof(header), &header);
+
+        if ((read_rc == PB_OK) && (result_cb != NULL))
+            result_cb(rc);
+    }
+
+    LOG_ERR("Booting is not supported by the simulator");
+    boot_flags = 0;
+    return rc;
+}
+
+int boot_jump(void)
+{
+    return -PB_ERR_NOT_SUPPORTED;
+}
@@ -0,0 +1,159 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Software hash and DSA provider for the host build, backed by OpenSSL's
+ * libcrypto. It stands in for the mbedtls driver, which needs the mbedtls
+ * sources that are fetched by the bootloader build.
+ *
+ */
+
+#include "crypto_openssl.h"
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+#include <pb/crypto.h>
+#include <pb/pb.h>
+
+static EVP_MD_CTX *hash_ctx;
+
+static const EVP_MD *openssl_md(hash_t alg)
+{
+    switch (alg) {
+    case HASH_MD5:
+        return EVP_md5();
+    case HASH_SHA256:
+        return EVP_sha256();
+    case HASH_SHA384:
+        return EVP_sha384();
+    case HASH_SHA512:
+        return EVP_sha512();
+    default:
+        return NULL;
+    }
+}
+
+static int openssl_hash_init(hash_t alg)
+{
+    const EVP_MD *md = openssl_md(alg);
+
+    if (md == NULL)
+        return -PB_ERR_PARAM;
+
+    if (EVP_DigestInit_ex(hash_ctx, md, NULL) != 1)
+        return -PB_ERR;
+
+    return PB_OK;
+}
+
+static int openssl_hash_update(const void *buf, size_t length)
+{
+    if (EVP_DigestUpdate(hash_ctx, buf, length) != 1)
+        return -PB_ERR;
+
+    return PB_OK;
+}
+
+static int openssl_hash_final(uint8_t *output, size_t size)
+{
+    if (size < (size_t)EVP_MD_CTX_get_size(hash_ctx))
+        return -PB_ERR_BUF_TOO_SMALL;
+
+    if (EVP_DigestFinal_ex(hash_ctx, output, NULL) != 1)
+        return -PB_ERR;
+
+    return PB_OK;
+}
+
+static int openssl_hash_digest(
+    hash_t alg, const void *buf, size_t length, uint8_t *output, size_t size)
+{
+    const EVP_MD *md = openssl_md(alg);
+
+    if (md == NULL)
+        return -PB_ERR_NOT_SUPPORTED;
+
+    if (size < (size_t)EVP_MD_get_size(md))
+        return -PB_ERR_BUF_TOO_SMALL;
+
+    if (EVP_Digest(buf, length, output, NULL, md, NULL) != 1)
+        return -PB_ERR;
+
+    return PB_OK;
+}
+
+static int openssl_ecdsa_verify(const uint8_t *der_signature,
+                                size_t signature_length,
+                                const uint8_t *der_key,
+                                size_t key_length,
+                                hash_t md_alg,
+                                uint8_t *md,
+                                size_t md_length,
+                                bool *verified)
+{
+    const unsigned char *p = der_key;
+    EVP_PKEY_CTX *ctx = NULL;
+    EVP_PKEY *key;
+    int rc = -PB_ERR_SIGNATURE;
+
+    *verified = false;
+
+    if (openssl_md(md_alg) == NULL)
+        return -PB_ERR_PARAM;
+
+    key = d2i_PUBKEY(NULL, &p, key_length);
+
+    if (key == NULL) {
+        LOG_ERR("Could not decode key");
+        return -PB_ERR_SIGNATURE;
+    }
+
+    ctx = EVP_PKEY_CTX_new(key, NULL);
+
+    if ((ctx == NULL) || (EVP_PKEY_verify_init(ctx) != 1))
+        goto err_out;
+
+    if (EVP_PKEY_verify(ctx, der_signature, signature_length, md, md_length) == 1) {
+        *verified = true;
+        rc = PB_OK;
+    }
+
+err_out:
+    EVP_PKEY_CTX_free(ctx);
+    EVP_PKEY_free(key);
+    return rc;
+}
+
+int crypto_openssl_init(void)
+{
+    int rc;
+
+    hash_ctx = EVP_MD_CTX_new();
+
+    if (hash_ctx == NULL)
+        return -PB_ERR_MEM;
+
+    static const struct hash_ops hash_ops = {
+        .name = "openssl-hash",
+        .alg_bits = HASH_MD5 | HASH_SHA256 | HASH_SHA384 | HASH_SHA512,
+        .init = openssl_hash_init,
+        .update = openssl_hash_update,
+        .final = openssl_hash_final,
+        .digest = openssl_hash_digest,
+    };
+
+    rc = hash_add_ops(&hash_ops);
+
+    if (rc != PB_OK)
+        return rc;
+
+    static const struct dsa_ops dsa_ops = {
+        .name = "openssl-ecdsa",
+        .alg_bits = DSA_EC_SECP256r1 | DSA_EC_SECP384r1 | DSA_EC_SECP521r1,
+        .verify = openssl_ecdsa_verify,
+    };
+
+    return dsa_add_ops(&dsa_ops);
+}
@@ -0,0 +1,20 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef PB_SIM_CRYPTO_OPENSSL_H
+#define PB_SIM_CRYPTO_OPENSSL_H
+
+/**
+ * Register the OpenSSL hash and ECDSA providers
+ *
+ * @return PB_OK on success or a negative number
+ */
+int crypto_openssl_init(void);
+
+#endif // PB_SIM_CRYPTO_OPENSSL_H
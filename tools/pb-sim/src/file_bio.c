@@ -0,0 +1,118 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * File backed block device, the host counterpart of the virtio block driver.
+ *
+ */
+
+#define _XOPEN_SOURCE 700
+
+#include "file_bio.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pb/pb.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FILE_BIO_BLOCK_SIZE 512
+
+static int fd = -1;
+
+static int file_bio_read(bio_dev_t dev, lba_t lba, size_t length, void *buf)
+{
+    off_t offset = (off_t)lba * FILE_BIO_BLOCK_SIZE;
+    uint8_t *p = buf;
+
+    while (length > 0) {
+        ssize_t bytes = pread(fd, p, length, offset);
+
+        if (bytes <= 0) {
+            LOG_ERR("Read failed at lba %" PRIu64 " (%s)",
+                    lba,
+                    bytes < 0 ? strerror(errno) : "EOF");
+            return -PB_ERR_IO;
+        }
+
+        p += bytes;
+        offset += bytes;
+        length -= bytes;
+    }
+
+    return PB_OK;
+}
+
+static int file_bio_write(bio_dev_t dev, lba_t lba, size_t length, const void *buf)
+{
+    off_t offset = (off_t)lba * FILE_BIO_BLOCK_SIZE;
+    const uint8_t *p = buf;
+
+    while (length > 0) {
+        ssize_t bytes = pwrite(fd, p, length, offset);
+
+        if (bytes <= 0) {
+            LOG_ERR("Write failed at lba %" PRIu64 " (%s)",
+                    lba,
+                    bytes < 0 ? strerror(errno) : "EOF");
+            return -PB_ERR_IO;
+        }
+
+        p += bytes;
+        offset += bytes;
+        length -= bytes;
+    }
+
+    return PB_OK;
+}
+
+bio_dev_t file_bio_init(const char *path, size_t size, const uuid_t uu)
+{
+    struct stat st;
+    int rc;
+
+    fd = open(path, O_RDWR | O_CREAT, 0644);
+
+    if (fd == -1) {
+        LOG_ERR("Could not open '%s' (%s)", path, strerror(errno));
+        return -PB_ERR_IO;
+    }
+
+    if (fstat(fd, &st) != 0)
+        return -PB_ERR_IO;
+
+    if (st.st_size == 0) {
+        if (ftruncate(fd, size) != 0) {
+            LOG_ERR("Could not resize '%s' (%s)", path, strerror(errno));
+            return -PB_ERR_IO;
+        }
+        st.st_size = size;
+    }
+
+    if ((st.st_size < FILE_BIO_BLOCK_SIZE) || (st.st_size % FILE_BIO_BLOCK_SIZE) != 0) {
+        LOG_ERR("'%s' is not a multiple of %u bytes", path, FILE_BIO_BLOCK_SIZE);
+        return -PB_ERR_PARAM;
+    }
+
+    bio_dev_t dev = bio_allocate(
+        0, (st.st_size / FILE_BIO_BLOCK_SIZE) - 1, FILE_BIO_BLOCK_SIZE, uu, "File disk");
+
+    if (dev < 0)
+        return dev;
+
+    rc = bio_set_ios(dev, file_bio_read, file_bio_write);
+
+    if (rc < 0)
+        return rc;
+
+    rc = bio_set_flags(dev, BIO_FLAG_VISIBLE | BIO_FLAG_WRITABLE);
+
+    if (rc < 0)
+        return rc;
+
+    return dev;
+}
@@ -0,0 +1,28 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef PB_SIM_FILE_BIO_H
+#define PB_SIM_FILE_BIO_H
+
+#include <pb/bio.h>
+#include <stddef.h>
+
+/**
+ * Open, or create, a disk image file and register it as a block device.
+ * A new file is extended to 'size' bytes, an existing file keeps its size.
+ *
+ * @param[in] path Path to the disk image
+ * @param[in] size Size in bytes of a new disk image
+ * @param[in] uu UUID of the block device
+ *
+ * @return A bio device handle on success or a negative number
+ */
+bio_dev_t file_bio_init(const char *path, size_t size, const uuid_t uu);
+
+#endif // PB_SIM_FILE_BIO_H
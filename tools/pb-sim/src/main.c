@@ -0,0 +1,142 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * pb-sim runs the command mode of the bootloader as a host process. The
+ * punchboot tool talks to it with the socket transport:
+ *
+ *   $ pb-sim -d /tmp/pb-sim.img &
+ *   $ punchboot -t socket dev show
+ *
+ * It is intended for measuring the protocol and the command mode stack
+ * with host tools like perf and valgrind, without qemu in the loop.
+ *
+ */
+
+#include "sim.h"
+#include "socket_transport.h"
+#include <getopt.h>
+#include <pb/cm.h>
+#include <pb/errors.h>
+#include <pb/utils_def.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Exit normally on SIGINT and SIGTERM so that the flash statistics, which
+ * are printed by 'atexit' handlers, are not lost */
+static void sim_exit(int sig)
+{
+    exit(0);
+}
+
+static void print_version(void)
+{
+    printf("pb-sim v%s (punchboot %s)\n", PROJECT_VERSION, PB_VERSION);
+}
+
+static void print_help(void)
+{
+    print_version();
+    printf("\n");
+    printf("Usage: pb-sim [options]\n\n");
+    printf("Options:\n");
+    printf("  -d, --disk <path>    Disk image, created if it does not exist\n");
+    printf("                       (default: /tmp/pb-sim.img)\n");
+    printf("  -S, --size <MiB>     Size of a new disk image (default: 512)\n");
+    printf("  -s, --socket <path>  Command mode socket (default: /tmp/pb.sock)\n");
+    printf("  -1, --once           Exit when the host disconnects or resets\n");
+    printf("  -n, --nor            Add a RAM backed 8 MiB SPI-NOR flash\n");
+    printf("  -m, --mmc            Add a RAM backed eMMC with a 16 MiB user area\n");
+    printf("  -V, --version        Print version and exit\n");
+    printf("  -h, --help           Print this help and exit\n");
+    printf("\n");
+    printf("Partition table variant 1 ('Benchmark') has two 128 MiB system partitions.\n");
+    printf("The NOR flash has UUID 1bd35a54-485d-4fb6-a822-cb58c3c5a068, erase and program\n");
+    printf("statistics are printed on exit.\n");
+    printf("The eMMC has the partition UUID's of the imx8mevk, the HS200 delay tap is\n");
+    printf("cached in '<disk>.tap' and command counts are printed on exit.\n");
+}
+
+int main(int argc, char **argv)
+{
+    struct sim_config cfg = {
+        .disk_path = "/tmp/pb-sim.img",
+        .disk_size = SZ_MiB(512),
+        .socket_path = "/tmp/pb.sock",
+        .once = false,
+        .nor = false,
+        .mmc = false,
+    };
+    int opt;
+    int rc;
+
+    static const struct option long_options[] = {
+        { "disk", required_argument, 0, 'd' },
+        { "size", required_argument, 0, 'S' },
+        { "socket", required_argument, 0, 's' },
+        { "once", no_argument, 0, '1' },
+        { "nor", no_argument, 0, 'n' },
+        { "mmc", no_argument, 0, 'm' },
+        { "version", no_argument, 0, 'V' },
+        { "help", no_argument, 0, 'h' },
+        { 0, 0, 0, 0 },
+    };
+
+    while ((opt = getopt_long(argc, argv, "d:S:s:1nmVh", long_options, NULL)) != -1) {
+        switch (opt) {
+        case 'd':
+            cfg.disk_path = optarg;
+            break;
+        case 'S':
+            cfg.disk_size = SZ_MiB(strtoul(optarg, NULL, 0));
+            break;
+        case 's':
+            cfg.socket_path = optarg;
+            break;
+        case '1':
+            cfg.once = true;
+            break;
+        case 'n':
+            cfg.nor = true;
+            break;
+        case 'm':
+            cfg.mmc = true;
+            break;
+        case 'V':
+            print_version();
+            return 0;
+        case 'h':
+            print_help();
+            return 0;
+        default:
+            print_help();
+            return -1;
+        }
+    }
+
+    /* Log output is written with '\n\r' line endings and should show up
+     * immediately when the output is redirected to a file */
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    signal(SIGINT, sim_exit);
+    signal(SIGTERM, sim_exit);
+
+    rc = sim_board_init(&cfg);
+
+    if (rc != PB_OK) {
+        fprintf(stderr, "Error: Board init failed (%i)\n", rc);
+        return -1;
+    }
+
+    socket_transport_configure(cfg.socket_path, cfg.once);
+
+    /* A reset from the host restarts command mode, other errors are fatal */
+    do {
+        rc = cm_run();
+    } while (!cfg.once && (rc == -PB_ERR_ABORT));
+
+    return (rc == -PB_ERR_ABORT) ? 0 : -1;
+}
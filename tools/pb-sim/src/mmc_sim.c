@@ -0,0 +1,136 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * eMMC of the simulator, the RAM backed card of 'mmc_ram' with storage
+ * from the heap. The HS200 delay tap is cached in a file, which stands in
+ * for the retained storage of a real board, and the command counts are
+ * printed when pb-sim exits.
+ *
+ */
+
+#include "mmc_sim.h"
+#include <drivers/mmc/mmc_ram.h>
+#include <pb/pb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MMC_SIM_USER_SIZE SZ_MiB(16)
+#define MMC_SIM_BOOT_SIZE SZ_MiB(1)
+#define MMC_SIM_RPMB_SIZE SZ_KiB(128)
+
+#define UUID_9eef7544_bf68_4bf7_8678_da117cbccba8 \
+    (const unsigned char *)"\x9e\xef\x75\x44\xbf\x68\x4b\xf7\x86\x78\xda\x11\x7c\xbc\xcb\xa8"
+#define UUID_4ee31690_0c9b_4d56_a6a6_e6d6ecfd4d54 \
+    (const unsigned char *)"\x4e\xe3\x16\x90\x0c\x9b\x4d\x56\xa6\xa6\xe6\xd6\xec\xfd\x4d\x54"
+#define UUID_1aad85a9_75cd_426d_8dc4_e9bdfeeb6875 \
+    (const unsigned char *)"\x1a\xad\x85\xa9\x75\xcd\x42\x6d\x8d\xc4\xe9\xbd\xfe\xeb\x68\x75"
+#define UUID_8d75d8b9_b169_4de6_bee0_48abdc95c408 \
+    (const unsigned char *)"\x8d\x75\xd8\xb9\xb1\x69\x4d\xe6\xbe\xe0\x48\xab\xdc\x95\xc4\x08"
+
+static const char *tap_cache;
+
+static int mmc_sim_tuning_cache_read(const mmc_cmd_resp_t cid, unsigned int *tap)
+{
+    int rc = -PB_ERR_NOT_FOUND;
+    mmc_cmd_resp_t cached_cid;
+    FILE *fp = fopen(tap_cache, "rb");
+
+    if (fp == NULL)
+        return rc;
+
+    if (fread(cached_cid, sizeof(cached_cid), 1, fp) == 1 && fread(tap, sizeof(*tap), 1, fp) == 1 &&
+        memcmp(cached_cid, cid, sizeof(cached_cid)) == 0)
+        rc = PB_OK;
+
+    fclose(fp);
+    return rc;
+}
+
+static int mmc_sim_tuning_cache_write(const mmc_cmd_resp_t cid, unsigned int tap)
+{
+    int rc = -PB_ERR_IO;
+    FILE *fp = fopen(tap_cache, "wb");
+
+    if (fp == NULL)
+        return rc;
+
+    if (fwrite(cid, sizeof(mmc_cmd_resp_t), 1, fp) == 1 && fwrite(&tap, sizeof(tap), 1, fp) == 1)
+        rc = PB_OK;
+
+    fclose(fp);
+    return rc;
+}
+
+static struct mmc_ram_config mmc_sim_config = {
+    .user_size = MMC_SIM_USER_SIZE,
+    .boot_size = MMC_SIM_BOOT_SIZE,
+    .rpmb_size = MMC_SIM_RPMB_SIZE,
+    .max_chunk_bytes = SZ_KiB(256),
+    .tap_first = 40,
+    .tap_last = 71,
+    .mmc = {
+        .mode = MMC_BUS_MODE_HS200,
+        .width = MMC_BUS_WIDTH_8BIT,
+        .boot_mode = EXT_CSD_BOOT_DDR | EXT_CSD_BOOT_BUS_WIDTH_8,
+        .boot0_uu = UUID_9eef7544_bf68_4bf7_8678_da117cbccba8,
+        .boot1_uu = UUID_4ee31690_0c9b_4d56_a6a6_e6d6ecfd4d54,
+        .user_uu = UUID_1aad85a9_75cd_426d_8dc4_e9bdfeeb6875,
+        .rpmb_uu = UUID_8d75d8b9_b169_4de6_bee0_48abdc95c408,
+        .flags = 0,
+        .tuning_cache_read = mmc_sim_tuning_cache_read,
+        .tuning_cache_write = mmc_sim_tuning_cache_write,
+    },
+};
+
+static void mmc_sim_report(void)
+{
+    const struct mmc_ram_stats *s = mmc_ram_stats();
+
+    printf("MMC: %u tuning blocks, delay tap %u\n",
+           s->cmds[MMC_CMD_SEND_TUNING_BLOCK_HS200],
+           s->delay_tap);
+    printf("MMC: %u CMD23, %u CMD17, %u CMD18, %u CMD24, %u CMD25, %u CMD13\n",
+           s->cmds[MMC_CMD_SET_BLOCK_COUNT],
+           s->cmds[MMC_CMD_READ_SINGLE_BLOCK],
+           s->cmds[MMC_CMD_READ_MULTIPLE_BLOCK],
+           s->cmds[MMC_CMD_WRITE_SINGLE_BLOCK],
+           s->cmds[MMC_CMD_WRITE_MULTIPLE_BLOCK],
+           s->cmds[MMC_CMD_SEND_STATUS]);
+    printf("MMC: %u busy waits\n", s->busy_waits);
+    printf("MMC: %llu bytes read, %llu bytes written\n", s->read_bytes, s->write_bytes);
+}
+
+int mmc_sim_init(const char *tap_cache_path)
+{
+    int rc;
+
+    mmc_sim_config.user = calloc(1, MMC_SIM_USER_SIZE);
+    mmc_sim_config.boot0 = calloc(1, MMC_SIM_BOOT_SIZE);
+    mmc_sim_config.boot1 = calloc(1, MMC_SIM_BOOT_SIZE);
+    mmc_sim_config.rpmb = calloc(1, MMC_SIM_RPMB_SIZE);
+
+    if (mmc_sim_config.user == NULL || mmc_sim_config.boot0 == NULL ||
+        mmc_sim_config.boot1 == NULL || mmc_sim_config.rpmb == NULL)
+        return -PB_ERR_MEM;
+
+    tap_cache = tap_cache_path;
+    atexit(mmc_sim_report);
+
+    rc = mmc_ram_init(&mmc_sim_config);
+
+    if (rc != PB_OK)
+        return rc;
+
+    /* The user area may be read back to measure reads */
+    bio_dev_t user = bio_get_part_by_uu(mmc_sim_config.mmc.user_uu);
+
+    if (user < 0)
+        return user;
+
+    return bio_clear_set_flags(user, 0, BIO_FLAG_READABLE);
+}
@@ -0,0 +1,27 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef PB_SIM_MMC_SIM_H
+#define PB_SIM_MMC_SIM_H
+
+/**
+ * Register a RAM backed eMMC through the MMC core. The card is set up for
+ * HS200 and only returns the tuning block for a window of delay taps. The
+ * selected tap is cached in 'tap_cache_path' together with the card CID,
+ * like a board would keep it in retained storage. The partition UUID's are
+ * the ones of the imx8mevk eMMC and the user area is readable. The number
+ * of commands of each kind is printed when pb-sim exits.
+ *
+ * @param[in] tap_cache_path File that holds the cached delay tap
+ *
+ * @return PB_OK on success or a negative number
+ */
+int mmc_sim_init(const char *tap_cache_path);
+
+#endif // PB_SIM_MMC_SIM_H
@@ -0,0 +1,125 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * RAM backed SPI-NOR HAL. Like a real NOR flash, an erase sets all bytes
+ * of a block to 0xff and programming can only clear bits. Every operation
+ * is counted and its duration is estimated from typical datasheet numbers
+ * of a quad SPI NOR, so that the effect of the SPI-NOR core can be measured
+ * without hardware.
+ *
+ */
+
+#include "nor_sim.h"
+#include <drivers/memc/spi_nor.h>
+#include <pb/pb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NOR_SIM_CAPACITY          SZ_MiB(8)
+#define NOR_SIM_PAGE_SIZE         256
+
+/* Typical timing, in us, and read throughput in bytes per us */
+#define NOR_SIM_PAGE_PROGRAM_US   400
+#define NOR_SIM_READ_BYTES_PER_US 50
+
+#define UUID_1bd35a54_485d_4fb6_a822_cb58c3c5a068 \
+    (const unsigned char *)"\x1b\xd3\x5a\x54\x48\x5d\x4f\xb6\xa8\x22\xcb\x58\xc3\xc5\xa0\x68"
+
+static const unsigned int erase_time_us[] = { 150000, 120000, 45000 };
+
+static uint8_t *flash;
+static unsigned long long read_bytes;
+static unsigned long long busy_us;
+
+static int
+nor_sim_read(const struct spi_nor_device *dev, uint32_t address, void *buf, size_t length)
+{
+    if ((address + length) > dev->capacity)
+        return -PB_ERR_PARAM;
+
+    memcpy(buf, flash + address, length);
+    read_bytes += length;
+    busy_us += length / NOR_SIM_READ_BYTES_PER_US;
+    return PB_OK;
+}
+
+static int nor_sim_page_program(const struct spi_nor_device *dev,
+                                uint32_t address,
+                                const void *buf,
+                                size_t length)
+{
+    const uint8_t *p = buf;
+    uint32_t page_offset = address & (dev->page_size - 1);
+
+    if ((page_offset + length) > dev->page_size) {
+        LOG_ERR("Page program at 0x%x crosses a page boundary", address);
+        return -PB_ERR_IO;
+    }
+
+    for (size_t i = 0; i < length; i++)
+        flash[address + i] &= p[i];
+
+    busy_us += NOR_SIM_PAGE_PROGRAM_US;
+    return PB_OK;
+}
+
+static int nor_sim_erase(const struct spi_nor_device *dev, uint32_t address, unsigned int erase_idx)
+{
+    size_t erase_sz = dev->erase_sizes[erase_idx];
+
+    /* The flash ignores the address bits below the erase block size */
+    memset(flash + (address & ~(erase_sz - 1)), 0xff, erase_sz);
+    busy_us += erase_time_us[erase_idx];
+    return PB_OK;
+}
+
+static const struct spi_nor_hal nor_sim_hal = {
+    .read = nor_sim_read,
+    .page_program = nor_sim_page_program,
+    .erase = nor_sim_erase,
+};
+
+static struct spi_nor_device nor_sim = {
+    .name = "Simulated NOR",
+    .uuid = UUID_1bd35a54_485d_4fb6_a822_cb58c3c5a068,
+    .capacity = NOR_SIM_CAPACITY,
+    .block_size = SZ_KiB(4),
+    .page_size = NOR_SIM_PAGE_SIZE,
+    .erase_sizes = { SZ_KiB(64), SZ_KiB(32), SZ_KiB(4) },
+    .hal = &nor_sim_hal,
+};
+
+static void nor_sim_report(void)
+{
+    const struct spi_nor_stats *s = &nor_sim.stats;
+
+    printf("NOR: %u pages programmed, %u skipped\n", s->pages_programmed, s->pages_skipped);
+    printf("NOR: %u blocks erased, %u blank blocks skipped, %u rewritten\n",
+           s->blocks_erased,
+           s->blocks_skipped,
+           s->blocks_rewritten);
+    printf("NOR: %llu bytes read, estimated busy time %llu ms\n", read_bytes, busy_us / 1000);
+}
+
+const struct spi_nor_stats *nor_sim_stats(void)
+{
+    return &nor_sim.stats;
+}
+
+bio_dev_t nor_sim_init(void)
+{
+    flash = malloc(NOR_SIM_CAPACITY);
+
+    if (flash == NULL)
+        return -PB_ERR_MEM;
+
+    memset(flash, 0xff, NOR_SIM_CAPACITY);
+    atexit(nor_sim_report);
+
+    return spi_nor_init(&nor_sim);
+}
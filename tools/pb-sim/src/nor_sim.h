@@ -0,0 +1,33 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef PB_SIM_NOR_SIM_H
+#define PB_SIM_NOR_SIM_H
+
+#include <drivers/memc/spi_nor.h>
+#include <pb/bio.h>
+
+/**
+ * Register a RAM backed SPI-NOR flash through the SPI-NOR core. The
+ * geometry is the one of the imxrt1060evk NOR flash and it uses the same
+ * UUID. Statistics and an estimate of the erase and program time are
+ * printed when pb-sim exits.
+ *
+ * @return A bio device handle on success or a negative number
+ */
+bio_dev_t nor_sim_init(void);
+
+/**
+ * Operation counters of the SPI-NOR core for the simulated flash
+ *
+ * @return Pointer to the statistics
+ */
+const struct spi_nor_stats *nor_sim_stats(void);
+
+#endif // PB_SIM_NOR_SIM_H
@@ -0,0 +1,60 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Platform interface of the simulator. The unique id and namespace are the
+ * ones of the qemu platform, so the simulator reports the same device UUID.
+ *
+ */
+
+#define _XOPEN_SOURCE 700
+
+#include <pb/pb.h>
+#include <pb/plat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const uint8_t device_unique_id[8] = "\xbe\x4e\xfc\xb4\x32\x58\xcd\x63";
+const char *platform_ns_uuid = "\x3f\xaf\xc6\xd3\xc3\x42\x4e\xdf\xa5\xa6\x0e\xb1\x39\xa7\x83\xb5";
+
+void plat_reset(void)
+{
+    LOG_INFO("Reset");
+    exit(0);
+}
+
+unsigned int plat_get_us_tick(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned int)((ts.tv_sec * 1000000ULL) + (ts.tv_nsec / 1000));
+}
+
+void plat_wdog_kick(void)
+{
+}
+
+int plat_boot_reason(void)
+{
+    return 0;
+}
+
+const char *plat_boot_reason_str(void)
+{
+    return "";
+}
+
+int plat_get_unique_id(uint8_t *output, size_t *length)
+{
+    if (sizeof(device_unique_id) > *length)
+        return -PB_ERR_BUF_TOO_SMALL;
+
+    memcpy(output, device_unique_id, sizeof(device_unique_id));
+    *length = sizeof(device_unique_id);
+    return PB_OK;
+}
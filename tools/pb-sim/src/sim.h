@@ -0,0 +1,36 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef PB_SIM_SIM_H
+#define PB_SIM_SIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct sim_config {
+    const char *disk_path; /*!< Disk image backing the block device */
+    size_t disk_size; /*!< Size in bytes of a new disk image */
+    const char *socket_path; /*!< Path of the command mode UNIX socket */
+    bool once; /*!< Exit when the first host disconnects */
+    bool nor; /*!< Add a RAM backed SPI-NOR flash */
+    bool mmc; /*!< Add a RAM backed eMMC */
+};
+
+/**
+ * Board initialization, the host counterpart of 'board_init' of the
+ * qemu test board. Sets up the disk, partition table, A/B state, fuses,
+ * root of trust and crypto providers.
+ *
+ * @param[in] cfg Simulator configuration
+ *
+ * @return PB_OK on success or a negative number
+ */
+int sim_board_init(const struct sim_config *cfg);
+
+#endif // PB_SIM_SIM_H
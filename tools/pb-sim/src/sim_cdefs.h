@@ -0,0 +1,28 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Included before every source file of the host build. The bootloader gets
+ * these from the in-tree libc 'cdefs.h', which is not used with glibc.
+ *
+ * Section placement is dropped, the host has no '.no_init' region and the
+ * large command buffers are better off in '.bss'.
+ *
+ */
+
+#ifndef PB_SIM_CDEFS_H
+#define PB_SIM_CDEFS_H
+
+#define __packed     __attribute__((__packed__))
+#define __used       __attribute__((__used__))
+#define __unused     __attribute__((__unused__))
+#define __aligned(x) __attribute__((__aligned__(x)))
+#define __section(x)
+
+/* Used by the buffer arena, the common line size of x86-64 and aarch64 */
+#define CACHE_LINE 64
+
+#endif // PB_SIM_CDEFS_H
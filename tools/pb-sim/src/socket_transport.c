@@ -0,0 +1,161 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * UNIX socket command mode transport. Transfers are carried out
+ * synchronously by 'read'/'write' and the result is reported by the
+ * following 'complete' call, which is how command mode expects an
+ * asynchronous transport to behave.
+ *
+ */
+
+#define _XOPEN_SOURCE 700
+
+#include "socket_transport.h"
+#include <errno.h>
+#include <pb/pb.h>
+#include <pb/plat.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static struct {
+    const char *path;
+    bool once;
+    bool session_ended;
+    int server_fd;
+    int client_fd;
+    int xfer_rc;
+} sock = {
+    .server_fd = -1,
+    .client_fd = -1,
+};
+
+void socket_transport_configure(const char *path, bool once)
+{
+    sock.path = path;
+    sock.once = once;
+}
+
+int socket_transport_init(void)
+{
+    struct sockaddr_un addr;
+
+    if (sock.client_fd != -1) {
+        close(sock.client_fd);
+        sock.client_fd = -1;
+        sock.session_ended = true;
+    }
+
+    /* With 'once' a disconnect is handled like a reset of the device */
+    if (sock.once && sock.session_ended)
+        plat_reset();
+
+    if (sock.server_fd != -1)
+        return PB_OK;
+
+    if (strlen(sock.path) >= sizeof(addr.sun_path))
+        return -PB_ERR_PARAM;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, sock.path);
+
+    sock.server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (sock.server_fd == -1)
+        return -PB_ERR_IO;
+
+    (void)unlink(sock.path);
+
+    if ((bind(sock.server_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) ||
+        (listen(sock.server_fd, 1) != 0)) {
+        LOG_ERR("Could not listen on '%s' (%s)", sock.path, strerror(errno));
+        close(sock.server_fd);
+        sock.server_fd = -1;
+        return -PB_ERR_IO;
+    }
+
+    LOG_INFO("Listening on '%s'", sock.path);
+    return PB_OK;
+}
+
+int socket_transport_connect(void)
+{
+    sock.client_fd = accept(sock.server_fd, NULL, NULL);
+
+    if (sock.client_fd == -1)
+        return (errno == EINTR) ? -PB_ERR_AGAIN : -PB_ERR_IO;
+
+    sock.xfer_rc = PB_OK;
+    return PB_OK;
+}
+
+int socket_transport_disconnect(void)
+{
+    if (sock.client_fd != -1) {
+        close(sock.client_fd);
+        sock.client_fd = -1;
+        sock.session_ended = true;
+    }
+
+    return PB_OK;
+}
+
+int socket_transport_read(void *buf, size_t length)
+{
+    uint8_t *p = buf;
+
+    sock.xfer_rc = PB_OK;
+
+    while (length > 0) {
+        ssize_t bytes = recv(sock.client_fd, p, length, 0);
+
+        if (bytes < 0 && errno == EINTR)
+            continue;
+
+        if (bytes <= 0) {
+            /* Zero bytes means that the host has disconnected */
+            sock.xfer_rc = -PB_ERR_IO;
+            break;
+        }
+
+        p += bytes;
+        length -= bytes;
+    }
+
+    return PB_OK;
+}
+
+int socket_transport_write(const void *buf, size_t length)
+{
+    const uint8_t *p = buf;
+
+    sock.xfer_rc = PB_OK;
+
+    while (length > 0) {
+        ssize_t bytes = send(sock.client_fd, p, length, MSG_NOSIGNAL);
+
+        if (bytes < 0 && errno == EINTR)
+            continue;
+
+        if (bytes <= 0) {
+            sock.xfer_rc = -PB_ERR_IO;
+            break;
+        }
+
+        p += bytes;
+        length -= bytes;
+    }
+
+    return PB_OK;
+}
+
+int socket_transport_complete(void)
+{
+    return sock.xfer_rc;
+}
@@ -0,0 +1,33 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef PB_SIM_SOCKET_TRANSPORT_H
+#define PB_SIM_SOCKET_TRANSPORT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Configure the UNIX socket command mode transport. The socket is created
+ * by the 'init' transport callback and accepts one host at a time, this is
+ * the server side of 'punchboot -t socket'.
+ *
+ * @param[in] path Path of the UNIX socket
+ * @param[in] once Reset, i.e. exit, when the first host disconnects
+ */
+void socket_transport_configure(const char *path, bool once);
+
+int socket_transport_init(void);
+int socket_transport_connect(void);
+int socket_transport_disconnect(void);
+int socket_transport_read(void *buf, size_t length);
+int socket_transport_write(const void *buf, size_t length);
+int socket_transport_complete(void);
+
+#endif // PB_SIM_SOCKET_TRANSPORT_H
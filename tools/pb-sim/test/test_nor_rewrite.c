@@ -0,0 +1,88 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Writes to the simulated SPI-NOR without erasing it first. The simulated
+ * page program ANDs the data into the flash, like a real NOR, so a page
+ * that needs a bit set must come out right through a rewrite of its erase
+ * block, without disturbing the rest of that block.
+ *
+ */
+
+#include "nor_sim.h"
+#include <pb/errors.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BLOCK_SIZE 4096
+#define PAGE_SIZE  256
+
+static uint8_t image[16384];
+static uint8_t readback[16384];
+
+#define CHECK(expr)                                                            \
+    do {                                                                       \
+        if (!(expr)) {                                                         \
+            fprintf(stderr, "%s:%i: '%s' failed\n", __FILE__, __LINE__, #expr); \
+            exit(1);                                                           \
+        }                                                                      \
+    } while (0)
+
+static void check_flash(bio_dev_t nor)
+{
+    CHECK(bio_read(nor, 0, sizeof(readback), readback) == PB_OK);
+    CHECK(memcmp(readback, image, sizeof(image)) == 0);
+}
+
+int main(void)
+{
+    bio_dev_t nor = nor_sim_init();
+    const struct spi_nor_stats *stats = nor_sim_stats();
+    struct spi_nor_stats before;
+
+    CHECK(nor >= 0);
+
+    for (size_t i = 0; i < sizeof(image); i++)
+        image[i] = (uint8_t)(i * 37 + (i >> 8));
+
+    CHECK(bio_write(nor, 0, sizeof(image), image) == PB_OK);
+    check_flash(nor);
+
+    /* One page in the second erase block changes and needs bits set */
+    before = *stats;
+    memset(&image[BLOCK_SIZE + 3 * PAGE_SIZE], 0x5a, PAGE_SIZE);
+    CHECK(bio_write(nor, 0, sizeof(image), image) == PB_OK);
+    check_flash(nor);
+    CHECK(stats->blocks_rewritten == before.blocks_rewritten + 1);
+    CHECK(stats->blocks_erased == before.blocks_erased + 1);
+    CHECK(stats->pages_programmed == before.pages_programmed + BLOCK_SIZE / PAGE_SIZE);
+
+    /* Only clearing bits is programmed in place */
+    before = *stats;
+    memset(&image[2 * BLOCK_SIZE], 0x00, PAGE_SIZE);
+    CHECK(bio_write(nor, 0, sizeof(image), image) == PB_OK);
+    check_flash(nor);
+    CHECK(stats->blocks_rewritten == before.blocks_rewritten);
+    CHECK(stats->pages_programmed == before.pages_programmed + 1);
+
+    /* A blank page over data is not a no-op */
+    before = *stats;
+    memset(&image[3 * BLOCK_SIZE + PAGE_SIZE], 0xff, PAGE_SIZE);
+    CHECK(bio_write(nor, 0, sizeof(image), image) == PB_OK);
+    check_flash(nor);
+    CHECK(stats->blocks_rewritten == before.blocks_rewritten + 1);
+
+    /* A write of one erase block, with a change inside one page */
+    before = *stats;
+    memset(&image[BLOCK_SIZE + 100], 0xa5, 16);
+    CHECK(bio_write(nor, 1, BLOCK_SIZE, &image[BLOCK_SIZE]) == PB_OK);
+    check_flash(nor);
+    CHECK(stats->blocks_rewritten == before.blocks_rewritten + 1);
+
+    printf("NOR rewrite without erase: OK\n");
+    return 0;
+}
@@ -20,9 +20,12 @@
 
 #include "pbstate.h"
 
-static struct pb_boot_state state;
+static struct pb_boot_state state, record;
+static struct pb_boot_state loaded; /* State as loaded, before any changes */
 static const char *primary_device;
 static const char *backup_device;
+static unsigned int journal_slots;
+static unsigned int journal_next;
 
 static pbstate_printfunc_t printfunc;
 
@@ -30,20 +33,24 @@ static pbstate_printfunc_t printfunc;
     if (printfunc)    \
     printfunc(fmt, ##__VA_ARGS__)
 
-static int verify_state(void)
+static uint32_t state_crc(struct pb_boot_state *s)
 {
-    uint32_t crc = state.crc;
-    int err = 0;
+    s->crc = 0;
+    return crc32(0, (const uint8_t *)s, sizeof(struct pb_boot_state));
+}
 
-    state.crc = 0;
+static int verify_state(struct pb_boot_state *s)
+{
+    uint32_t crc = s->crc;
+    int err = 0;
 
-    if (state.magic != PB_STATE_MAGIC) {
+    if (s->magic != PB_STATE_MAGIC) {
         LOG("Error: Incorrect magic\n");
         err = -EIO;
         goto config_err_out;
     }
 
-    if (crc != crc32(0, (uint8_t *)&state, sizeof(struct pb_boot_state))) {
+    if (crc != state_crc(s)) {
         LOG("Error: CRC failed\n");
         err = -EIO;
         goto config_err_out;
@@ -56,14 +63,15 @@ config_err_out:
     return err;
 }
 
-static int write_state(int fd)
+static int write_state(int fd, const struct pb_boot_state *s, unsigned int block)
 {
     size_t write_sz = 0;
-    const char *buffer = (const char *)&state;
-    size_t buffer_len = sizeof(state);
+    const char *buffer = (const char *)s;
+    size_t buffer_len = sizeof(*s);
+    off_t offset = (off_t)block * sizeof(*s);
 
     do {
-        ssize_t write_now = write(fd, buffer + write_sz, buffer_len - write_sz);
+        ssize_t write_now = pwrite(fd, buffer + write_sz, buffer_len - write_sz, offset + write_sz);
         if (write_now == -1) {
             return -errno;
         }
@@ -73,14 +81,15 @@ static int write_state(int fd)
     return 0;
 }
 
-static int read_state(int fd)
+static int read_state(int fd, struct pb_boot_state *s, unsigned int block)
 {
     size_t read_sz = 0;
-    char *buffer = (char *)&state;
-    size_t buffer_len = sizeof(state);
+    char *buffer = (char *)s;
+    size_t buffer_len = sizeof(*s);
+    off_t offset = (off_t)block * sizeof(*s);
 
     do {
-        ssize_t read_now = read(fd, buffer + read_sz, buffer_len - read_sz);
+        ssize_t read_now = pread(fd, buffer + read_sz, buffer_len - read_sz, offset + read_sz);
         if (read_now == 0) {
             return -EIO;
         } else if (read_now == -1) {
@@ -92,6 +101,37 @@ static int read_state(int fd)
     return 0;
 }
 
+/* Applies the journal records of the primary partition on top of the
+ * snapshot in 'state', see 'pb_state_blob.h' for the format. */
+static void replay_journal(int fd)
+{
+    off_t size = lseek(fd, 0, SEEK_END);
+    unsigned int no_of_blocks = (size > 0) ? (size / sizeof(state)) : 0;
+
+    if (no_of_blocks > (PB_STATE_JOURNAL_MAX_RECORDS + 1))
+        journal_slots = PB_STATE_JOURNAL_MAX_RECORDS;
+    else if (no_of_blocks > 1)
+        journal_slots = no_of_blocks - 1;
+    else
+        journal_slots = 0;
+
+    for (journal_next = 0; journal_next < journal_slots; journal_next++) {
+        uint32_t crc;
+
+        if (read_state(fd, &record, 1 + journal_next) != 0)
+            break;
+
+        crc = record.crc;
+
+        if ((record.magic != PB_STATE_JOURNAL_MAGIC) ||
+            (record.generation != state.generation) || (crc != state_crc(&record)))
+            break;
+
+        memcpy(&state, &record, sizeof(state));
+        state.magic = PB_STATE_MAGIC;
+    }
+}
+
 static int open_and_load_state(bool wr)
 {
     int rc;
@@ -114,44 +154,46 @@ static int open_and_load_state(bool wr)
         goto err_close_out;
     }
 
-    rc = read_state(fd);
-
-    if (rc != 0) {
-        goto err_close_and_release_out;
-    }
+    rc = read_state(fd, &state, 0);
 
-    rc = verify_state();
+    if (rc == 0)
+        rc = verify_state(&state);
 
-    // If the primary state is okay, we just return the fd and won't check
-    // the backup state since it will be overwritten anyway.
     if (rc == 0)
-        return fd;
+        replay_journal(fd);
 
-    // If the primary state is corruptet we should try to load the
-    // backup.
-    backup_fd = open(backup_device, wr ? O_RDWR : O_RDONLY);
+    // The backup is always read. If the primary state is corrupt it's used
+    // instead and it's also newer if the bootloader was interrupted while
+    // writing a new snapshot.
+    backup_fd = open(backup_device, O_RDONLY);
 
     if (backup_fd == -1) {
+        if (rc == 0) {
+            memcpy(&loaded, &state, sizeof(loaded));
+            return fd;
+        }
+
         rc = -errno;
         goto err_close_and_release_out;
     }
 
-    rc = read_state(backup_fd);
+    if ((read_state(backup_fd, &record, 0) == 0) && (verify_state(&record) == 0)) {
+        if ((rc != 0) || ((int32_t)(record.generation - state.generation) > 0)) {
+            memcpy(&state, &record, sizeof(state));
+            // Next write is a new snapshot on both partitions
+            journal_next = journal_slots;
+        }
 
-    if (rc != 0) {
-        goto err_close_backup_out;
+        rc = 0;
     }
 
-    rc = verify_state();
+    close(backup_fd);
 
-    if (rc != 0) {
-        goto err_close_backup_out;
-    }
+    if (rc != 0)
+        goto err_close_and_release_out;
 
-    close(backup_fd);
+    memcpy(&loaded, &state, sizeof(loaded));
     return fd;
-err_close_backup_out:
-    close(backup_fd);
 err_close_and_release_out:
     flock(fd, LOCK_UN);
 err_close_out:
@@ -159,50 +201,83 @@ err_close_out:
     return rc;
 }
 
-static int close_and_save_state(int fd, bool wr)
+static int write_snapshot(int fd)
 {
-    int rc = 0;
+    int rc;
     int backup_fd;
-    uint32_t crc;
 
-    if (!wr) {
-        goto err_close_and_release_out;
-    }
+    state.magic = PB_STATE_MAGIC;
+    state.generation++;
+    state.crc = state_crc(&state);
 
-    if (lseek(fd, 0, SEEK_SET) == (off_t)-1) {
+    backup_fd = open(backup_device, O_WRONLY | O_DSYNC);
+
+    if (backup_fd == -1) {
         rc = -errno;
-        goto err_close_and_release_out;
+        LOG("Error: Could not open '%s' (%i)\n", backup_device, rc);
+        return rc;
     }
 
-    state.crc = 0;
-    crc = crc32(0, (const uint8_t *)&state, sizeof(struct pb_boot_state));
-    state.crc = crc;
+    /* The backup is written first, it has the latest state if the
+     * primary write is interrupted. */
+    rc = write_state(backup_fd, &state, 0);
+    close(backup_fd);
+
+    if (rc != 0) {
+        LOG("Could not write backup config data (%i)\n", rc);
+        return rc;
+    }
 
-    rc = write_state(fd);
+    rc = write_state(fd, &state, 0);
 
     if (rc != 0) {
         LOG("Could not write primary config data (%i)\n", rc);
-        goto err_close_and_release_out;
+        return rc;
     }
 
-    backup_fd = open(backup_device, O_WRONLY | O_DSYNC);
+    journal_next = 0;
+    return 0;
+}
 
-    if (backup_fd == -1) {
-        rc = -errno;
-        LOG("Error: Could not open '%s' (%i)\n", backup_device, rc);
+/* Like the bootloader, only a change of the boot attempt counter is
+ * appended to the journal. Other changes are written as a new snapshot
+ * so that the backup partition has the same system selection. */
+static bool journal_write_allowed(void)
+{
+    if (journal_next >= journal_slots)
+        return false;
+
+    memcpy(&record, &state, sizeof(record));
+    record.magic = loaded.magic;
+    record.remaining_boot_attempts = loaded.remaining_boot_attempts;
+    record.generation = loaded.generation;
+    record.crc = loaded.crc;
+
+    return (memcmp(&record, &loaded, sizeof(record)) == 0);
+}
+
+static int close_and_save_state(int fd, bool wr)
+{
+    int rc = 0;
+
+    if (!wr) {
         goto err_close_and_release_out;
     }
 
-    /* Synchronize backup partition with primary partition */
-    rc = write_state(backup_fd);
+    if (journal_write_allowed()) {
+        memcpy(&record, &state, sizeof(record));
+        record.magic = PB_STATE_JOURNAL_MAGIC;
+        record.crc = state_crc(&record);
 
-    if (rc != 0) {
-        LOG("Could not write backup config data (%i)\n", rc);
-        goto err_close_backup_out;
+        rc = write_state(fd, &record, 1 + journal_next);
+
+        if (rc != 0) {
+            LOG("Could not write primary config data (%i)\n", rc);
+        }
+    } else {
+        rc = write_snapshot(fd);
     }
 
-err_close_backup_out:
-    close(backup_fd);
 err_close_and_release_out:
     flock(fd, LOCK_UN);
     close(fd);
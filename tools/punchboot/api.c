@@ -39,10 +39,19 @@ int pb_api_free_context(struct pb_context *ctx)
     if (ctx->free)
         ctx->free(ctx);
 
+    pb_api_invalidate_cache(ctx);
     free(ctx);
     return PB_RESULT_OK;
 }
 
+void pb_api_invalidate_cache(struct pb_context *ctx)
+{
+    ctx->caps_valid = false;
+    free(ctx->part_tbl);
+    ctx->part_tbl = NULL;
+    ctx->part_tbl_entries = 0;
+}
+
 int pb_api_list_devices(struct pb_context *ctx,
                         void (*list_cb)(const char *uuid_str, void *priv),
                         void *priv)
@@ -8,6 +8,7 @@
 
 struct pb_context;
 struct pb_command;
+struct pb_crypto_provider;
 
 typedef int (*pb_init_t)(struct pb_context *ctx);
 typedef int (*pb_free_t)(struct pb_context *ctx);
@@ -25,19 +26,6 @@ typedef int (*pb_disconnect_t)(struct pb_context *ctx);
 
 typedef int (*pb_debug_t)(struct pb_context *ctx, int level, const char *fmt, ...);
 
-struct pb_context {
-    bool connected;
-    pb_init_t init;
-    pb_free_t free;
-    pb_write_t write;
-    pb_read_t read;
-    pb_list_devices_t list;
-    pb_connect_t connect;
-    pb_disconnect_t disconnect;
-    pb_debug_t d;
-    void *transport;
-};
-
 struct pb_device_capabilities {
     uint8_t stream_no_of_buffers;
     uint32_t stream_buffer_size;
@@ -45,6 +33,10 @@ struct pb_device_capabilities {
     uint16_t part_erase_timeout_ms;
     uint8_t bpak_stream_support;
     uint32_t chunk_transfer_max_bytes;
+    uint32_t part_digest_chunk_size;
+    uint8_t stream_read_flags;
+    uint8_t verify_digest_algs; /*!< Bit n is set for enum pb_digest_alg n */
+    uint8_t verify_digest_preferred; /*!< Fastest verify digest on the device */
 };
 
 #define PB_PART_FLAG_BOOTABLE           (1 << 0)
@@ -62,8 +54,28 @@ struct pb_partition_table_entry {
     uint8_t flags; /*!< Flags */
 };
 
+struct pb_context {
+    bool connected;
+    pb_init_t init;
+    pb_free_t free;
+    pb_write_t write;
+    pb_read_t read;
+    pb_list_devices_t list;
+    pb_connect_t connect;
+    pb_disconnect_t disconnect;
+    pb_debug_t d;
+    void *transport;
+    /* The capabilities and the partition table are read once per context
+     * and dropped when the table is installed or the device is reset */
+    bool caps_valid;
+    struct pb_device_capabilities caps;
+    struct pb_partition_table_entry *part_tbl;
+    int part_tbl_entries;
+};
+
 int pb_api_create_context(struct pb_context **ctx, pb_debug_t debug);
 int pb_api_free_context(struct pb_context *ctx);
+void pb_api_invalidate_cache(struct pb_context *ctx);
 int pb_api_list_devices(struct pb_context *ctx,
                         void (*list_cb)(const char *uuid_str, void *priv),
                         void *priv);
@@ -95,6 +107,10 @@ int pb_api_slc_revoke_key(struct pb_context *ctx, uint32_t key_id);
 
 int pb_api_device_read_caps(struct pb_context *ctx, struct pb_device_capabilities *caps);
 
+int pb_api_device_read_crypto_providers(struct pb_context *ctx,
+                                        struct pb_crypto_provider *out,
+                                        int *entries);
+
 int pb_api_auth_set_password(struct pb_context *ctx, const char *password, size_t size);
 
 int pb_api_bootloader_version(struct pb_context *ctx, char *version, size_t size);
@@ -107,19 +123,31 @@ int pb_api_partition_install_table(struct pb_context *ctx, const uint8_t *uu, ui
 
 int pb_api_partition_verify(struct pb_context *ctx,
                             uint8_t *uuid,
-                            uint8_t *sha256,
-                            uint32_t size,
+                            uint8_t digest_alg,
+                            const uint8_t *digest,
+                            size_t digest_size,
+                            uint64_t size,
                             bool bpak);
 
 int pb_api_partition_read_bpak(struct pb_context *ctx, uint8_t *uuid, struct bpak_header *header);
 
 int pb_api_partition_erase(struct pb_context *ctx,
                            uint8_t *uuid,
-                           uint32_t start_lba,
-                           uint32_t block_count);
+                           uint64_t start_lba,
+                           uint64_t block_count);
 
 int pb_api_partition_write(struct pb_context *ctx, int file_fd, uint8_t *uuid);
 
+int pb_api_partition_read_digests(struct pb_context *ctx,
+                                  uint8_t *uuid,
+                                  uint64_t offset,
+                                  uint64_t size,
+                                  uint32_t chunk_size,
+                                  uint8_t *digests,
+                                  size_t digests_size);
+
+int pb_api_partition_write_delta(struct pb_context *ctx, int file_fd, uint8_t *uuid);
+
 int pb_api_partition_read(struct pb_context *ctx, int file_fd, uint8_t *uuid);
 
 int pb_api_stream_init(struct pb_context *ctx, uint8_t *uuid);
@@ -140,6 +168,15 @@ int pb_api_stream_read_buffer(struct pb_context *ctx,
                               uint32_t size,
                               void *data);
 
+int pb_api_stream_read_buffer_ext(struct pb_context *ctx,
+                                  uint8_t buffer_id,
+                                  uint64_t offset,
+                                  uint32_t size,
+                                  uint8_t flags,
+                                  uint32_t read_ahead_size,
+                                  void *data,
+                                  bool *zero);
+
 int pb_api_stream_finalize(struct pb_context *ctx);
 
 int pb_api_boot_part(struct pb_context *ctx, uint8_t *uuid, bool verbose);
@@ -193,6 +193,12 @@ int pb_api_boot_bpak(struct pb_context *ctx, const void *bpak_image, uint8_t *uu
 
         if (!pb_wire_valid_result(&result))
             return -PB_RESULT_ERROR;
+
+        /* Images with per-part digests are verified as each part arrives */
+        if (result.result_code != PB_RESULT_OK) {
+            ctx->d(ctx, 0, "%s: Part %x failed (%i)\n", __func__, p->id, result.result_code);
+            return result.result_code;
+        }
     }
 
     rc = ctx->read(ctx, &result, sizeof(result));
@@ -11,6 +11,7 @@ int pb_api_device_reset(struct pb_context *ctx)
 
     ctx->d(ctx, 2, "%s: call\n", __func__);
 
+    pb_api_invalidate_cache(ctx);
     pb_wire_init_command(&cmd, PB_CMD_DEVICE_RESET);
 
     rc = ctx->write(ctx, &cmd, sizeof(cmd));
@@ -94,6 +95,11 @@ int pb_api_device_read_caps(struct pb_context *ctx, struct pb_device_capabilitie
 
     ctx->d(ctx, 2, "%s: call\n", __func__);
 
+    if (ctx->caps_valid) {
+        memcpy(caps, &ctx->caps, sizeof(*caps));
+        return PB_RESULT_OK;
+    }
+
     pb_wire_init_command(&cmd, PB_CMD_DEVICE_READ_CAPS);
 
     rc = ctx->write(ctx, &cmd, sizeof(cmd));
@@ -118,6 +124,78 @@ int pb_api_device_read_caps(struct pb_context *ctx, struct pb_device_capabilitie
     caps->operation_timeout_ms = result_caps.operation_timeout_ms;
     caps->part_erase_timeout_ms = result_caps.part_erase_timeout_ms;
     caps->chunk_transfer_max_bytes = result_caps.chunk_transfer_max_bytes;
+    caps->part_digest_chunk_size = result_caps.part_digest_chunk_size;
+    caps->stream_read_flags = result_caps.stream_read_flags;
+    caps->verify_digest_algs = result_caps.verify_digest_algs;
+    caps->verify_digest_preferred = result_caps.verify_digest_preferred;
+
+    if (result.result_code == PB_RESULT_OK) {
+        memcpy(&ctx->caps, caps, sizeof(*caps));
+        ctx->caps_valid = true;
+    }
+
+    ctx->d(ctx,
+           2,
+           "%s: return %i (%s)\n",
+           __func__,
+           result.result_code,
+           pb_error_string(result.result_code));
+    return result.result_code;
+}
+
+int pb_api_device_read_crypto_providers(struct pb_context *ctx,
+                                        struct pb_crypto_provider *out,
+                                        int *entries)
+{
+    int rc;
+    struct pb_command cmd;
+    struct pb_result result;
+    struct pb_result_crypto_providers providers_result;
+
+    ctx->d(ctx, 2, "%s: call\n", __func__);
+
+    pb_wire_init_command(&cmd, PB_CMD_CRYPTO_PROVIDERS_READ);
+
+    rc = ctx->write(ctx, &cmd, sizeof(cmd));
+
+    if (rc != PB_RESULT_OK)
+        return rc;
+
+    rc = ctx->read(ctx, &result, sizeof(result));
+
+    if (rc != PB_RESULT_OK)
+        return rc;
+
+    if (!pb_wire_valid_result(&result))
+        return -PB_RESULT_ERROR;
+
+    if (result.result_code != PB_RESULT_OK)
+        return result.result_code;
+
+    memcpy(&providers_result, result.response, sizeof(providers_result));
+
+    if ((providers_result.size % sizeof(*out)) != 0)
+        return -PB_RESULT_ERROR;
+
+    if ((providers_result.size / sizeof(*out)) > (size_t)(*entries))
+        return -PB_RESULT_NO_MEMORY;
+
+    if (providers_result.size > 0) {
+        rc = ctx->read(ctx, out, providers_result.size);
+
+        if (rc != PB_RESULT_OK)
+            return rc;
+    }
+
+    *entries = providers_result.size / sizeof(*out);
+
+    rc = ctx->read(ctx, &result, sizeof(result));
+
+    if (rc != PB_RESULT_OK)
+        return rc;
+
+    if (!pb_wire_valid_result(&result))
+        return -PB_RESULT_ERROR;
 
     ctx->d(ctx,
            2,
@@ -1,4 +1,5 @@
 #include "api.h"
+#include "sha256.h"
 #include <bpak/bpak.h>
 #include <errno.h>
 #include <pb-tools/compat.h>
@@ -25,6 +26,15 @@ int pb_api_partition_read_table(struct pb_context *ctx,
 
     ctx->d(ctx, 2, "%s: call\n", __func__);
 
+    if (ctx->part_tbl != NULL) {
+        if (ctx->part_tbl_entries > (*entries))
+            return -PB_RESULT_NO_MEMORY;
+
+        memcpy(out, ctx->part_tbl, sizeof(*out) * ctx->part_tbl_entries);
+        *entries = ctx->part_tbl_entries;
+        return PB_RESULT_OK;
+    }
+
     pb_wire_init_command(&cmd, PB_CMD_PART_TBL_READ);
 
     rc = ctx->write(ctx, &cmd, sizeof(cmd));
@@ -103,6 +113,17 @@ skip_tbl_read:
     }
 
     free(tbl);
+
+    if ((result.result_code == PB_RESULT_OK) && (tbl_read_result.no_of_entries > 0)) {
+        size_t tbl_size = sizeof(*out) * tbl_read_result.no_of_entries;
+
+        ctx->part_tbl = malloc(tbl_size);
+
+        if (ctx->part_tbl != NULL) {
+            memcpy(ctx->part_tbl, out, tbl_size);
+            ctx->part_tbl_entries = tbl_read_result.no_of_entries;
+        }
+    }
     ctx->d(ctx,
            2,
            "%s: return %i (%s)\n",
@@ -121,6 +142,7 @@ int pb_api_partition_install_table(struct pb_context *ctx, const uint8_t *uu, ui
     struct pb_result result;
 
     ctx->d(ctx, 2, "%s: call\n", __func__);
+    pb_api_invalidate_cache(ctx);
     memset(&install_tbl, 0, sizeof(install_tbl));
     memcpy(install_tbl.uu, uu, 16);
     install_tbl.variant = variant;
@@ -151,8 +173,10 @@ int pb_api_partition_install_table(struct pb_context *ctx, const uint8_t *uu, ui
 
 int pb_api_partition_verify(struct pb_context *ctx,
                             uint8_t *uuid,
-                            uint8_t *sha256,
-                            uint32_t size,
+                            uint8_t digest_alg,
+                            const uint8_t *digest,
+                            size_t digest_size,
+                            uint64_t size,
                             bool bpak)
 {
     int rc;
@@ -164,8 +188,20 @@ int pb_api_partition_verify(struct pb_context *ctx,
 
     memset(&verify, 0, sizeof(verify));
     memcpy(verify.uuid, uuid, 16);
-    memcpy(verify.sha256, sha256, 32);
-    verify.size = size;
+
+    if (digest_alg == PB_DIGEST_SHA256) {
+        if (digest_size != sizeof(verify.sha256))
+            return -PB_RESULT_INVALID_ARGUMENT;
+        memcpy(verify.sha256, digest, digest_size);
+    } else {
+        if (digest_size > sizeof(verify.digest))
+            return -PB_RESULT_INVALID_ARGUMENT;
+        memcpy(verify.digest, digest, digest_size);
+    }
+
+    verify.digest_alg = digest_alg;
+    verify.size = (size > UINT32_MAX) ? UINT32_MAX : (uint32_t)size;
+    verify.size64 = size;
 
     if (bpak)
         verify.bpak = 1;
@@ -250,8 +286,8 @@ int pb_api_partition_read_bpak(struct pb_context *ctx, uint8_t *uuid, struct bpa
 
 int pb_api_partition_erase(struct pb_context *ctx,
                            uint8_t *uuid,
-                           uint32_t start_lba,
-                           uint32_t block_count)
+                           uint64_t start_lba,
+                           uint64_t block_count)
 {
     int rc;
     struct pb_command cmd;
@@ -262,8 +298,10 @@ int pb_api_partition_erase(struct pb_context *ctx,
 
     memset(&erase_command, 0, sizeof(erase_command));
     memcpy(erase_command.uuid, uuid, 16);
-    erase_command.start_lba = start_lba;
-    erase_command.block_count = block_count;
+    erase_command.start_lba = start_lba & 0xffffffff;
+    erase_command.start_lba_hi = start_lba >> 32;
+    erase_command.block_count = block_count & 0xffffffff;
+    erase_command.block_count_hi = block_count >> 32;
 
     pb_wire_init_command2(&cmd, PB_CMD_PART_ERASE, &erase_command, sizeof(erase_command));
 
@@ -289,6 +327,75 @@ int pb_api_partition_erase(struct pb_context *ctx,
     return result.result_code;
 }
 
+int pb_api_partition_read_digests(struct pb_context *ctx,
+                                  uint8_t *uuid,
+                                  uint64_t offset,
+                                  uint64_t size,
+                                  uint32_t chunk_size,
+                                  uint8_t *digests,
+                                  size_t digests_size)
+{
+    int rc;
+    struct pb_command cmd;
+    struct pb_command_part_read_digests digest_command;
+    struct pb_result_part_read_digests digest_result;
+    struct pb_result result;
+
+    ctx->d(ctx, 2, "%s: call\n", __func__);
+
+    memset(&digest_command, 0, sizeof(digest_command));
+    memcpy(digest_command.uuid, uuid, 16);
+    digest_command.offset = offset;
+    digest_command.size = (size > UINT32_MAX) ? UINT32_MAX : (uint32_t)size;
+    digest_command.size64 = size;
+    digest_command.chunk_size = chunk_size;
+
+    pb_wire_init_command2(
+        &cmd, PB_CMD_PART_READ_DIGESTS, &digest_command, sizeof(digest_command));
+
+    rc = ctx->write(ctx, &cmd, sizeof(cmd));
+
+    if (rc != PB_RESULT_OK)
+        return rc;
+
+    rc = ctx->read(ctx, &result, sizeof(result));
+
+    if (rc != PB_RESULT_OK)
+        return rc;
+
+    if (!pb_wire_valid_result(&result))
+        return -PB_RESULT_ERROR;
+
+    if (result.result_code != PB_RESULT_OK)
+        return result.result_code;
+
+    memcpy(&digest_result, result.response, sizeof(digest_result));
+
+    if (digest_result.size > digests_size)
+        return -PB_RESULT_NO_MEMORY;
+
+    rc = ctx->read(ctx, digests, digest_result.size);
+
+    if (rc != PB_RESULT_OK)
+        return rc;
+
+    rc = ctx->read(ctx, &result, sizeof(result));
+
+    if (rc != PB_RESULT_OK)
+        return rc;
+
+    if (!pb_wire_valid_result(&result))
+        return -PB_RESULT_ERROR;
+
+    ctx->d(ctx,
+           2,
+           "%s: return %i (%s)\n",
+           __func__,
+           result.result_code,
+           pb_error_string(result.result_code));
+    return result.result_code;
+}
+
 static int read_part_table(struct pb_context *ctx,
                            struct pb_partition_table_entry **table,
                            int *entries)
@@ -333,6 +440,7 @@ int pb_api_partition_write(struct pb_context *ctx, int file_fd, uint8_t *uuid)
     size_t offset = 0;
     ssize_t read_bytes = 0;
     bool bpak_file = false;
+    int finalize_rc;
     int rc;
 
     if (lseek(file_fd, 0, SEEK_SET) == (off_t)-1) {
@@ -429,14 +537,252 @@ int pb_api_partition_write(struct pb_context *ctx, int file_fd, uint8_t *uuid)
     }
 
 err_free_buf:
-    pb_api_stream_finalize(ctx);
+    /* With background commits the device reports a failed write of the
+     * last buffer when the stream is finalized */
+    finalize_rc = pb_api_stream_finalize(ctx);
+
+    if (rc == PB_RESULT_OK)
+        rc = finalize_rc;
+
     free(chunk_buffer);
     return rc;
 }
 
+struct pb_delta_state {
+    struct pb_device_capabilities caps;
+    uint8_t *uuid;
+    uint8_t *chunk_buffer;
+    uint8_t *digests;
+    size_t digests_size;
+    uint8_t buffer_id;
+    size_t chunks_total;
+    size_t chunks_written;
+};
+
+static int write_delta_range(struct pb_context *ctx,
+                             struct pb_delta_state *state,
+                             int file_fd,
+                             off_t file_offset,
+                             uint64_t part_offset,
+                             size_t length)
+{
+    size_t chunk_size = state->caps.part_digest_chunk_size;
+    size_t batch_max = (state->digests_size / PB_WIRE_PART_DIGEST_SIZE) * chunk_size;
+    uint8_t digest[PB_SHA256_DIGEST_SIZE];
+    struct pb_sha256_ctx sha256;
+    int rc;
+
+    if (lseek(file_fd, file_offset, SEEK_SET) == (off_t)-1) {
+        return -PB_RESULT_IO_ERROR;
+    }
+
+    while (length > 0) {
+        size_t batch_len = length > batch_max ? batch_max : length;
+        size_t bytes_left = batch_len;
+
+        rc = pb_api_partition_read_digests(ctx,
+                                           state->uuid,
+                                           part_offset,
+                                           batch_len,
+                                           chunk_size,
+                                           state->digests,
+                                           state->digests_size);
+
+        if (rc != PB_RESULT_OK)
+            return rc;
+
+        for (size_t n = 0; bytes_left > 0; n++) {
+            size_t chunk_len = bytes_left > chunk_size ? chunk_size : bytes_left;
+
+            if (read(file_fd, state->chunk_buffer, chunk_len) != (ssize_t)chunk_len) {
+                return -PB_RESULT_IO_ERROR;
+            }
+
+            pb_sha256_init(&sha256);
+            pb_sha256_update(&sha256, state->chunk_buffer, chunk_len);
+            pb_sha256_final(&sha256, digest);
+
+            state->chunks_total++;
+
+            if (memcmp(digest, &state->digests[n * PB_WIRE_PART_DIGEST_SIZE], sizeof(digest)) !=
+                0) {
+                rc = pb_api_stream_prepare_buffer(
+                    ctx, state->buffer_id, state->chunk_buffer, chunk_len);
+
+                if (rc != PB_RESULT_OK)
+                    return rc;
+
+                rc = pb_api_stream_write_buffer(ctx, state->buffer_id, part_offset, chunk_len);
+
+                if (rc != PB_RESULT_OK)
+                    return rc;
+
+                state->buffer_id = (state->buffer_id + 1) % state->caps.stream_no_of_buffers;
+                state->chunks_written++;
+            }
+
+            part_offset += chunk_len;
+            bytes_left -= chunk_len;
+        }
+
+        length -= batch_len;
+    }
+
+    return PB_RESULT_OK;
+}
+
+int pb_api_partition_write_delta(struct pb_context *ctx, int file_fd, uint8_t *uuid)
+{
+    struct pb_delta_state state;
+    struct pb_partition_table_entry *tbl;
+    int tbl_entries;
+    struct bpak_header header;
+    size_t part_size = 0;
+    uint8_t part_flags = 0;
+    bool part_found = false;
+    off_t file_size;
+    ssize_t read_bytes;
+    int finalize_rc;
+    int rc;
+
+    memset(&state, 0, sizeof(state));
+    state.uuid = uuid;
+
+    rc = pb_api_device_read_caps(ctx, &state.caps);
+    if (rc != PB_RESULT_OK) {
+        return rc;
+    }
+
+    if (state.caps.part_digest_chunk_size == 0 ||
+        state.caps.part_digest_chunk_size > state.caps.chunk_transfer_max_bytes) {
+        ctx->d(ctx, 1, "%s: delta not supported, writing everything\n", __func__);
+        return pb_api_partition_write(ctx, file_fd, uuid);
+    }
+
+    file_size = lseek(file_fd, 0, SEEK_END);
+
+    if (file_size == (off_t)-1) {
+        return -PB_RESULT_IO_ERROR;
+    }
+
+    rc = read_part_table(ctx, &tbl, &tbl_entries);
+    if (rc != PB_RESULT_OK) {
+        return rc;
+    }
+
+    for (int i = 0; i < tbl_entries; i++) {
+        if (memcmp(tbl[i].uuid, uuid, 16) == 0) {
+            part_size = (tbl[i].last_block - tbl[i].first_block + 1) * tbl[i].block_size;
+            part_flags = tbl[i].flags;
+            part_found = true;
+            break;
+        }
+    }
+    free(tbl);
+
+    if (!part_found) {
+        return -PB_RESULT_NOT_FOUND;
+    }
+
+    /* The device only digests partitions that may be read back */
+    if (!(part_flags & PB_PART_FLAG_READABLE)) {
+        ctx->d(ctx, 1, "%s: partition is not readable, writing everything\n", __func__);
+        return pb_api_partition_write(ctx, file_fd, uuid);
+    }
+
+    state.chunk_buffer = malloc(state.caps.part_digest_chunk_size);
+    state.digests_size = state.caps.stream_buffer_size;
+    state.digests = malloc(state.digests_size);
+
+    if (!state.chunk_buffer || !state.digests) {
+        rc = -PB_RESULT_MEM_ERROR;
+        goto err_free_buf;
+    }
+
+    rc = pb_api_stream_init(ctx, uuid);
+    if (rc != PB_RESULT_OK) {
+        goto err_free_buf;
+    }
+
+    if (lseek(file_fd, 0, SEEK_SET) == (off_t)-1) {
+        rc = -PB_RESULT_IO_ERROR;
+        goto err_finalize;
+    }
+
+    read_bytes = read(file_fd, &header, sizeof(header));
+
+    if (read_bytes < 0) {
+        rc = -PB_RESULT_IO_ERROR;
+    } else if (read_bytes == sizeof(header) && bpak_valid_header(&header) == BPAK_OK) {
+        /* The header is stored at the end of the partition and the
+         * payload at the start, just like pb_api_partition_write */
+        rc = write_delta_range(
+            ctx, &state, file_fd, 0, part_size - sizeof(header), sizeof(header));
+
+        if (rc == PB_RESULT_OK) {
+            rc = write_delta_range(
+                ctx, &state, file_fd, sizeof(header), 0, file_size - sizeof(header));
+        }
+    } else {
+        rc = write_delta_range(ctx, &state, file_fd, 0, 0, file_size);
+    }
+
+    ctx->d(ctx,
+           1,
+           "%s: wrote %zu of %zu chunks\n",
+           __func__,
+           state.chunks_written,
+           state.chunks_total);
+
+err_finalize:
+    finalize_rc = pb_api_stream_finalize(ctx);
+
+    if (rc == PB_RESULT_OK)
+        rc = finalize_rc;
+err_free_buf:
+    free(state.digests);
+    free(state.chunk_buffer);
+    return rc;
+}
+
+/* Skip over an all-zero chunk in the output file, leaving a hole where the
+ * file system supports it. The last byte of the final chunk is always written
+ * so that the file gets the correct length. */
+static int write_zero_chunk(int file_fd, unsigned char *buffer, size_t length, bool last)
+{
+    ssize_t bytes_written;
+
+#ifndef _MSC_VER
+    off_t skip = last ? (off_t)(length - 1) : (off_t)length;
+
+    if (lseek(file_fd, skip, SEEK_CUR) != (off_t)-1) {
+        if (!last)
+            return PB_RESULT_OK;
+
+        buffer[0] = 0;
+        bytes_written = write(file_fd, buffer, 1);
+        return (bytes_written == 1) ? PB_RESULT_OK : -PB_RESULT_IO_ERROR;
+    }
+#else
+    (void)last;
+#endif
+
+    /* Not seekable, fall back to writing the zeros */
+    memset(buffer, 0, length);
+    bytes_written = write(file_fd, buffer, length);
+
+    if (bytes_written != (ssize_t)length) {
+        fprintf(stderr, "Error: Write failed (%i)\n", -errno);
+        return -PB_RESULT_IO_ERROR;
+    }
+
+    return PB_RESULT_OK;
+}
+
 int pb_api_partition_read(struct pb_context *ctx, int file_fd, uint8_t *uuid)
 {
     struct pb_device_capabilities caps;
+    uint8_t read_flags = 0;
     struct pb_partition_table_entry *tbl;
     size_t chunk_size;
     size_t offset = 0;
@@ -445,6 +791,7 @@ int pb_api_partition_read(struct pb_context *ctx, int file_fd, uint8_t *uuid)
     int entries = 128;
     bool part_found = false;
     size_t bytes_left;
+    int finalize_rc;
     int rc = -PB_RESULT_ERROR;
 
     if (!uuid) {
@@ -500,28 +847,52 @@ int pb_api_partition_read(struct pb_context *ctx, int file_fd, uint8_t *uuid)
         goto err_free_tbl;
     }
 
+    if (caps.stream_no_of_buffers >= 2) {
+        read_flags = caps.stream_read_flags &
+                     (PB_STREAM_READ_FLAG_ELIDE_ZERO | PB_STREAM_READ_FLAG_READ_AHEAD);
+    }
+
     do {
         size_t to_read = bytes_left > chunk_size ? chunk_size : bytes_left;
-        rc = pb_api_stream_read_buffer(ctx, buffer_id, offset, to_read, buffer);
+        size_t next_bytes_left = bytes_left - to_read;
+        size_t read_ahead = next_bytes_left > chunk_size ? chunk_size : next_bytes_left;
+        bool zero = false;
+
+        if (read_flags) {
+            rc = pb_api_stream_read_buffer_ext(
+                ctx, buffer_id, offset, to_read, read_flags, read_ahead, buffer, &zero);
+        } else {
+            rc = pb_api_stream_read_buffer(ctx, buffer_id, offset, to_read, buffer);
+        }
 
         if (rc != PB_RESULT_OK)
             break;
 
         buffer_id = (buffer_id + 1) % caps.stream_no_of_buffers;
 
-        ssize_t bytes_written = write(file_fd, buffer, to_read);
+        if (zero) {
+            rc = write_zero_chunk(file_fd, buffer, to_read, (next_bytes_left == 0));
 
-        if (bytes_written != (ssize_t)to_read) {
-            rc = -PB_RESULT_IO_ERROR;
-            fprintf(stderr, "Error: Write failed (%i)\n", -errno);
-            break;
+            if (rc != PB_RESULT_OK)
+                break;
+        } else {
+            ssize_t bytes_written = write(file_fd, buffer, to_read);
+
+            if (bytes_written != (ssize_t)to_read) {
+                rc = -PB_RESULT_IO_ERROR;
+                fprintf(stderr, "Error: Write failed (%i)\n", -errno);
+                break;
+            }
         }
 
         offset += to_read;
         bytes_left -= to_read;
     } while (bytes_left > 0);
 
-    pb_api_stream_finalize(ctx);
+    finalize_rc = pb_api_stream_finalize(ctx);
+
+    if (rc == PB_RESULT_OK)
+        rc = finalize_rc;
 
 err_free_tbl:
     free(tbl);
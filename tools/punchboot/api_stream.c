@@ -234,6 +234,102 @@ int pb_api_stream_read_buffer(struct pb_context *ctx,
     return result.result_code;
 }
 
+int pb_api_stream_read_buffer_ext(struct pb_context *ctx,
+                                  uint8_t buffer_id,
+                                  uint64_t offset,
+                                  uint32_t size,
+                                  uint8_t flags,
+                                  uint32_t read_ahead_size,
+                                  void *data,
+                                  bool *zero)
+{
+    int rc;
+    struct pb_command_stream_read_buffer read_command;
+    struct pb_result_stream_read_buffer read_result;
+    struct pb_command cmd;
+    struct pb_result result;
+
+    ctx->d(ctx, 2, "%s: call\n", __func__);
+
+    memset(&read_command, 0, sizeof(read_command));
+
+    read_command.buffer_id = buffer_id;
+    read_command.offset = offset;
+    read_command.size = size;
+    read_command.flags = flags;
+    read_command.read_ahead_size = read_ahead_size;
+
+    pb_wire_init_command2(&cmd, PB_CMD_STREAM_READ_BUFFER, &read_command, sizeof(read_command));
+
+    rc = ctx->write(ctx, &cmd, sizeof(cmd));
+
+    if (rc != PB_RESULT_OK) {
+        ctx->d(ctx, 2, "%s: cmd write failed\n", __func__);
+        return rc;
+    }
+
+    rc = ctx->read(ctx, &result, sizeof(result));
+
+    if (rc != PB_RESULT_OK) {
+        ctx->d(ctx, 2, "%s: cmd result read failed\n", __func__);
+        return rc;
+    }
+
+    if (!pb_wire_valid_result(&result)) {
+        ctx->d(ctx, 2, "%s: cmd result not valid\n", __func__);
+        return -PB_RESULT_ERROR;
+    }
+
+    if (result.result_code != PB_RESULT_OK) {
+        ctx->d(ctx,
+               2,
+               "%s: return %i (%s)\n",
+               __func__,
+               result.result_code,
+               pb_error_string(result.result_code));
+        return result.result_code;
+    }
+
+    memcpy(&read_result, result.response, sizeof(read_result));
+
+    if (read_result.size > size) {
+        ctx->d(ctx, 0, "%s: Invalid data size %u\n", __func__, read_result.size);
+        return -PB_RESULT_ERROR;
+    }
+
+    *zero = (read_result.zero != 0);
+
+    if (read_result.size > 0) {
+        rc = ctx->read(ctx, data, read_result.size);
+
+        if (rc != PB_RESULT_OK) {
+            ctx->d(ctx, 2, "%s: partition data read failed\n", __func__);
+            return rc;
+        }
+    }
+
+    rc = ctx->read(ctx, &result, sizeof(result));
+
+    if (rc != PB_RESULT_OK) {
+        ctx->d(ctx, 2, "%s: partition data result read failed\n", __func__);
+        return rc;
+    }
+
+    if (!pb_wire_valid_result(&result)) {
+        ctx->d(ctx, 2, "%s: partition data result not valid\n", __func__);
+        return -PB_RESULT_ERROR;
+    }
+
+    ctx->d(ctx,
+           2,
+           "%s: return %i (%s)\n",
+           __func__,
+           result.result_code,
+           pb_error_string(result.result_code));
+
+    return result.result_code;
+}
+
 int pb_api_stream_finalize(struct pb_context *ctx)
 {
     int rc;
@@ -21,9 +21,10 @@ from _punchboot import (  # type: ignore[import-not-found] # noqa: F401
     TransferError,
 )
 
+from .crypto import CryptoProvider, CryptoProviderFlags, DigestAlg
 from .helpers import library_version, list_usb_devices, pb_id, wait_for_device
 from .partition import Partition, PartitionFlags
-from .session import Session
+from .session import FileDigest, Session, file_digest
 from .slc import SLC
 
 _pb_exceptions = [
@@ -52,6 +53,11 @@ __all__ = [
     "Partition",
     "PartitionFlags",
     "SLC",
+    "CryptoProvider",
+    "CryptoProviderFlags",
+    "DigestAlg",
+    "FileDigest",
+    "file_digest",
     "library_version",
     "pb_id",
     "wait_for_device",
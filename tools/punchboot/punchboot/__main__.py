@@ -4,6 +4,7 @@ from __future__ import annotations
 
 import contextlib
 import getopt
+import json
 import logging
 import os
 import pathlib
@@ -19,7 +20,8 @@ from click.shell_completion import CompletionItem
 
 import punchboot
 
-from . import Partition, Session, list_usb_devices
+from . import CryptoProvider, DigestAlg, Partition, Session, list_usb_devices, wait_for_device
+from .provision import Manifest, ManifestError, Provisioner, StepTiming
 
 logger = logging.getLogger("pb")
 
@@ -218,6 +220,19 @@ def dev_reset(_ctx: click.Context, s: Session) -> None:
     s.device_reset()
 
 
+@dev.command("wait")
+@click.option("--timeout", type=int, default=10, show_default=True, help="Timeout in seconds")
+@click.pass_context
+def dev_wait(ctx: click.Context, timeout: int) -> None:
+    """Wait for a device to attach."""
+    socket = ctx.obj["socket"] if ctx.obj["transport"] == "socket" else None
+    try:
+        wait_for_device(timeout, ctx.obj["device-uuid"], socket)
+    except TimeoutError as e:
+        msg = "No device found"
+        raise click.ClickException(msg) from e
+
+
 @dev.command("show")
 @pb_session
 @click.pass_context
@@ -229,6 +244,33 @@ def dev_show(_ctx: click.Context, s: Session) -> None:
     click.echo(f"{'Board name:':<20}{s.device_get_boardname()}")
 
 
+@dev.command("crypto")
+@pb_session
+@click.pass_context
+def dev_crypto(_ctx: click.Context, s: Session) -> None:
+    """Show crypto providers and their measured costs.
+
+    'S' and 'L' mark the provider that is used for small and for large inputs.
+    """
+
+    def _used_helper(p: CryptoProvider) -> str:
+        return ("S" if p.selected_small else "-") + ("L" if p.selected_large else "-")
+
+    def _cost_helper(p: CryptoProvider) -> str:
+        if p.dsa:
+            return ""
+        if not p.calibrated:
+            return "not calibrated"
+        return f"{p.setup_ns} ns + {p.ns_per_kib} ns/KiB"
+
+    click.echo(f"{'Provider':<16}   {'Algorithm':<12}   {'Used':<4}   {'Prio':<4}   {'Cost':<24}")
+    click.echo(f"{'--------':<16}   {'---------':<12}   {'----':<4}   {'----':<4}   {'----':<24}")
+    for p in s.device_get_crypto_providers():
+        click.echo(
+            f"{p.name:<16}   {p.alg:<12}   {_used_helper(p):<4}   {p.priority:<4}   {_cost_helper(p):<24}"  # noqa: E501
+        )
+
+
 @cli.group()
 @click.pass_context
 def auth(_ctx: click.Context) -> None:
@@ -377,12 +419,21 @@ def part_erase(_ctx: click.Context, s: Session, part_uuid: uuid.UUID) -> None:
     shell_complete=_get_part_completion_helper(filt_write=True),
     required=True,
 )
+@click.option(
+    "delta",
+    "--delta",
+    is_flag=True,
+    default=False,
+    help="Only transfer chunks that differ from the current partition contents",
+)
 @pb_session
 @click.pass_context
-def part_write(_ctx: click.Context, s: Session, part_uuid: uuid.UUID, file: pathlib.Path) -> None:
+def part_write(
+    _ctx: click.Context, s: Session, part_uuid: uuid.UUID, file: pathlib.Path, delta: bool
+) -> None:
     """Write data to a partiton."""
     logger.debug("Writing %s to partition %s...", file, part_uuid)
-    s.part_write(file, part_uuid)
+    s.part_write(file, part_uuid, delta)
 
 
 @part.command("read")
@@ -408,12 +459,22 @@ def part_read(_ctx: click.Context, s: Session, file: pathlib.Path, part_uuid: uu
     shell_complete=_get_part_completion_helper(),
     required=True,
 )
+@click.option(
+    "digest",
+    "--digest",
+    type=click.Choice(["auto", "sha256", "sha512", "blake3"]),
+    default="auto",
+    help="Digest algorithm, 'auto' uses the fastest one on the device",
+)
 @pb_session
 @click.pass_context
-def part_verify(_ctx: click.Context, s: Session, part_uuid: uuid.UUID, file: pathlib.Path) -> None:
+def part_verify(
+    _ctx: click.Context, s: Session, part_uuid: uuid.UUID, file: pathlib.Path, digest: str
+) -> None:
     """Verify the contents of a partition."""
+    digest_alg = None if digest == "auto" else DigestAlg[digest.upper()]
     logger.debug("Verifying %s against contents of partition %s...", file, part_uuid)
-    s.part_verify(file, part_uuid)
+    s.part_verify(file, part_uuid, digest_alg)
 
 
 @cli.group()
@@ -649,6 +710,54 @@ def slc_revoke_key(_ctx: click.Context, s: Session, key_id: str, force: bool) ->
         s.slc_revoke_key(revoke_key_id)
 
 
+def _load_manifest(_ctx: click.Context, _param: click.Parameter, value: pathlib.Path) -> Manifest:
+    try:
+        return Manifest.load(value)
+    except ManifestError as e:
+        raise click.BadParameter(str(e)) from e
+
+
+@cli.command("provision")
+@click.argument(
+    "manifest",
+    type=click.Path(exists=True, dir_okay=False, path_type=pathlib.Path),
+    callback=_load_manifest,
+)
+@click.option(
+    "--report",
+    type=click.Path(dir_okay=False, writable=True, path_type=pathlib.Path),
+    help="Write the step timings to a JSON file",
+)
+@pb_session
+@click.pass_context
+def provision(
+    ctx: click.Context, s: Session, manifest: Manifest, report: pathlib.Path | None
+) -> None:
+    """Execute a provisioning manifest in one session.
+
+    The manifest is a JSON file with a list of steps, see 'punchboot.provision'
+    for the format. SLC steps are executed without confirmation.
+    """
+    sessions = [s]
+
+    def _connect(device_uuid: uuid.UUID | None) -> Session:
+        if sessions:
+            return sessions.pop()
+        if ctx.obj["transport"] == "socket":
+            return Session(socket_path=ctx.obj["socket"])
+        return Session(device_uuid=device_uuid or ctx.obj["device-uuid"])
+
+    def _report_step(t: StepTiming) -> None:
+        rate = f"{t.mib_per_s:8.2f} MiB/s" if t.length else ""
+        click.echo(f"[{t.step.index:>3}] {t.step.describe():<56} {t.seconds:8.3f} s {rate}")
+
+    timings = Provisioner(_connect, _report_step).run(manifest)
+    click.echo(f"{len(timings)} steps in {sum(t.seconds for t in timings):.3f} s")
+
+    if report is not None:
+        report.write_text(json.dumps([t.to_dict() for t in timings], indent=4) + "\n")
+
+
 @cli.command("completion")
 @click.pass_context
 def shell_completion_helper(_ctx: click.Context) -> None:
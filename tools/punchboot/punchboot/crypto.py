@@ -0,0 +1,83 @@
+"""Punchboot crypto provider class."""
+
+from __future__ import annotations
+
+from dataclasses import dataclass
+from enum import Flag, IntEnum
+
+
+class DigestAlg(IntEnum):
+    """Digest algorithms for partition verification.
+
+    SHA256 is supported by all devices. Devices report the other algorithms
+    and which one is the fastest, see 'Session.part_verify_digests'.
+    """
+
+    SHA256 = 0
+    SHA512 = 1
+    BLAKE3 = 2
+
+
+class CryptoProviderFlags(Flag):
+    """Crypto provider flags.
+
+    Flags:
+
+    FLAG_DSA: Signature provider, otherwise a hash provider
+    FLAG_SMALL: Provider is used for small inputs
+    FLAG_LARGE: Provider is used for large inputs
+    FLAG_CALIBRATED: The costs have been measured on the device
+    """
+
+    FLAG_DSA = 1 << 0
+    FLAG_SMALL = 1 << 1
+    FLAG_LARGE = 1 << 2
+    FLAG_CALIBRATED = 1 << 3
+
+
+@dataclass(frozen=True)
+class CryptoProvider:
+    """One algorithm of a crypto provider on the device.
+
+    Parameters
+    ----------
+    name:
+        Name of the provider
+    alg:
+        Name of the algorithm
+    flags:
+        Flags for the provider
+    priority:
+        Build time priority, higher is preferred
+    setup_ns:
+        Measured cost of one hash job in ns
+    ns_per_kib:
+        Measured cost of one KiB of input in ns
+    """
+
+    name: str
+    alg: str
+    flags: CryptoProviderFlags
+    priority: int
+    setup_ns: int
+    ns_per_kib: int
+
+    @property
+    def dsa(self) -> bool:
+        """Get if this is a signature provider."""
+        return CryptoProviderFlags.FLAG_DSA in self.flags
+
+    @property
+    def calibrated(self) -> bool:
+        """Get if the costs have been measured."""
+        return CryptoProviderFlags.FLAG_CALIBRATED in self.flags
+
+    @property
+    def selected_small(self) -> bool:
+        """Get if the provider is used for small inputs."""
+        return CryptoProviderFlags.FLAG_SMALL in self.flags
+
+    @property
+    def selected_large(self) -> bool:
+        """Get if the provider is used for large inputs."""
+        return CryptoProviderFlags.FLAG_LARGE in self.flags
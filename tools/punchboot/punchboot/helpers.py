@@ -10,6 +10,7 @@ import _punchboot  # type: ignore[import-not-found]
 import semver  # type: ignore[import-not-found]
 
 if TYPE_CHECKING:
+    import pathlib
     from collections.abc import Sequence
 
 
@@ -298,13 +299,31 @@ def pb_id(cmd: str) -> int:
     return value
 
 
-def wait_for_device(timeout: int = -1) -> None:
+def wait_for_device(
+    timeout: int = -1,
+    device_uuid: uuid.UUID | str | None = None,
+    socket_path: pathlib.Path | str | None = None,
+) -> None:
     """Wait for a punchboot device to enumerate.
 
+    USB devices are tracked with libusb hotplug events where available, so
+    this returns as soon as the device is attached.
+
     Keyword arguments:
-    timeout -- Timeout in seconds
+    timeout     -- Timeout in seconds, zero or negative only checks the
+                   attached devices
+    device_uuid -- Optional UUID of a specific device
+    socket_path -- Optional path to a domain socket, polled until the device
+                   answers
+
+    Exceptions:
+    TimeoutError -- No device was found
     """
-    _punchboot.wait_for_device(timeout)
+    _punchboot.wait_for_device(
+        timeout,
+        str(device_uuid) if device_uuid is not None else None,
+        str(socket_path) if socket_path is not None else None,
+    )
 
 
 def list_usb_devices() -> Sequence[uuid.UUID]:
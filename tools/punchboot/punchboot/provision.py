@@ -0,0 +1,449 @@
+"""Manifest driven provisioning.
+
+A manifest is a JSON file with a list of steps that are executed in order
+in one session:
+
+    {
+        "steps": [
+            {"op": "auth token", "token": "device.token", "key-id": "pb-development"},
+            {"op": "part install", "part": "1eacedf3-3790-48c7-8ed8-9188ff49672b"},
+            {"op": "dev reset"},
+            {"op": "part write", "file": "rootfs.bpak", "part": "2af755d8-..."},
+            {"op": "part verify", "file": "rootfs.bpak", "part": "2af755d8-..."},
+            {"op": "boot enable", "part": "2af755d8-..."}
+        ]
+    }
+
+The operations and their arguments follow the CLI commands:
+
+    auth password   password
+    auth token      token, key-id
+    part install    part, variant (0)
+    part erase      part
+    part write      file, part, delta (false)
+    part verify     file, part, digest ("auto", "sha256", "sha512" or "blake3")
+    boot enable     part
+    boot disable
+    slc configure
+    slc lock
+    slc eol
+    slc revoke-key  key-id
+    dev reset       timeout (30), seconds to wait for the device to come back
+
+File paths are relative to the manifest. Authentication, the device
+capabilities and the partition table are reused between the steps. While a
+step runs, the file of the next 'part write' or 'part verify' step is read,
+and hashed for 'part verify', in the background.
+
+The device only picks up a newly installed partition table after a reset,
+so 'part install' is normally followed by 'dev reset'. After a reset the
+session reconnects to the same device and repeats the last authentication
+step.
+"""
+
+from __future__ import annotations
+
+import json
+import pathlib
+import time
+import uuid
+from concurrent.futures import Future, ThreadPoolExecutor
+from dataclasses import dataclass, field
+from typing import TYPE_CHECKING, Any
+
+import _punchboot  # type: ignore[import-not-found]
+
+from .crypto import DigestAlg
+from .session import FileDigest, Session, file_digest
+
+if TYPE_CHECKING:
+    from collections.abc import Callable, Sequence
+
+# Operation -> (required arguments, optional arguments with defaults)
+_OPS: dict[str, tuple[tuple[str, ...], dict[str, Any]]] = {
+    "auth password": (("password",), {}),
+    "auth token": (("token", "key-id"), {}),
+    "part install": (("part",), {"variant": 0}),
+    "part erase": (("part",), {}),
+    "part write": (("file", "part"), {"delta": False}),
+    "part verify": (("file", "part"), {"digest": "auto"}),
+    "boot enable": (("part",), {}),
+    "boot disable": ((), {}),
+    "slc configure": ((), {}),
+    "slc lock": ((), {}),
+    "slc eol": ((), {}),
+    "slc revoke-key": (("key-id",), {}),
+    "dev reset": ((), {"timeout": 30}),
+}
+
+_FILE_ARGS = ("file", "token")
+_DIGESTS = ("auto", "sha256", "sha512", "blake3")
+
+# Seconds between connection attempts after a reset
+_RECONNECT_INTERVAL = 0.5
+
+# Size of the reads that bring a file into the page cache
+_PREFETCH_CHUNK = 1024 * 1024
+
+
+class ManifestError(ValueError):
+    """The manifest is invalid."""
+
+
+@dataclass(frozen=True)
+class Step:
+    """One step of a manifest.
+
+    Parameters
+    ----------
+    index:
+        Position in the manifest, starting at 1
+    op:
+        Operation, for example 'part write'
+    args:
+        Arguments, including the defaults of the optional ones
+    """
+
+    index: int
+    op: str
+    args: dict[str, Any] = field(default_factory=dict)
+
+    @property
+    def file(self) -> pathlib.Path | None:
+        """Get the file that is transferred or verified, if any."""
+        if self.op in ("part write", "part verify"):
+            return pathlib.Path(self.args["file"])
+        return None
+
+    def describe(self) -> str:
+        """Get a short description for reports."""
+        if self.file is not None:
+            return f"{self.op} {self.file.name}"
+        if "part" in self.args:
+            return f"{self.op} {self.args['part']}"
+        return self.op
+
+
+@dataclass(frozen=True)
+class StepTiming:
+    """Timing of one executed step.
+
+    Parameters
+    ----------
+    step:
+        The step
+    seconds:
+        Time spent in the step, including waiting for its prefetched file
+    wait_seconds:
+        Time spent waiting for the background read of the file
+    length:
+        Bytes in the file of the step, zero for steps without a file
+    """
+
+    step: Step
+    seconds: float
+    wait_seconds: float
+    length: int
+
+    @property
+    def mib_per_s(self) -> float:
+        """Get the throughput in MiB/s, zero for steps without a file."""
+        if self.length == 0 or self.seconds <= 0:
+            return 0.0
+        return self.length / self.seconds / (1024 * 1024)
+
+    def to_dict(self) -> dict[str, Any]:
+        """Get the timing as a dictionary, for JSON reports."""
+        return {
+            "index": self.step.index,
+            "op": self.step.op,
+            "description": self.step.describe(),
+            "seconds": round(self.seconds, 6),
+            "wait_seconds": round(self.wait_seconds, 6),
+            "bytes": self.length,
+            "mib_per_s": round(self.mib_per_s, 3),
+        }
+
+
+def _parse_uuid(step_index: int, name: str, value: Any) -> str:  # noqa: ANN401
+    try:
+        return str(uuid.UUID(str(value)))
+    except ValueError:
+        msg = f"Step {step_index}: '{name}' is not a UUID: {value}"
+        raise ManifestError(msg) from None
+
+
+def _parse_args(index: int, op: str, entry: dict[str, Any]) -> dict[str, Any]:
+    required, optional = _OPS[op]
+    args: dict[str, Any] = dict(optional)
+
+    for name, value in entry.items():
+        if name == "op":
+            continue
+        if name not in required and name not in optional:
+            msg = f"Step {index}: unknown argument '{name}' for '{op}'"
+            raise ManifestError(msg)
+        args[name] = value
+
+    for name in required:
+        if name not in args:
+            msg = f"Step {index}: '{op}' needs '{name}'"
+            raise ManifestError(msg)
+
+    return args
+
+
+def _parse_step(index: int, entry: Any, base: pathlib.Path) -> Step:  # noqa: ANN401
+    if not isinstance(entry, dict) or entry.get("op") not in _OPS:
+        msg = f"Step {index}: expected an object with one of the operations as 'op'"
+        raise ManifestError(msg)
+
+    args = _parse_args(index, entry["op"], entry)
+
+    if "part" in args:
+        args["part"] = _parse_uuid(index, "part", args["part"])
+
+    if args.get("digest", "auto") not in _DIGESTS:
+        msg = f"Step {index}: digest must be one of {', '.join(_DIGESTS)}"
+        raise ManifestError(msg)
+
+    for name in _FILE_ARGS:
+        if name in args:
+            path = base / str(args[name])
+            if not path.is_file():
+                msg = f"Step {index}: no such file '{path}'"
+                raise ManifestError(msg)
+            args[name] = str(path)
+
+    return Step(index, entry["op"], args)
+
+
+@dataclass(frozen=True)
+class Manifest:
+    """A provisioning plan.
+
+    Parameters
+    ----------
+    steps:
+        Steps in execution order
+    """
+
+    steps: Sequence[Step]
+
+    @classmethod
+    def load(cls, path: pathlib.Path) -> Manifest:
+        """Read and validate a manifest file.
+
+        All files that the manifest refers to must exist, so that a run does
+        not stop half way because of a typo.
+
+        Exceptions:
+        ManifestError -- The manifest is invalid
+        """
+        try:
+            data = json.loads(path.read_text())
+        except json.JSONDecodeError as e:
+            msg = f"{path}: {e}"
+            raise ManifestError(msg) from None
+
+        if not isinstance(data, dict) or not isinstance(data.get("steps"), list):
+            msg = f"{path}: expected an object with a list of 'steps'"
+            raise ManifestError(msg)
+
+        base = path.resolve().parent
+        return cls(tuple(_parse_step(i + 1, e, base) for i, e in enumerate(data["steps"])))
+
+
+def _read_through(path: pathlib.Path) -> None:
+    """Read a file so that the transfer finds it in the page cache."""
+    with path.open("rb") as f:
+        while f.read(_PREFETCH_CHUNK):
+            pass
+
+
+class Provisioner:
+    """Executes a manifest in one session.
+
+    Keyword arguments:
+    connect  -- Opens a session. Called with None at the start and with the
+                device UUID after each 'dev reset' that is followed by more
+                steps.
+    report   -- Optional callback that is called after every step
+    """
+
+    def __init__(
+        self,
+        connect: Callable[[uuid.UUID | None], Session],
+        report: Callable[[StepTiming], None] | None = None,
+    ) -> None:
+        """Initialize the provisioner."""
+        self._connect = connect
+        self._report = report
+        self._session: Session | None = None
+        self._auth: Step | None = None
+        self._preferred_digest: DigestAlg | None = None
+        self._auto_digest = False
+
+    @property
+    def session(self) -> Session:
+        """Get the current session, connecting if needed."""
+        if self._session is None:
+            self._session = self._connect(None)
+        return self._session
+
+    def _digest_alg(self, step: Step, query: bool = True) -> DigestAlg | None:
+        """Get the digest of a verify step.
+
+        'auto' is resolved by asking the device once. Without 'query' the
+        result is None until then, the capabilities may need authentication.
+        """
+        digest: str = step.args["digest"]
+
+        if digest != "auto":
+            return DigestAlg[digest.upper()]
+
+        if self._preferred_digest is None and query:
+            self._preferred_digest = self.session.part_verify_digests()[1]
+
+        return self._preferred_digest
+
+    def _prefetch(self, pool: ThreadPoolExecutor, step: Step) -> Future[Any]:
+        file = step.file
+        assert file is not None  # noqa: S101
+
+        digest_alg = self._digest_alg(step, query=False) if step.op == "part verify" else None
+
+        if digest_alg is not None:
+            return pool.submit(file_digest, file, digest_alg)
+
+        return pool.submit(_read_through, file)
+
+    def _verify(self, step: Step, prefetched: FileDigest | None) -> None:
+        digest_alg = self._digest_alg(step)
+        assert digest_alg is not None  # noqa: S101
+
+        if prefetched is None or prefetched.digest_alg != digest_alg:
+            prefetched = file_digest(pathlib.Path(step.args["file"]), digest_alg)
+
+        self.session.part_verify(prefetched, step.args["part"])
+
+    def _authenticate(self, step: Step) -> None:
+        if step.op == "auth password":
+            self.session.authenticate(step.args["password"])
+        else:
+            self.session.authenticate_dsa_token(
+                pathlib.Path(step.args["token"]), step.args["key-id"]
+            )
+
+        self._auth = step
+
+        # Resolve 'auto' now, so that the next verify file is hashed in the
+        # background
+        if self._auto_digest and self._preferred_digest is None:
+            self._preferred_digest = self.session.part_verify_digests()[1]
+
+    def _reset(self, step: Step, last: bool) -> None:
+        device_uuid = self.session.device_get_uuid() if not last else None
+        self.session.device_reset()
+        self.session.close()
+        self._session = None
+
+        if last:
+            return
+
+        deadline = time.monotonic() + float(step.args["timeout"])
+
+        while True:
+            try:
+                self._session = self._connect(device_uuid)
+                if self._session.device_get_uuid() != device_uuid:
+                    self._session.close()
+                    self._session = None
+                    raise _punchboot.NotFoundError
+                break
+            except _punchboot.Error:
+                if time.monotonic() > deadline:
+                    raise
+                time.sleep(_RECONNECT_INTERVAL)
+
+        if self._auth is not None:
+            self._authenticate(self._auth)
+
+    def _execute(self, step: Step, prefetched: FileDigest | None, last: bool) -> None:
+        s = self.session
+        args = step.args
+        ops: dict[str, Callable[[], None]] = {
+            "auth password": lambda: self._authenticate(step),
+            "auth token": lambda: self._authenticate(step),
+            "part install": lambda: s.part_table_install(args["part"], int(args["variant"])),
+            "part erase": lambda: s.part_erase(args["part"]),
+            "part write": lambda: s.part_write(
+                pathlib.Path(args["file"]), args["part"], bool(args["delta"])
+            ),
+            "part verify": lambda: self._verify(step, prefetched),
+            "boot enable": lambda: s.boot_set_boot_part(args["part"]),
+            "boot disable": lambda: s.boot_set_boot_part(uuid.UUID(bytes=b"\x00" * 16)),
+            "slc configure": s.slc_set_configuration,
+            "slc lock": s.slc_set_configuration_lock,
+            "slc eol": s.slc_set_end_of_life,
+            "slc revoke-key": lambda: s.slc_revoke_key(args["key-id"]),
+            "dev reset": lambda: self._reset(step, last),
+        }
+
+        ops[step.op]()
+
+    def run(self, manifest: Manifest) -> list[StepTiming]:
+        """Execute all steps of a manifest.
+
+        Stops at the first step that fails and raises its exception. The
+        session is closed when the run ends.
+
+        Returns the timing of every step.
+        """
+        timings: list[StepTiming] = []
+        steps = manifest.steps
+        file_steps = [i for i, step in enumerate(steps) if step.file is not None]
+        pending: dict[int, Future[Any]] = {}
+        self._auto_digest = any(
+            step.op == "part verify" and step.args["digest"] == "auto" for step in steps
+        )
+
+        with ThreadPoolExecutor(max_workers=1, thread_name_prefix="pb-prefetch") as pool:
+            try:
+                for i, step in enumerate(steps):
+                    start = time.monotonic()
+                    prefetched: FileDigest | None = None  # None for write steps
+                    wait_seconds = 0.0
+
+                    if step.file is not None:
+                        future = pending.pop(i, None) or self._prefetch(pool, step)
+                        prefetched = future.result()
+                        wait_seconds = time.monotonic() - start
+
+                    # Read, or read and hash, the next file while this step
+                    # talks to the device
+                    next_file = next((k for k in file_steps if k > i), None)
+                    if next_file is not None and next_file not in pending:
+                        pending[next_file] = self._prefetch(pool, steps[next_file])
+
+                    self._execute(step, prefetched, last=(i == len(steps) - 1))
+
+                    timing = StepTiming(
+                        step,
+                        time.monotonic() - start,
+                        wait_seconds,
+                        step.file.stat().st_size if step.file is not None else 0,
+                    )
+                    timings.append(timing)
+
+                    if self._report is not None:
+                        self._report(timing)
+            finally:
+                for future in pending.values():
+                    future.cancel()
+
+                if self._session is not None:
+                    self._session.close()
+                    self._session = None
+
+        return timings
@@ -10,11 +10,13 @@ import io
 import pathlib
 import uuid
 from collections.abc import Callable
+from dataclasses import dataclass
 from typing import IO, TYPE_CHECKING, Union
 
 import _punchboot  # type: ignore[import-not-found]
 import semver  # type: ignore[import-not-found]
 
+from .crypto import CryptoProvider, CryptoProviderFlags, DigestAlg
 from .helpers import pb_id, valid_bpak_magic
 from .partition import Partition, PartitionFlags
 from .slc import SLC
@@ -45,6 +47,81 @@ def _partuuid_to_uuid(uu: PartUUIDType) -> uuid.UUID:
     return uu
 
 
+@dataclass(frozen=True)
+class FileDigest:
+    """Digest of a file, computed ahead of 'Session.part_verify'.
+
+    Parameters
+    ----------
+    digest_alg:
+        Digest algorithm
+    digest:
+        Digest of the file contents
+    length:
+        Length of the file in bytes
+    bpak:
+        The file starts with a BPAK header
+    """
+
+    digest_alg: DigestAlg
+    digest: bytes
+    length: int
+    bpak: bool
+
+
+def file_digest(file: pathlib.Path | IO[bytes] | bytes, digest_alg: DigestAlg) -> FileDigest:
+    """Hash a file for partition verification.
+
+    This does not talk to the device and can run in another thread while a
+    transfer is in progress.
+
+    Keyword arguments:
+    file       -- The file as a pathlib Path, BufferedReader or a bytes array
+    digest_alg -- Digest algorithm
+    """
+    data_length: int
+    chunk_len: int = 1024 * 1024
+    bpak_header_len: int = 4096
+    bpak_header_valid: bool = False
+
+    if digest_alg == DigestAlg.BLAKE3:
+        hash_ctx = _punchboot.Blake3()
+    elif digest_alg == DigestAlg.SHA512:
+        hash_ctx = hashlib.sha512()
+    else:
+        hash_ctx = hashlib.sha256()
+
+    def _chunk_reader(fh: IO[bytes]) -> int:
+        length: int = 0
+        nonlocal bpak_header_valid
+        # Check if the first 4k contains a valid BPAK header
+        if chunk := fh.read(bpak_header_len):
+            hash_ctx.update(chunk)
+            length += len(chunk)
+            bpak_header_valid = valid_bpak_magic(chunk)
+        # Read the rest
+        while chunk := fh.read(chunk_len):
+            hash_ctx.update(chunk)
+            length += len(chunk)
+
+        return length
+
+    if isinstance(file, pathlib.Path):
+        with file.open("rb") as f:
+            data_length = _chunk_reader(f)
+    elif isinstance(file, bytes):
+        hash_ctx.update(file)
+        bpak_header_valid = valid_bpak_magic(file)
+        data_length = len(file)
+    elif _has_fileno(file):
+        data_length = _chunk_reader(file)
+    else:
+        msg = "File is not a supported type"
+        raise TypeError(msg)
+
+    return FileDigest(digest_alg, hash_ctx.digest(), data_length, bpak_header_valid)
+
+
 class Session:
     """Punchboot session class.
 
@@ -135,70 +212,71 @@ class Session:
             for p in self.pb_s.part_get_partitions()
         ]
 
-    def part_verify(self, file: pathlib.Path | IO[bytes] | bytes, part: PartUUIDType) -> None:
+    def part_verify_digests(self) -> tuple[list[DigestAlg], DigestAlg]:
+        """Get the digest algorithms that the device can verify partitions with.
+
+        Returns a tuple of the supported algorithms and the fastest one.
+        Devices that do not report any algorithms only support SHA256.
+        """
+        algs_mask, preferred = self.pb_s.part_verify_digests()
+        algs = [alg for alg in DigestAlg if algs_mask & (1 << alg)]
+
+        if not algs:
+            return ([DigestAlg.SHA256], DigestAlg.SHA256)
+
+        if preferred not in algs:
+            preferred = DigestAlg.SHA256
+
+        return (algs, DigestAlg(preferred))
+
+    def part_verify(
+        self,
+        file: pathlib.Path | IO[bytes] | bytes | FileDigest,
+        part: PartUUIDType,
+        digest_alg: DigestAlg | None = None,
+    ) -> None:
         """Verify the contents of a partition.
 
         Keyword arguments:
-        part -- The partition UUID either as a UUID object or a string representation
-        file -- The file to verify as a pathlib Path, BufferedReader or a bytes array
+        part       -- The partition UUID either as a UUID object or a string representation
+        file       -- The file to verify as a pathlib Path, BufferedReader or a bytes array,
+                      or a digest from 'file_digest'
+        digest_alg -- Digest algorithm, by default the fastest one on the device. Not used
+                      when 'file' is a digest.
 
         Exceptions:
         PartVerifyError       -- The file contents does not match the partition
         NotFoundError         -- Partition was not found
         NotAuthenticatedError -- Authentication required
+        NotSupportedError     -- The device does not support 'digest_alg'
 
         On success this function returns nothing.
         """
         uu: uuid.UUID = _partuuid_to_uuid(part)
-        data_length: int
-        chunk_len: int = 1024 * 1024
-        bpak_header_len: int = 4096
-        bpak_header_valid: bool = False
-        hash_ctx = hashlib.sha256()
-
-        def _chunk_reader(fh: IO[bytes]) -> int:
-            length: int = 0
-            nonlocal bpak_header_valid
-            # Check if the first 4k contains a valid BPAK header
-            if chunk := fh.read(bpak_header_len):
-                hash_ctx.update(chunk)
-                length += len(chunk)
-                bpak_header_valid = valid_bpak_magic(chunk)
-            # Read the rest
-            while chunk := fh.read(chunk_len):
-                hash_ctx.update(chunk)
-                length += len(chunk)
-
-            return length
 
-        if isinstance(file, pathlib.Path):
-            with file.open("rb") as f:
-                data_length = _chunk_reader(f)
-        elif isinstance(file, bytes):
-            hash_ctx.update(file)
-            bpak_header_valid = valid_bpak_magic(file)
-            data_length = len(file)
-        elif _has_fileno(file):
-            data_length = _chunk_reader(file)
-        else:
-            msg = "File is not a supported type"
-            raise TypeError(msg)
+        if not isinstance(file, FileDigest):
+            if digest_alg is None:
+                digest_alg = self.part_verify_digests()[1]
+            file = file_digest(file, digest_alg)
 
-        self.pb_s.part_verify(uu.bytes, hash_ctx.digest(), data_length, bpak_header_valid)
+        self.pb_s.part_verify(uu.bytes, file.digest, file.length, file.bpak, int(file.digest_alg))
 
-    def part_write(self, file: pathlib.Path | IO[bytes], part: PartUUIDType) -> None:
+    def part_write(
+        self, file: pathlib.Path | IO[bytes], part: PartUUIDType, delta: bool = False
+    ) -> None:
         """Write data to a partition.
 
         Keyword arguments:
             file  -- Path or BufferedReader to write
             part  -- UUID of target partition
+            delta -- Only transfer chunks that differ from the partition contents
         """
         uu: uuid.UUID = _partuuid_to_uuid(part)
         if isinstance(file, pathlib.Path):
             with file.open("rb") as f:
-                self.pb_s.part_write(f, uu.bytes)
+                self.pb_s.part_write(f, uu.bytes, delta)
         elif _has_fileno(file):
-            self.pb_s.part_write(file, uu.bytes)
+            self.pb_s.part_write(file, uu.bytes, delta)
         else:
             msg = "File is not a supported type"
             raise TypeError(msg)
@@ -377,6 +455,17 @@ class Session:
         """Read the device's board name."""
         return str(self.pb_s.device_get_boardname())
 
+    def device_get_crypto_providers(self) -> Sequence[CryptoProvider]:
+        """Get a list of 'CryptoProvider' objects.
+
+        There is one entry for every algorithm of every provider, the flags
+        tell which provider is used for small and for large inputs.
+        """
+        return [
+            CryptoProvider(p[0], p[1], CryptoProviderFlags(p[2]), p[3], p[4], p[5])
+            for p in self.pb_s.device_get_crypto_providers()
+        ]
+
     def board_run_command(self, cmd: str | int, args: bytes = b"") -> bytes:
         """Execute a board specific command.
 
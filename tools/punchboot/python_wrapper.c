@@ -5,12 +5,14 @@
 #include "api.h"
 #include "socket.h"
 #include "usb.h"
+#include <blake3/blake3.h>
 #include <pb-tools/compat.h>
 #include <pb-tools/error.h>
 #include <pb-tools/wire.h>
 #include <Python.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 
 #ifdef _MSC_VER
 #include <windows.h>
@@ -22,19 +24,24 @@
 #error "Only python3 supported"
 #endif
 
+/* Transfers run without the GIL, so the GIL is taken here */
 static int log_cb(struct pb_context *ctx, int level, const char *fmt, ...)
 {
     static PyObject *logger = NULL;
     static PyObject *log_msg = NULL;
     char msg_buf[1024];
+    PyGILState_STATE gil_state;
     int rc;
     (void)ctx;
     (void)level;
 
+    gil_state = PyGILState_Ensure();
+
     if (logger == NULL) {
         PyObject *logging = PyImport_ImportModuleNoBlock("logging");
         if (logging == NULL) {
             PyErr_SetString(PyExc_ImportError, "Could not import module 'logging'");
+            PyGILState_Release(gil_state);
             return -1;
         }
 
@@ -42,6 +49,7 @@ static int log_cb(struct pb_context *ctx, int level, const char *fmt, ...)
 
         if (logger == NULL) {
             PyErr_SetString(PyExc_RuntimeError, "Can't configure logger");
+            PyGILState_Release(gil_state);
             return -1;
         }
     }
@@ -61,6 +69,7 @@ static int log_cb(struct pb_context *ctx, int level, const char *fmt, ...)
     }
     va_end(args);
 
+    PyGILState_Release(gil_state);
     return 0;
 }
 
@@ -321,6 +330,52 @@ static PyObject *device_get_boardname(PyObject *self, PyObject *Py_UNUSED(args))
     return Py_BuildValue("s", board_name);
 }
 
+static PyObject *device_get_crypto_providers(PyObject *self, PyObject *Py_UNUSED(args))
+{
+    struct pb_session *session = (struct pb_session *)self;
+    struct pb_crypto_provider providers[64];
+    int entries = sizeof(providers) / sizeof(providers[0]);
+    PyObject *provider_list = NULL;
+    int rc;
+
+    if (validate_pb_session(session) != 0) {
+        return NULL;
+    }
+
+    rc = pb_api_device_read_crypto_providers(session->ctx, providers, &entries);
+    if (rc != PB_RESULT_OK) {
+        return pb_exception_from_rc(rc);
+    }
+
+    provider_list = PyList_New(entries);
+
+    if (!provider_list) {
+        return PyErr_NoMemory();
+    }
+
+    for (int i = 0; i < entries; i++) {
+        struct pb_crypto_provider *p = &providers[i];
+
+        p->name[sizeof(p->name) - 1] = 0;
+        p->alg[sizeof(p->alg) - 1] = 0;
+
+        PyObject *provider_tpl = PyTuple_New(6);
+        PyTuple_SetItem(provider_tpl, 0, Py_BuildValue("s", p->name));
+        PyTuple_SetItem(provider_tpl, 1, Py_BuildValue("s", p->alg));
+        PyTuple_SetItem(provider_tpl, 2, Py_BuildValue("I", p->flags));
+        PyTuple_SetItem(provider_tpl, 3, Py_BuildValue("i", p->priority));
+        PyTuple_SetItem(provider_tpl, 4, Py_BuildValue("I", p->setup_ns));
+        PyTuple_SetItem(provider_tpl, 5, Py_BuildValue("I", p->ns_per_kib));
+
+        if (PyList_SetItem(provider_list, i, provider_tpl) != 0) {
+            Py_CLEAR(provider_list);
+            return NULL;
+        }
+    }
+
+    return provider_list;
+}
+
 static PyObject *slc_set_configuration(PyObject *self, PyObject *Py_UNUSED(args))
 {
     struct pb_session *session = (struct pb_session *)self;
@@ -532,8 +587,8 @@ static PyObject *part_get_partitions(PyObject *self, PyObject *Py_UNUSED(args))
         PyObject *part_tpl = PyTuple_New(6);
         PyTuple_SetItem(part_tpl, 0, Py_BuildValue("y#", tbl[i].uuid, 16));
         PyTuple_SetItem(part_tpl, 1, Py_BuildValue("s", tbl[i].description));
-        PyTuple_SetItem(part_tpl, 2, Py_BuildValue("i", tbl[i].first_block));
-        PyTuple_SetItem(part_tpl, 3, Py_BuildValue("i", tbl[i].last_block));
+        PyTuple_SetItem(part_tpl, 2, Py_BuildValue("K", (unsigned long long)tbl[i].first_block));
+        PyTuple_SetItem(part_tpl, 3, Py_BuildValue("K", (unsigned long long)tbl[i].last_block));
         PyTuple_SetItem(part_tpl, 4, Py_BuildValue("i", tbl[i].block_size));
         PyTuple_SetItem(part_tpl, 5, Py_BuildValue("i", tbl[i].flags));
 
@@ -579,14 +634,16 @@ static PyObject *part_table_install(PyObject *self, PyObject *args, PyObject *kw
 static PyObject *part_write(PyObject *self, PyObject *args, PyObject *kwds)
 {
     struct pb_session *session = (struct pb_session *)self;
-    static char *kwlist[] = { "file", "uuid", NULL };
+    static char *kwlist[] = { "file", "uuid", "delta", NULL };
     PyObject *file = NULL;
     int file_fd = -1;
     uint8_t *part_uu = NULL;
     size_t part_uu_len = 0;
+    int delta = 0;
     int rc;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "Oy#", kwlist, &file, &part_uu, &part_uu_len)) {
+    if (!PyArg_ParseTupleAndKeywords(
+            args, kwds, "Oy#|p", kwlist, &file, &part_uu, &part_uu_len, &delta)) {
         return NULL;
     }
 
@@ -600,7 +657,12 @@ static PyObject *part_write(PyObject *self, PyObject *args, PyObject *kwds)
         return NULL;
     }
 
-    rc = pb_api_partition_write(session->ctx, file_fd, part_uu);
+    Py_BEGIN_ALLOW_THREADS
+    if (delta)
+        rc = pb_api_partition_write_delta(session->ctx, file_fd, part_uu);
+    else
+        rc = pb_api_partition_write(session->ctx, file_fd, part_uu);
+    Py_END_ALLOW_THREADS
 
     if (rc != 0) {
         return pb_exception_from_rc(rc);
@@ -633,7 +695,9 @@ static PyObject *part_read(PyObject *self, PyObject *args, PyObject *kwds)
         return NULL;
     }
 
+    Py_BEGIN_ALLOW_THREADS
     rc = pb_api_partition_read(session->ctx, file_fd, part_uu);
+    Py_END_ALLOW_THREADS
 
     if (rc != 0) {
         return pb_exception_from_rc(rc);
@@ -648,12 +712,12 @@ static PyObject *part_erase(PyObject *self, PyObject *args, PyObject *kwds)
     static char *kwlist[] = { "uuid", "start_lba", "count", NULL };
     uint8_t *part_uu = NULL;
     size_t part_uu_len = 0;
-    unsigned int start_lba = 0;
-    unsigned int block_count = 0;
+    unsigned long long start_lba = 0;
+    unsigned long long block_count = 0;
     int rc;
 
     if (!PyArg_ParseTupleAndKeywords(
-            args, kwds, "y#II", kwlist, &part_uu, &part_uu_len, &start_lba, &block_count)) {
+            args, kwds, "y#KK", kwlist, &part_uu, &part_uu_len, &start_lba, &block_count)) {
         return NULL;
     }
 
@@ -673,25 +737,27 @@ static PyObject *part_erase(PyObject *self, PyObject *args, PyObject *kwds)
 static PyObject *part_verify(PyObject *self, PyObject *args, PyObject *kwds)
 {
     struct pb_session *session = (struct pb_session *)self;
-    static char *kwlist[] = { "uuid", "sha256_digest", "data_length", "bpak", NULL };
+    static char *kwlist[] = { "uuid", "digest", "data_length", "bpak", "digest_alg", NULL };
     uint8_t *uu_part;
     size_t uu_part_len = 0;
-    uint8_t *sha256_digest = NULL;
-    size_t sha256_digest_len = 0;
+    uint8_t *digest = NULL;
+    size_t digest_len = 0;
     int bpak_file = 0;
-    unsigned int data_length = 0;
+    unsigned long long data_length = 0;
+    unsigned char digest_alg = PB_DIGEST_SHA256;
     int rc;
 
     if (!PyArg_ParseTupleAndKeywords(args,
                                      kwds,
-                                     "y#y#I|p",
+                                     "y#y#K|pb",
                                      kwlist,
                                      &uu_part,
                                      &uu_part_len,
-                                     &sha256_digest,
-                                     &sha256_digest_len,
+                                     &digest,
+                                     &digest_len,
                                      &data_length,
-                                     &bpak_file)) {
+                                     &bpak_file,
+                                     &digest_alg)) {
         return NULL;
     }
 
@@ -699,7 +765,10 @@ static PyObject *part_verify(PyObject *self, PyObject *args, PyObject *kwds)
         return NULL;
     }
 
-    rc = pb_api_partition_verify(session->ctx, uu_part, sha256_digest, data_length, bpak_file);
+    Py_BEGIN_ALLOW_THREADS
+    rc = pb_api_partition_verify(
+        session->ctx, uu_part, digest_alg, digest, digest_len, data_length, bpak_file);
+    Py_END_ALLOW_THREADS
 
     if (rc != PB_RESULT_OK) {
         return pb_exception_from_rc(rc);
@@ -708,6 +777,25 @@ static PyObject *part_verify(PyObject *self, PyObject *args, PyObject *kwds)
     Py_RETURN_NONE;
 }
 
+static PyObject *part_verify_digests(PyObject *self, PyObject *Py_UNUSED(args))
+{
+    struct pb_session *session = (struct pb_session *)self;
+    struct pb_device_capabilities caps;
+    int rc;
+
+    if (validate_pb_session(session) != 0) {
+        return NULL;
+    }
+
+    rc = pb_api_device_read_caps(session->ctx, &caps);
+
+    if (rc != PB_RESULT_OK) {
+        return pb_exception_from_rc(rc);
+    }
+
+    return Py_BuildValue("(ii)", caps.verify_digest_algs, caps.verify_digest_preferred);
+}
+
 static PyObject *boot_set_boot_part(PyObject *self, PyObject *args, PyObject *kwds)
 {
     struct pb_session *session = (struct pb_session *)self;
@@ -918,6 +1006,12 @@ static PyMethodDef PbSession_methods[] = {
         METH_NOARGS,
         "Shows device board name",
     },
+    {
+        "device_get_crypto_providers",
+        device_get_crypto_providers,
+        METH_NOARGS,
+        "Reads the crypto providers of the device and their measured costs",
+    },
     /* SLC API */
     {
         "slc_get_lifecycle",
@@ -992,6 +1086,12 @@ static PyMethodDef PbSession_methods[] = {
         METH_VARARGS | METH_KEYWORDS,
         "Verify that partition is flashed with specified file",
     },
+    {
+        "part_verify_digests",
+        part_verify_digests,
+        METH_NOARGS,
+        "Return the supported and the preferred verify digest algorithms",
+    },
     {
         "part_erase",
         (PyCFunction)(void (*)(void))part_erase,
@@ -1051,40 +1151,139 @@ static PyTypeObject PbSession = {
     .tp_methods = PbSession_methods,
 };
 
-static PyObject *wait_for_device(PyObject *self, PyObject *args, PyObject *kwds)
+struct pb_blake3 {
+    PyObject_HEAD struct blake3_hasher hasher;
+};
+
+static int PbBlake3_init(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    struct pb_blake3 *b3 = (struct pb_blake3 *)self;
+    static char *kwlist[] = { NULL };
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "", kwlist)) {
+        return -1;
+    }
+
+    blake3_hasher_init(&b3->hasher);
+    return 0;
+}
+
+static PyObject *blake3_update(PyObject *self, PyObject *args)
+{
+    struct pb_blake3 *b3 = (struct pb_blake3 *)self;
+    Py_buffer data;
+
+    if (!PyArg_ParseTuple(args, "y*", &data)) {
+        return NULL;
+    }
+
+    blake3_hasher_update(&b3->hasher, data.buf, data.len);
+    PyBuffer_Release(&data);
+    Py_RETURN_NONE;
+}
+
+static PyObject *blake3_digest(PyObject *self, PyObject *Py_UNUSED(args))
+{
+    struct pb_blake3 *b3 = (struct pb_blake3 *)self;
+    uint8_t digest[BLAKE3_OUT_LEN];
+
+    blake3_hasher_finalize(&b3->hasher, digest, sizeof(digest));
+    return PyBytes_FromStringAndSize((const char *)digest, sizeof(digest));
+}
+
+static PyMethodDef PbBlake3_methods[] = {
+    {
+        "update",
+        blake3_update,
+        METH_VARARGS,
+        "Add data to the hash",
+    },
+    {
+        "digest",
+        blake3_digest,
+        METH_NOARGS,
+        "Return the digest of the data so far",
+    },
+    { NULL },
+};
+
+static PyTypeObject PbBlake3 = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "punchboot.Blake3",
+    .tp_doc = PyDoc_STR("BLAKE3 hash, used for partition verification"),
+    .tp_basicsize = sizeof(struct pb_blake3),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)PbBlake3_init,
+    .tp_methods = PbBlake3_methods,
+};
+
+#ifdef __linux__
+/* Sockets have no hotplug events, poll until the device answers */
+static int wait_for_socket(const char *socket_path, int64_t timeout)
 {
-    static char *kwlist[] = { "timeout", NULL };
-    int64_t timeout = -1;
     struct pb_context *ctx;
+    struct timespec now;
     uint8_t uuid[16];
+    int64_t deadline_ms;
     int rc;
-    (void)self;
 
-    /* Allow passing None for args */
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|k", kwlist, &timeout)) {
-        return NULL;
-    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    deadline_ms = (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+    deadline_ms += (timeout > 0) ? (timeout * 1000) : 0;
 
     while (true) {
-        rc = init_transport(NULL, NULL, &ctx);
+        rc = init_transport(NULL, socket_path, &ctx);
 
         if (rc == PB_RESULT_OK) {
             rc = get_uuid(ctx, uuid);
             pb_api_free_context(ctx);
         }
 
-        if (rc != PB_RESULT_OK) {
-            if (timeout > 0) {
-                sleep(1);
-                timeout--;
-            } else {
-                PyErr_SetString(PyExc_TimeoutError, "No device found");
-                return NULL;
-            }
-        } else {
-            break;
-        }
-    };
+        if (rc == PB_RESULT_OK)
+            return rc;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        if (((int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000) >= deadline_ms)
+            return -PB_RESULT_TIMEOUT;
+
+        usleep(100000);
+    }
+}
+#endif
+
+static PyObject *wait_for_device(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = { "timeout", "uuid", "socket_path", NULL };
+    long long timeout = -1;
+    char *device_uuid = NULL;
+    char *socket_path = NULL;
+    int rc;
+    (void)self;
+
+    /* Allow passing None for args */
+    if (!PyArg_ParseTupleAndKeywords(
+            args, kwds, "|Lzz", kwlist, &timeout, &device_uuid, &socket_path)) {
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    if (socket_path) {
+#ifdef __linux__
+        rc = wait_for_socket(socket_path, timeout);
+#else
+        rc = -PB_RESULT_NOT_SUPPORTED;
+#endif
+    } else {
+        rc = pb_usb_wait_for_device(device_uuid, (timeout > 0) ? (int)(timeout * 1000) : 0);
+    }
+    Py_END_ALLOW_THREADS
+
+    if (rc != PB_RESULT_OK) {
+        PyErr_SetString(PyExc_TimeoutError, "No device found");
+        return NULL;
+    }
 
     Py_RETURN_NONE;
 }
@@ -1132,7 +1331,7 @@ static PyMethodDef Punchboot_methods[] = {
         "wait_for_device",
         (PyCFunction)(void (*)(void))wait_for_device,
         METH_VARARGS | METH_KEYWORDS,
-        "Wait for a device, optional timeout in seconds",
+        "Wait for a device, optional timeout in seconds, device UUID and socket path",
     },
     {
         "list_usb_devices",
@@ -1154,6 +1353,10 @@ PyMODINIT_FUNC PyInit__punchboot(void)
         return NULL;
     }
 
+    if (PyType_Ready(&PbBlake3) < 0) {
+        return NULL;
+    }
+
     PyObject *mod = PyModule_Create(&Punchboot);
     if (mod == NULL) {
         return NULL;
@@ -1166,6 +1369,14 @@ PyMODINIT_FUNC PyInit__punchboot(void)
         return NULL;
     }
 
+    Py_INCREF(&PbBlake3);
+    if (PyModule_AddObject(mod, "Blake3", (PyObject *)&PbBlake3) < 0) {
+        Py_DECREF(&PbBlake3);
+        Py_DECREF(&PbSession);
+        Py_DECREF(mod);
+        return NULL;
+    }
+
     if (pb_exceptions_init(mod) != 0) {
         Py_DECREF(&PbSession);
         Py_DECREF(mod);
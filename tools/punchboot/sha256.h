@@ -0,0 +1,20 @@
+#ifndef TOOLS_PUNCHBOOT_SHA256_H_
+#define TOOLS_PUNCHBOOT_SHA256_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PB_SHA256_DIGEST_SIZE 32
+
+struct pb_sha256_ctx {
+    uint32_t state[8];
+    uint64_t length;
+    uint8_t block[64];
+    size_t block_len;
+};
+
+void pb_sha256_init(struct pb_sha256_ctx *ctx);
+void pb_sha256_update(struct pb_sha256_ctx *ctx, const void *data, size_t length);
+void pb_sha256_final(struct pb_sha256_ctx *ctx, uint8_t *digest);
+
+#endif // TOOLS_PUNCHBOOT_SHA256_H_
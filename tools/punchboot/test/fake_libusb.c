@@ -0,0 +1,440 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * A fake libusb backend for the host tests of the usb transport. Devices
+ * are attached and detached by the test, hotplug events are queued and
+ * delivered from libusb_handle_events, like the real library does.
+ *
+ */
+
+#include "fake_libusb.h"
+#include <libusb-1.0/libusb.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FAKE_USB_MAX_DEVICES 16
+#define FAKE_USB_MAX_EVENTS  64
+#define FAKE_USB_VID         0x1209
+#define FAKE_USB_PID         0x2019
+#define FAKE_USB_SERIAL_IDX  3
+
+struct libusb_context {
+    int dummy;
+};
+
+struct libusb_device {
+    char serial[64];
+    bool attached;
+    int refs;
+    int serial_failures;
+    int serial_reads;
+};
+
+struct libusb_device_handle {
+    libusb_device *dev;
+};
+
+static struct fake_usb {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool no_hotplug;
+    libusb_context usb_ctx;
+    libusb_device devices[FAKE_USB_MAX_DEVICES];
+    unsigned int no_of_devices;
+    libusb_hotplug_callback_fn cb;
+    void *cb_data;
+    unsigned int no_of_pending; /* Queued or being delivered */
+    unsigned int no_of_events;
+    struct fake_usb_event {
+        libusb_device *dev;
+        libusb_hotplug_event event;
+    } events[FAKE_USB_MAX_EVENTS];
+} fake = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+/* Called with the lock held */
+static libusb_device *fake_usb_lookup(const char *serial, bool create)
+{
+    libusb_device *dev;
+
+    for (unsigned int i = 0; i < fake.no_of_devices; i++) {
+        if (strcmp(fake.devices[i].serial, serial) == 0)
+            return &fake.devices[i];
+    }
+
+    if (!create || (fake.no_of_devices == FAKE_USB_MAX_DEVICES)) {
+        fprintf(stderr, "fake_libusb: unknown device '%s'\n", serial);
+        abort();
+    }
+
+    dev = &fake.devices[fake.no_of_devices++];
+    snprintf(dev->serial, sizeof(dev->serial), "%s", serial);
+    return dev;
+}
+
+/* Called with the lock held */
+static void fake_usb_queue_event(libusb_device *dev, libusb_hotplug_event event)
+{
+    if (fake.cb == NULL)
+        return;
+
+    if (fake.no_of_events == FAKE_USB_MAX_EVENTS) {
+        fprintf(stderr, "fake_libusb: event queue overflow\n");
+        abort();
+    }
+
+    /* The reference is dropped once the callback has been called */
+    dev->refs++;
+    fake.events[fake.no_of_events].dev = dev;
+    fake.events[fake.no_of_events].event = event;
+    fake.no_of_events++;
+    fake.no_of_pending++;
+    pthread_cond_broadcast(&fake.cond);
+}
+
+void fake_usb_plug(const char *serial)
+{
+    libusb_device *dev;
+
+    pthread_mutex_lock(&fake.lock);
+    dev = fake_usb_lookup(serial, true);
+
+    if (!dev->attached) {
+        dev->attached = true;
+        fake_usb_queue_event(dev, LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED);
+    }
+
+    pthread_mutex_unlock(&fake.lock);
+}
+
+void fake_usb_unplug(const char *serial)
+{
+    libusb_device *dev;
+
+    pthread_mutex_lock(&fake.lock);
+    dev = fake_usb_lookup(serial, false);
+
+    if (dev->attached) {
+        dev->attached = false;
+        fake_usb_queue_event(dev, LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT);
+    }
+
+    pthread_mutex_unlock(&fake.lock);
+}
+
+void fake_usb_fail_serial(const char *serial, int count)
+{
+    pthread_mutex_lock(&fake.lock);
+    fake_usb_lookup(serial, true)->serial_failures = count;
+    pthread_mutex_unlock(&fake.lock);
+}
+
+void fake_usb_set_hotplug(bool enable)
+{
+    fake.no_hotplug = !enable;
+}
+
+void fake_usb_sync(void)
+{
+    pthread_mutex_lock(&fake.lock);
+
+    while (fake.no_of_pending > 0)
+        pthread_cond_wait(&fake.cond, &fake.lock);
+
+    pthread_mutex_unlock(&fake.lock);
+}
+
+int fake_usb_refs(const char *serial)
+{
+    int refs;
+
+    pthread_mutex_lock(&fake.lock);
+    refs = fake_usb_lookup(serial, false)->refs;
+    pthread_mutex_unlock(&fake.lock);
+    return refs;
+}
+
+int fake_usb_serial_reads(const char *serial)
+{
+    int reads;
+
+    pthread_mutex_lock(&fake.lock);
+    reads = fake_usb_lookup(serial, false)->serial_reads;
+    pthread_mutex_unlock(&fake.lock);
+    return reads;
+}
+
+int libusb_init(libusb_context **ctx)
+{
+    *ctx = &fake.usb_ctx;
+    return LIBUSB_SUCCESS;
+}
+
+void libusb_exit(libusb_context *ctx)
+{
+    (void)ctx;
+}
+
+int libusb_has_capability(uint32_t capability)
+{
+    if (capability == LIBUSB_CAP_HAS_HOTPLUG)
+        return !fake.no_hotplug;
+
+    return 0;
+}
+
+ssize_t libusb_get_device_list(libusb_context *ctx, libusb_device ***list)
+{
+    libusb_device **devs;
+    ssize_t n = 0;
+
+    (void)ctx;
+
+    devs = calloc(FAKE_USB_MAX_DEVICES + 1, sizeof(*devs));
+
+    if (devs == NULL)
+        return LIBUSB_ERROR_IO;
+
+    pthread_mutex_lock(&fake.lock);
+    for (unsigned int i = 0; i < fake.no_of_devices; i++) {
+        if (fake.devices[i].attached) {
+            fake.devices[i].refs++;
+            devs[n++] = &fake.devices[i];
+        }
+    }
+    pthread_mutex_unlock(&fake.lock);
+
+    *list = devs;
+    return n;
+}
+
+void libusb_free_device_list(libusb_device **list, int unref_devices)
+{
+    if (unref_devices) {
+        for (int i = 0; list[i] != NULL; i++)
+            libusb_unref_device(list[i]);
+    }
+
+    free(list);
+}
+
+libusb_device *libusb_ref_device(libusb_device *dev)
+{
+    pthread_mutex_lock(&fake.lock);
+    dev->refs++;
+    pthread_mutex_unlock(&fake.lock);
+    return dev;
+}
+
+void libusb_unref_device(libusb_device *dev)
+{
+    pthread_mutex_lock(&fake.lock);
+
+    if (dev->refs == 0) {
+        fprintf(stderr, "fake_libusb: unbalanced unref of '%s'\n", dev->serial);
+        abort();
+    }
+
+    dev->refs--;
+    pthread_mutex_unlock(&fake.lock);
+}
+
+int libusb_get_device_descriptor(libusb_device *dev, struct libusb_device_descriptor *desc)
+{
+    (void)dev;
+
+    memset(desc, 0, sizeof(*desc));
+    desc->bLength = 18;
+    desc->idVendor = FAKE_USB_VID;
+    desc->idProduct = FAKE_USB_PID;
+    desc->iSerialNumber = FAKE_USB_SERIAL_IDX;
+    return LIBUSB_SUCCESS;
+}
+
+int libusb_open(libusb_device *dev, libusb_device_handle **dev_handle)
+{
+    libusb_device_handle *h;
+    bool attached;
+
+    pthread_mutex_lock(&fake.lock);
+    attached = dev->attached;
+    pthread_mutex_unlock(&fake.lock);
+
+    if (!attached)
+        return LIBUSB_ERROR_NO_DEVICE;
+
+    h = malloc(sizeof(*h));
+
+    if (h == NULL)
+        return LIBUSB_ERROR_IO;
+
+    h->dev = libusb_ref_device(dev);
+    *dev_handle = h;
+    return LIBUSB_SUCCESS;
+}
+
+void libusb_close(libusb_device_handle *dev_handle)
+{
+    libusb_unref_device(dev_handle->dev);
+    free(dev_handle);
+}
+
+int libusb_get_string_descriptor_ascii(libusb_device_handle *dev_handle,
+                                       uint8_t desc_index,
+                                       unsigned char *data,
+                                       int length)
+{
+    libusb_device *dev = dev_handle->dev;
+    int rc;
+
+    if (desc_index != FAKE_USB_SERIAL_IDX)
+        return LIBUSB_ERROR_IO;
+
+    pthread_mutex_lock(&fake.lock);
+    dev->serial_reads++;
+
+    if (!dev->attached) {
+        rc = LIBUSB_ERROR_NO_DEVICE;
+    } else if (dev->serial_failures != 0) {
+        if (dev->serial_failures > 0)
+            dev->serial_failures--;
+        rc = LIBUSB_ERROR_IO;
+    } else {
+        rc = snprintf((char *)data, length, "%s", dev->serial);
+    }
+
+    pthread_mutex_unlock(&fake.lock);
+    return rc;
+}
+
+int libusb_kernel_driver_active(libusb_device_handle *dev_handle, int interface_number)
+{
+    (void)dev_handle;
+    (void)interface_number;
+    return 0;
+}
+
+int libusb_detach_kernel_driver(libusb_device_handle *dev_handle, int interface_number)
+{
+    (void)dev_handle;
+    (void)interface_number;
+    return LIBUSB_SUCCESS;
+}
+
+int libusb_claim_interface(libusb_device_handle *dev_handle, int interface_number)
+{
+    (void)dev_handle;
+    (void)interface_number;
+    return LIBUSB_SUCCESS;
+}
+
+int libusb_release_interface(libusb_device_handle *dev_handle, int interface_number)
+{
+    (void)dev_handle;
+    (void)interface_number;
+    return LIBUSB_SUCCESS;
+}
+
+int libusb_bulk_transfer(libusb_device_handle *dev_handle,
+                         unsigned char endpoint,
+                         unsigned char *data,
+                         int length,
+                         int *actual_length,
+                         unsigned int timeout)
+{
+    (void)dev_handle;
+    (void)endpoint;
+    (void)data;
+    (void)length;
+    (void)actual_length;
+    (void)timeout;
+    return LIBUSB_ERROR_IO;
+}
+
+int libusb_hotplug_register_callback(libusb_context *ctx,
+                                     int events,
+                                     int flags,
+                                     int vendor_id,
+                                     int product_id,
+                                     int dev_class,
+                                     libusb_hotplug_callback_fn cb_fn,
+                                     void *user_data,
+                                     libusb_hotplug_callback_handle *callback_handle)
+{
+    libusb_device **devs;
+    ssize_t n;
+
+    (void)events;
+    (void)vendor_id;
+    (void)product_id;
+    (void)dev_class;
+    (void)callback_handle;
+
+    if (fake.no_hotplug)
+        return LIBUSB_ERROR_NOT_SUPPORTED;
+
+    pthread_mutex_lock(&fake.lock);
+    fake.cb = cb_fn;
+    fake.cb_data = user_data;
+    pthread_mutex_unlock(&fake.lock);
+
+    /* The attached devices are reported before this returns */
+    if (flags & LIBUSB_HOTPLUG_ENUMERATE) {
+        n = libusb_get_device_list(ctx, &devs);
+
+        for (ssize_t i = 0; i < n; i++)
+            cb_fn(ctx, devs[i], LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED, user_data);
+
+        libusb_free_device_list(devs, 1);
+    }
+
+    return LIBUSB_SUCCESS;
+}
+
+/* Delivers the queued events, or returns after a while without any */
+int libusb_handle_events(libusb_context *ctx)
+{
+    struct fake_usb_event events[FAKE_USB_MAX_EVENTS];
+    unsigned int no_of_events;
+    struct timespec deadline;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += 100000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&fake.lock);
+
+    while (fake.no_of_events == 0) {
+        if (pthread_cond_timedwait(&fake.cond, &fake.lock, &deadline) != 0)
+            break;
+    }
+
+    no_of_events = fake.no_of_events;
+    memcpy(events, fake.events, sizeof(events[0]) * no_of_events);
+    fake.no_of_events = 0;
+    pthread_mutex_unlock(&fake.lock);
+
+    for (unsigned int i = 0; i < no_of_events; i++) {
+        fake.cb(ctx, events[i].dev, events[i].event, fake.cb_data);
+        libusb_unref_device(events[i].dev);
+    }
+
+    pthread_mutex_lock(&fake.lock);
+    fake.no_of_pending -= no_of_events;
+    pthread_cond_broadcast(&fake.cond);
+    pthread_mutex_unlock(&fake.lock);
+
+    return LIBUSB_SUCCESS;
+}
@@ -0,0 +1,55 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef TOOLS_PUNCHBOOT_TEST_FAKE_LIBUSB_H_
+#define TOOLS_PUNCHBOOT_TEST_FAKE_LIBUSB_H_
+
+#include <stdbool.h>
+
+/**
+ * Attach a punchboot device. The serial number string of the device is
+ * 'serial'. A hotplug event is queued if a callback is registered.
+ */
+void fake_usb_plug(const char *serial);
+
+/**
+ * Detach a device. Open handles keep working until they are closed, but
+ * new opens fail with LIBUSB_ERROR_NO_DEVICE.
+ */
+void fake_usb_unplug(const char *serial);
+
+/**
+ * Make the next 'count' serial number reads of a device fail with
+ * LIBUSB_ERROR_IO. A negative count fails all reads.
+ */
+void fake_usb_fail_serial(const char *serial, int count);
+
+/**
+ * Enable or disable LIBUSB_CAP_HAS_HOTPLUG. Must be called before the
+ * transport is used.
+ */
+void fake_usb_set_hotplug(bool enable);
+
+/**
+ * Wait until all queued hotplug events have been delivered by
+ * libusb_handle_events.
+ */
+void fake_usb_sync(void);
+
+/**
+ * @return The number of references held on a device
+ */
+int fake_usb_refs(const char *serial);
+
+/**
+ * @return The number of serial number reads of a device
+ */
+int fake_usb_serial_reads(const char *serial);
+
+#endif // TOOLS_PUNCHBOOT_TEST_FAKE_LIBUSB_H_
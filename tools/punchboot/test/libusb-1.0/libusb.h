@@ -0,0 +1,105 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * The subset of the libusb-1.0 API that is used by the usb transport. The
+ * host tests link the transport against the fake backend in fake_libusb.c
+ * instead of a real libusb, so the tests don't need libusb or a device.
+ *
+ */
+
+#ifndef FAKE_LIBUSB_LIBUSB_H_
+#define FAKE_LIBUSB_LIBUSB_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#define LIBUSB_CALL
+
+typedef struct libusb_context libusb_context;
+typedef struct libusb_device libusb_device;
+typedef struct libusb_device_handle libusb_device_handle;
+
+struct libusb_device_descriptor {
+    uint8_t bLength;
+    uint16_t idVendor;
+    uint16_t idProduct;
+    uint8_t iSerialNumber;
+};
+
+enum libusb_error {
+    LIBUSB_SUCCESS = 0,
+    LIBUSB_ERROR_IO = -1,
+    LIBUSB_ERROR_NO_DEVICE = -4,
+    LIBUSB_ERROR_NOT_SUPPORTED = -12,
+};
+
+enum libusb_capability {
+    LIBUSB_CAP_HAS_HOTPLUG = 0x0001,
+};
+
+enum libusb_endpoint_direction {
+    LIBUSB_ENDPOINT_OUT = 0x00,
+    LIBUSB_ENDPOINT_IN = 0x80,
+};
+
+typedef enum {
+    LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED = 0x01,
+    LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT = 0x02,
+} libusb_hotplug_event;
+
+typedef enum {
+    LIBUSB_HOTPLUG_ENUMERATE = 0x01,
+} libusb_hotplug_flag;
+
+#define LIBUSB_HOTPLUG_MATCH_ANY -1
+
+typedef int libusb_hotplug_callback_handle;
+
+typedef int(LIBUSB_CALL *libusb_hotplug_callback_fn)(libusb_context *ctx,
+                                                     libusb_device *device,
+                                                     libusb_hotplug_event event,
+                                                     void *user_data);
+
+int libusb_init(libusb_context **ctx);
+void libusb_exit(libusb_context *ctx);
+int libusb_has_capability(uint32_t capability);
+
+ssize_t libusb_get_device_list(libusb_context *ctx, libusb_device ***list);
+void libusb_free_device_list(libusb_device **list, int unref_devices);
+libusb_device *libusb_ref_device(libusb_device *dev);
+void libusb_unref_device(libusb_device *dev);
+int libusb_get_device_descriptor(libusb_device *dev, struct libusb_device_descriptor *desc);
+
+int libusb_open(libusb_device *dev, libusb_device_handle **dev_handle);
+void libusb_close(libusb_device_handle *dev_handle);
+int libusb_get_string_descriptor_ascii(libusb_device_handle *dev_handle,
+                                       uint8_t desc_index,
+                                       unsigned char *data,
+                                       int length);
+int libusb_kernel_driver_active(libusb_device_handle *dev_handle, int interface_number);
+int libusb_detach_kernel_driver(libusb_device_handle *dev_handle, int interface_number);
+int libusb_claim_interface(libusb_device_handle *dev_handle, int interface_number);
+int libusb_release_interface(libusb_device_handle *dev_handle, int interface_number);
+int libusb_bulk_transfer(libusb_device_handle *dev_handle,
+                         unsigned char endpoint,
+                         unsigned char *data,
+                         int length,
+                         int *actual_length,
+                         unsigned int timeout);
+
+int libusb_hotplug_register_callback(libusb_context *ctx,
+                                     int events,
+                                     int flags,
+                                     int vendor_id,
+                                     int product_id,
+                                     int dev_class,
+                                     libusb_hotplug_callback_fn cb_fn,
+                                     void *user_data,
+                                     libusb_hotplug_callback_handle *callback_handle);
+int libusb_handle_events(libusb_context *ctx);
+
+#endif // FAKE_LIBUSB_LIBUSB_H_
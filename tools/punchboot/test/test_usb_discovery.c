@@ -0,0 +1,145 @@
+/**
+ * Punch BOOT
+ *
+ * Copyright (C) 2023 Jonas Blixt <jonpe960@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Device discovery of the usb transport against the fake libusb backend.
+ * Runs with hotplug events by default and polls the bus when started with
+ * 'poll'.
+ *
+ */
+
+#include "fake_libusb.h"
+#include "usb.h"
+#include <pb-tools/error.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define UUID_A "4d1d2a6c-06c9-4e4c-bd86-0d8f0a0e2a01"
+#define UUID_B "4d1d2a6c-06c9-4e4c-bd86-0d8f0a0e2a02"
+#define UUID_C "4d1d2a6c-06c9-4e4c-bd86-0d8f0a0e2a03"
+#define UUID_D "4d1d2a6c-06c9-4e4c-bd86-0d8f0a0e2a04"
+
+#define LATE_ARRIVAL_MS 200
+
+#define CHECK(expr)                                                            \
+    do {                                                                       \
+        if (!(expr)) {                                                         \
+            fprintf(stderr, "%s:%i: '%s' failed\n", __FILE__, __LINE__, #expr); \
+            exit(1);                                                           \
+        }                                                                      \
+    } while (0)
+
+static bool hotplug = true;
+
+static unsigned int time_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned int)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+/* Hotplug events are delivered by the discovery thread, wait for them to
+ * be processed so that the next lookup sees the new state of the bus */
+static void sync_events(void)
+{
+    if (hotplug)
+        fake_usb_sync();
+}
+
+static void *late_arrival(void *arg)
+{
+    usleep(LATE_ARRIVAL_MS * 1000);
+    fake_usb_plug((const char *)arg);
+    return NULL;
+}
+
+static void test_arrival(void)
+{
+    fake_usb_plug(UUID_A);
+    CHECK(pb_usb_wait_for_device(UUID_A, 0) == PB_RESULT_OK);
+    CHECK(pb_usb_wait_for_device(NULL, 0) == PB_RESULT_OK);
+    CHECK(pb_usb_wait_for_device(UUID_B, 0) == -PB_RESULT_TIMEOUT);
+}
+
+static void test_late_arrival(void)
+{
+    pthread_t thread;
+    unsigned int t0;
+
+    t0 = time_ms();
+    CHECK(pthread_create(&thread, NULL, late_arrival, UUID_B) == 0);
+    CHECK(pb_usb_wait_for_device(UUID_B, 5000) == PB_RESULT_OK);
+    CHECK(pthread_join(thread, NULL) == 0);
+
+    /* Returns on arrival, not at the timeout */
+    CHECK((time_ms() - t0) >= LATE_ARRIVAL_MS);
+    CHECK((time_ms() - t0) < 2000);
+}
+
+static void test_departure(void)
+{
+    fake_usb_unplug(UUID_A);
+    sync_events();
+    CHECK(pb_usb_wait_for_device(UUID_A, 0) == -PB_RESULT_TIMEOUT);
+    CHECK(pb_usb_wait_for_device(UUID_A, 200) == -PB_RESULT_TIMEOUT);
+    CHECK(pb_usb_wait_for_device(UUID_B, 0) == PB_RESULT_OK);
+
+    /* No references to the device are left behind */
+    CHECK(fake_usb_refs(UUID_A) == 0);
+
+    fake_usb_plug(UUID_A);
+    sync_events();
+    CHECK(pb_usb_wait_for_device(UUID_A, 0) == PB_RESULT_OK);
+}
+
+static void test_serial_failure(void)
+{
+    int reads;
+
+    /* A device that never reports its serial number is not matched by
+     * UUID, but it is still a punchboot device */
+    fake_usb_unplug(UUID_A);
+    fake_usb_unplug(UUID_B);
+    fake_usb_fail_serial(UUID_C, -1);
+    fake_usb_plug(UUID_C);
+    sync_events();
+    CHECK(pb_usb_wait_for_device(UUID_C, 300) == -PB_RESULT_TIMEOUT);
+    CHECK(pb_usb_wait_for_device(NULL, 0) == PB_RESULT_OK);
+
+    /* With hotplug the serial number is read once per arrival, with a few
+     * attempts, and not again on every lookup */
+    reads = fake_usb_serial_reads(UUID_C);
+    CHECK(pb_usb_wait_for_device(UUID_C, 0) == -PB_RESULT_TIMEOUT);
+    if (hotplug)
+        CHECK(fake_usb_serial_reads(UUID_C) == reads);
+
+    /* A read that fails right after arrival is retried */
+    fake_usb_fail_serial(UUID_D, 1);
+    fake_usb_plug(UUID_D);
+    sync_events();
+    CHECK(pb_usb_wait_for_device(UUID_D, 1000) == PB_RESULT_OK);
+}
+
+int main(int argc, char **argv)
+{
+    if ((argc > 1) && (strcmp(argv[1], "poll") == 0)) {
+        hotplug = false;
+        fake_usb_set_hotplug(false);
+    }
+
+    test_arrival();
+    test_late_arrival();
+    test_departure();
+    test_serial_failure();
+
+    printf("usb discovery (%s): ok\n", hotplug ? "hotplug" : "poll");
+    return 0;
+}
@@ -10,12 +10,24 @@
 #include "usb.h"
 #include "api.h"
 #include <libusb-1.0/libusb.h>
+#include <pb-tools/compat.h>
 #include <pb-tools/error.h>
 #include <pb-tools/wire.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+
+#ifdef _MSC_VER
+#include <windows.h>
+#else
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+/* libusb has no hotplug support on windows */
+#define PB_USB_HOTPLUG
+#endif
 
 struct pb_usb_private {
     libusb_device *dev;
@@ -25,116 +37,435 @@ struct pb_usb_private {
     const char *device_uuid;
 };
 
-#define PB_USB_PRIVATE(__ctx) ((struct pb_usb_private *)ctx->transport)
-#define PB_USB_VID            0x1209
-#define PB_USB_PID            0x2019
+#define PB_USB_PRIVATE(__ctx)   ((struct pb_usb_private *)ctx->transport)
+#define PB_USB_VID              0x1209
+#define PB_USB_PID              0x2019
+#define PB_USB_SERIAL_LEN       128
+#define PB_USB_MAX_DEVICES      128
+#define PB_USB_SERIAL_ATTEMPTS  3
+#define PB_USB_SERIAL_RETRY_US  50000
+#define PB_USB_POLL_INTERVAL_US 100000
 
-static void pb_usb_close_handle(struct pb_usb_private *p)
+static uint64_t pb_usb_time_ms(void)
 {
-    if (p->h == NULL)
-        return;
-
-    libusb_close(p->h);
-    p->h = NULL;
+#ifdef _MSC_VER
+    return GetTickCount64();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#endif
 }
 
-static int pb_usb_init(struct pb_context *ctx)
+/* The serial number string of a punchboot device is its UUID */
+static int pb_usb_read_serial(libusb_device *dev, char *serial, size_t len)
 {
+    struct libusb_device_descriptor desc;
+    libusb_device_handle *h;
     int rc;
-    struct pb_usb_private *priv = PB_USB_PRIVATE(ctx);
 
-    rc = libusb_init(&priv->usb_ctx);
+    rc = libusb_get_device_descriptor(dev, &desc);
 
     if (rc < 0)
-        return -PB_RESULT_ERROR;
+        return rc;
 
-    return PB_RESULT_OK;
+    rc = libusb_open(dev, &h);
+
+    if (rc != 0)
+        return rc;
+
+    rc = libusb_get_string_descriptor_ascii(
+        h, desc.iSerialNumber, (unsigned char *)serial, (int)len);
+    libusb_close(h);
+    return rc;
 }
 
-static int pb_usb_connect(struct pb_context *ctx)
+static bool pb_usb_is_punchboot(libusb_device *dev)
 {
-    int rc = PB_RESULT_OK;
-    int i = 0;
-    bool found_device = false;
-    unsigned char device_serial[128];
-    struct pb_usb_private *priv = PB_USB_PRIVATE(ctx);
-    libusb_device *dev;
+    struct libusb_device_descriptor desc;
+
+    if (libusb_get_device_descriptor(dev, &desc) < 0)
+        return false;
+
+    return (desc.idVendor == PB_USB_VID) && (desc.idProduct == PB_USB_PID);
+}
+
+/* Enumerate the bus and open every punchboot device until 'device_uuid'
+ * is found. Used when libusb can't deliver hotplug events. */
+static int pb_usb_scan(libusb_context *usb_ctx, const char *device_uuid, libusb_device **dev_out)
+{
+    char device_serial[PB_USB_SERIAL_LEN];
     libusb_device **devs;
+    libusb_device *dev;
+    int rc = -PB_RESULT_NOT_FOUND;
+    int i = 0;
 
-    if (libusb_get_device_list(NULL, &devs) < 0)
+    if (libusb_get_device_list(usb_ctx, &devs) < 0)
         return -PB_RESULT_NOT_FOUND;
 
     while ((dev = devs[i++]) != NULL) {
-        struct libusb_device_descriptor desc;
+        if (!pb_usb_is_punchboot(dev))
+            continue;
 
-        rc = libusb_get_device_descriptor(dev, &desc);
+        if (device_uuid) {
+            if (pb_usb_read_serial(dev, device_serial, sizeof(device_serial)) < 0)
+                continue;
 
-        if (rc < 0)
-            continue;
+            if (strcmp(device_serial, device_uuid) != 0)
+                continue;
+        }
+
+        *dev_out = libusb_ref_device(dev);
+        rc = PB_RESULT_OK;
+        break;
+    }
 
-        if ((desc.idVendor == PB_USB_VID) && (desc.idProduct == PB_USB_PID)) {
-            if (priv->device_uuid) {
-                rc = libusb_open(dev, &priv->h);
-                if (rc != 0)
-                    continue;
+    libusb_free_device_list(devs, 1);
+    return rc;
+}
 
-                rc = libusb_get_string_descriptor_ascii(
-                    priv->h, desc.iSerialNumber, device_serial, sizeof(device_serial));
+#ifdef PB_USB_HOTPLUG
+/* Devices are added to the map by the hotplug callback. The callback must
+ * not do I/O, so the serial numbers are read by the event thread, once per
+ * device when it arrives instead of on every connect. */
+static struct pb_usb_discovery {
+    int status;
+    libusb_context *usb_ctx;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    unsigned int no_of_unresolved;
+    struct pb_usb_device_entry {
+        libusb_device *dev; /* NULL for a free entry */
+        bool resolved; /* The serial number has been read */
+        bool has_serial; /* False if the device could not be opened */
+        char serial[PB_USB_SERIAL_LEN];
+    } devices[PB_USB_MAX_DEVICES];
+} discovery = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+static pthread_once_t discovery_once = PTHREAD_ONCE_INIT;
 
-                pb_usb_close_handle(priv);
+static int LIBUSB_CALL pb_usb_hotplug_cb(libusb_context *usb_ctx,
+                                         libusb_device *dev,
+                                         libusb_hotplug_event event,
+                                         void *user_data)
+{
+    (void)usb_ctx;
+    (void)user_data;
 
-                if (rc < 0)
-                    continue;
+    pthread_mutex_lock(&discovery.lock);
 
-                if (strcmp((char *)device_serial, priv->device_uuid) != 0)
-                    continue;
+    for (int i = 0; i < PB_USB_MAX_DEVICES; i++) {
+        struct pb_usb_device_entry *e = &discovery.devices[i];
+
+        if (event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED) {
+            if (e->dev != NULL)
+                continue;
+
+            e->dev = libusb_ref_device(dev);
+            e->resolved = false;
+            e->has_serial = false;
+            discovery.no_of_unresolved++;
+            break;
+        } else if (e->dev == dev) {
+            if (!e->resolved)
+                discovery.no_of_unresolved--;
+
+            libusb_unref_device(e->dev);
+            e->dev = NULL;
+            break;
+        }
+    }
+
+    pthread_cond_broadcast(&discovery.cond);
+    pthread_mutex_unlock(&discovery.lock);
+    return 0;
+}
+
+static void pb_usb_resolve_devices(void)
+{
+    while (true) {
+        char serial[PB_USB_SERIAL_LEN];
+        libusb_device *dev = NULL;
+        int rc = -1;
+
+        pthread_mutex_lock(&discovery.lock);
+        for (int i = 0; i < PB_USB_MAX_DEVICES; i++) {
+            if ((discovery.devices[i].dev != NULL) && !discovery.devices[i].resolved) {
+                dev = libusb_ref_device(discovery.devices[i].dev);
+                break;
             }
-            priv->dev = dev;
-            found_device = true;
+        }
+        pthread_mutex_unlock(&discovery.lock);
+
+        if (dev == NULL)
+            return;
+
+        /* The descriptors are not always readable right after arrival */
+        for (int n = 0; n < PB_USB_SERIAL_ATTEMPTS; n++) {
+            rc = pb_usb_read_serial(dev, serial, sizeof(serial));
+
+            if (rc >= 0)
+                break;
+
+            usleep(PB_USB_SERIAL_RETRY_US);
+        }
+
+        pthread_mutex_lock(&discovery.lock);
+        for (int i = 0; i < PB_USB_MAX_DEVICES; i++) {
+            struct pb_usb_device_entry *e = &discovery.devices[i];
+
+            /* The device may have left while it was opened */
+            if ((e->dev != dev) || e->resolved)
+                continue;
+
+            e->resolved = true;
+            e->has_serial = (rc >= 0);
+            if (e->has_serial)
+                memcpy(e->serial, serial, sizeof(serial));
+            discovery.no_of_unresolved--;
             break;
         }
+        pthread_cond_broadcast(&discovery.cond);
+        pthread_mutex_unlock(&discovery.lock);
+
+        libusb_unref_device(dev);
     }
+}
+
+static void *pb_usb_discovery_thread(void *arg)
+{
+    (void)arg;
 
-    if (!found_device) {
-        rc = -PB_RESULT_NOT_FOUND;
-        goto err_free_devs_out;
+    while (true) {
+        pb_usb_resolve_devices();
+        libusb_handle_events(discovery.usb_ctx);
     }
 
-    rc = libusb_open(priv->dev, &priv->h);
+    return NULL;
+}
 
-    if (rc != 0) {
-        rc = -PB_RESULT_NOT_FOUND;
-        goto err_free_devs_out;
+static void pb_usb_discovery_init(void)
+{
+    pthread_t thread;
+    int rc;
+
+    if (!libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG)) {
+        discovery.status = -PB_RESULT_NOT_SUPPORTED;
+        return;
     }
 
-    if (libusb_kernel_driver_active(priv->h, 0))
-        libusb_detach_kernel_driver(priv->h, 0);
+    if (libusb_init(&discovery.usb_ctx) < 0) {
+        discovery.status = -PB_RESULT_ERROR;
+        return;
+    }
 
-    rc = libusb_claim_interface(priv->h, 0);
+    /* With 'ENUMERATE' the callback is called for the attached devices
+     * before this returns */
+    rc = libusb_hotplug_register_callback(discovery.usb_ctx,
+                                          LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED |
+                                              LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT,
+                                          LIBUSB_HOTPLUG_ENUMERATE,
+                                          PB_USB_VID,
+                                          PB_USB_PID,
+                                          LIBUSB_HOTPLUG_MATCH_ANY,
+                                          pb_usb_hotplug_cb,
+                                          NULL,
+                                          NULL);
+
+    if (rc != LIBUSB_SUCCESS) {
+        discovery.status = -PB_RESULT_NOT_SUPPORTED;
+        return;
+    }
 
-    if (rc != 0) {
-        rc = -PB_RESULT_ERROR;
-        goto err_close_dev_out;
+    if (pthread_create(&thread, NULL, pb_usb_discovery_thread, NULL) != 0) {
+        discovery.status = -PB_RESULT_ERROR;
+        return;
     }
-    priv->interface_claimed = true;
 
-    if (priv->h == NULL)
-        rc = -PB_RESULT_ERROR;
+    pthread_detach(thread);
+    discovery.status = PB_RESULT_OK;
+}
 
-    libusb_free_device_list(devs, 1);
+static struct pb_usb_device_entry *pb_usb_discovery_match(const char *device_uuid)
+{
+    for (int i = 0; i < PB_USB_MAX_DEVICES; i++) {
+        struct pb_usb_device_entry *e = &discovery.devices[i];
 
-    if (rc == PB_RESULT_OK)
-        ctx->connected = true;
+        if (e->dev == NULL)
+            continue;
 
-    return rc;
+        /* Any device will do, the serial number is not needed */
+        if (device_uuid == NULL)
+            return e;
 
-err_close_dev_out:
-    pb_usb_close_handle(priv);
-err_free_devs_out:
-    libusb_free_device_list(devs, 1);
+        if (e->has_serial && (strcmp(e->serial, device_uuid) == 0))
+            return e;
+    }
+
+    return NULL;
+}
+
+/* Look up a device in the map. A timeout of zero only waits for the
+ * serial numbers of the attached devices, a negative timeout waits
+ * forever. */
+static int pb_usb_discovery_find(const char *device_uuid, int timeout_ms, libusb_device **dev_out)
+{
+    struct pb_usb_device_entry *e;
+    struct timespec deadline;
+    int rc = -PB_RESULT_NOT_FOUND;
+
+    pthread_once(&discovery_once, pb_usb_discovery_init);
+
+    if (discovery.status != PB_RESULT_OK)
+        return discovery.status;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&discovery.lock);
+
+    while (true) {
+        e = pb_usb_discovery_match(device_uuid);
+
+        if (e != NULL) {
+            *dev_out = libusb_ref_device(e->dev);
+            rc = PB_RESULT_OK;
+            break;
+        }
+
+        if (timeout_ms == 0) {
+            if (discovery.no_of_unresolved == 0)
+                break;
+            pthread_cond_wait(&discovery.cond, &discovery.lock);
+        } else if (timeout_ms < 0) {
+            pthread_cond_wait(&discovery.cond, &discovery.lock);
+        } else if (pthread_cond_timedwait(&discovery.cond, &discovery.lock, &deadline) ==
+                   ETIMEDOUT) {
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&discovery.lock);
     return rc;
 }
 
+static int pb_usb_discovery_list(void (*list_cb)(const char *uuid_str, void *priv),
+                                 void *list_cb_priv)
+{
+    char(*serials)[PB_USB_SERIAL_LEN];
+    int no_of_serials = 0;
+
+    pthread_once(&discovery_once, pb_usb_discovery_init);
+
+    if (discovery.status != PB_RESULT_OK)
+        return discovery.status;
+
+    serials = malloc(sizeof(*serials) * PB_USB_MAX_DEVICES);
+
+    if (serials == NULL)
+        return -PB_RESULT_NO_MEMORY;
+
+    pthread_mutex_lock(&discovery.lock);
+
+    while (discovery.no_of_unresolved > 0)
+        pthread_cond_wait(&discovery.cond, &discovery.lock);
+
+    for (int i = 0; i < PB_USB_MAX_DEVICES; i++) {
+        if ((discovery.devices[i].dev != NULL) && discovery.devices[i].has_serial)
+            memcpy(serials[no_of_serials++], discovery.devices[i].serial, PB_USB_SERIAL_LEN);
+    }
+
+    pthread_mutex_unlock(&discovery.lock);
+
+    /* The callback runs without the lock, it may call back into python */
+    for (int i = 0; i < no_of_serials; i++)
+        list_cb(serials[i], list_cb_priv);
+
+    free(serials);
+    return PB_RESULT_OK;
+}
+#else
+static int pb_usb_discovery_find(const char *device_uuid, int timeout_ms, libusb_device **dev_out)
+{
+    (void)device_uuid;
+    (void)timeout_ms;
+    (void)dev_out;
+    return -PB_RESULT_NOT_SUPPORTED;
+}
+
+static int pb_usb_discovery_list(void (*list_cb)(const char *uuid_str, void *priv),
+                                 void *list_cb_priv)
+{
+    (void)list_cb;
+    (void)list_cb_priv;
+    return -PB_RESULT_NOT_SUPPORTED;
+}
+#endif // PB_USB_HOTPLUG
+
+static void pb_usb_close_handle(struct pb_usb_private *p)
+{
+    if (p->h == NULL)
+        return;
+
+    libusb_close(p->h);
+    p->h = NULL;
+}
+
+static int pb_usb_init(struct pb_context *ctx)
+{
+    int rc;
+    struct pb_usb_private *priv = PB_USB_PRIVATE(ctx);
+
+    rc = libusb_init(&priv->usb_ctx);
+
+    if (rc < 0)
+        return -PB_RESULT_ERROR;
+
+    return PB_RESULT_OK;
+}
+
+static int pb_usb_connect(struct pb_context *ctx)
+{
+    int rc;
+    struct pb_usb_private *priv = PB_USB_PRIVATE(ctx);
+
+    rc = pb_usb_discovery_find(priv->device_uuid, 0, &priv->dev);
+
+    if (rc == -PB_RESULT_NOT_SUPPORTED)
+        rc = pb_usb_scan(priv->usb_ctx, priv->device_uuid, &priv->dev);
+
+    if (rc != PB_RESULT_OK)
+        return rc;
+
+    rc = libusb_open(priv->dev, &priv->h);
+
+    if (rc != 0)
+        return -PB_RESULT_NOT_FOUND;
+
+    if (libusb_kernel_driver_active(priv->h, 0))
+        libusb_detach_kernel_driver(priv->h, 0);
+
+    rc = libusb_claim_interface(priv->h, 0);
+
+    if (rc != 0) {
+        pb_usb_close_handle(priv);
+        return -PB_RESULT_ERROR;
+    }
+
+    priv->interface_claimed = true;
+    ctx->connected = true;
+    return PB_RESULT_OK;
+}
+
 static int pb_usb_free(struct pb_context *ctx)
 {
     struct pb_usb_private *priv = PB_USB_PRIVATE(ctx);
@@ -143,6 +474,10 @@ static int pb_usb_free(struct pb_context *ctx)
         libusb_release_interface(priv->h, 0);
 
     pb_usb_close_handle(priv);
+
+    if (priv->dev != NULL)
+        libusb_unref_device(priv->dev);
+
     libusb_exit(priv->usb_ctx);
     free(ctx->transport);
     return PB_RESULT_OK;
@@ -180,39 +515,26 @@ static int pb_usb_list(struct pb_context *ctx,
                        void (*list_cb)(const char *uuid_str, void *priv),
                        void *list_cb_priv)
 {
-    int rc = PB_RESULT_OK;
-    int i = 0;
-    unsigned char device_serial[128];
+    char device_serial[PB_USB_SERIAL_LEN];
     struct pb_usb_private *priv = PB_USB_PRIVATE(ctx);
-    struct libusb_device_descriptor desc;
     libusb_device *dev;
     libusb_device **devs;
+    int i = 0;
 
-    if (libusb_get_device_list(NULL, &devs) < 0)
+    if (pb_usb_discovery_list(list_cb, list_cb_priv) == PB_RESULT_OK)
+        return PB_RESULT_OK;
+
+    if (libusb_get_device_list(priv->usb_ctx, &devs) < 0)
         return -PB_RESULT_ERROR;
 
     while ((dev = devs[i++]) != NULL) {
-        rc = libusb_get_device_descriptor(dev, &desc);
-
-        if (rc < 0)
+        if (!pb_usb_is_punchboot(dev))
             continue;
 
-        if ((desc.idVendor == PB_USB_VID) && (desc.idProduct == PB_USB_PID)) {
-            rc = libusb_open(dev, &priv->h);
-
-            if (rc != 0)
-                continue;
-
-            rc = libusb_get_string_descriptor_ascii(
-                priv->h, desc.iSerialNumber, device_serial, sizeof(device_serial));
-
-            if (rc < 0)
-                continue;
-
-            pb_usb_close_handle(priv);
+        if (pb_usb_read_serial(dev, device_serial, sizeof(device_serial)) < 0)
+            continue;
 
-            list_cb((const char *)device_serial, list_cb_priv);
-        }
+        list_cb(device_serial, list_cb_priv);
     }
 
     libusb_free_device_list(devs, 1);
@@ -240,3 +562,44 @@ int pb_usb_transport_init(struct pb_context *ctx, const char *device_uuid)
 
     return ctx->init(ctx);
 }
+
+int pb_usb_wait_for_device(const char *device_uuid, int timeout_ms)
+{
+    libusb_context *usb_ctx;
+    libusb_device *dev;
+    uint64_t deadline = pb_usb_time_ms() + (uint64_t)((timeout_ms > 0) ? timeout_ms : 0);
+    int rc;
+
+    rc = pb_usb_discovery_find(device_uuid, timeout_ms, &dev);
+
+    if (rc == PB_RESULT_OK) {
+        libusb_unref_device(dev);
+        return PB_RESULT_OK;
+    }
+
+    if (rc != -PB_RESULT_NOT_SUPPORTED)
+        return -PB_RESULT_TIMEOUT;
+
+    if (libusb_init(&usb_ctx) < 0)
+        return -PB_RESULT_ERROR;
+
+    /* No hotplug events, poll the bus */
+    while (true) {
+        rc = pb_usb_scan(usb_ctx, device_uuid, &dev);
+
+        if (rc == PB_RESULT_OK) {
+            libusb_unref_device(dev);
+            break;
+        }
+
+        if ((timeout_ms >= 0) && (pb_usb_time_ms() >= deadline)) {
+            rc = -PB_RESULT_TIMEOUT;
+            break;
+        }
+
+        usleep(PB_USB_POLL_INTERVAL_US);
+    }
+
+    libusb_exit(usb_ctx);
+    return rc;
+}
@@ -5,4 +5,20 @@
 
 int pb_usb_transport_init(struct pb_context *ctx, const char *device_uuid);
 
+/**
+ * Wait for a punchboot device to enumerate.
+ *
+ * With libusb hotplug support the devices are tracked by a discovery thread
+ * that is started on first use and this returns as soon as the device is
+ * attached. Otherwise the bus is polled.
+ *
+ * @param[in] device_uuid UUID string of the device or NULL for any device
+ * @param[in] timeout_ms Timeout in ms, zero only checks the attached devices
+ *                       and a negative value waits forever
+ *
+ * @return PB_RESULT_OK on success,
+ *        -PB_RESULT_TIMEOUT if no device was found
+ */
+int pb_usb_wait_for_device(const char *device_uuid, int timeout_ms);
+
 #endif // INCLUDE_PB_USB_TRANSPORT_H_